@@ -214,6 +214,10 @@ extern const char *(*MEM_name_ptr)(void *vmemh);
 /* Switch allocator to slower but fully guarded mode. */
 void MEM_use_guarded_allocator(void);
 
+/* Switch allocator to keep small blocks in per-thread caches, using NUMA node local memory when
+ * available. Like the guarded allocator, this must be done before any allocation happened. */
+void MEM_use_pooled_allocator(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
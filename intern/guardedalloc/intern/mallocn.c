@@ -123,3 +123,34 @@ void MEM_use_guarded_allocator(void)
   MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_pooled_allocator(void)
+{
+  MEM_pooled_init();
+
+  MEM_allocN_len = MEM_pooled_allocN_len;
+  MEM_freeN = MEM_pooled_freeN;
+  MEM_dupallocN = MEM_pooled_dupallocN;
+  MEM_reallocN_id = MEM_pooled_reallocN_id;
+  MEM_recallocN_id = MEM_pooled_recallocN_id;
+  MEM_callocN = MEM_pooled_callocN;
+  MEM_calloc_arrayN = MEM_pooled_calloc_arrayN;
+  MEM_mallocN = MEM_pooled_mallocN;
+  MEM_malloc_arrayN = MEM_pooled_malloc_arrayN;
+  MEM_mallocN_aligned = MEM_pooled_mallocN_aligned;
+  MEM_printmemlist_pydict = MEM_pooled_printmemlist_pydict;
+  MEM_printmemlist = MEM_pooled_printmemlist;
+  MEM_callbackmemlist = MEM_pooled_callbackmemlist;
+  MEM_printmemlist_stats = MEM_pooled_printmemlist_stats;
+  MEM_set_error_callback = MEM_pooled_set_error_callback;
+  MEM_consistency_check = MEM_pooled_consistency_check;
+  MEM_set_memory_debug = MEM_pooled_set_memory_debug;
+  MEM_get_memory_in_use = MEM_pooled_get_memory_in_use;
+  MEM_get_memory_blocks_in_use = MEM_pooled_get_memory_blocks_in_use;
+  MEM_reset_peak_memory = MEM_pooled_reset_peak_memory;
+  MEM_get_peak_memory = MEM_pooled_get_peak_memory;
+
+#ifndef NDEBUG
+  MEM_name_ptr = MEM_pooled_name_ptr;
+#endif
+}
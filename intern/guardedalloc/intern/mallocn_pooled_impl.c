@@ -0,0 +1,835 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup MEM
+ *
+ * Memory allocation which keeps small blocks in per-thread caches.
+ *
+ * Small blocks are split from spans which are allocated on the NUMA node of the thread that
+ * needs them (when NUMA is available). Freed blocks go to the cache of the freeing thread, when a
+ * cache holds too many blocks of one size, some of them are moved to a global list where other
+ * threads can take them from. Small blocks are never given back to the system.
+ *
+ * Memory counters are split into shards on separate cache lines, so threads don't all write to
+ * the same memory on every allocation. Large and aligned blocks use the system allocator.
+ */
+
+#include <pthread.h>
+#include <sched.h> /* sched_yield */
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <sys/types.h>
+
+#include "MEM_guardedalloc.h"
+
+/* to ensure strict conversions */
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+#include "atomic_ops.h"
+#include "mallocn_intern.h"
+#include "numaapi.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h> /* _mm_pause */
+#endif
+
+typedef struct MemHead {
+  /* Length of allocated memory block. */
+  size_t len;
+} MemHead;
+
+typedef struct MemHeadAligned {
+  short alignment;
+  size_t len;
+} MemHeadAligned;
+
+enum {
+  MEMHEAD_ALIGN_FLAG = 1,
+  /* Block comes from a span, and is stored in a size class list when freed. */
+  MEMHEAD_POOLED_FLAG = 2,
+};
+
+#define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
+#define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
+#define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
+#define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_POOLED(memhead) ((memhead)->len & (size_t)MEMHEAD_POOLED_FLAG)
+
+/* Blocks (including their MemHead) up to `SIZE_CLASS_STEP * SIZE_CLASSES_NUM` bytes are pooled,
+ * rounded up to a multiple of `SIZE_CLASS_STEP`. */
+#define SIZE_CLASS_STEP 16
+#define SIZE_CLASSES_NUM 64
+#define SIZE_CLASS_MAX_LEN (SIZE_CLASS_STEP * SIZE_CLASSES_NUM)
+
+/* Size of memory chunks requested from the system, which are split into blocks. */
+#define SPAN_SIZE (256 * 1024)
+
+/* Number of bytes in blocks moved between thread caches and global lists at once. */
+#define TRANSFER_SIZE (16 * 1024)
+
+#define STAT_SHARDS_NUM 64
+#define CACHE_LINE_SIZE 64
+
+#ifdef _MSC_VER
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#  define MEM_THREAD_LOCAL __thread
+#endif
+
+typedef struct FreeBlock {
+  struct FreeBlock *next;
+} FreeBlock;
+
+typedef struct FreeList {
+  FreeBlock *first;
+  unsigned int len;
+} FreeList;
+
+typedef struct StatShard {
+  int64_t mem_in_use;
+  int64_t totblock;
+  char _pad[CACHE_LINE_SIZE - 2 * sizeof(int64_t)];
+} StatShard;
+
+typedef struct ThreadCache {
+  FreeList free_lists[SIZE_CLASSES_NUM];
+  /* Unused part of the last span. */
+  char *span_next;
+  char *span_end;
+  /* Statistics are counted here, may be shared with other threads. */
+  StatShard *stat_shard;
+} ThreadCache;
+
+typedef struct GlobalFreeList {
+  FreeList list;
+  uint32_t lock;
+  char _pad[CACHE_LINE_SIZE - sizeof(FreeList) - sizeof(uint32_t)];
+} GlobalFreeList;
+
+/* Sum of all shards gives the actual values. A single shard can go below zero,
+ * when blocks are freed by another thread than the one that allocated them. */
+static StatShard stat_shards[STAT_SHARDS_NUM];
+static uint32_t stat_shard_next = 0;
+static size_t peak_mem = 0;
+static size_t span_mem = 0;
+
+static GlobalFreeList global_free_lists[SIZE_CLASSES_NUM];
+
+static pthread_key_t thread_cache_key;
+static MEM_THREAD_LOCAL ThreadCache *thread_cache = NULL;
+static bool use_numa = false;
+
+static bool malloc_debug_memset = false;
+
+static void (*error_callback)(const char *) = NULL;
+
+#ifdef __GNUC__
+__attribute__((format(printf, 1, 2)))
+#endif
+static void
+print_error(const char *str, ...)
+{
+  char buf[512];
+  va_list ap;
+
+  va_start(ap, str);
+  vsnprintf(buf, sizeof(buf), str, ap);
+  va_end(ap);
+  buf[sizeof(buf) - 1] = '\0';
+
+  if (error_callback) {
+    error_callback(buf);
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Statistics
+ * \{ */
+
+MEM_INLINE StatShard *stat_shard_get(const ThreadCache *cache)
+{
+  /* Threads without cache share the first shard. */
+  return cache ? cache->stat_shard : &stat_shards[0];
+}
+
+MEM_INLINE void stat_add(StatShard *shard, size_t len)
+{
+  atomic_add_and_fetch_int64(&shard->mem_in_use, (int64_t)len);
+  atomic_add_and_fetch_int64(&shard->totblock, 1);
+}
+
+MEM_INLINE void stat_sub(StatShard *shard, size_t len)
+{
+  atomic_sub_and_fetch_int64(&shard->mem_in_use, (int64_t)len);
+  atomic_sub_and_fetch_int64(&shard->totblock, 1);
+}
+
+static size_t stat_mem_in_use(void)
+{
+  int64_t mem_in_use = 0;
+  for (int i = 0; i < STAT_SHARDS_NUM; i++) {
+    mem_in_use += stat_shards[i].mem_in_use;
+  }
+  return (mem_in_use > 0) ? (size_t)mem_in_use : 0;
+}
+
+static unsigned int stat_totblock(void)
+{
+  int64_t totblock = 0;
+  for (int i = 0; i < STAT_SHARDS_NUM; i++) {
+    totblock += stat_shards[i].totblock;
+  }
+  return (totblock > 0) ? (unsigned int)totblock : 0;
+}
+
+/* Summing all shards on every allocation would defeat their purpose,
+ * so the peak is only updated when memory is requested from the system. */
+static void stat_update_peak(void)
+{
+  atomic_fetch_and_update_max_z(&peak_mem, stat_mem_in_use());
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Size Classes
+ * \{ */
+
+MEM_INLINE int size_class_from_block_len(size_t block_len)
+{
+  return (int)((block_len - 1) / SIZE_CLASS_STEP);
+}
+
+MEM_INLINE size_t size_class_block_len(int size_class)
+{
+  return (size_t)(size_class + 1) * SIZE_CLASS_STEP;
+}
+
+MEM_INLINE unsigned int size_class_transfer_len(int size_class)
+{
+  return (unsigned int)(TRANSFER_SIZE / size_class_block_len(size_class));
+}
+
+/* Number of busy-wait iterations on a taken lock before the thread yields its time slice. */
+#define SPIN_LOCK_YIELD_COUNT 64
+
+MEM_INLINE void spin_lock_pause(void)
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+static void global_free_list_lock(GlobalFreeList *global_list)
+{
+  while (atomic_cas_uint32(&global_list->lock, 0, 1) != 0) {
+    /* Wait with plain reads until the lock looks free, so the cache line is not written to
+     * while another thread holds it. */
+    int spins = 0;
+    while (*(volatile uint32_t *)&global_list->lock != 0) {
+      if (++spins < SPIN_LOCK_YIELD_COUNT) {
+        spin_lock_pause();
+      }
+      else {
+        sched_yield();
+        spins = 0;
+      }
+    }
+  }
+}
+
+static void global_free_list_unlock(GlobalFreeList *global_list)
+{
+  atomic_cas_uint32(&global_list->lock, 1, 0);
+}
+
+/* Move the first `len` blocks of the list to the global list. */
+static void global_free_list_push(int size_class, FreeList *list, unsigned int len)
+{
+  FreeBlock *first = list->first;
+  FreeBlock *last = first;
+  for (unsigned int i = 1; i < len; i++) {
+    last = last->next;
+  }
+  list->first = last->next;
+  list->len -= len;
+
+  GlobalFreeList *global_list = &global_free_lists[size_class];
+  global_free_list_lock(global_list);
+  last->next = global_list->list.first;
+  global_list->list.first = first;
+  global_list->list.len += len;
+  global_free_list_unlock(global_list);
+}
+
+static void global_free_list_push_block(int size_class, FreeBlock *block)
+{
+  FreeList list = {block, 1};
+  block->next = NULL;
+  global_free_list_push(size_class, &list, 1);
+}
+
+/* Move up to `len` blocks from the global list to the (empty) list. */
+static void global_free_list_pop(int size_class, FreeList *list, unsigned int len)
+{
+  GlobalFreeList *global_list = &global_free_lists[size_class];
+  if (global_list->list.first == NULL) {
+    return;
+  }
+
+  global_free_list_lock(global_list);
+  FreeBlock *first = global_list->list.first;
+  if (first != NULL) {
+    FreeBlock *last = first;
+    unsigned int last_len = 1;
+    while (last_len < len && last->next != NULL) {
+      last = last->next;
+      last_len++;
+    }
+    global_list->list.first = last->next;
+    global_list->list.len -= last_len;
+
+    last->next = list->first;
+    list->first = first;
+    list->len += last_len;
+  }
+  global_free_list_unlock(global_list);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Thread Caches
+ * \{ */
+
+static char *span_alloc(void)
+{
+  void *span = NULL;
+  if (use_numa) {
+    /* Pages are placed on the node of the thread which uses the span. */
+    span = numaAPI_AllocateLocal(SPAN_SIZE);
+  }
+  if (span == NULL) {
+    span = malloc(SPAN_SIZE);
+  }
+  if (span != NULL) {
+    atomic_add_and_fetch_z(&span_mem, SPAN_SIZE);
+  }
+  return span;
+}
+
+/* Give the unused part of the current span to the global lists, so it doesn't get lost. */
+static void span_release_remainder(ThreadCache *cache)
+{
+  while (cache->span_next + SIZE_CLASS_STEP <= cache->span_end) {
+    const size_t remainder = (size_t)(cache->span_end - cache->span_next);
+    const int size_class = (remainder >= SIZE_CLASS_MAX_LEN) ?
+                               SIZE_CLASSES_NUM - 1 :
+                               (int)(remainder / SIZE_CLASS_STEP) - 1;
+    global_free_list_push_block(size_class, (FreeBlock *)cache->span_next);
+    cache->span_next += size_class_block_len(size_class);
+  }
+  cache->span_next = cache->span_end = NULL;
+}
+
+static FreeBlock *thread_cache_refill(ThreadCache *cache, int size_class)
+{
+  FreeList *list = &cache->free_lists[size_class];
+  const unsigned int transfer_len = size_class_transfer_len(size_class);
+
+  /* Reuse blocks freed by other threads first. */
+  global_free_list_pop(size_class, list, transfer_len);
+  if (list->first != NULL) {
+    return list->first;
+  }
+
+  const size_t block_len = size_class_block_len(size_class);
+  for (unsigned int i = 0; i < transfer_len; i++) {
+    if (cache->span_next + block_len > cache->span_end) {
+      if (i > 0) {
+        break;
+      }
+      char *span = span_alloc();
+      if (span == NULL) {
+        return NULL;
+      }
+      span_release_remainder(cache);
+      cache->span_next = span;
+      cache->span_end = span + SPAN_SIZE;
+      stat_update_peak();
+    }
+    FreeBlock *block = (FreeBlock *)cache->span_next;
+    cache->span_next += block_len;
+    block->next = list->first;
+    list->first = block;
+    list->len++;
+  }
+
+  return list->first;
+}
+
+static void thread_cache_free(void *cache_v)
+{
+  ThreadCache *cache = cache_v;
+  for (int size_class = 0; size_class < SIZE_CLASSES_NUM; size_class++) {
+    FreeList *list = &cache->free_lists[size_class];
+    if (list->len > 0) {
+      global_free_list_push(size_class, list, list->len);
+    }
+  }
+  span_release_remainder(cache);
+
+  /* The cache is created again when the thread allocates from another key destructor. */
+  if (thread_cache == cache) {
+    thread_cache = NULL;
+  }
+  free(cache);
+}
+
+MEM_INLINE ThreadCache *thread_cache_ensure(void)
+{
+  ThreadCache *cache = thread_cache;
+  if (LIKELY(cache != NULL)) {
+    return cache;
+  }
+
+  cache = calloc(1, sizeof(ThreadCache));
+  if (UNLIKELY(cache == NULL)) {
+    return NULL;
+  }
+  const uint32_t shard_index = atomic_fetch_and_add_uint32(&stat_shard_next, 1);
+  cache->stat_shard = &stat_shards[shard_index % STAT_SHARDS_NUM];
+  /* Only used to flush the cache when the thread ends. */
+  pthread_setspecific(thread_cache_key, cache);
+  thread_cache = cache;
+  return cache;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocator API
+ * \{ */
+
+/* `len` should be aligned already, returns NULL on failure. */
+static MemHead *mem_pooled_alloc(size_t len, bool clear)
+{
+  ThreadCache *cache = thread_cache_ensure();
+  MemHead *memh;
+
+  if (LIKELY(cache != NULL && len + sizeof(MemHead) <= SIZE_CLASS_MAX_LEN)) {
+    const int size_class = size_class_from_block_len(len + sizeof(MemHead));
+    FreeList *list = &cache->free_lists[size_class];
+    FreeBlock *block = list->first;
+    if (UNLIKELY(block == NULL)) {
+      block = thread_cache_refill(cache, size_class);
+      if (UNLIKELY(block == NULL)) {
+        return NULL;
+      }
+    }
+    list->first = block->next;
+    list->len--;
+
+    memh = (MemHead *)block;
+    memh->len = len | (size_t)MEMHEAD_POOLED_FLAG;
+    if (clear) {
+      memset(memh + 1, 0, len);
+    }
+    stat_add(stat_shard_get(cache), len);
+  }
+  else {
+    memh = clear ? (MemHead *)calloc(1, len + sizeof(MemHead)) :
+                   (MemHead *)malloc(len + sizeof(MemHead));
+    if (UNLIKELY(memh == NULL)) {
+      return NULL;
+    }
+    memh->len = len;
+    stat_add(stat_shard_get(cache), len);
+    stat_update_peak();
+  }
+
+  if (UNLIKELY(malloc_debug_memset && len && !clear)) {
+    memset(memh + 1, 255, len);
+  }
+
+  return memh;
+}
+
+size_t MEM_pooled_allocN_len(const void *vmemh)
+{
+  if (vmemh) {
+    return MEMHEAD_FROM_PTR(vmemh)->len &
+           ~((size_t)(MEMHEAD_ALIGN_FLAG) | (size_t)(MEMHEAD_POOLED_FLAG));
+  }
+  else {
+    return 0;
+  }
+}
+
+void MEM_pooled_freeN(void *vmemh)
+{
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  size_t len = MEM_pooled_allocN_len(vmemh);
+
+  if (vmemh == NULL) {
+    print_error("Attempt to free NULL pointer\n");
+#ifdef WITH_ASSERT_ABORT
+    abort();
+#endif
+    return;
+  }
+
+  ThreadCache *cache = thread_cache_ensure();
+  stat_sub(stat_shard_get(cache), len);
+
+  if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+  if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+    MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+    aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+  }
+  else if (LIKELY(MEMHEAD_IS_POOLED(memh))) {
+    const int size_class = size_class_from_block_len(len + sizeof(MemHead));
+    FreeBlock *block = (FreeBlock *)memh;
+    if (LIKELY(cache != NULL)) {
+      FreeList *list = &cache->free_lists[size_class];
+      block->next = list->first;
+      list->first = block;
+      list->len++;
+
+      const unsigned int transfer_len = size_class_transfer_len(size_class);
+      if (UNLIKELY(list->len > 2 * transfer_len)) {
+        global_free_list_push(size_class, list, transfer_len);
+      }
+    }
+    else {
+      global_free_list_push_block(size_class, block);
+    }
+  }
+  else {
+    free(memh);
+  }
+}
+
+void *MEM_pooled_dupallocN(const void *vmemh)
+{
+  void *newp = NULL;
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    const size_t prev_size = MEM_pooled_allocN_len(vmemh);
+    if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_pooled_mallocN_aligned(
+          prev_size, (size_t)memh_aligned->alignment, "dupli_malloc");
+    }
+    else {
+      newp = MEM_pooled_mallocN(prev_size, "dupli_malloc");
+    }
+    memcpy(newp, vmemh, prev_size);
+  }
+  return newp;
+}
+
+void *MEM_pooled_reallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_pooled_allocN_len(vmemh);
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_pooled_mallocN(len, "realloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_pooled_mallocN_aligned(len, (size_t)memh_aligned->alignment, "realloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        /* grow (or remain same size) */
+        memcpy(newp, vmemh, old_len);
+      }
+    }
+
+    MEM_pooled_freeN(vmemh);
+  }
+  else {
+    newp = MEM_pooled_mallocN(len, str);
+  }
+
+  return newp;
+}
+
+void *MEM_pooled_recallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_pooled_allocN_len(vmemh);
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_pooled_mallocN(len, "recalloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_pooled_mallocN_aligned(len, (size_t)memh_aligned->alignment, "recalloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        memcpy(newp, vmemh, old_len);
+
+        if (len > old_len) {
+          /* grow */
+          /* zero new bytes */
+          memset(((char *)newp) + old_len, 0, len - old_len);
+        }
+      }
+    }
+
+    MEM_pooled_freeN(vmemh);
+  }
+  else {
+    newp = MEM_pooled_callocN(len, str);
+  }
+
+  return newp;
+}
+
+void *MEM_pooled_callocN(size_t len, const char *str)
+{
+  MemHead *memh;
+
+  len = SIZET_ALIGN_4(len);
+
+  memh = mem_pooled_alloc(len, true);
+
+  if (LIKELY(memh)) {
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)stat_mem_in_use());
+  return NULL;
+}
+
+void *MEM_pooled_calloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Calloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)stat_mem_in_use());
+    abort();
+    return NULL;
+  }
+
+  return MEM_pooled_callocN(total_size, str);
+}
+
+void *MEM_pooled_mallocN(size_t len, const char *str)
+{
+  MemHead *memh;
+
+  len = SIZET_ALIGN_4(len);
+
+  memh = mem_pooled_alloc(len, false);
+
+  if (LIKELY(memh)) {
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)stat_mem_in_use());
+  return NULL;
+}
+
+void *MEM_pooled_malloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Malloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)stat_mem_in_use());
+    abort();
+    return NULL;
+  }
+
+  return MEM_pooled_mallocN(total_size, str);
+}
+
+void *MEM_pooled_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+  /* Huge alignment values doesn't make sense and they wouldn't fit into 'short' used in the
+   * MemHead. */
+  assert(alignment < 1024);
+
+  /* We only support alignments that are a power of two. */
+  assert(IS_POW2(alignment));
+
+  /* Some OS specific aligned allocators require a certain minimal alignment. */
+  if (alignment < ALIGNED_MALLOC_MINIMUM_ALIGNMENT) {
+    alignment = ALIGNED_MALLOC_MINIMUM_ALIGNMENT;
+  }
+
+  /* It's possible that MemHead's size is not properly aligned,
+   * do extra padding to deal with this. */
+  size_t extra_padding = MEMHEAD_ALIGN_PADDING(alignment);
+
+  len = SIZET_ALIGN_4(len);
+
+  MemHeadAligned *memh = (MemHeadAligned *)aligned_malloc(
+      len + extra_padding + sizeof(MemHeadAligned), alignment);
+
+  if (LIKELY(memh)) {
+    /* We keep padding in the beginning of MemHead,
+     * this way it's always possible to get MemHead
+     * from the data pointer.
+     */
+    memh = (MemHeadAligned *)((char *)memh + extra_padding);
+
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
+    memh->alignment = (short)alignment;
+    stat_add(stat_shard_get(thread_cache_ensure()), len);
+    stat_update_peak();
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)stat_mem_in_use());
+  return NULL;
+}
+
+void MEM_pooled_printmemlist_pydict(void)
+{
+}
+
+void MEM_pooled_printmemlist(void)
+{
+}
+
+/* unused */
+void MEM_pooled_callbackmemlist(void (*func)(void *))
+{
+  (void)func; /* Ignored. */
+}
+
+void MEM_pooled_printmemlist_stats(void)
+{
+  stat_update_peak();
+
+  printf("\ntotal memory len: %.3f MB\n", (double)stat_mem_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  printf("pooled memory reserved: %.3f MB (%s)\n",
+         (double)span_mem / (double)(1024 * 1024),
+         use_numa ? "NUMA node local" : "NUMA not available");
+  printf(
+      "\nFor more detailed per-block statistics run Blender with memory debugging command line "
+      "argument.\n");
+
+#ifdef HAVE_MALLOC_STATS
+  printf("System Statistics:\n");
+  malloc_stats();
+#endif
+}
+
+void MEM_pooled_set_error_callback(void (*func)(const char *))
+{
+  error_callback = func;
+}
+
+bool MEM_pooled_consistency_check(void)
+{
+  return true;
+}
+
+void MEM_pooled_set_memory_debug(void)
+{
+  malloc_debug_memset = true;
+}
+
+size_t MEM_pooled_get_memory_in_use(void)
+{
+  return stat_mem_in_use();
+}
+
+unsigned int MEM_pooled_get_memory_blocks_in_use(void)
+{
+  return stat_totblock();
+}
+
+void MEM_pooled_reset_peak_memory(void)
+{
+  peak_mem = stat_mem_in_use();
+}
+
+size_t MEM_pooled_get_peak_memory(void)
+{
+  stat_update_peak();
+  return peak_mem;
+}
+
+#ifndef NDEBUG
+const char *MEM_pooled_name_ptr(void *vmemh)
+{
+  if (vmemh) {
+    return "unknown block name ptr";
+  }
+  else {
+    return "MEM_pooled_name_ptr(NULL)";
+  }
+}
+#endif /* NDEBUG */
+
+void MEM_pooled_init(void)
+{
+  pthread_key_create(&thread_cache_key, thread_cache_free);
+  use_numa = (numaAPI_Initialize() == NUMAAPI_SUCCESS);
+}
+
+/** \} */
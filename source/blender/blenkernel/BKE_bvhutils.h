@@ -260,6 +260,21 @@ bool bvhcache_has_tree(const struct BVHCache *bvh_cache, const BVHTree *tree);
 struct BVHCache *bvhcache_init(void);
 void bvhcache_free(struct BVHCache *bvh_cache);
 
+/**
+ * Shared BVHCache, for meshes with the same geometry.
+ */
+
+typedef struct BVHCacheSharedStats {
+  /** Number of trees found in the shared cache, and built because they were not. */
+  unsigned int hits, misses;
+  unsigned int entries_num;
+  size_t mem_in_use;
+} BVHCacheSharedStats;
+
+void BKE_bvhcache_shared_stats_get(BVHCacheSharedStats *r_stats);
+void BKE_bvhcache_shared_mem_limit_set(size_t mem_limit);
+void BKE_bvhcache_shared_exit(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -89,6 +89,8 @@ typedef struct Cloth {
   short pad3;
   struct BVHTree *bvhtree;     /* collision tree for this cloth object */
   struct BVHTree *bvhselftree; /* collision tree for this cloth object */
+  float bvhtree_cost;     /* SAH cost of bvhtree when it was last balanced. */
+  float bvhselftree_cost; /* SAH cost of bvhselftree when it was last balanced. */
   struct MVertTri *tri;
   struct Implicit_Data *implicit; /* our implicit solver connects to this pointer */
   struct EdgeSet *edgeset;        /* used for selfcollisions */
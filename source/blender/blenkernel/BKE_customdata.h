@@ -81,6 +81,12 @@ void customData_mask_layers__print(const struct CustomData_MeshMasks *mask);
 
 typedef void (*cd_interp)(
     const void **sources, const float *weights, const float *sub_weights, int count, void *dest);
+typedef void (*cd_interp_multi)(const void *src_data,
+                                const int *src_indices,
+                                const float *weights,
+                                const int *src_offsets,
+                                int dest_len,
+                                void *dest_data);
 typedef void (*cd_copy)(const void *source, void *dest, int count);
 typedef bool (*cd_validate)(void *item, const uint totitems, const bool do_fixes);
 
@@ -231,6 +237,8 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
                                                   const char *name,
                                                   const int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
+const void *CustomData_retain_layer_data(struct CustomData *data, int type, void **r_sharing);
+void CustomData_release_layer_data(void *sharing, int type, const void *layer_data, int totelem);
 
 /* set the CD_FLAG_NOCOPY flag in custom data layers where the mask is
  * zero for the layer type, so only layer types specified by the mask
@@ -296,6 +304,20 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+/* interpolates many dest elements at once, one layer at a time, layers are matched like in
+ * CustomData_interp. dest element (dest_index + i) is interpolated from the source elements
+ * src_indices[src_offsets[i]] to src_indices[src_offsets[i + 1] - 1], with the weights at the
+ * same positions (1 when weights == NULL). sub-element weights are not supported.
+ *
+ * the dest elements must not be used as source elements.
+ */
+void CustomData_interp_multi(const struct CustomData *source,
+                             struct CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             const int *src_offsets,
+                             int dest_index,
+                             int dest_len);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
@@ -55,6 +55,7 @@ void BKE_image_free_packedfiles(struct Image *image);
 void BKE_image_free_views(struct Image *image);
 void BKE_image_free_buffers(struct Image *image);
 void BKE_image_free_buffers_ex(struct Image *image, bool do_lock);
+unsigned int BKE_image_buffers_generation(void);
 /* call from library */
 void BKE_image_free(struct Image *image);
 
@@ -38,6 +38,7 @@
 
 #include "DNA_scene_types.h"
 
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -55,6 +56,12 @@
 
 #include "DEG_depsgraph.h"
 
+#include "CLG_log.h"
+
+#include "PIL_time.h"
+
+static CLG_LogRef LOG = {"bke.blender_undo"};
+
 /* -------------------------------------------------------------------- */
 /** \name Global Undo
  * \{ */
@@ -100,6 +107,18 @@ bool BKE_memfile_undo_decode(MemFileUndoData *mfu,
   return success;
 }
 
+/** Total size of the chunks which share their memory with the previous undo step. */
+static size_t memfile_undo_shared_size(const MemFile *memfile)
+{
+  size_t size = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->is_identical) {
+      size += chunk->size;
+    }
+  }
+  return size;
+}
+
 MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
 {
   MemFileUndoData *mfu = MEM_callocN(sizeof(MemFileUndoData), __func__);
@@ -123,12 +142,20 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
     BLI_strncpy(mfu->filename, filename, sizeof(mfu->filename));
   }
   else {
+    const double time_start = PIL_check_seconds_timer();
     MemFile *prevfile = (mfu_prev) ? &(mfu_prev->memfile) : NULL;
     if (prevfile) {
       BLO_memfile_clear_future(prevfile);
     }
     /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
     mfu->undo_size = mfu->memfile.size;
+
+    CLOG_INFO(&LOG,
+              1,
+              "Memfile undo push: %.3f ms, %zu bytes stored, %zu bytes shared with previous step",
+              (PIL_check_seconds_timer() - time_start) * 1000.0,
+              mfu->memfile.size,
+              memfile_undo_shared_size(&mfu->memfile));
   }
 
   bmain->is_memfile_undo_written = true;
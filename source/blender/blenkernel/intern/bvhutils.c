@@ -29,12 +29,17 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_bvhutils.h"
+#include "BKE_customdata.h"
 #include "BKE_editmesh.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
@@ -48,6 +53,8 @@
 typedef struct BVHCacheItem {
   bool is_filled;
   BVHTree *tree;
+  /** When set the tree is owned by the shared cache, see #BVHCacheShared. */
+  struct BVHCacheShared *shared;
 } BVHCacheItem;
 
 typedef struct BVHCache {
@@ -146,6 +153,8 @@ static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType typ
   item->is_filled = true;
 }
 
+static void bvhcache_shared_release(struct BVHCacheShared *shared);
+
 /**
  * frees a bvhcache
  */
@@ -153,13 +162,538 @@ void bvhcache_free(BVHCache *bvh_cache)
 {
   for (BVHCacheType index = 0; index < BVHTREE_MAX_ITEM; index++) {
     BVHCacheItem *item = &bvh_cache->items[index];
-    BLI_bvhtree_free(item->tree);
+    if (item->shared) {
+      bvhcache_shared_release(item->shared);
+      item->shared = NULL;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+    }
     item->tree = NULL;
   }
   BLI_mutex_end(&bvh_cache->mutex);
   MEM_freeN(bvh_cache);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Shared BVHCache
+ *
+ * Trees built by #BKE_bvhtree_from_mesh_get are shared by all evaluated meshes with the same
+ * coordinates and topology, such as the evaluated copies of a mesh used by many objects. Entries
+ * are found by a hash of a sample of the elements, then the elements the tree is built from are
+ * compared, so a hash collision never returns the tree of another mesh. Entries are referenced by
+ * the #BVHCache of every mesh using them. Unused entries are kept for meshes evaluated later,
+ * until the memory limit is exceeded and the least recently used ones are freed.
+ *
+ * Entries don't copy the mesh arrays they compare with, they retain the #CustomData layers of the
+ * mesh the tree was built from (see #CustomData_retain_layer_data), which keep their data until
+ * the entry is freed and are copied by writers. Meshes in #Main are written to in place, their
+ * trees are not shared. Neither are the trees of meshes seen for the first time, so unique meshes
+ * don't pay for the comparisons and the memory of the entries.
+ *
+ * The global mutex only guards the lookup, trees are built without holding it. Threads needing
+ * a tree that is being built by another thread wait for that tree only.
+ * \{ */
+
+#define BVHCACHE_SHARED_MEM_LIMIT_DEFAULT ((size_t)256 << 20)
+
+#define BVHCACHE_SHARED_LAYERS_MAX 3
+/** Number of elements of each layer hashed by #bvhcache_shared_key_from_mesh. */
+#define BVHCACHE_SHARED_HASH_SAMPLES 16
+/** Size of #g_bvhcache_shared.seen. */
+#define BVHCACHE_SHARED_SEEN_LEN 256
+
+typedef struct BVHCacheSharedLayer {
+  /** #CustomData layer type of the elements. */
+  int type;
+  int len;
+  const void *data;
+  /** Set when the data is retained for the entry, see #CustomData_retain_layer_data. */
+  void *sharing;
+} BVHCacheSharedLayer;
+
+typedef struct BVHCacheSharedKey {
+  /** Hash of the element counts and a sample of the elements. */
+  uint hash;
+  BVHCacheType type;
+  int tree_type;
+  /** The elements the tree is built from, compared when the hashes are equal. */
+  int layers_num;
+  BVHCacheSharedLayer layers[BVHCACHE_SHARED_LAYERS_MAX];
+} BVHCacheSharedKey;
+
+typedef struct BVHCacheShared {
+  /** Link in #g_bvhcache_shared.unused, when there are no users. */
+  struct BVHCacheShared *next, *prev;
+
+  /** The key layers are retained, they stay valid when the building mesh is freed. */
+  BVHCacheSharedKey key;
+  /** Can be NULL when there is nothing to build the tree from, as for #BVHCacheItem. */
+  BVHTree *tree;
+  size_t mem_size;
+
+  int users;
+  bool is_built;
+  /** The tree could not be stored, the entry is not in the cache anymore. */
+  bool is_abandoned;
+  /** Notified when the tree is built. */
+  ThreadCondition built_condition;
+} BVHCacheShared;
+
+static struct {
+  ThreadMutex mutex;
+  /** #BVHCacheSharedKey -> #BVHCacheShared. */
+  GHash *entries;
+  /** Entries without users, least recently used first. */
+  ListBase unused;
+  size_t mem_in_use;
+  size_t mem_limit;
+  /** Hashes of the keys requested before, indexed by the hash. Overwritten on collisions. */
+  uint seen[BVHCACHE_SHARED_SEEN_LEN];
+  BVHCacheSharedStats stats;
+} g_bvhcache_shared = {
+    .mutex = BLI_MUTEX_INITIALIZER,
+    .mem_limit = BVHCACHE_SHARED_MEM_LIMIT_DEFAULT,
+};
+
+/**
+ * Write the fields of element \a index of \a layer which the tree of \a type depends on to
+ * \a r_fields, the coordinates and vertex indices but no normals or other flags.
+ * \return The size of the fields in bytes.
+ */
+BLI_INLINE size_t bvhcache_shared_elem_fields(const BVHCacheSharedLayer *layer,
+                                              const BVHCacheType type,
+                                              const int index,
+                                              uint r_fields[4])
+{
+  switch (layer->type) {
+    case CD_MVERT: {
+      const MVert *mv = &((const MVert *)layer->data)[index];
+      memcpy(r_fields, mv->co, sizeof(mv->co));
+      return sizeof(mv->co);
+    }
+    case CD_MEDGE: {
+      const MEdge *me = &((const MEdge *)layer->data)[index];
+      r_fields[0] = me->v1;
+      r_fields[1] = me->v2;
+      r_fields[2] = (type == BVHTREE_FROM_LOOSEEDGES) ? (me->flag & ME_LOOSEEDGE) : 0;
+      return sizeof(uint[3]);
+    }
+    case CD_MFACE: {
+      const MFace *mf = &((const MFace *)layer->data)[index];
+      r_fields[0] = mf->v1;
+      r_fields[1] = mf->v2;
+      r_fields[2] = mf->v3;
+      r_fields[3] = mf->v4;
+      return sizeof(uint[4]);
+    }
+    case CD_MLOOP: {
+      r_fields[0] = ((const MLoop *)layer->data)[index].v;
+      return sizeof(uint);
+    }
+    case CD_MPOLY: {
+      const MPoly *mp = &((const MPoly *)layer->data)[index];
+      r_fields[0] = (uint)mp->loopstart;
+      r_fields[1] = (uint)mp->totloop;
+      r_fields[2] = (type == BVHTREE_FROM_LOOPTRI_NO_HIDDEN) ? (mp->flag & ME_HIDE) : 0;
+      return sizeof(uint[3]);
+    }
+  }
+  BLI_assert(false);
+  return 0;
+}
+
+static uint bvhcache_shared_key_hash(const void *key_v)
+{
+  const BVHCacheSharedKey *key = key_v;
+  return key->hash;
+}
+
+static bool bvhcache_shared_key_cmp(const void *a_v, const void *b_v)
+{
+  const BVHCacheSharedKey *a = a_v;
+  const BVHCacheSharedKey *b = b_v;
+  if (!((a->hash == b->hash) && (a->type == b->type) && (a->tree_type == b->tree_type) &&
+        (a->layers_num == b->layers_num))) {
+    return true;
+  }
+  for (int i = 0; i < a->layers_num; i++) {
+    const BVHCacheSharedLayer *layer_a = &a->layers[i];
+    const BVHCacheSharedLayer *layer_b = &b->layers[i];
+    if ((layer_a->type != layer_b->type) || (layer_a->len != layer_b->len)) {
+      return true;
+    }
+    if (layer_a->data == layer_b->data) {
+      /* Meshes referencing the same data, as well as a mesh looking up its own entry. */
+      continue;
+    }
+    for (int index = 0; index < layer_a->len; index++) {
+      uint fields_a[4], fields_b[4];
+      const size_t fields_len = bvhcache_shared_elem_fields(layer_a, a->type, index, fields_a);
+      bvhcache_shared_elem_fields(layer_b, b->type, index, fields_b);
+      if (memcmp(fields_a, fields_b, fields_len) != 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static void bvhcache_shared_key_layer_add(BVHCacheSharedKey *key,
+                                          BLI_HashMurmur2A *mm2,
+                                          const int type,
+                                          const void *data,
+                                          const int len)
+{
+  BLI_assert(key->layers_num < BVHCACHE_SHARED_LAYERS_MAX);
+  BVHCacheSharedLayer *layer = &key->layers[key->layers_num++];
+  layer->type = type;
+  layer->len = (data != NULL) ? len : 0;
+  layer->data = data;
+  layer->sharing = NULL;
+
+  BLI_hash_mm2a_add_int(mm2, layer->len);
+  if (layer->len == 0) {
+    return;
+  }
+  /* Evenly spaced elements, including the first and the last. */
+  const int samples_num = min_ii(layer->len, BVHCACHE_SHARED_HASH_SAMPLES);
+  for (int i = 0; i < samples_num; i++) {
+    const int index = (samples_num > 1) ?
+                          (int)(((int64_t)(layer->len - 1) * i) / (samples_num - 1)) :
+                          0;
+    uint fields[4];
+    const size_t fields_len = bvhcache_shared_elem_fields(layer, key->type, index, fields);
+    BLI_hash_mm2a_add(mm2, (const uchar *)fields, fields_len);
+  }
+}
+
+/**
+ * The key of the tree of \a type for \a mesh. It references the mesh arrays,
+ * so it is only valid as long as they are, unless they are retained.
+ */
+static void bvhcache_shared_key_from_mesh(Mesh *mesh,
+                                          const BVHCacheType type,
+                                          const int tree_type,
+                                          BVHCacheSharedKey *r_key)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add_int(&mm2, (int)type);
+  BLI_hash_mm2a_add_int(&mm2, tree_type);
+
+  r_key->type = type;
+  r_key->tree_type = tree_type;
+  r_key->layers_num = 0;
+  bvhcache_shared_key_layer_add(r_key, &mm2, CD_MVERT, mesh->mvert, mesh->totvert);
+
+  switch (type) {
+    case BVHTREE_FROM_VERTS:
+      break;
+    case BVHTREE_FROM_LOOSEVERTS:
+    case BVHTREE_FROM_EDGES:
+    case BVHTREE_FROM_LOOSEEDGES:
+      bvhcache_shared_key_layer_add(r_key, &mm2, CD_MEDGE, mesh->medge, mesh->totedge);
+      break;
+    case BVHTREE_FROM_FACES:
+      bvhcache_shared_key_layer_add(r_key, &mm2, CD_MFACE, mesh->mface, mesh->totface);
+      break;
+    case BVHTREE_FROM_LOOPTRI:
+    case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+      /* The triangles only depend on the polygons and the coordinates. */
+      bvhcache_shared_key_layer_add(r_key, &mm2, CD_MLOOP, mesh->mloop, mesh->totloop);
+      bvhcache_shared_key_layer_add(r_key, &mm2, CD_MPOLY, mesh->mpoly, mesh->totpoly);
+      break;
+    case BVHTREE_FROM_EM_VERTS:
+    case BVHTREE_FROM_EM_EDGES:
+    case BVHTREE_FROM_EM_LOOPTRI:
+    case BVHTREE_MAX_ITEM:
+      BLI_assert(false);
+      break;
+  }
+
+  r_key->hash = BLI_hash_mm2a_end(&mm2);
+}
+
+static CustomData *bvhcache_shared_layer_customdata(Mesh *mesh, const int type)
+{
+  switch (type) {
+    case CD_MVERT:
+      return &mesh->vdata;
+    case CD_MEDGE:
+      return &mesh->edata;
+    case CD_MFACE:
+      return &mesh->fdata;
+    case CD_MLOOP:
+      return &mesh->ldata;
+    case CD_MPOLY:
+      return &mesh->pdata;
+  }
+  BLI_assert(false);
+  return NULL;
+}
+
+static void bvhcache_shared_key_release(BVHCacheSharedKey *key)
+{
+  for (int i = 0; i < key->layers_num; i++) {
+    BVHCacheSharedLayer *layer = &key->layers[i];
+    if (layer->sharing != NULL) {
+      CustomData_release_layer_data(layer->sharing, layer->type, layer->data, layer->len);
+      layer->sharing = NULL;
+    }
+  }
+}
+
+/**
+ * Retain the layers of \a mesh referenced by \a key.
+ * \return False when the data of a layer can't be retained, nothing is retained then.
+ */
+static bool bvhcache_shared_key_retain(Mesh *mesh, BVHCacheSharedKey *key)
+{
+  for (int i = 0; i < key->layers_num; i++) {
+    BVHCacheSharedLayer *layer = &key->layers[i];
+    if (layer->len == 0) {
+      continue;
+    }
+    CustomData *cdata = bvhcache_shared_layer_customdata(mesh, layer->type);
+    const void *data = CustomData_retain_layer_data(cdata, layer->type, &layer->sharing);
+    if (data == NULL) {
+      bvhcache_shared_key_release(key);
+      return false;
+    }
+    BLI_assert(data == layer->data);
+  }
+  return true;
+}
+
+/** Memory used by the retained key layers, which are freed with the entry when unused. */
+static size_t bvhcache_shared_key_mem_size(const BVHCacheSharedKey *key)
+{
+  size_t mem_size = 0;
+  for (int i = 0; i < key->layers_num; i++) {
+    const BVHCacheSharedLayer *layer = &key->layers[i];
+    mem_size += (size_t)layer->len * CustomData_sizeof(layer->type);
+  }
+  return mem_size;
+}
+
+/**
+ * Check whether a key with the hash of \a key was requested before, and remember it otherwise.
+ * Collisions only make meshes share their tree later.
+ */
+static bool bvhcache_shared_seen(const BVHCacheSharedKey *key)
+{
+  uint *seen = &g_bvhcache_shared.seen[key->hash % BVHCACHE_SHARED_SEEN_LEN];
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+  const bool is_seen = (*seen == key->hash);
+  *seen = key->hash;
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+  return is_seen;
+}
+
+static void bvhcache_shared_entry_free(void *shared_v)
+{
+  BVHCacheShared *shared = shared_v;
+  BLI_bvhtree_free(shared->tree);
+  bvhcache_shared_key_release(&shared->key);
+  BLI_condition_end(&shared->built_condition);
+  MEM_freeN(shared);
+}
+
+/* Free the least recently used entries until the memory limit is respected. */
+static void bvhcache_shared_evict_unused(void)
+{
+  while (g_bvhcache_shared.mem_in_use > g_bvhcache_shared.mem_limit &&
+         g_bvhcache_shared.unused.first) {
+    BVHCacheShared *shared = g_bvhcache_shared.unused.first;
+    BLI_remlink(&g_bvhcache_shared.unused, shared);
+    BLI_ghash_remove(g_bvhcache_shared.entries, &shared->key, NULL, NULL);
+    g_bvhcache_shared.mem_in_use -= shared->mem_size;
+    bvhcache_shared_entry_free(shared);
+  }
+}
+
+/**
+ * Find the entry for \a key and add a user to it, waiting until its tree is built.
+ *
+ * \return True when the entry was created, the caller then builds the tree
+ * and passes it to #bvhcache_shared_built.
+ */
+static bool bvhcache_shared_acquire(const BVHCacheSharedKey *key, BVHCacheShared **r_shared)
+{
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+
+  if (g_bvhcache_shared.entries == NULL) {
+    g_bvhcache_shared.entries = BLI_ghash_new(
+        bvhcache_shared_key_hash, bvhcache_shared_key_cmp, __func__);
+  }
+
+  void **key_p, **val_p;
+  BVHCacheShared *shared;
+  bool is_new;
+  while (true) {
+    is_new = !BLI_ghash_ensure_p_ex(g_bvhcache_shared.entries, key, &key_p, &val_p);
+    if (is_new) {
+      shared = MEM_callocN(sizeof(*shared), __func__);
+      shared->key = *key;
+      shared->users = 1;
+      BLI_condition_init(&shared->built_condition);
+      *key_p = &shared->key;
+      *val_p = shared;
+      g_bvhcache_shared.stats.misses++;
+      break;
+    }
+    shared = *val_p;
+    if (shared->users++ == 0) {
+      BLI_remlink(&g_bvhcache_shared.unused, shared);
+    }
+    while (!shared->is_built) {
+      BLI_condition_wait(&shared->built_condition, &g_bvhcache_shared.mutex);
+    }
+    if (!shared->is_abandoned) {
+      g_bvhcache_shared.stats.hits++;
+      break;
+    }
+    /* The entry was removed while waiting for it, look up the key again. */
+    if (--shared->users == 0) {
+      bvhcache_shared_entry_free(shared);
+    }
+  }
+
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+
+  *r_shared = shared;
+  return is_new;
+}
+
+/* Store the tree of an entry created by #bvhcache_shared_acquire, the entry takes ownership. */
+static void bvhcache_shared_built(BVHCacheShared *shared, BVHTree *tree)
+{
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+  shared->tree = tree;
+  shared->mem_size = sizeof(*shared) + bvhcache_shared_key_mem_size(&shared->key) +
+                     (tree ? BLI_bvhtree_get_memory_size(tree) : 0);
+  shared->is_built = true;
+  g_bvhcache_shared.mem_in_use += shared->mem_size;
+  BLI_condition_notify_all(&shared->built_condition);
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+}
+
+/**
+ * Remove an entry created by #bvhcache_shared_acquire when its tree could not be stored.
+ * Threads waiting for the tree look it up again.
+ */
+static void bvhcache_shared_abandon(BVHCacheShared *shared)
+{
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+  BLI_ghash_remove(g_bvhcache_shared.entries, &shared->key, NULL, NULL);
+  shared->is_built = true;
+  shared->is_abandoned = true;
+  BLI_condition_notify_all(&shared->built_condition);
+  if (--shared->users == 0) {
+    bvhcache_shared_entry_free(shared);
+  }
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+}
+
+static void bvhcache_shared_release(BVHCacheShared *shared)
+{
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+  BLI_assert(shared->users > 0 && shared->is_built);
+  if (--shared->users == 0) {
+    BLI_addtail(&g_bvhcache_shared.unused, shared);
+    bvhcache_shared_evict_unused();
+  }
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+}
+
+/**
+ * Look for the tree of \a mesh in the shared cache and add it to the #BVHCache of the mesh.
+ *
+ * \return True when the tree was found. Otherwise the tree must be built, and passed to
+ * #bvhcache_shared_built when \a r_shared_new is set. Trees of meshes which are not shared are
+ * only cached by the mesh.
+ */
+static bool bvhcache_find_shared(Mesh *mesh,
+                                 const BVHCacheType type,
+                                 const int tree_type,
+                                 BVHTree **r_tree,
+                                 BVHCacheShared **r_shared_new)
+{
+  BVHCache **bvh_cache_p = (BVHCache **)&mesh->runtime.bvh_cache;
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
+
+  *r_shared_new = NULL;
+  if (!(mesh->id.tag & LIB_TAG_NO_MAIN)) {
+    return false;
+  }
+
+  BVHCacheSharedKey key;
+  bvhcache_shared_key_from_mesh(mesh, type, tree_type, &key);
+  if (!bvhcache_shared_seen(&key)) {
+    return false;
+  }
+  /* Retained before the lookup, so a new entry keeps the arrays it is compared with. */
+  if (!bvhcache_shared_key_retain(mesh, &key)) {
+    return false;
+  }
+
+  BVHCacheShared *shared;
+  if (bvhcache_shared_acquire(&key, &shared)) {
+    *r_shared_new = shared;
+    return false;
+  }
+  bvhcache_shared_key_release(&key);
+
+  bool lock_started = false;
+  if (bvhcache_find(bvh_cache_p, type, r_tree, &lock_started, mesh_eval_mutex)) {
+    /* Another thread added the tree to this mesh in the meantime. */
+    bvhcache_shared_release(shared);
+    return true;
+  }
+  bvhcache_insert(*bvh_cache_p, shared->tree, type);
+  (*bvh_cache_p)->items[type].shared = shared;
+  bvhcache_unlock(*bvh_cache_p, lock_started);
+
+  *r_tree = shared->tree;
+  return true;
+}
+
+void BKE_bvhcache_shared_stats_get(BVHCacheSharedStats *r_stats)
+{
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+  *r_stats = g_bvhcache_shared.stats;
+  r_stats->entries_num = g_bvhcache_shared.entries ?
+                             BLI_ghash_len(g_bvhcache_shared.entries) :
+                             0;
+  r_stats->mem_in_use = g_bvhcache_shared.mem_in_use;
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+}
+
+/**
+ * Set the memory used by the shared trees above which unused trees are freed.
+ */
+void BKE_bvhcache_shared_mem_limit_set(size_t mem_limit)
+{
+  BLI_mutex_lock(&g_bvhcache_shared.mutex);
+  g_bvhcache_shared.mem_limit = mem_limit;
+  bvhcache_shared_evict_unused();
+  BLI_mutex_unlock(&g_bvhcache_shared.mutex);
+}
+
+/* Only to be called on exit, after all meshes are freed. */
+void BKE_bvhcache_shared_exit(void)
+{
+  if (g_bvhcache_shared.entries) {
+    BLI_ghash_free(g_bvhcache_shared.entries, NULL, bvhcache_shared_entry_free);
+    g_bvhcache_shared.entries = NULL;
+  }
+  BLI_listbase_clear(&g_bvhcache_shared.unused);
+  g_bvhcache_shared.mem_in_use = 0;
+}
+
 /** \} */
 /* -------------------------------------------------------------------- */
 /** \name Local Callbacks
@@ -1397,24 +1931,19 @@ static BLI_bitmap *looptri_no_hidden_map_get(const MPoly *mpoly,
 }
 
 /**
- * Builds or queries a bvhcache for the cache bvhtree of the request type.
+ * Build the tree of \a bvh_cache_type for \a mesh and add it to its #BVHCache, unless
+ * \a is_cached is set. Then fill \a data to use the tree with the mesh.
  */
-BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
-                                   struct Mesh *mesh,
-                                   const BVHCacheType bvh_cache_type,
-                                   const int tree_type)
+static BVHTree *bvhtree_from_mesh_setup(BVHTreeFromMesh *data,
+                                        Mesh *mesh,
+                                        const BVHCacheType bvh_cache_type,
+                                        const int tree_type,
+                                        const bool is_cached,
+                                        BVHTree *tree)
 {
-  BVHTree *tree = NULL;
   BVHCache **bvh_cache_p = (BVHCache **)&mesh->runtime.bvh_cache;
   ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
 
-  bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, NULL, NULL);
-
-  if (is_cached && tree == NULL) {
-    memset(data, 0, sizeof(*data));
-    return tree;
-  }
-
   switch (bvh_cache_type) {
     case BVHTREE_FROM_VERTS:
     case BVHTREE_FROM_LOOSEVERTS:
@@ -1562,6 +2091,83 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
       break;
   }
 
+  return tree;
+}
+
+typedef struct BVHTreeFromMeshSetupData {
+  BVHTreeFromMesh *data;
+  Mesh *mesh;
+  BVHCacheType bvh_cache_type;
+  int tree_type;
+  BVHTree *tree;
+} BVHTreeFromMeshSetupData;
+
+static void bvhtree_from_mesh_setup_isolated_cb(void *userdata)
+{
+  BVHTreeFromMeshSetupData *setup_data = userdata;
+  setup_data->tree = bvhtree_from_mesh_setup(setup_data->data,
+                                             setup_data->mesh,
+                                             setup_data->bvh_cache_type,
+                                             setup_data->tree_type,
+                                             false,
+                                             NULL);
+}
+
+/**
+ * Builds or queries a bvhcache for the cache bvhtree of the request type.
+ */
+BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
+                                   struct Mesh *mesh,
+                                   const BVHCacheType bvh_cache_type,
+                                   const int tree_type)
+{
+  BVHTree *tree = NULL;
+  BVHCache **bvh_cache_p = (BVHCache **)&mesh->runtime.bvh_cache;
+  BVHCacheShared *shared_new = NULL;
+
+  bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, NULL, NULL);
+
+  if (is_cached == false) {
+    is_cached = bvhcache_find_shared(mesh, bvh_cache_type, tree_type, &tree, &shared_new);
+  }
+
+  if (is_cached && tree == NULL) {
+    memset(data, 0, sizeof(*data));
+    return tree;
+  }
+
+  if (shared_new != NULL) {
+    /* Other threads needing the tree wait for it, so the tasks building it must not wait for
+     * them in turn, which they could when this thread ran unrelated tasks in the meantime. */
+    BVHTreeFromMeshSetupData setup_data = {
+        .data = data,
+        .mesh = mesh,
+        .bvh_cache_type = bvh_cache_type,
+        .tree_type = tree_type,
+    };
+    BLI_task_isolate(bvhtree_from_mesh_setup_isolated_cb, &setup_data);
+    tree = setup_data.tree;
+  }
+  else {
+    tree = bvhtree_from_mesh_setup(data, mesh, bvh_cache_type, tree_type, is_cached, tree);
+  }
+
+  if (shared_new != NULL) {
+    /* The new tree is in the cache of this mesh, move its ownership to the shared cache. */
+    BVHCacheItem *item = &(*bvh_cache_p)->items[bvh_cache_type];
+    BLI_mutex_lock(&(*bvh_cache_p)->mutex);
+    if (item->tree == tree && item->shared == NULL) {
+      item->shared = shared_new;
+      BLI_mutex_unlock(&(*bvh_cache_p)->mutex);
+      bvhcache_shared_built(shared_new, tree);
+    }
+    else {
+      /* The cache of this mesh got a tree from elsewhere in the meantime, which it keeps. */
+      BLI_mutex_unlock(&(*bvh_cache_p)->mutex);
+      bvhcache_shared_abandon(shared_new);
+    }
+  }
+
   if (data->tree != NULL) {
 #ifdef DEBUG
     if (BLI_bvhtree_get_tree_type(data->tree) != tree_type) {
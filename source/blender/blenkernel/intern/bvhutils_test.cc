@@ -0,0 +1,304 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include <utility>
+
+extern "C" {
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+
+#include "BKE_bvhutils.h"
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+}
+
+namespace blender::bke::tests {
+
+/* Same as the default limit of the shared cache. */
+static const size_t BVHCACHE_SHARED_MEM_LIMIT = (size_t)256 << 20;
+
+class bvhcache_shared : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void TearDown() override
+  {
+    BKE_bvhcache_shared_mem_limit_set(BVHCACHE_SHARED_MEM_LIMIT);
+  }
+};
+
+/* A grid of `size` by `size` quads in the XY plane, moved up by `height`. */
+static Mesh *grid_mesh_create(int size, float height)
+{
+  const int verts_size = size + 1;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_size * verts_size, 0, 0, size * size * 4, size * size);
+  for (int y = 0; y < verts_size; y++) {
+    for (int x = 0; x < verts_size; x++) {
+      copy_v3_fl3(mesh->mvert[y * verts_size + x].co, (float)x, (float)y, height);
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int poly_index = y * size + x;
+      MPoly *mpoly = &mesh->mpoly[poly_index];
+      mpoly->loopstart = poly_index * 4;
+      mpoly->totloop = 4;
+      MLoop *mloop = &mesh->mloop[mpoly->loopstart];
+      mloop[0].v = y * verts_size + x;
+      mloop[1].v = y * verts_size + x + 1;
+      mloop[2].v = (y + 1) * verts_size + x + 1;
+      mloop[3].v = (y + 1) * verts_size + x;
+    }
+  }
+  return mesh;
+}
+
+static BVHCacheSharedStats stats_get()
+{
+  BVHCacheSharedStats stats;
+  BKE_bvhcache_shared_stats_get(&stats);
+  return stats;
+}
+
+/* Request the tree of a mesh with the geometry of `mesh`, so its tree is shared from now on. */
+static void tree_request_first(const Mesh *mesh, const int tree_type)
+{
+  Mesh *mesh_first = BKE_mesh_copy_for_eval((Mesh *)mesh, false);
+  BVHTreeFromMesh data;
+  BKE_bvhtree_from_mesh_get(&data, mesh_first, BVHTREE_FROM_LOOPTRI, tree_type);
+  free_bvhtree_from_mesh(&data);
+  BKE_id_free(nullptr, mesh_first);
+}
+
+TEST_F(bvhcache_shared, NotSharedWhenSeenFirst)
+{
+  const BVHCacheSharedStats stats_before = stats_get();
+
+  Mesh *mesh = grid_mesh_create(8, 1.0f);
+  BVHTreeFromMesh data;
+  BVHTree *tree = BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_NE(tree, nullptr);
+
+  const BVHCacheSharedStats stats = stats_get();
+  EXPECT_EQ(stats.misses, stats_before.misses);
+  EXPECT_EQ(stats.hits, stats_before.hits);
+  EXPECT_EQ(stats.entries_num, stats_before.entries_num);
+
+  free_bvhtree_from_mesh(&data);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(bvhcache_shared, SharedBetweenEqualMeshes)
+{
+  const BVHCacheSharedStats stats_before = stats_get();
+
+  Mesh *mesh_a = grid_mesh_create(8, 0.0f);
+  Mesh *mesh_b = grid_mesh_create(8, 0.0f);
+  Mesh *mesh_c = grid_mesh_create(8, 0.0f);
+  BVHTreeFromMesh data_a, data_b, data_c;
+  /* Built for the first mesh only. */
+  BVHTree *tree_a = BKE_bvhtree_from_mesh_get(&data_a, mesh_a, BVHTREE_FROM_LOOPTRI, 2);
+  BVHTree *tree_b = BKE_bvhtree_from_mesh_get(&data_b, mesh_b, BVHTREE_FROM_LOOPTRI, 2);
+  BVHTree *tree_c = BKE_bvhtree_from_mesh_get(&data_c, mesh_c, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_NE(tree_a, nullptr);
+  EXPECT_NE(tree_a, tree_b);
+  EXPECT_EQ(tree_b, tree_c);
+  EXPECT_EQ(BLI_bvhtree_get_len(tree_b), 8 * 8 * 2);
+
+  const BVHCacheSharedStats stats = stats_get();
+  EXPECT_EQ(stats.misses, stats_before.misses + 1);
+  EXPECT_EQ(stats.hits, stats_before.hits + 1);
+  EXPECT_EQ(stats.entries_num, stats_before.entries_num + 1);
+  EXPECT_GT(stats.mem_in_use, stats_before.mem_in_use);
+
+  free_bvhtree_from_mesh(&data_a);
+  free_bvhtree_from_mesh(&data_b);
+  free_bvhtree_from_mesh(&data_c);
+  BKE_id_free(nullptr, mesh_a);
+  BKE_id_free(nullptr, mesh_b);
+  BKE_id_free(nullptr, mesh_c);
+}
+
+TEST_F(bvhcache_shared, SharedIgnoringNormalsAndFlags)
+{
+  Mesh *mesh_a = grid_mesh_create(8, 6.0f);
+  Mesh *mesh_b = grid_mesh_create(8, 6.0f);
+  tree_request_first(mesh_a, 2);
+  mesh_b->mvert[10].no[0] = 100;
+  mesh_b->mvert[10].flag |= ME_HIDE;
+  mesh_b->mpoly[10].flag |= ME_SMOOTH;
+
+  BVHTreeFromMesh data_a, data_b;
+  BVHTree *tree_a = BKE_bvhtree_from_mesh_get(&data_a, mesh_a, BVHTREE_FROM_LOOPTRI, 2);
+  BVHTree *tree_b = BKE_bvhtree_from_mesh_get(&data_b, mesh_b, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_EQ(tree_a, tree_b);
+
+  free_bvhtree_from_mesh(&data_a);
+  free_bvhtree_from_mesh(&data_b);
+  BKE_id_free(nullptr, mesh_a);
+  BKE_id_free(nullptr, mesh_b);
+}
+
+TEST_F(bvhcache_shared, NotSharedBetweenDifferentMeshes)
+{
+  Mesh *mesh_a = grid_mesh_create(8, 4.0f);
+  Mesh *mesh_b = grid_mesh_create(8, 4.0f);
+  Mesh *mesh_c = grid_mesh_create(8, 4.0f);
+  Mesh *mesh_d = grid_mesh_create(8, 4.0f);
+  tree_request_first(mesh_a, 2);
+  tree_request_first(mesh_c, 4);
+  /* Differs from the others in a single vertex, which is not hashed. */
+  mesh_b->mvert[20].co[2] = 5.0f;
+  tree_request_first(mesh_b, 2);
+  /* Same coordinates, different topology. */
+  std::swap(mesh_d->mloop[40].v, mesh_d->mloop[41].v);
+  tree_request_first(mesh_d, 2);
+
+  BVHTreeFromMesh data_a, data_b, data_c, data_d;
+  BVHTree *tree_a = BKE_bvhtree_from_mesh_get(&data_a, mesh_a, BVHTREE_FROM_LOOPTRI, 2);
+  BVHTree *tree_b = BKE_bvhtree_from_mesh_get(&data_b, mesh_b, BVHTREE_FROM_LOOPTRI, 2);
+  /* Same geometry, different tree type. */
+  BVHTree *tree_c = BKE_bvhtree_from_mesh_get(&data_c, mesh_c, BVHTREE_FROM_LOOPTRI, 4);
+  BVHTree *tree_d = BKE_bvhtree_from_mesh_get(&data_d, mesh_d, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_NE(tree_a, tree_b);
+  EXPECT_NE(tree_a, tree_c);
+  EXPECT_NE(tree_a, tree_d);
+  EXPECT_NE(tree_b, tree_d);
+
+  free_bvhtree_from_mesh(&data_a);
+  free_bvhtree_from_mesh(&data_b);
+  free_bvhtree_from_mesh(&data_c);
+  free_bvhtree_from_mesh(&data_d);
+  BKE_id_free(nullptr, mesh_a);
+  BKE_id_free(nullptr, mesh_b);
+  BKE_id_free(nullptr, mesh_c);
+  BKE_id_free(nullptr, mesh_d);
+}
+
+TEST_F(bvhcache_shared, KeptAfterBuildingMeshIsFreed)
+{
+  Mesh *mesh_a = grid_mesh_create(8, 2.0f);
+  tree_request_first(mesh_a, 2);
+  BVHTreeFromMesh data_a;
+  BVHTree *tree_a = BKE_bvhtree_from_mesh_get(&data_a, mesh_a, BVHTREE_FROM_LOOPTRI, 2);
+  free_bvhtree_from_mesh(&data_a);
+  BKE_id_free(nullptr, mesh_a);
+
+  /* The entry compares with the arrays of the freed mesh, which it retains. */
+  const BVHCacheSharedStats stats_before = stats_get();
+  Mesh *mesh_b = grid_mesh_create(8, 2.0f);
+  BVHTreeFromMesh data_b;
+  BVHTree *tree_b = BKE_bvhtree_from_mesh_get(&data_b, mesh_b, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_EQ(tree_a, tree_b);
+  EXPECT_EQ(stats_get().hits, stats_before.hits + 1);
+
+  /* The tree references the elements of the mesh it is used with. */
+  BVHTreeRayHit hit;
+  hit.index = -1;
+  hit.dist = FLT_MAX;
+  const float co[3] = {2.5f, 3.5f, 10.0f};
+  const float dir[3] = {0.0f, 0.0f, -1.0f};
+  BLI_bvhtree_ray_cast(tree_b, co, dir, 0.0f, &hit, data_b.raycast_callback, &data_b);
+  EXPECT_NE(hit.index, -1);
+  EXPECT_FLOAT_EQ(hit.dist, 8.0f);
+
+  free_bvhtree_from_mesh(&data_b);
+  BKE_id_free(nullptr, mesh_b);
+}
+
+TEST_F(bvhcache_shared, RetainedArraysCopiedForWriting)
+{
+  Mesh *mesh_a = grid_mesh_create(8, 7.0f);
+  tree_request_first(mesh_a, 2);
+  BVHTreeFromMesh data_a;
+  BVHTree *tree_a = BKE_bvhtree_from_mesh_get(&data_a, mesh_a, BVHTREE_FROM_LOOPTRI, 2);
+  free_bvhtree_from_mesh(&data_a);
+
+  /* Writing to the vertices of the building mesh doesn't change the key of the entry. */
+  const MVert *mvert_prev = mesh_a->mvert;
+  mesh_a->mvert = (MVert *)CustomData_duplicate_referenced_layer(
+      &mesh_a->vdata, CD_MVERT, mesh_a->totvert);
+  EXPECT_NE(mesh_a->mvert, mvert_prev);
+  mesh_a->mvert[0].co[2] = 0.0f;
+
+  Mesh *mesh_b = grid_mesh_create(8, 7.0f);
+  BVHTreeFromMesh data_b;
+  BVHTree *tree_b = BKE_bvhtree_from_mesh_get(&data_b, mesh_b, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_EQ(tree_a, tree_b);
+
+  free_bvhtree_from_mesh(&data_b);
+  BKE_id_free(nullptr, mesh_a);
+  BKE_id_free(nullptr, mesh_b);
+}
+
+TEST_F(bvhcache_shared, UnusedEvicted)
+{
+  /* Free all unused entries left by other tests. */
+  BKE_bvhcache_shared_mem_limit_set(0);
+  const BVHCacheSharedStats stats_before = stats_get();
+
+  Mesh *mesh_a = grid_mesh_create(8, 0.0f);
+  Mesh *mesh_b = grid_mesh_create(8, 0.0f);
+  tree_request_first(mesh_a, 2);
+  BVHTreeFromMesh data_a, data_b;
+  BVHTree *tree_a = BKE_bvhtree_from_mesh_get(&data_a, mesh_a, BVHTREE_FROM_LOOPTRI, 2);
+  BVHTree *tree_b = BKE_bvhtree_from_mesh_get(&data_b, mesh_b, BVHTREE_FROM_LOOPTRI, 2);
+  EXPECT_EQ(tree_a, tree_b);
+  free_bvhtree_from_mesh(&data_a);
+  free_bvhtree_from_mesh(&data_b);
+
+  /* Still used by the second mesh. */
+  BKE_id_free(nullptr, mesh_a);
+  EXPECT_EQ(stats_get().entries_num, stats_before.entries_num + 1);
+
+  BKE_id_free(nullptr, mesh_b);
+  const BVHCacheSharedStats stats = stats_get();
+  EXPECT_EQ(stats.entries_num, stats_before.entries_num);
+  EXPECT_EQ(stats.mem_in_use, stats_before.mem_in_use);
+}
+
+TEST_F(bvhcache_shared, KeptBelowMemoryLimit)
+{
+  BKE_bvhcache_shared_mem_limit_set(BVHCACHE_SHARED_MEM_LIMIT);
+
+  Mesh *mesh = grid_mesh_create(8, 3.0f);
+  tree_request_first(mesh, 2);
+  BVHTreeFromMesh data;
+  BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_LOOPTRI, 2);
+  free_bvhtree_from_mesh(&data);
+  const BVHCacheSharedStats stats_used = stats_get();
+  BKE_id_free(nullptr, mesh);
+
+  /* Unused entries are kept until the memory limit is lowered. */
+  EXPECT_EQ(stats_get().entries_num, stats_used.entries_num);
+  BKE_bvhcache_shared_mem_limit_set(0);
+  EXPECT_LT(stats_get().entries_num, stats_used.entries_num);
+}
+
+}  // namespace blender::bke::tests
@@ -51,6 +51,10 @@
 
 // #include "PIL_time.h"  /* timing for debug prints */
 
+/* Rebuild the collision trees when refitting them to the moved cloth
+ * made them this much more expensive to query than after balancing. */
+#define CLOTH_BVH_REBALANCE_COST_FACTOR 1.5f
+
 /* ********** cloth engine ******* */
 /* Prototypes for internal functions.
  */
@@ -224,17 +228,28 @@ static BVHTree *bvhtree_build_from_cloth(ClothModifierData *clmd, float epsilon)
     }
   }
 
-  /* balance tree */
-  BLI_bvhtree_balance(bvhtree);
+  /* balance tree, cloth trees are queried every step so spend more time building them */
+  BLI_bvhtree_balance_ex(bvhtree, BVH_BALANCE_SAH);
 
   return bvhtree;
 }
 
+static void bvhtree_refit_cloth(BVHTree *bvhtree, float *cost_balanced)
+{
+  BLI_bvhtree_update_tree(bvhtree);
+
+  if (BLI_bvhtree_get_sah_cost(bvhtree) > *cost_balanced * CLOTH_BVH_REBALANCE_COST_FACTOR) {
+    BLI_bvhtree_rebalance(bvhtree, BVH_BALANCE_SAH);
+    *cost_balanced = BLI_bvhtree_get_sah_cost(bvhtree);
+  }
+}
+
 void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
 {
   unsigned int i = 0;
   Cloth *cloth = clmd->clothObject;
   BVHTree *bvhtree;
+  float *bvhtree_cost;
   ClothVertex *verts = cloth->verts;
   const MVertTri *vt;
 
@@ -242,9 +257,11 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
 
   if (self) {
     bvhtree = cloth->bvhselftree;
+    bvhtree_cost = &cloth->bvhselftree_cost;
   }
   else {
     bvhtree = cloth->bvhtree;
+    bvhtree_cost = &cloth->bvhtree_cost;
   }
 
   if (!bvhtree) {
@@ -287,7 +304,7 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
         }
       }
 
-      BLI_bvhtree_update_tree(bvhtree);
+      bvhtree_refit_cloth(bvhtree, bvhtree_cost);
     }
   }
   else {
@@ -305,7 +322,7 @@ void bvhtree_update_from_cloth(ClothModifierData *clmd, bool moving, bool self)
         }
       }
 
-      BLI_bvhtree_update_tree(bvhtree);
+      bvhtree_refit_cloth(bvhtree, bvhtree_cost);
     }
   }
 }
@@ -927,6 +944,13 @@ static int cloth_from_object(
 
   clmd->clothObject->bvhtree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->epsilon);
   clmd->clothObject->bvhselftree = bvhtree_build_from_cloth(clmd, clmd->coll_parms->selfepsilon);
+  if (clmd->clothObject->bvhtree) {
+    clmd->clothObject->bvhtree_cost = BLI_bvhtree_get_sah_cost(clmd->clothObject->bvhtree);
+  }
+  if (clmd->clothObject->bvhselftree) {
+    clmd->clothObject->bvhselftree_cost = BLI_bvhtree_get_sah_cost(
+        clmd->clothObject->bvhselftree);
+  }
 
   return 1;
 }
@@ -24,8 +24,14 @@
  * \ingroup bke
  */
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* Since we have versioning code here (CustomData_verify_versions()). */
 #define DNA_DEPRECATED_ALLOW
 
@@ -167,6 +173,12 @@ typedef struct LayerTypeInfo {
   /** a function to determine max allowed number of layers,
    * should be NULL or return -1 if no limit */
   int (*layers_max)(void);
+
+  /**
+   * an optional function to interpolate many elements of this layer's data at once,
+   * see #CustomData_interp_multi. Must give the same results as \a interp.
+   */
+  cd_interp_multi interp_multi;
 } LayerTypeInfo;
 
 static void layerCopy_mdeformvert(const void *source, void *dest, int count)
@@ -1560,6 +1572,159 @@ static bool layerValidate_propfloat2(void *data, const uint totitems, const bool
   return has_errors;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Interpolation
+ *
+ * Layer types made of floats interpolate many elements at once, avoiding the per element
+ * callback and the array of source pointers. The order of operations matches the per element
+ * interpolation, so the results are the same.
+ * \{ */
+
+BLI_INLINE void interp_multi_float_n(const float *src_data,
+                                     const int *src_indices,
+                                     const float *weights,
+                                     const int *src_offsets,
+                                     const int dest_len,
+                                     float *dest_data,
+                                     const int stride,
+                                     const int components)
+{
+  for (int i = 0; i < dest_len; i++) {
+    float result[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const float weight = weights ? weights[j] : 1.0f;
+      const float *src = src_data + (size_t)src_indices[j] * (size_t)stride;
+      for (int c = 0; c < components; c++) {
+        result[c] += src[c] * weight;
+      }
+    }
+    float *dest = dest_data + (size_t)i * (size_t)stride;
+    for (int c = 0; c < components; c++) {
+      dest[c] = result[c];
+    }
+  }
+}
+
+static void layerInterpMulti_propfloat2(const void *src_data,
+                                        const int *src_indices,
+                                        const float *weights,
+                                        const int *src_offsets,
+                                        int dest_len,
+                                        void *dest_data)
+{
+  interp_multi_float_n(src_data, src_indices, weights, src_offsets, dest_len, dest_data, 2, 2);
+}
+
+static void layerInterpMulti_propfloat3(const void *src_data,
+                                        const int *src_indices,
+                                        const float *weights,
+                                        const int *src_offsets,
+                                        int dest_len,
+                                        void *dest_data)
+{
+  interp_multi_float_n(src_data, src_indices, weights, src_offsets, dest_len, dest_data, 3, 3);
+}
+
+static void layerInterpMulti_propcol(const void *src_data,
+                                     const int *src_indices,
+                                     const float *weights,
+                                     const int *src_offsets,
+                                     int dest_len,
+                                     void *dest_data)
+{
+  const MPropCol *src_cols = src_data;
+  MPropCol *dest_cols = dest_data;
+#ifdef __SSE2__
+  for (int i = 0; i < dest_len; i++) {
+    __m128 result = _mm_setzero_ps();
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const __m128 weight = _mm_set1_ps(weights ? weights[j] : 1.0f);
+      const __m128 src = _mm_loadu_ps(src_cols[src_indices[j]].color);
+      result = _mm_add_ps(result, _mm_mul_ps(src, weight));
+    }
+    _mm_storeu_ps(dest_cols[i].color, result);
+  }
+#else
+  interp_multi_float_n((const float *)src_cols,
+                       src_indices,
+                       weights,
+                       src_offsets,
+                       dest_len,
+                       (float *)dest_cols,
+                       4,
+                       4);
+#endif
+}
+
+static void layerInterpMulti_mloopuv(const void *src_data,
+                                     const int *src_indices,
+                                     const float *weights,
+                                     const int *src_offsets,
+                                     int dest_len,
+                                     void *dest_data)
+{
+  const MLoopUV *src_uvs = src_data;
+  MLoopUV *dest_uvs = dest_data;
+  for (int i = 0; i < dest_len; i++) {
+    float uv[2] = {0.0f, 0.0f};
+    int flag = 0;
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const float weight = weights ? weights[j] : 1.0f;
+      const MLoopUV *src = &src_uvs[src_indices[j]];
+      madd_v2_v2fl(uv, src->uv, weight);
+      if (weight > 0.0f) {
+        flag |= src->flag;
+      }
+    }
+    copy_v2_v2(dest_uvs[i].uv, uv);
+    dest_uvs[i].flag = flag;
+  }
+}
+
+static void layerInterpMulti_mloopcol(const void *src_data,
+                                      const int *src_indices,
+                                      const float *weights,
+                                      const int *src_offsets,
+                                      int dest_len,
+                                      void *dest_data)
+{
+  const MLoopCol *src_cols = src_data;
+  MLoopCol *dest_cols = dest_data;
+  for (int i = 0; i < dest_len; i++) {
+    float col[4];
+#ifdef __SSE2__
+    __m128 result = _mm_setzero_ps();
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const __m128 weight = _mm_set1_ps(weights ? weights[j] : 1.0f);
+      /* Expand the r, g, b, a bytes to floats. */
+      int src_col;
+      memcpy(&src_col, &src_cols[src_indices[j]], sizeof(src_col));
+      const __m128i src_bytes = _mm_cvtsi32_si128(src_col);
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i src_ints = _mm_unpacklo_epi16(_mm_unpacklo_epi8(src_bytes, zero), zero);
+      result = _mm_add_ps(result, _mm_mul_ps(_mm_cvtepi32_ps(src_ints), weight));
+    }
+    _mm_storeu_ps(col, result);
+#else
+    zero_v4(col);
+    for (int j = src_offsets[i]; j < src_offsets[i + 1]; j++) {
+      const float weight = weights ? weights[j] : 1.0f;
+      const MLoopCol *src = &src_cols[src_indices[j]];
+      col[0] += src->r * weight;
+      col[1] += src->g * weight;
+      col[2] += src->b * weight;
+      col[3] += src->a * weight;
+    }
+#endif
+    dest_cols[i].r = round_fl_to_uchar_clamp(col[0]);
+    dest_cols[i].g = round_fl_to_uchar_clamp(col[1]);
+    dest_cols[i].b = round_fl_to_uchar_clamp(col[2]);
+    dest_cols[i].a = round_fl_to_uchar_clamp(col[3]);
+  }
+}
+
+/** \} */
+
 static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
     /* 0: CD_MVERT */
     {sizeof(MVert), "MVert", 1, NULL, NULL, NULL, NULL, NULL, NULL},
@@ -1702,7 +1867,8 @@ static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
      NULL,
      NULL,
      NULL,
-     layerMaxNum_tface},
+     layerMaxNum_tface,
+     layerInterpMulti_mloopuv},
     /* 17: CD_MLOOPCOL */
     {sizeof(MLoopCol),
      "MLoopCol",
@@ -1723,7 +1889,8 @@ static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
      NULL,
      NULL,
      NULL,
-     layerMaxNum_mloopcol},
+     layerMaxNum_mloopcol,
+     layerInterpMulti_mloopcol},
     /* 18: CD_TANGENT */
     {sizeof(float) * 4 * 4, "", 0, N_("Tangent"), NULL, NULL, NULL, NULL, NULL},
     /* 19: CD_MDISPS */
@@ -1895,7 +2062,8 @@ static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
      NULL,
      NULL,
      NULL,
-     layerMaxNum_propcol},
+     layerMaxNum_propcol,
+     layerInterpMulti_propcol},
     /* 48: CD_PROP_FLOAT3 */
     {sizeof(float[3]),
      "vec3f",
@@ -1910,7 +2078,14 @@ static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
      NULL,
      layerMultiply_propfloat3,
      NULL,
-     layerAdd_propfloat3},
+     layerAdd_propfloat3,
+     NULL,
+     NULL,
+     NULL,
+     NULL,
+     NULL,
+     NULL,
+     layerInterpMulti_propfloat3},
     /* 49: CD_PROP_FLOAT2 */
     {sizeof(float[2]),
      "vec2f",
@@ -1925,7 +2100,14 @@ static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
      NULL,
      layerMultiply_propfloat2,
      NULL,
-     layerAdd_propfloat2},
+     layerAdd_propfloat2,
+     NULL,
+     NULL,
+     NULL,
+     NULL,
+     NULL,
+     NULL,
+     layerInterpMulti_propfloat2},
 };
 
 static const char *LAYERTYPENAMES[CD_NUMTYPES] = {
@@ -2164,6 +2346,132 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Layer Sharing
+ *
+ * Layers added with #CD_REFERENCE from a layer that owns its data count their users in
+ * #CustomDataLayer.sharing, so the data stays valid until the last of them is freed, no matter
+ * which one is freed first. The layers referencing the data have #CD_FLAG_NOFREE set.
+ *
+ * Shared data is never written to in place, by any of its users. Writers get their own copy from
+ * #CustomData_duplicate_referenced_layer first, which only copies while other users remain.
+ * Code replacing the data of a layer with #CustomData_set_layer has to do the same before freeing
+ * the previous data.
+ * \{ */
+
+typedef struct CustomDataLayerSharing {
+  int32_t users;
+} CustomDataLayerSharing;
+
+/**
+ * Add a user to the data of \a layer.
+ * \return NULL when the data is referenced from outside of any #CustomData and can't be shared.
+ */
+static CustomDataLayerSharing *customData_layer_share(CustomDataLayer *layer)
+{
+  CustomDataLayerSharing *sharing = layer->sharing;
+  if (sharing == NULL) {
+    if (layer->flag & CD_FLAG_NOFREE) {
+      return NULL;
+    }
+    /* The same mesh can be referenced by several objects evaluated in parallel. */
+    sharing = MEM_mallocN(sizeof(*sharing), __func__);
+    sharing->users = 1;
+    CustomDataLayerSharing *sharing_prev = atomic_cas_ptr((void **)&layer->sharing, NULL, sharing);
+    if (sharing_prev != NULL) {
+      MEM_freeN(sharing);
+      sharing = sharing_prev;
+    }
+  }
+  atomic_add_and_fetch_int32(&sharing->users, 1);
+  return sharing;
+}
+
+/**
+ * Remove the user of \a layer from its shared data.
+ * \return true when it was the last user, which then has to free the data.
+ */
+static bool customData_layer_unshare(CustomDataLayer *layer)
+{
+  CustomDataLayerSharing *sharing = layer->sharing;
+  layer->sharing = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    MEM_freeN(sharing);
+    return true;
+  }
+  return false;
+}
+
+/** True when other layers use the data of \a layer as well. */
+static bool customData_layer_is_shared(const CustomDataLayer *layer)
+{
+  return layer->sharing && atomic_add_and_fetch_int32(&layer->sharing->users, 0) > 1;
+}
+
+/** Number of elements allocated for shared data, for functions which don't get it passed. */
+static int customData_layer_data_len(const CustomDataLayer *layer)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+  return (int)(MEM_allocN_len(layer->data) / typeInfo->size);
+}
+
+static void customData_layer_data_free(int type, void *data, int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->free) {
+    typeInfo->free(data, totelem, typeInfo->size);
+  }
+  MEM_freeN(data);
+}
+
+/**
+ * Make \a layer the only owner of its data, copying the first \a totelem elements when
+ * the data is shared with other layers or referenced from elsewhere.
+ */
+static void customData_layer_ensure_owned(CustomDataLayer *layer, const int totelem)
+{
+  if (layer->sharing) {
+    if (atomic_add_and_fetch_int32(&layer->sharing->users, 0) == 1) {
+      /* Other users are gone, take over the data without copying it. */
+      MEM_freeN(layer->sharing);
+      layer->sharing = NULL;
+      layer->flag &= ~CD_FLAG_NOFREE;
+      return;
+    }
+  }
+  else if (!(layer->flag & CD_FLAG_NOFREE)) {
+    return;
+  }
+
+  /* MEM_dupallocN won't work in case of complex layers, like e.g.
+   * CD_MDEFORMVERT, which has pointers to allocated data...
+   * So in case a custom copy function is defined, use it!
+   */
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+  void *data = layer->data;
+
+  if (typeInfo->copy) {
+    layer->data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    typeInfo->copy(data, layer->data, totelem);
+  }
+  else if (layer->flag & CD_FLAG_NOFREE) {
+    layer->data = MEM_dupallocN(data);
+  }
+  else {
+    layer->data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    memcpy(layer->data, data, (size_t)totelem * typeInfo->size);
+  }
+
+  if (layer->sharing && customData_layer_unshare(layer)) {
+    /* Other users were freed while copying. */
+    customData_layer_data_free(layer->type, data, totelem);
+  }
+  layer->flag &= ~CD_FLAG_NOFREE;
+}
+
+/** \} */
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2231,6 +2539,15 @@ bool CustomData_merge(const struct CustomData *source,
     }
 
     if (newlayer) {
+      if (data && newlayer->data == data) {
+        if (alloctype == CD_REFERENCE) {
+          newlayer->sharing = customData_layer_share(layer);
+        }
+        else if (alloctype == CD_ASSIGN) {
+          newlayer->sharing = layer->sharing;
+        }
+      }
+
       newlayer->uid = layer->uid;
 
       newlayer->active = lastactive;
@@ -2257,6 +2574,10 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->sharing) {
+      /* Don't move the data from under other layers that use it. */
+      customData_layer_ensure_owned(layer, MIN2(totelem, customData_layer_data_len(layer)));
+    }
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
 }
@@ -2278,19 +2599,14 @@ void CustomData_copy(const struct CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
-    }
-
-    if (layer->data) {
-      MEM_freeN(layer->data);
+  if (layer->sharing) {
+    if (customData_layer_unshare(layer)) {
+      customData_layer_data_free(layer->type, layer->data, totelem);
     }
   }
+  else if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+    customData_layer_data_free(layer->type, layer->data, totelem);
+  }
 }
 
 static void CustomData_external_free(CustomData *data)
@@ -2678,6 +2994,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2863,25 +3180,8 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
 
   layer = &data->layers[layer_index];
 
-  if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          (size_t)totelem, typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
-
-    layer->flag &= ~CD_FLAG_NOFREE;
-  }
+  /* Copies referenced data and data still shared with other layers. */
+  customData_layer_ensure_owned(layer, totelem);
 
   return layer->data;
 }
@@ -2935,7 +3235,46 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 
   layer = &data->layers[layer_index];
 
-  return (layer->flag & CD_FLAG_NOFREE) != 0;
+  return (layer->flag & CD_FLAG_NOFREE) || customData_layer_is_shared(layer);
+}
+
+/**
+ * Add a user to the data of the active layer of \a type, for code outside of #CustomData keeping
+ * it around, such as caches keyed on it. Like for layers sharing the data, writers copy it first,
+ * and it stays valid until passed to #CustomData_release_layer_data, even when the layer is freed.
+ *
+ * \return The layer data, NULL when there is no such layer or its data can't be shared.
+ */
+const void *CustomData_retain_layer_data(CustomData *data, int type, void **r_sharing)
+{
+  const int layer_index = CustomData_get_active_layer_index(data, type);
+  if (layer_index == -1) {
+    return NULL;
+  }
+
+  CustomDataLayer *layer = &data->layers[layer_index];
+  CustomDataLayerSharing *sharing = customData_layer_share(layer);
+  if (sharing == NULL) {
+    return NULL;
+  }
+
+  *r_sharing = sharing;
+  return layer->data;
+}
+
+/**
+ * Remove a user added by #CustomData_retain_layer_data, freeing the data when it was the last.
+ */
+void CustomData_release_layer_data(void *sharing_v,
+                                   int type,
+                                   const void *layer_data,
+                                   int totelem)
+{
+  CustomDataLayerSharing *sharing = sharing_v;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    MEM_freeN(sharing);
+    customData_layer_data_free(type, (void *)layer_data, totelem);
+  }
 }
 
 void CustomData_free_temporary(CustomData *data, int totelem)
@@ -3123,6 +3462,12 @@ void CustomData_free_elem(CustomData *data, int index, int count)
       if (typeInfo->free) {
         size_t offset = (size_t)index * typeInfo->size;
 
+        if (data->layers[i].sharing) {
+          /* Other users still need the elements. */
+          customData_layer_ensure_owned(&data->layers[i],
+                                        customData_layer_data_len(&data->layers[i]));
+        }
+
         typeInfo->free(POINTER_OFFSET(data->layers[i].data, offset), count, typeInfo->size);
       }
     }
@@ -3197,6 +3542,76 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+void CustomData_interp_multi(const CustomData *source,
+                             CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             const int *src_offsets,
+                             int dest_index,
+                             int dest_len)
+{
+  const void *source_buf[SOURCE_BUF_SIZE];
+  const void **sources = NULL;
+  int sources_len = 0;
+
+  /* interpolates a layer at a time, matching layers like CustomData_interp */
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+    if (!typeInfo->interp) {
+      continue;
+    }
+
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+    if (dest->layers[dest_i].type != source->layers[src_i].type) {
+      continue;
+    }
+
+    const void *src_data = source->layers[src_i].data;
+    void *dest_data = POINTER_OFFSET(dest->layers[dest_i].data,
+                                     (size_t)dest_index * typeInfo->size);
+
+    if (typeInfo->interp_multi) {
+      typeInfo->interp_multi(src_data, src_indices, weights, src_offsets, dest_len, dest_data);
+    }
+    else {
+      /* Fall back to interpolating one element at a time. */
+      for (int i = 0; i < dest_len; i++) {
+        const int count = src_offsets[i + 1] - src_offsets[i];
+        if (count > sources_len) {
+          if (sources != NULL && sources != source_buf) {
+            MEM_freeN((void *)sources);
+          }
+          sources = (count > SOURCE_BUF_SIZE) ?
+                        MEM_malloc_arrayN(count, sizeof(*sources), __func__) :
+                        source_buf;
+          sources_len = (count > SOURCE_BUF_SIZE) ? count : SOURCE_BUF_SIZE;
+        }
+        for (int j = 0; j < count; j++) {
+          sources[j] = POINTER_OFFSET(
+              src_data, (size_t)src_indices[src_offsets[i] + j] * typeInfo->size);
+        }
+        typeInfo->interp(sources,
+                         weights ? &weights[src_offsets[i]] : NULL,
+                         NULL,
+                         count,
+                         POINTER_OFFSET(dest_data, (size_t)i * typeInfo->size));
+      }
+    }
+
+    dest_i++;
+  }
+
+  if (sources != NULL && sources != source_buf) {
+    MEM_freeN((void *)sources);
+  }
+}
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -3360,6 +3775,17 @@ const char *CustomData_get_layer_name(const CustomData *data, int type, int n)
   return (layer_index == -1) ? NULL : data->layers[layer_index].name;
 }
 
+static void customData_set_layer_data(CustomDataLayer *layer, void *ptr)
+{
+  if (layer->sharing) {
+    /* The caller takes care of the previous data, which it can only free when no other layer
+     * uses it. Use #CustomData_duplicate_referenced_layer before replacing shared data. */
+    BLI_assert(!customData_layer_is_shared(layer));
+    customData_layer_unshare(layer);
+  }
+  layer->data = ptr;
+}
+
 void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
 {
   /* get the layer index of the first layer of type */
@@ -3369,7 +3795,7 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return NULL;
   }
 
-  data->layers[layer_index].data = ptr;
+  customData_set_layer_data(&data->layers[layer_index], ptr);
 
   return ptr;
 }
@@ -3382,7 +3808,7 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return NULL;
   }
 
-  data->layers[layer_index].data = ptr;
+  customData_set_layer_data(&data->layers[layer_index], ptr);
 
   return ptr;
 }
@@ -3998,7 +4424,8 @@ bool CustomData_has_referenced(const struct CustomData *data)
 {
   int i;
   for (i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    if ((data->layers[i].flag & CD_FLAG_NOFREE) ||
+        customData_layer_is_shared(&data->layers[i])) {
       return true;
     }
   }
@@ -4369,7 +4796,8 @@ void CustomData_file_write_prepare(CustomData *data,
         }
         write_layers_size += chunk_size;
       }
-      write_layers[j++] = *layer;
+      write_layers[j] = *layer;
+      write_layers[j++].sharing = NULL;
     }
   }
   BLI_assert(j == data->totlayer);
@@ -0,0 +1,241 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_rand.h"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+}
+
+namespace blender::bke::tests {
+
+/* Types with a batched interpolation, and #CD_PROP_FLOAT which falls back to the per element
+ * interpolation. */
+static const int interp_types[] = {
+    CD_PROP_FLOAT,
+    CD_MLOOPUV,
+    CD_MLOOPCOL,
+    CD_PROP_COLOR,
+    CD_PROP_FLOAT3,
+    CD_PROP_FLOAT2,
+};
+
+static void customdata_interp_layers_add(CustomData *data, int totelem, RNG *rng)
+{
+  CustomData_reset(data);
+  for (const int type : interp_types) {
+    /* Two layers of every type, to check that layers are matched in order. */
+    for (int n = 0; n < 2; n++) {
+      void *layer_data = CustomData_add_layer(data, type, CD_CALLOC, nullptr, totelem);
+      if (rng) {
+        /* Random bits for integer members, such as the UV flags and the color bytes. */
+        float *values = (float *)layer_data;
+        const size_t values_len = CustomData_sizeof(type) * totelem / sizeof(float);
+        for (size_t i = 0; i < values_len; i++) {
+          values[i] = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+        }
+      }
+    }
+  }
+}
+
+/* Interpolate the same elements with #CustomData_interp and #CustomData_interp_multi,
+ * the results have to be the same. */
+static void test_interp_multi(const bool use_weights)
+{
+  const int source_len = 64;
+  const int dest_len = 200;
+  const int dest_index = 3;
+  RNG *rng = BLI_rng_new(0);
+
+  CustomData source, dest_single, dest_multi;
+  customdata_interp_layers_add(&source, source_len, rng);
+  customdata_interp_layers_add(&dest_single, dest_index + dest_len, nullptr);
+  customdata_interp_layers_add(&dest_multi, dest_index + dest_len, nullptr);
+
+  /* Between one and eight sources per element, with some zero weights. */
+  int *src_offsets = (int *)MEM_malloc_arrayN(dest_len + 1, sizeof(int), __func__);
+  int *src_indices = (int *)MEM_malloc_arrayN(dest_len * 8, sizeof(int), __func__);
+  float *weights = (float *)MEM_malloc_arrayN(dest_len * 8, sizeof(float), __func__);
+  src_offsets[0] = 0;
+  for (int i = 0; i < dest_len; i++) {
+    const int count = 1 + BLI_rng_get_int(rng) % 8;
+    for (int j = src_offsets[i]; j < src_offsets[i] + count; j++) {
+      src_indices[j] = BLI_rng_get_int(rng) % source_len;
+      weights[j] = (BLI_rng_get_int(rng) % 4 == 0) ? 0.0f : BLI_rng_get_float(rng);
+    }
+    src_offsets[i + 1] = src_offsets[i] + count;
+  }
+
+  for (int i = 0; i < dest_len; i++) {
+    CustomData_interp(&source,
+                      &dest_single,
+                      &src_indices[src_offsets[i]],
+                      use_weights ? &weights[src_offsets[i]] : nullptr,
+                      nullptr,
+                      src_offsets[i + 1] - src_offsets[i],
+                      dest_index + i);
+  }
+  CustomData_interp_multi(&source,
+                          &dest_multi,
+                          src_indices,
+                          use_weights ? weights : nullptr,
+                          src_offsets,
+                          dest_index,
+                          dest_len);
+
+  ASSERT_EQ(dest_single.totlayer, dest_multi.totlayer);
+  for (int i = 0; i < dest_single.totlayer; i++) {
+    const CustomDataLayer *layer_single = &dest_single.layers[i];
+    const CustomDataLayer *layer_multi = &dest_multi.layers[i];
+    const size_t size = CustomData_sizeof(layer_single->type);
+    EXPECT_EQ(memcmp(layer_single->data, layer_multi->data, size * (dest_index + dest_len)), 0)
+        << "layer " << i << " of type " << layer_single->type;
+  }
+
+  MEM_freeN(src_offsets);
+  MEM_freeN(src_indices);
+  MEM_freeN(weights);
+  CustomData_free(&source, source_len);
+  CustomData_free(&dest_single, dest_index + dest_len);
+  CustomData_free(&dest_multi, dest_index + dest_len);
+  BLI_rng_free(rng);
+}
+
+TEST(customdata_interp_multi, SameAsInterp)
+{
+  test_interp_multi(true);
+}
+
+TEST(customdata_interp_multi, SameAsInterpWithoutWeights)
+{
+  test_interp_multi(false);
+}
+
+static const int sharing_len = 16;
+
+static float *sharing_layer_add(CustomData *data)
+{
+  CustomData_reset(data);
+  float *values = (float *)CustomData_add_layer(
+      data, CD_PROP_FLOAT, CD_CALLOC, nullptr, sharing_len);
+  for (int i = 0; i < sharing_len; i++) {
+    values[i] = (float)i;
+  }
+  return values;
+}
+
+static void sharing_layer_copy(const CustomData *source, CustomData *dest)
+{
+  CustomData_copy(source, dest, CD_MASK_PROP_FLOAT, CD_REFERENCE, sharing_len);
+}
+
+static bool sharing_layer_values_equal(const CustomData *data, const float offset)
+{
+  const float *values = (const float *)CustomData_get_layer(data, CD_PROP_FLOAT);
+  for (int i = 0; i < sharing_len; i++) {
+    if (values[i] != (float)i + offset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(customdata_sharing, ReferenceSharesData)
+{
+  CustomData owner, user;
+  float *values = sharing_layer_add(&owner);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&owner, CD_PROP_FLOAT));
+
+  sharing_layer_copy(&owner, &user);
+  EXPECT_EQ(CustomData_get_layer(&user, CD_PROP_FLOAT), values);
+  EXPECT_TRUE(CustomData_is_referenced_layer(&owner, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&user, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_has_referenced(&owner));
+
+  CustomData_free(&user, sharing_len);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&owner, CD_PROP_FLOAT));
+  EXPECT_EQ(CustomData_get_layer(&owner, CD_PROP_FLOAT), values);
+  CustomData_free(&owner, sharing_len);
+}
+
+TEST(customdata_sharing, FreedAfterLastUser)
+{
+  const uint blocks_before = MEM_get_memory_blocks_in_use();
+  CustomData owner, user_a, user_b;
+  sharing_layer_add(&owner);
+  sharing_layer_copy(&owner, &user_a);
+  sharing_layer_copy(&user_a, &user_b);
+
+  /* Users are freed in any order, the data stays valid for the remaining ones. */
+  CustomData_free(&owner, sharing_len);
+  EXPECT_TRUE(sharing_layer_values_equal(&user_a, 0.0f));
+  EXPECT_TRUE(sharing_layer_values_equal(&user_b, 0.0f));
+  CustomData_free(&user_b, sharing_len);
+  EXPECT_TRUE(sharing_layer_values_equal(&user_a, 0.0f));
+  const uint blocks_last_user = MEM_get_memory_blocks_in_use();
+
+  CustomData_free(&user_a, sharing_len);
+  EXPECT_LT(MEM_get_memory_blocks_in_use(), blocks_last_user);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_before);
+}
+
+TEST(customdata_sharing, UnshareOnWrite)
+{
+  CustomData owner, user_a, user_b;
+  float *values = sharing_layer_add(&owner);
+  sharing_layer_copy(&owner, &user_a);
+  sharing_layer_copy(&owner, &user_b);
+
+  /* The owner gets its own copy as well, the other users don't see the changes. */
+  float *values_owner = (float *)CustomData_duplicate_referenced_layer(
+      &owner, CD_PROP_FLOAT, sharing_len);
+  EXPECT_NE(values_owner, values);
+  for (int i = 0; i < sharing_len; i++) {
+    values_owner[i] += 1.0f;
+  }
+  EXPECT_TRUE(sharing_layer_values_equal(&owner, 1.0f));
+  EXPECT_TRUE(sharing_layer_values_equal(&user_a, 0.0f));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&owner, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&user_a, CD_PROP_FLOAT));
+
+  float *values_a = (float *)CustomData_duplicate_referenced_layer(
+      &user_a, CD_PROP_FLOAT, sharing_len);
+  EXPECT_NE(values_a, values);
+  for (int i = 0; i < sharing_len; i++) {
+    values_a[i] += 2.0f;
+  }
+  EXPECT_TRUE(sharing_layer_values_equal(&user_a, 2.0f));
+  EXPECT_TRUE(sharing_layer_values_equal(&user_b, 0.0f));
+
+  /* The last user takes over the data without copying it. */
+  EXPECT_EQ(CustomData_duplicate_referenced_layer(&user_b, CD_PROP_FLOAT, sharing_len), values);
+
+  CustomData_free(&owner, sharing_len);
+  CustomData_free(&user_a, sharing_len);
+  CustomData_free(&user_b, sharing_len);
+}
+
+}  // namespace blender::bke::tests
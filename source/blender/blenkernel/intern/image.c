@@ -37,6 +37,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -105,6 +107,13 @@
 
 static CLG_LogRef LOG = {"bke.image"};
 static ThreadMutex *image_mutex;
+/* Incremented whenever image buffers are freed, see #BKE_image_buffers_generation. */
+static uint image_buffers_generation = 0;
+
+static void image_buffers_generation_bump(void)
+{
+  atomic_add_and_fetch_uint32(&image_buffers_generation, 1);
+}
 
 static void image_init(Image *ima, short source, short type);
 static void image_free_packedfiles(Image *ima);
@@ -294,6 +303,10 @@ static void imagecache_put(Image *image, int index, ImBuf *ibuf)
 
   key.index = index;
 
+  if (IMB_moviecache_has_frame(image->cache, &key)) {
+    /* The buffer is replaced and freed. */
+    image_buffers_generation_bump();
+  }
   IMB_moviecache_put(image->cache, &key, ibuf);
 }
 
@@ -306,6 +319,7 @@ static void imagecache_remove(Image *image, int index)
   ImageCacheKey key;
   key.index = index;
   IMB_moviecache_remove(image->cache, &key);
+  image_buffers_generation_bump();
 }
 
 static struct ImBuf *imagecache_get(Image *image, int index)
@@ -336,9 +350,20 @@ static void image_free_cached_frames(Image *image)
   if (image->cache) {
     IMB_moviecache_free(image->cache);
     image->cache = NULL;
+    image_buffers_generation_bump();
   }
 }
 
+/**
+ * Changes whenever the buffers of any image are freed, for example when it is reloaded.
+ * Buffers allocated afterwards can get the address of a freed one, so data cached for a buffer
+ * is only valid as long as the generation stays the same.
+ */
+uint BKE_image_buffers_generation(void)
+{
+  return atomic_add_and_fetch_uint32(&image_buffers_generation, 0);
+}
+
 static void image_free_packedfiles(Image *ima)
 {
   while (ima->packedfiles.last) {
@@ -1153,6 +1178,7 @@ void BKE_image_free_all_textures(Main *bmain)
 #endif
 
       IMB_moviecache_cleanup(ima->cache, imagecache_check_dirty, NULL);
+      image_buffers_generation_bump();
 
 #ifdef CHECK_FREED_SIZE
       tot_freed_size += old_size - image_mem_size(ima);
@@ -1177,6 +1203,7 @@ void BKE_image_free_anim_ibufs(Image *ima, int except_frame)
   BLI_mutex_lock(image_mutex);
   if (ima->cache != NULL) {
     IMB_moviecache_cleanup(ima->cache, imagecache_check_free_anim, &except_frame);
+    image_buffers_generation_bump();
   }
   BLI_mutex_unlock(image_mutex);
 }
@@ -217,6 +217,7 @@ typedef struct MeshCalcNormalsData {
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
+  bool write_vert_normals;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
@@ -307,18 +308,22 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
     normalize_v3_v3(no, mv->co);
   }
 
-  normal_float_to_short_v3(mv->no, no);
+  if (data->write_vert_normals) {
+    normal_float_to_short_v3(mv->no, no);
+  }
 }
 
-void BKE_mesh_calc_normals_poly(MVert *mverts,
-                                float (*r_vertnors)[3],
-                                int numVerts,
-                                const MLoop *mloop,
-                                const MPoly *mpolys,
-                                int numLoops,
-                                int numPolys,
-                                float (*r_polynors)[3],
-                                const bool only_face_normals)
+/* Same as #BKE_mesh_calc_normals_poly, optionally leaving the normals of \a mverts unchanged. */
+static void mesh_calc_normals_poly_ex(MVert *mverts,
+                                      float (*r_vertnors)[3],
+                                      int numVerts,
+                                      const MLoop *mloop,
+                                      const MPoly *mpolys,
+                                      int numLoops,
+                                      int numPolys,
+                                      float (*r_polynors)[3],
+                                      const bool only_face_normals,
+                                      const bool write_vert_normals)
 {
   float(*pnors)[3] = r_polynors;
 
@@ -362,6 +367,7 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .pnors = pnors,
       .lnors_weighted = lnors_weighted,
       .vnors = vnors,
+      .write_vert_normals = write_vert_normals,
   };
 
   /* Compute poly normals, and prepare weighted loop normals. */
@@ -384,6 +390,79 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
   MEM_freeN(lnors_weighted);
 }
 
+void BKE_mesh_calc_normals_poly(MVert *mverts,
+                                float (*r_vertnors)[3],
+                                int numVerts,
+                                const MLoop *mloop,
+                                const MPoly *mpolys,
+                                int numLoops,
+                                int numPolys,
+                                float (*r_polynors)[3],
+                                const bool only_face_normals)
+{
+  mesh_calc_normals_poly_ex(mverts,
+                            r_vertnors,
+                            numVerts,
+                            mloop,
+                            mpolys,
+                            numLoops,
+                            numPolys,
+                            r_polynors,
+                            only_face_normals,
+                            true);
+}
+
+/**
+ * Calculate the vertex normals of \a mesh, and its poly normals when \a r_polynors is set.
+ *
+ * Vertices shared with other meshes are only duplicated when their normals actually change,
+ * which they typically don't for evaluated meshes referencing their input mesh.
+ */
+void BKE_mesh_calc_normals_ex(Mesh *mesh, float (*r_polynors)[3])
+{
+  if (!CustomData_is_referenced_layer(&mesh->vdata, CD_MVERT)) {
+    BKE_mesh_calc_normals_poly(mesh->mvert,
+                               NULL,
+                               mesh->totvert,
+                               mesh->mloop,
+                               mesh->mpoly,
+                               mesh->totloop,
+                               mesh->totpoly,
+                               r_polynors,
+                               false);
+    return;
+  }
+
+  float(*vnors)[3] = MEM_malloc_arrayN((size_t)mesh->totvert, sizeof(*vnors), __func__);
+  mesh_calc_normals_poly_ex(mesh->mvert,
+                            vnors,
+                            mesh->totvert,
+                            mesh->mloop,
+                            mesh->mpoly,
+                            mesh->totloop,
+                            mesh->totpoly,
+                            r_polynors,
+                            false,
+                            false);
+
+  int i;
+  for (i = 0; i < mesh->totvert; i++) {
+    short no[3];
+    normal_float_to_short_v3(no, vnors[i]);
+    if (memcmp(no, mesh->mvert[i].no, sizeof(no)) != 0) {
+      break;
+    }
+  }
+  if (i != mesh->totvert) {
+    mesh->mvert = CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
+    for (; i < mesh->totvert; i++) {
+      normal_float_to_short_v3(mesh->mvert[i].no, vnors[i]);
+    }
+  }
+
+  MEM_freeN(vnors);
+}
+
 void BKE_mesh_ensure_normals(Mesh *mesh)
 {
   if (mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL) {
@@ -421,17 +500,26 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
     if (do_add_poly_nors_cddata) {
       poly_nors = MEM_malloc_arrayN((size_t)mesh->totpoly, sizeof(*poly_nors), __func__);
     }
+    else {
+      /* The layer may be shared with other meshes, which must not see the changes. */
+      poly_nors = CustomData_duplicate_referenced_layer(&mesh->pdata, CD_NORMAL, mesh->totpoly);
+    }
 
     /* calculate poly/vert normals */
-    BKE_mesh_calc_normals_poly(mesh->mvert,
-                               NULL,
-                               mesh->totvert,
-                               mesh->mloop,
-                               mesh->mpoly,
-                               mesh->totloop,
-                               mesh->totpoly,
-                               poly_nors,
-                               !do_vert_normals);
+    if (do_vert_normals) {
+      BKE_mesh_calc_normals_ex(mesh, poly_nors);
+    }
+    else {
+      BKE_mesh_calc_normals_poly(mesh->mvert,
+                                 NULL,
+                                 mesh->totvert,
+                                 mesh->mloop,
+                                 mesh->mpoly,
+                                 mesh->totloop,
+                                 mesh->totpoly,
+                                 poly_nors,
+                                 true);
+    }
 
     if (do_add_poly_nors_cddata) {
       CustomData_add_layer(&mesh->pdata, CD_NORMAL, CD_ASSIGN, poly_nors, mesh->totpoly);
@@ -449,15 +537,7 @@ void BKE_mesh_calc_normals(Mesh *mesh)
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
-  BKE_mesh_calc_normals_poly(mesh->mvert,
-                             NULL,
-                             mesh->totvert,
-                             mesh->mloop,
-                             mesh->mpoly,
-                             mesh->totloop,
-                             mesh->totpoly,
-                             NULL,
-                             false);
+  BKE_mesh_calc_normals_ex(mesh, NULL);
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(BKE_mesh_calc_normals);
 #endif
@@ -2054,7 +2134,7 @@ static void mesh_set_custom_normals(Mesh *mesh, float (*r_custom_nors)[3], const
   short(*clnors)[2];
   const int numloops = mesh->totloop;
 
-  clnors = CustomData_get_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL);
+  clnors = CustomData_duplicate_referenced_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL, numloops);
   if (clnors != NULL) {
     memset(clnors, 0, sizeof(*clnors) * (size_t)numloops);
   }
@@ -2066,15 +2146,7 @@ static void mesh_set_custom_normals(Mesh *mesh, float (*r_custom_nors)[3], const
   bool free_polynors = false;
   if (polynors == NULL) {
     polynors = MEM_mallocN(sizeof(float[3]) * (size_t)mesh->totpoly, __func__);
-    BKE_mesh_calc_normals_poly(mesh->mvert,
-                               NULL,
-                               mesh->totvert,
-                               mesh->mloop,
-                               mesh->mpoly,
-                               mesh->totloop,
-                               mesh->totpoly,
-                               polynors,
-                               false);
+    BKE_mesh_calc_normals_ex(mesh, polynors);
     free_polynors = true;
   }
 
@@ -2381,10 +2381,34 @@ void psys_find_parents(ParticleSimulationData *sim, const bool use_render_params
 
   BLI_kdtree_3d_balance(tree);
 
-  for (; p < totchild; p++, cpa++) {
-    psys_particle_on_emitter(
-        sim->psmd, from, cpa->num, DMCACHE_ISCHILD, cpa->fuv, cpa->foffset, co, 0, 0, 0, orco);
-    cpa->parent = BLI_kdtree_3d_find_nearest(tree, orco, NULL);
+  /* Look up the parents of all remaining children at once. */
+  const int totquery = totchild - p;
+  if (totquery > 0) {
+    float(*orcos)[3] = MEM_malloc_arrayN((size_t)totquery, sizeof(*orcos), __func__);
+    int *parents = MEM_malloc_arrayN((size_t)totquery, sizeof(*parents), __func__);
+
+    for (int i = 0; i < totquery; i++) {
+      psys_particle_on_emitter(sim->psmd,
+                               from,
+                               cpa[i].num,
+                               DMCACHE_ISCHILD,
+                               cpa[i].fuv,
+                               cpa[i].foffset,
+                               co,
+                               0,
+                               0,
+                               0,
+                               orcos[i]);
+    }
+
+    BLI_kdtree_3d_find_nearest_multi(tree, orcos, (uint)totquery, parents, NULL);
+
+    for (int i = 0; i < totquery; i++) {
+      cpa[i].parent = parents[i];
+    }
+
+    MEM_freeN(orcos);
+    MEM_freeN(parents);
   }
 
   BLI_kdtree_3d_free(tree);
@@ -44,6 +44,7 @@
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "BLI_array.h"
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_edgehash.h"
@@ -65,10 +66,6 @@
 #include "BKE_scene.h"
 #include "BKE_subsurf.h"
 
-#ifndef USE_DYNSIZE
-#  include "BLI_array.h"
-#endif
-
 #include "CCGSubSurf.h"
 
 /* assumes MLoop's are laid out 4 for each poly, in order */
@@ -2018,6 +2015,12 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   BLI_array_declare(loopidx);
   BLI_array_declare(vertidx);
 #endif
+  /* Sources and weights of all loops of a face, to interpolate them at once. */
+  int *interp_src_indices = NULL, *interp_src_offsets = NULL;
+  float *interp_weights = NULL;
+  BLI_array_declare(interp_src_indices);
+  BLI_array_declare(interp_src_offsets);
+  BLI_array_declare(interp_weights);
   int loopindex, loopindex2;
   int edgeSize;
   int gridSize;
@@ -2142,30 +2145,55 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
       }
     }
 
+    /*interpolate per-loop data, all loops of the face at once*/
+    {
+      const int loops_len = numVerts * gridFaces * gridFaces * 4;
+      const int corner_offsets[4][2] = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
+      int *src_index, *src_offset;
+      float *weight;
+
+      BLI_array_clear(interp_src_indices);
+      BLI_array_clear(interp_src_offsets);
+      BLI_array_clear(interp_weights);
+      BLI_array_grow_items(interp_src_indices, loops_len * numVerts);
+      BLI_array_grow_items(interp_src_offsets, loops_len + 1);
+      BLI_array_grow_items(interp_weights, loops_len * numVerts);
+
+      src_index = interp_src_indices;
+      src_offset = interp_src_offsets;
+      weight = interp_weights;
+      for (s = 0; s < numVerts; s++) {
+        for (y = 0; y < gridFaces; y++) {
+          for (x = 0; x < gridFaces; x++) {
+            for (i = 0; i < 4; i++) {
+              const int cy = y + corner_offsets[i][1], cx = x + corner_offsets[i][0];
+              w2 = w + s * numVerts * g2_wid * g2_wid + (cy * g2_wid + cx) * numVerts;
+              memcpy(weight, w2, sizeof(*weight) * numVerts);
+              memcpy(src_index, loopidx, sizeof(*src_index) * numVerts);
+              *src_offset = (int)(src_index - interp_src_indices);
+              weight += numVerts;
+              src_index += numVerts;
+              src_offset++;
+            }
+          }
+        }
+      }
+      *src_offset = (int)(src_index - interp_src_indices);
+
+      CustomData_interp_multi(&dm->loopData,
+                              &ccgdm->dm.loopData,
+                              interp_src_indices,
+                              interp_weights,
+                              interp_src_offsets,
+                              loopindex2,
+                              loops_len);
+      loopindex2 += loops_len;
+    }
+
     for (s = 0; s < numVerts; s++) {
       /*interpolate per-face data*/
       for (y = 0; y < gridFaces; y++) {
         for (x = 0; x < gridFaces; x++) {
-          w2 = w + s * numVerts * g2_wid * g2_wid + (y * g2_wid + x) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
-
-          w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
-
-          w2 = w + s * numVerts * g2_wid * g2_wid + ((y + 1) * g2_wid + (x + 1)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
-
-          w2 = w + s * numVerts * g2_wid * g2_wid + ((y)*g2_wid + (x + 1)) * numVerts;
-          CustomData_interp(
-              &dm->loopData, &ccgdm->dm.loopData, loopidx, w2, NULL, numVerts, loopindex2);
-          loopindex2++;
-
           /*copy over poly data, e.g. mtexpoly*/
           CustomData_copy_data(&dm->polyData, &ccgdm->dm.polyData, origIndex, faceNum, 1);
 
@@ -2283,6 +2311,9 @@ static void set_ccgdm_all_geometry(CCGDerivedMesh *ccgdm,
   BLI_array_free(vertidx);
   BLI_array_free(loopidx);
 #endif
+  BLI_array_free(interp_src_indices);
+  BLI_array_free(interp_src_offsets);
+  BLI_array_free(interp_weights);
   free_ss_weights(&wtable);
 
   BLI_assert(vertNum == ccgSubSurf_getNumFinalVerts(ss));
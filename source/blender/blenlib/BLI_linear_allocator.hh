@@ -34,7 +34,7 @@ namespace blender {
 template<typename Allocator = GuardedAllocator> class LinearAllocator : NonCopyable, NonMovable {
  private:
   Allocator allocator_;
-  Vector<void *> owned_buffers_;
+  Vector<Span<char>> owned_buffers_;
   Vector<Span<char>> unused_borrowed_buffers_;
 
   uintptr_t current_begin_;
@@ -55,8 +55,8 @@ template<typename Allocator = GuardedAllocator> class LinearAllocator : NonCopya
 
   ~LinearAllocator()
   {
-    for (void *ptr : owned_buffers_) {
-      allocator_.deallocate(ptr);
+    for (Span<char> buffer : owned_buffers_) {
+      allocator_.deallocate((void *)buffer.data());
     }
   }
 
@@ -194,6 +194,38 @@ template<typename Allocator = GuardedAllocator> class LinearAllocator : NonCopya
     this->provide_buffer(aligned_buffer.ptr(), Size);
   }
 
+  /**
+   * Invalidate all memory that has been handed out by this allocator, so that it can be reused
+   * for new allocations. Only the largest owned buffer is kept, the others are freed. This allows
+   * using the same allocator for many similar tasks without allocating new memory every time.
+   *
+   * Buffers passed to #provide_buffer are not reused.
+   */
+  void reset()
+  {
+#ifdef DEBUG
+    debug_allocated_amount_ = 0;
+#endif
+    unused_borrowed_buffers_.clear();
+
+    if (owned_buffers_.is_empty()) {
+      current_begin_ = 0;
+      current_end_ = 0;
+      return;
+    }
+
+    /* Buffer sizes are increasing, so the last one is the largest. */
+    const Span<char> largest_buffer = owned_buffers_.pop_last();
+    for (Span<char> buffer : owned_buffers_) {
+      allocator_.deallocate((void *)buffer.data());
+    }
+    owned_buffers_.clear();
+    owned_buffers_.append(largest_buffer);
+
+    current_begin_ = (uintptr_t)largest_buffer.begin();
+    current_end_ = (uintptr_t)largest_buffer.end();
+  }
+
  private:
   void allocate_new_buffer(int64_t min_allocation_size)
   {
@@ -212,7 +244,7 @@ template<typename Allocator = GuardedAllocator> class LinearAllocator : NonCopya
     next_min_alloc_size_ = size_in_bytes * 2;
 
     void *buffer = allocator_.allocate(size_in_bytes, 8, AT);
-    owned_buffers_.append(buffer);
+    owned_buffers_.append(Span<char>((char *)buffer, size_in_bytes));
     current_begin_ = (uintptr_t)buffer;
     current_end_ = current_begin_ + size_in_bytes;
   }
@@ -43,6 +43,10 @@ BLI_mempool *BLI_mempool_create(unsigned int esize,
 void *BLI_mempool_alloc(BLI_mempool *pool) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 void *BLI_mempool_calloc(BLI_mempool *pool) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 void BLI_mempool_free(BLI_mempool *pool, void *addr) ATTR_NONNULL(1, 2);
+void BLI_mempool_alloc_multi(BLI_mempool *pool, void **r_elems, unsigned int elems_len)
+    ATTR_NONNULL(1, 2);
+void BLI_mempool_free_multi(BLI_mempool *pool, void **elems, unsigned int elems_len)
+    ATTR_NONNULL(1, 2);
 void BLI_mempool_clear_ex(BLI_mempool *pool, const int totelem_reserve) ATTR_NONNULL(1);
 void BLI_mempool_clear(BLI_mempool *pool) ATTR_NONNULL(1);
 void BLI_mempool_destroy(BLI_mempool *pool) ATTR_NONNULL(1);
@@ -94,6 +98,35 @@ BLI_mempool_iter *BLI_mempool_iter_threadsafe_create(BLI_mempool *pool,
     ATTR_NONNULL();
 void BLI_mempool_iter_threadsafe_free(BLI_mempool_iter *iter_arr) ATTR_NONNULL();
 
+/**
+ * Per thread cache of free elements, used to allocate and free elements of a single pool from
+ * multiple threads at once. Elements are moved between the cache and the pool in batches,
+ * so the pool only has to be locked once per batch.
+ *
+ * The cache can be part of the `userdata_chunk` of parallel tasks: initialize it once and
+ * flush it from every thread that used its copy.
+ *
+ * \note While caches are in use, the pool must not be accessed with the other functions.
+ * #BLI_mempool_len doesn't include elements allocated or freed by caches until they are flushed.
+ */
+typedef struct BLI_mempool_thread_cache {
+  BLI_mempool *pool;
+  /* private */
+  struct BLI_freenode *free;
+  unsigned int free_len;
+  int totused_delta;
+} BLI_mempool_thread_cache;
+
+void BLI_mempool_thread_cache_init(BLI_mempool *pool, BLI_mempool_thread_cache *cache)
+    ATTR_NONNULL();
+void *BLI_mempool_thread_cache_alloc(BLI_mempool_thread_cache *cache) ATTR_MALLOC
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+void *BLI_mempool_thread_cache_calloc(BLI_mempool_thread_cache *cache) ATTR_MALLOC
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+void BLI_mempool_thread_cache_free(BLI_mempool_thread_cache *cache, void *addr)
+    ATTR_NONNULL(1, 2);
+void BLI_mempool_thread_cache_flush(BLI_mempool_thread_cache *cache) ATTR_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,6 +47,15 @@ void BLI_task_scheduler_init(void);
 void BLI_task_scheduler_exit(void);
 int BLI_task_scheduler_num_threads(void);
 
+/* Task Isolation
+ *
+ * Run a function so that, while it waits for the tasks it spawned, the calling thread only
+ * executes those tasks and not unrelated ones from the scheduler. Needed when the function holds
+ * a lock or is waited for by other tasks, which could otherwise end up running on its own stack
+ * and deadlock. */
+
+void BLI_task_isolate(void (*func)(void *userdata), void *userdata);
+
 /* Task Pool
  *
  * Pool of tasks that will be executed by the central task scheduler. For each
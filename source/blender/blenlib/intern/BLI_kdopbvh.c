@@ -30,6 +30,8 @@
  *
  * - Ray-cast:
  *   #BLI_bvhtree_ray_cast, #BVHRayCastData
+ * - Ray-cast of ray packets:
+ *   #BLI_bvhtree_ray_cast_packet, #BVHRayPacketData
  * - Nearest point on surface:
  *   #BLI_bvhtree_find_nearest, #BVHNearestData
  * - Overlapping 2 trees:
@@ -40,12 +42,20 @@
 
 #include <assert.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define USE_KDOPBVH_SSE2
+#  include <emmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -157,6 +167,28 @@ typedef struct BVHRayCastData {
   BVHTreeRayHit hit;
 } BVHRayCastData;
 
+/* Number of rays traversing the tree together. */
+#define BVH_RAY_PACKET_SIZE 4
+
+typedef struct BVHRayPacketData {
+  const BVHTree *tree;
+
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+
+  BVHTreeRay ray[BVH_RAY_PACKET_SIZE];
+  BVHTreeRayHit hit[BVH_RAY_PACKET_SIZE];
+
+#ifdef USE_KDOPBVH_WATERTIGHT
+  struct IsectRayPrecalc isect_precalc[BVH_RAY_PACKET_SIZE];
+#endif
+
+  /* Structure of arrays layout of the rays, for the SIMD bounding box tests.
+   * Initialized by bvhtree_ray_packet_data_precalc */
+  float origin[3][BVH_RAY_PACKET_SIZE];
+  float idot_axis[3][BVH_RAY_PACKET_SIZE];
+} BVHRayPacketData;
+
 typedef struct BVHNearestProjectedData {
   const BVHTree *tree;
   struct DistProjectedAABBPrecalc precalc;
@@ -865,6 +897,471 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Binned SAH Build
+ *
+ * Alternative to #non_recursive_bvh_div_nodes, used for #BVH_BALANCE_SAH.
+ *
+ * Instead of splitting the leafs in groups of equal size at the median of the largest axis,
+ * leafs are split where the surface area heuristic (SAH) estimates the lowest cost to traverse
+ * the children. This gives much better trees for unevenly distributed primitives.
+ *
+ * Nodes are built from binary splits, repeated on the child with the largest surface area until
+ * the node has `tree_type` children. Big sub-trees are built in parallel, and the binning of big
+ * nodes is multi-threaded too.
+ *
+ * Only the first three axes (the AABB) of the bounding volumes are used to build the tree.
+ * \{ */
+
+#define BVH_SAH_BINS 16
+
+/** Node of the binned SAH build, covering a range of the leafs array. */
+typedef struct BVHSahNode {
+  int leafs_begin, leafs_end;
+  /** Index of the first child in #BVHSahBuildData.nodes, brother nodes are sequential. */
+  int children_begin;
+  char children_num;
+  char main_axis;
+} BVHSahNode;
+
+typedef struct BVHSahBuildData {
+  const BVHTree *tree;
+  BVHNode **leafs_array;
+
+  BVHSahNode *nodes;
+  /** Number of used #BVHSahBuildData.nodes (accessed atomically). */
+  uint nodes_num;
+  /** Number of nodes with more than one leaf, which become branches (accessed atomically). */
+  uint branches_num;
+
+  TaskPool *task_pool;
+} BVHSahBuildData;
+
+typedef struct BVHSahBin {
+  float bv[6];
+  int count;
+} BVHSahBin;
+
+typedef struct BVHSahBinningData {
+  BVHNode **leafs_array;
+  int axis;
+  float centroid_min;
+  float centroid_scale;
+} BVHSahBinningData;
+
+static void sah_bv_init(float bv[6])
+{
+  for (int i = 0; i < 3; i++) {
+    bv[2 * i] = FLT_MAX;
+    bv[2 * i + 1] = -FLT_MAX;
+  }
+}
+
+static void sah_bv_join(float bv[6], const float other[6])
+{
+  for (int i = 0; i < 3; i++) {
+    bv[2 * i] = min_ff(bv[2 * i], other[2 * i]);
+    bv[2 * i + 1] = max_ff(bv[2 * i + 1], other[2 * i + 1]);
+  }
+}
+
+static float sah_bv_surface_area(const float bv[6])
+{
+  const float dx = bv[1] - bv[0];
+  const float dy = bv[3] - bv[2];
+  const float dz = bv[5] - bv[4];
+  if (dx < 0.0f || dy < 0.0f || dz < 0.0f) {
+    return 0.0f;
+  }
+  return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static float sah_bv_centroid(const float bv[6], const int axis)
+{
+  return (bv[2 * axis] + bv[2 * axis + 1]) * 0.5f;
+}
+
+static int sah_bin_index(const BVHSahBinningData *data, const float bv[6])
+{
+  const int bin = (int)((sah_bv_centroid(bv, data->axis) - data->centroid_min) *
+                        data->centroid_scale);
+  return min_ii(max_ii(bin, 0), BVH_SAH_BINS - 1);
+}
+
+static void sah_centroid_bounds_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict tls)
+{
+  const BVHSahBinningData *data = userdata;
+  float *centroid_bv = tls->userdata_chunk;
+  const float *bv = data->leafs_array[i]->bv;
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float centroid = sah_bv_centroid(bv, axis);
+    centroid_bv[2 * axis] = min_ff(centroid_bv[2 * axis], centroid);
+    centroid_bv[2 * axis + 1] = max_ff(centroid_bv[2 * axis + 1], centroid);
+  }
+}
+
+static void sah_centroid_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                       void *__restrict chunk_join,
+                                       void *__restrict chunk)
+{
+  sah_bv_join(chunk_join, chunk);
+}
+
+static void sah_binning_cb(void *__restrict userdata,
+                           const int i,
+                           const TaskParallelTLS *__restrict tls)
+{
+  const BVHSahBinningData *data = userdata;
+  BVHSahBin *bins = tls->userdata_chunk;
+  const float *bv = data->leafs_array[i]->bv;
+
+  BVHSahBin *bin = &bins[sah_bin_index(data, bv)];
+  sah_bv_join(bin->bv, bv);
+  bin->count++;
+}
+
+static void sah_binning_reduce(const void *__restrict UNUSED(userdata),
+                               void *__restrict chunk_join,
+                               void *__restrict chunk)
+{
+  BVHSahBin *bins_join = chunk_join;
+  const BVHSahBin *bins = chunk;
+  for (int i = 0; i < BVH_SAH_BINS; i++) {
+    sah_bv_join(bins_join[i].bv, bins[i].bv);
+    bins_join[i].count += bins[i].count;
+  }
+}
+
+static void sah_range_bv(BVHNode **leafs_array, const int begin, const int end, float r_bv[6])
+{
+  sah_bv_init(r_bv);
+  for (int i = begin; i < end; i++) {
+    sah_bv_join(r_bv, leafs_array[i]->bv);
+  }
+}
+
+/**
+ * Split the leafs in `[begin, end)` in two, at the bin boundary with the lowest SAH cost.
+ * The leafs array is partitioned so that the first range ends at the returned index.
+ */
+static int sah_split(BVHNode **leafs_array,
+                     const int begin,
+                     const int end,
+                     float r_bv_a[6],
+                     float r_bv_b[6],
+                     char *r_axis)
+{
+  BVHSahBinningData data = {.leafs_array = leafs_array};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (end - begin > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = KDOPBVH_THREAD_LEAF_THRESHOLD;
+
+  /* Bin along the axis with the largest extent of the centroids. */
+  float centroid_bv[6];
+  sah_bv_init(centroid_bv);
+  settings.userdata_chunk = centroid_bv;
+  settings.userdata_chunk_size = sizeof(centroid_bv);
+  settings.func_reduce = sah_centroid_bounds_reduce;
+  BLI_task_parallel_range(begin, end, &data, sah_centroid_bounds_cb, &settings);
+
+  data.axis = 0;
+  for (int axis = 1; axis < 3; axis++) {
+    if (centroid_bv[2 * axis + 1] - centroid_bv[2 * axis] >
+        centroid_bv[2 * data.axis + 1] - centroid_bv[2 * data.axis]) {
+      data.axis = axis;
+    }
+  }
+  *r_axis = (char)data.axis;
+
+  const float extent = centroid_bv[2 * data.axis + 1] - centroid_bv[2 * data.axis];
+  if (!(extent > 0.0f)) {
+    /* All centroids are at the same place, any split is as good as another. */
+    const int mid = (begin + end) / 2;
+    sah_range_bv(leafs_array, begin, mid, r_bv_a);
+    sah_range_bv(leafs_array, mid, end, r_bv_b);
+    return mid;
+  }
+
+  data.centroid_min = centroid_bv[2 * data.axis];
+  data.centroid_scale = (float)BVH_SAH_BINS / extent;
+
+  BVHSahBin bins[BVH_SAH_BINS];
+  for (int i = 0; i < BVH_SAH_BINS; i++) {
+    sah_bv_init(bins[i].bv);
+    bins[i].count = 0;
+  }
+  settings.userdata_chunk = bins;
+  settings.userdata_chunk_size = sizeof(bins);
+  settings.func_reduce = sah_binning_reduce;
+  BLI_task_parallel_range(begin, end, &data, sah_binning_cb, &settings);
+
+  /* Sweep the bins from the right to get the cost of the right side of every split. */
+  float right_cost[BVH_SAH_BINS];
+  {
+    float bv[6];
+    int count = 0;
+    sah_bv_init(bv);
+    for (int i = BVH_SAH_BINS - 1; i > 0; i--) {
+      sah_bv_join(bv, bins[i].bv);
+      count += bins[i].count;
+      right_cost[i] = sah_bv_surface_area(bv) * (float)count;
+    }
+  }
+
+  /* Split between bin `best_split - 1` and `best_split`. */
+  int best_split = 0;
+  {
+    float best_cost = FLT_MAX;
+    float bv[6];
+    int count = 0;
+    sah_bv_init(bv);
+    for (int i = 1; i < BVH_SAH_BINS; i++) {
+      sah_bv_join(bv, bins[i - 1].bv);
+      count += bins[i - 1].count;
+      if (count == 0 || count == end - begin) {
+        continue;
+      }
+      const float cost = sah_bv_surface_area(bv) * (float)count + right_cost[i];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_split = i;
+      }
+    }
+  }
+  /* The first and last bins always contain a centroid, so there is a valid split. */
+  BLI_assert(best_split != 0);
+
+  sah_bv_init(r_bv_a);
+  sah_bv_init(r_bv_b);
+  for (int i = 0; i < BVH_SAH_BINS; i++) {
+    sah_bv_join((i < best_split) ? r_bv_a : r_bv_b, bins[i].bv);
+  }
+
+  int mid = begin;
+  for (int i = begin; i < end; i++) {
+    if (sah_bin_index(&data, leafs_array[i]->bv) < best_split) {
+      SWAP(BVHNode *, leafs_array[i], leafs_array[mid]);
+      mid++;
+    }
+  }
+  return mid;
+}
+
+static void sah_build_node(BVHSahBuildData *data, const int node_index);
+
+static void sah_build_node_task(TaskPool *__restrict pool, void *taskdata)
+{
+  BVHSahBuildData *data = BLI_task_pool_user_data(pool);
+  sah_build_node(data, POINTER_AS_INT(taskdata));
+}
+
+static void sah_build_node(BVHSahBuildData *data, const int node_index)
+{
+  BVHSahNode *node = &data->nodes[node_index];
+  const int tree_type = data->tree->tree_type;
+
+  /* Ranges of the children, ordered as in the leafs array. */
+  int ranges[MAX_TREETYPE + 1][2];
+  float ranges_area[MAX_TREETYPE + 1];
+  int ranges_num = 1;
+  ranges[0][0] = node->leafs_begin;
+  ranges[0][1] = node->leafs_end;
+  ranges_area[0] = FLT_MAX;
+  node->main_axis = 0;
+
+  while (ranges_num < tree_type) {
+    /* Split the child with the largest surface area. */
+    int split_index = -1;
+    for (int i = 0; i < ranges_num; i++) {
+      if ((ranges[i][1] - ranges[i][0] > 1) &&
+          (split_index == -1 || ranges_area[i] > ranges_area[split_index])) {
+        split_index = i;
+      }
+    }
+    if (split_index == -1) {
+      break;
+    }
+
+    float bv_a[6], bv_b[6];
+    char axis;
+    const int begin = ranges[split_index][0];
+    const int end = ranges[split_index][1];
+    const int mid = sah_split(data->leafs_array, begin, end, bv_a, bv_b, &axis);
+    if (ranges_num == 1) {
+      node->main_axis = axis;
+    }
+
+    memmove(&ranges[split_index + 1],
+            &ranges[split_index],
+            sizeof(*ranges) * (size_t)(ranges_num - split_index));
+    memmove(&ranges_area[split_index + 1],
+            &ranges_area[split_index],
+            sizeof(*ranges_area) * (size_t)(ranges_num - split_index));
+    ranges[split_index][1] = mid;
+    ranges[split_index + 1][0] = mid;
+    ranges_area[split_index] = sah_bv_surface_area(bv_a);
+    ranges_area[split_index + 1] = sah_bv_surface_area(bv_b);
+    ranges_num++;
+  }
+
+  node->children_num = (char)ranges_num;
+  node->children_begin = (int)atomic_fetch_and_add_uint32(&data->nodes_num, (uint)ranges_num);
+
+  for (int i = 0; i < ranges_num; i++) {
+    const int child_index = node->children_begin + i;
+    BVHSahNode *child = &data->nodes[child_index];
+    child->leafs_begin = ranges[i][0];
+    child->leafs_end = ranges[i][1];
+    child->children_begin = 0;
+    child->children_num = 0;
+    child->main_axis = 0;
+
+    const int leafs_num = child->leafs_end - child->leafs_begin;
+    if (leafs_num > 1) {
+      atomic_add_and_fetch_uint32(&data->branches_num, 1);
+      if (leafs_num > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+        BLI_task_pool_push(
+            data->task_pool, sah_build_node_task, POINTER_FROM_INT(child_index), false, NULL);
+      }
+      else {
+        sah_build_node(data, child_index);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure the tree can store \a totbranch branches, the binned SAH build may need more
+ * branches than the implicit tree allocated by #BLI_bvhtree_new.
+ * Only the leafs are kept, so this must be called before linking the branches.
+ */
+static void bvhtree_ensure_branches_len(BVHTree *tree, const int totbranch)
+{
+  const int numnodes_old = (int)(MEM_allocN_len(tree->nodearray) / sizeof(*tree->nodearray));
+  const int numnodes = tree->totleaf + totbranch;
+  if (numnodes <= numnodes_old) {
+    return;
+  }
+
+  BVHNode *nodearray_old = tree->nodearray;
+  tree->nodes = MEM_recallocN(tree->nodes, sizeof(BVHNode *) * (size_t)numnodes);
+  tree->nodearray = MEM_recallocN(tree->nodearray, sizeof(BVHNode) * (size_t)numnodes);
+  tree->nodebv = MEM_recallocN(tree->nodebv, sizeof(float) * (size_t)(tree->axis * numnodes));
+  tree->nodechild = MEM_recallocN(tree->nodechild,
+                                  sizeof(BVHNode *) * (size_t)(tree->tree_type * numnodes));
+
+  for (int i = 0; i < tree->totleaf; i++) {
+    tree->nodes[i] = &tree->nodearray[tree->nodes[i] - nodearray_old];
+  }
+  for (int i = 0; i < numnodes; i++) {
+    tree->nodearray[i].bv = &tree->nodebv[i * tree->axis];
+    tree->nodearray[i].children = &tree->nodechild[i * tree->tree_type];
+  }
+}
+
+typedef struct BVHSahLinkData {
+  BVHTree *tree;
+  const BVHSahNode *nodes;
+  const int *branch_index;
+} BVHSahLinkData;
+
+static void sah_link_branch_cb(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHSahLinkData *data = userdata;
+  const BVHSahNode *node = &data->nodes[i];
+  if (node->children_num == 0) {
+    return;
+  }
+
+  BVHTree *tree = data->tree;
+  BVHNode *branch = tree->nodes[tree->totleaf + data->branch_index[i]];
+  branch->totnode = node->children_num;
+  branch->main_axis = node->main_axis;
+
+  int k;
+  for (k = 0; k < node->children_num; k++) {
+    const int child_index = node->children_begin + k;
+    const BVHSahNode *child = &data->nodes[child_index];
+    if (child->children_num != 0) {
+      branch->children[k] = tree->nodes[tree->totleaf + data->branch_index[child_index]];
+    }
+    else {
+      branch->children[k] = tree->nodes[child->leafs_begin];
+    }
+    branch->children[k]->parent = branch;
+  }
+  for (; k < tree->tree_type; k++) {
+    branch->children[k] = NULL;
+  }
+}
+
+/**
+ * Build the branches of the tree with binned SAH splits.
+ * Sets `tree->totbranch` and links the branches in `tree->nodes`.
+ */
+static void sah_bvh_build(BVHTree *tree)
+{
+  BVHSahBuildData data = {
+      .tree = tree,
+      .leafs_array = tree->nodes,
+      /* Every node has at least two children, except the root of a single leaf tree. */
+      .nodes = MEM_malloc_arrayN((size_t)(2 * tree->totleaf + 1), sizeof(BVHSahNode), __func__),
+      .nodes_num = 1,
+      .branches_num = 1,
+  };
+  data.nodes[0].leafs_begin = 0;
+  data.nodes[0].leafs_end = tree->totleaf;
+
+  data.task_pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+  sah_build_node(&data, 0);
+  BLI_task_pool_work_and_wait(data.task_pool);
+  BLI_task_pool_free(data.task_pool);
+
+  /* Number branches in the order their nodes were created. Parents are created before their
+   * children, so children always have a greater index, which #BLI_bvhtree_update_tree needs. */
+  const int nodes_num = (int)data.nodes_num;
+  int *branch_index = MEM_malloc_arrayN((size_t)nodes_num, sizeof(int), __func__);
+  int totbranch = 0;
+  for (int i = 0; i < nodes_num; i++) {
+    branch_index[i] = (data.nodes[i].children_num != 0) ? totbranch++ : -1;
+  }
+  BLI_assert(totbranch == (int)data.branches_num);
+
+  /* Leafs were reordered in place by the build, the order is kept here. */
+  bvhtree_ensure_branches_len(tree, totbranch);
+  tree->totbranch = totbranch;
+  for (int i = 0; i < totbranch; i++) {
+    tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+  }
+
+  BVHSahLinkData link_data = {
+      .tree = tree,
+      .nodes = data.nodes,
+      .branch_index = branch_index,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = KDOPBVH_THREAD_LEAF_THRESHOLD;
+  BLI_task_parallel_range(0, nodes_num, &link_data, sah_link_branch_cb, &settings);
+
+  tree->nodes[tree->totleaf]->parent = NULL;
+
+  MEM_freeN(branch_index);
+  MEM_freeN(data.nodes);
+
+  BLI_bvhtree_update_tree(tree);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -955,7 +1452,11 @@ void BLI_bvhtree_free(BVHTree *tree)
   }
 }
 
-void BLI_bvhtree_balance(BVHTree *tree)
+/**
+ * \param flag: #BVH_BALANCE_SAH to build the tree with the surface area heuristic,
+ * which is slower than the default median splits but gives faster queries.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, int flag)
 {
   BVHNode **leafs_array = tree->nodes;
 
@@ -963,15 +1464,21 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  /* The SAH build only uses the x, y, z axes which other k-DOP types don't have. */
+  if ((flag & BVH_BALANCE_SAH) && (tree->totleaf > 1) && (tree->start_axis == 0)) {
+    sah_bvh_build(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
 
-  /* current code expects the branches to be linked to the nodes array
-   * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
-  for (int i = 0; i < tree->totbranch; i++) {
-    tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    /* current code expects the branches to be linked to the nodes array
+     * we perform that linkage here */
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+    for (int i = 0; i < tree->totbranch; i++) {
+      tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    }
   }
 
 #ifdef USE_SKIP_LINKS
@@ -987,6 +1494,30 @@ void BLI_bvhtree_balance(BVHTree *tree)
 #endif
 }
 
+void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, 0);
+}
+
+/**
+ * Build the branches of a balanced tree again, from the bounds of the leafs as updated by
+ * #BLI_bvhtree_update_node. Slower than refitting with #BLI_bvhtree_update_tree, but restores
+ * the quality of trees whose leafs moved a lot since they were balanced,
+ * see #BLI_bvhtree_get_sah_cost.
+ */
+void BLI_bvhtree_rebalance(BVHTree *tree, int flag)
+{
+  const int numnodes = (int)(MEM_allocN_len(tree->nodearray) / sizeof(*tree->nodearray));
+
+  /* Both builders expect branches without children. */
+  memset(&tree->nodechild[tree->totleaf * tree->tree_type],
+         0,
+         sizeof(*tree->nodechild) * (size_t)((numnodes - tree->totleaf) * tree->tree_type));
+  tree->totbranch = 0;
+
+  BLI_bvhtree_balance_ex(tree, flag);
+}
+
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints)
 {
   axis_t axis_iter;
@@ -1076,6 +1607,41 @@ float BLI_bvhtree_get_epsilon(const BVHTree *tree)
   return tree->epsilon;
 }
 
+/**
+ * Memory allocated for the tree, in bytes.
+ */
+size_t BLI_bvhtree_get_memory_size(const BVHTree *tree)
+{
+  return sizeof(BVHTree) + MEM_allocN_len(tree->nodes) + MEM_allocN_len(tree->nodearray) +
+         MEM_allocN_len(tree->nodechild) + MEM_allocN_len(tree->nodebv);
+}
+
+/**
+ * Estimated cost of queries on the tree according to the surface area heuristic:
+ * the summed surface area of the branches relative to the surface area of the root.
+ *
+ * Refitting with #BLI_bvhtree_update_tree keeps the topology of the tree, so the cost grows as
+ * the leafs move. Comparing it with the cost after balancing tells when the tree should be
+ * rebuilt with #BLI_bvhtree_rebalance.
+ */
+float BLI_bvhtree_get_sah_cost(const BVHTree *tree)
+{
+  if (tree->totbranch == 0 || tree->start_axis != 0) {
+    return 0.0f;
+  }
+
+  const float root_area = sah_bv_surface_area(tree->nodes[tree->totleaf]->bv);
+  if (root_area == 0.0f) {
+    return 0.0f;
+  }
+
+  double area = 0.0;
+  for (int i = 0; i < tree->totbranch; i++) {
+    area += (double)sah_bv_surface_area(tree->nodes[tree->totleaf + i]->bv);
+  }
+  return (float)(area / (double)root_area);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2062,6 +2628,216 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_packet
+ *
+ * Same as #BLI_bvhtree_ray_cast_ex, but a packet of rays traverses the tree together: every node
+ * is visited once for the whole packet and the ray/box tests of all its rays are done at once
+ * using SIMD instructions. This pays off for coherent rays (such as rays cast from neighboring
+ * pixels or vertices) which mostly visit the same nodes.
+ *
+ * \{ */
+
+static void bvhtree_ray_packet_data_precalc(BVHRayPacketData *data, int rays_num, int flag)
+{
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    if (lane >= rays_num) {
+      /* Unused lanes never become active, only make sure they contain valid numbers. */
+      for (int i = 0; i < 3; i++) {
+        data->origin[i][lane] = 0.0f;
+        data->idot_axis[i][lane] = 0.0f;
+      }
+      continue;
+    }
+    const BVHTreeRay *ray = &data->ray[lane];
+    for (int i = 0; i < 3; i++) {
+      data->origin[i][lane] = ray->origin[i];
+      /* Match #bvhtree_ray_cast_data_precalc. */
+      data->idot_axis[i][lane] = (fabsf(ray->direction[i]) < FLT_EPSILON) ?
+                                     FLT_MAX :
+                                     1.0f / ray->direction[i];
+    }
+  }
+
+#ifdef USE_KDOPBVH_WATERTIGHT
+  for (int lane = 0; lane < rays_num; lane++) {
+    if (flag & BVH_RAYCAST_WATERTIGHT) {
+      isect_ray_tri_watertight_v3_precalc(&data->isect_precalc[lane], data->ray[lane].direction);
+      data->ray[lane].isect_precalc = &data->isect_precalc[lane];
+    }
+    else {
+      data->ray[lane].isect_precalc = NULL;
+    }
+  }
+#else
+  UNUSED_VARS(flag);
+#endif
+}
+
+/**
+ * Packet version of #fast_ray_nearest_hit.
+ *
+ * \return Bit mask of the rays from \a mask which hit the bounding volume closer than their
+ * current hit, the distance to it is stored in \a r_dist.
+ */
+static int ray_packet_nearest_hit(const BVHRayPacketData *data,
+                                  const float bv[6],
+                                  const int mask,
+                                  float r_dist[BVH_RAY_PACKET_SIZE])
+{
+#ifdef USE_KDOPBVH_SSE2
+  const __m128 hit_dist = _mm_setr_ps(
+      data->hit[0].dist, data->hit[1].dist, data->hit[2].dist, data->hit[3].dist);
+  __m128 t1[3], t2[3];
+  for (int i = 0; i < 3; i++) {
+    const __m128 origin = _mm_loadu_ps(data->origin[i]);
+    const __m128 idot = _mm_loadu_ps(data->idot_axis[i]);
+    const __m128 ta = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[2 * i]), origin), idot);
+    const __m128 tb = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[2 * i + 1]), origin), idot);
+    t1[i] = _mm_min_ps(ta, tb);
+    t2[i] = _mm_max_ps(ta, tb);
+  }
+  const __m128 zero = _mm_setzero_ps();
+  __m128 miss = _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[1]), _mm_cmplt_ps(t2[0], t1[1]));
+  miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[2]), _mm_cmplt_ps(t2[0], t1[2])));
+  miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[1], t2[2]), _mm_cmplt_ps(t2[1], t1[2])));
+  miss = _mm_or_ps(miss, _mm_cmplt_ps(_mm_min_ps(_mm_min_ps(t2[0], t2[1]), t2[2]), zero));
+  const __m128 dist = _mm_max_ps(_mm_max_ps(t1[0], t1[1]), t1[2]);
+  /* Rejects the box further than the current hit, which covers the `t1 > hit.dist` checks of
+   * the scalar version too. */
+  miss = _mm_or_ps(miss, _mm_cmpge_ps(dist, hit_dist));
+  _mm_storeu_ps(r_dist, dist);
+  return mask & ~_mm_movemask_ps(miss);
+#else
+  int hit_mask = 0;
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    if ((mask & (1 << lane)) == 0) {
+      continue;
+    }
+    float t1[3], t2[3];
+    for (int i = 0; i < 3; i++) {
+      const float ta = (bv[2 * i] - data->origin[i][lane]) * data->idot_axis[i][lane];
+      const float tb = (bv[2 * i + 1] - data->origin[i][lane]) * data->idot_axis[i][lane];
+      t1[i] = min_ff(ta, tb);
+      t2[i] = max_ff(ta, tb);
+    }
+    if (t1[0] > t2[1] || t2[0] < t1[1] || t1[0] > t2[2] || t2[0] < t1[2] || t1[1] > t2[2] ||
+        t2[1] < t1[2] || t2[0] < 0.0f || t2[1] < 0.0f || t2[2] < 0.0f) {
+      continue;
+    }
+    r_dist[lane] = max_fff(t1[0], t1[1], t1[2]);
+    if (r_dist[lane] < data->hit[lane].dist) {
+      hit_mask |= 1 << lane;
+    }
+  }
+  return hit_mask;
+#endif
+}
+
+static void dfs_raycast_packet(BVHRayPacketData *data, const BVHNode *node, int mask)
+{
+  float dist[BVH_RAY_PACKET_SIZE];
+  mask = ray_packet_nearest_hit(data, node->bv, mask, dist);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+      if ((mask & (1 << lane)) == 0) {
+        continue;
+      }
+      BVHTreeRayHit *hit = &data->hit[lane];
+      if (data->callback) {
+        data->callback(data->userdata, node->index, &data->ray[lane], hit);
+      }
+      else {
+        hit->index = node->index;
+        hit->dist = dist[lane];
+        madd_v3_v3v3fl(hit->co, data->ray[lane].origin, data->ray[lane].direction, dist[lane]);
+      }
+    }
+  }
+  else {
+    /* Pick loop direction to dive into the tree, based on the direction of the first ray of the
+     * packet which is still active. */
+    const BVHTreeRay *ray = &data->ray[bitscan_forward_i(mask)];
+    if (dot_v3v3(ray->direction, bvhtree_kdop_axes[node->main_axis]) > 0.0f) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_raycast_packet(data, node->children[i], mask);
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_raycast_packet(data, node->children[i], mask);
+      }
+    }
+  }
+}
+
+/**
+ * Cast \a rays_num rays, with the same result as calling #BLI_bvhtree_ray_cast_ex for each of
+ * them (the order in which the leaves are visited may differ, which only matters for hits at
+ * exactly the same distance).
+ *
+ * Rays are traversed in packets of consecutive rays, so the rays should be sorted to keep
+ * neighboring rays coherent.
+ *
+ * \param hits: Array of \a rays_num hits. They must be initialized by the caller (typically
+ * `index = -1` and `dist = BVH_RAYCAST_DIST_MAX`) and are updated with the closest hit.
+ */
+void BLI_bvhtree_ray_cast_packet(BVHTree *tree,
+                                 const float (*co)[3],
+                                 const float (*dir)[3],
+                                 int rays_num,
+                                 float radius,
+                                 BVHTreeRayHit *hits,
+                                 BVHTree_RayCastCallback callback,
+                                 void *userdata,
+                                 int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+  if (root == NULL) {
+    return;
+  }
+
+  /* The packet box test does not support ray radius, same as #fast_ray_nearest_hit. */
+  if (radius != 0.0f) {
+    for (int i = 0; i < rays_num; i++) {
+      BLI_bvhtree_ray_cast_ex(tree, co[i], dir[i], radius, &hits[i], callback, userdata, flag);
+    }
+    return;
+  }
+
+  BVHRayPacketData data;
+  data.tree = tree;
+  data.callback = callback;
+  data.userdata = userdata;
+
+  for (int start = 0; start < rays_num; start += BVH_RAY_PACKET_SIZE) {
+    const int packet_size = min_ii(BVH_RAY_PACKET_SIZE, rays_num - start);
+
+    for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+      /* Unused lanes get a copy of the last ray, they are masked out from the traversal. */
+      const int ray_index = start + min_ii(lane, packet_size - 1);
+      BLI_ASSERT_UNIT_V3(dir[ray_index]);
+      copy_v3_v3(data.ray[lane].origin, co[ray_index]);
+      copy_v3_v3(data.ray[lane].direction, dir[ray_index]);
+      data.ray[lane].radius = 0.0f;
+      data.hit[lane] = hits[ray_index];
+    }
+    bvhtree_ray_packet_data_precalc(&data, packet_size, flag);
+
+    dfs_raycast_packet(&data, root, (1 << packet_size) - 1);
+
+    for (int lane = 0; lane < packet_size; lane++) {
+      hits[start + lane] = data.hit[lane];
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
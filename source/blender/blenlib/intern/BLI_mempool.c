@@ -27,11 +27,16 @@
  * - Freeing chunks.
  * - Iterating over allocated chunks
  *   (optionally when using the #BLI_MEMPOOL_ALLOW_ITER flag).
+ * - Allocating and freeing from multiple threads using #BLI_mempool_thread_cache.
  */
 
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h> /* _mm_pause */
+#endif
+
 #include "atomic_ops.h"
 
 #include "BLI_utildefines.h"
@@ -131,6 +136,8 @@ struct BLI_mempool {
   uint maxchunks;
   /** Number of elements currently in use. */
   uint totused;
+  /** Protects the free list and chunks when accessed through thread caches. */
+  uint32_t lock;
 #ifdef USE_TOTALLOC
   /** Number of elements allocated in total. */
   uint totalloc;
@@ -315,6 +322,7 @@ BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag
   pool->totalloc = 0;
 #endif
   pool->totused = 0;
+  pool->lock = 0;
 
   if (totelem) {
     /* Allocate the actual chunks. */
@@ -366,6 +374,46 @@ void *BLI_mempool_calloc(BLI_mempool *pool)
   return retval;
 }
 
+/**
+ * Free all chunks except the first one, used when no elements are in use anymore.
+ */
+static void mempool_free_all_but_first_chunk(BLI_mempool *pool)
+{
+  const uint esize = pool->esize;
+  BLI_freenode *curnode;
+  uint j;
+  BLI_mempool_chunk *first;
+
+  first = pool->chunks;
+  mempool_chunk_free_all(first->next);
+  first->next = NULL;
+  pool->chunk_tail = first;
+
+#ifdef USE_TOTALLOC
+  pool->totalloc = pool->pchunk;
+#endif
+
+  /* Temp alloc so valgrind doesn't complain when setting free'd blocks 'next'. */
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_ALLOC(pool, CHUNK_DATA(first), pool->csize);
+#endif
+
+  curnode = CHUNK_DATA(first);
+  pool->free = curnode;
+
+  j = pool->pchunk;
+  while (j--) {
+    curnode->next = NODE_STEP_NEXT(curnode);
+    curnode = curnode->next;
+  }
+  curnode = NODE_STEP_PREV(curnode);
+  curnode->next = NULL; /* terminate the list */
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_FREE(pool, CHUNK_DATA(first));
+#endif
+}
+
 /**
  * Free an element from the mempool.
  *
@@ -415,42 +463,293 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
 
   /* Nothing is in use; free all the chunks except the first. */
   if (UNLIKELY(pool->totused == 0) && (pool->chunks->next)) {
-    const uint esize = pool->esize;
-    BLI_freenode *curnode;
-    uint j;
-    BLI_mempool_chunk *first;
+    mempool_free_all_but_first_chunk(pool);
+  }
+}
 
-    first = pool->chunks;
-    mempool_chunk_free_all(first->next);
-    first->next = NULL;
-    pool->chunk_tail = first;
+/**
+ * Allocate \a elems_len elements at once, filling \a r_elems with them.
+ */
+void BLI_mempool_alloc_multi(BLI_mempool *pool, void **r_elems, uint elems_len)
+{
+  const bool use_iter = (pool->flag & BLI_MEMPOOL_ALLOW_ITER) != 0;
 
-#ifdef USE_TOTALLOC
-    pool->totalloc = pool->pchunk;
+  for (uint i = 0; i < elems_len; i++) {
+    if (UNLIKELY(pool->free == NULL)) {
+      BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
+      mempool_chunk_add(pool, mpchunk, NULL);
+    }
+
+    BLI_freenode *free_pop = pool->free;
+    if (use_iter) {
+      free_pop->freeword = USEDWORD;
+    }
+    pool->free = free_pop->next;
+
+#ifdef WITH_MEM_VALGRIND
+    VALGRIND_MEMPOOL_ALLOC(pool, free_pop, pool->esize);
+#endif
+
+    r_elems[i] = free_pop;
+  }
+
+  pool->totused += elems_len;
+}
+
+/**
+ * Free \a elems_len elements at once, the free list is only updated once for all of them.
+ *
+ * \note doesn't protect against double frees, take care!
+ */
+void BLI_mempool_free_multi(BLI_mempool *pool, void **elems, uint elems_len)
+{
+  if (elems_len == 0) {
+    return;
+  }
+
+  const bool use_iter = (pool->flag & BLI_MEMPOOL_ALLOW_ITER) != 0;
+  BLI_freenode *first = elems[0];
+  BLI_freenode *last = NULL;
+
+  for (uint i = 0; i < elems_len; i++) {
+    BLI_freenode *node = elems[i];
+
+#ifndef NDEBUG
+    if (UNLIKELY(mempool_debug_memset)) {
+      memset(node, 255, pool->esize);
+    }
 #endif
 
-    /* Temp alloc so valgrind doesn't complain when setting free'd blocks 'next'. */
+    if (use_iter) {
+      BLI_assert(node->freeword != FREEWORD);
+      node->freeword = FREEWORD;
+    }
+    if (last) {
+      last->next = node;
+    }
+    last = node;
+
 #ifdef WITH_MEM_VALGRIND
-    VALGRIND_MEMPOOL_ALLOC(pool, CHUNK_DATA(first), pool->csize);
+    VALGRIND_MEMPOOL_FREE(pool, node);
 #endif
+  }
 
-    curnode = CHUNK_DATA(first);
-    pool->free = curnode;
+  last->next = pool->free;
+  pool->free = first;
 
-    j = pool->pchunk;
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode = curnode->next;
+  BLI_assert(pool->totused >= elems_len);
+  pool->totused -= elems_len;
+
+  if (UNLIKELY(pool->totused == 0) && (pool->chunks->next)) {
+    mempool_free_all_but_first_chunk(pool);
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Thread Cache
+ * \{ */
+
+BLI_INLINE void mempool_lock_pause(void)
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+/**
+ * Lock the pool using atomics only, since this file is also compiled into `makesdna`,
+ * which doesn't link the threading API.
+ */
+BLI_INLINE void mempool_lock(BLI_mempool *pool)
+{
+  while (atomic_cas_uint32(&pool->lock, 0, 1) != 0) {
+    /* Wait with plain reads until the lock looks free, so the cache line is not written to while
+     * another thread holds it. */
+    while (*(volatile uint32_t *)&pool->lock != 0) {
+      mempool_lock_pause();
     }
-    curnode = NODE_STEP_PREV(curnode);
-    curnode->next = NULL; /* terminate the list */
+  }
+}
+
+BLI_INLINE void mempool_unlock(BLI_mempool *pool)
+{
+  atomic_cas_uint32(&pool->lock, 1, 0);
+}
+
+/**
+ * Number of free elements moved between a cache and the pool at once.
+ * A full chunk, so new chunks can be given to a cache as a whole.
+ */
+BLI_INLINE uint mempool_thread_cache_batch_len(const BLI_mempool *pool)
+{
+  return pool->pchunk;
+}
+
+/**
+ * Apply the number of elements allocated and freed by the cache to the pool.
+ * The pool has to be locked.
+ */
+static void mempool_thread_cache_sync_totused(BLI_mempool_thread_cache *cache)
+{
+  cache->pool->totused = (uint)((int)cache->pool->totused + cache->totused_delta);
+  cache->totused_delta = 0;
+}
+
+static void mempool_thread_cache_refill(BLI_mempool_thread_cache *cache)
+{
+  BLI_mempool *pool = cache->pool;
+  const uint batch_len = mempool_thread_cache_batch_len(pool);
+
+  mempool_lock(pool);
+  if (pool->free == NULL) {
+    /* Don't hold the lock while allocating. */
+    mempool_unlock(pool);
+    BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
+    mempool_lock(pool);
+
+    /* Other threads may have freed elements in the meantime, keep those after the new ones. */
+    BLI_freenode *free_prev = pool->free;
+    BLI_freenode *last_tail = mempool_chunk_add(pool, mpchunk, NULL);
+    last_tail->next = free_prev;
+    pool->free = CHUNK_DATA(mpchunk);
+  }
+
+  BLI_freenode *first = pool->free;
+  BLI_freenode *last = first;
+  uint len = 1;
+  while (len < batch_len && last->next != NULL) {
+    last = last->next;
+    len++;
+  }
+  pool->free = last->next;
+  mempool_thread_cache_sync_totused(cache);
+  mempool_unlock(pool);
+
+  last->next = cache->free;
+  cache->free = first;
+  cache->free_len += len;
+}
+
+/**
+ * Give the first \a len free elements of the cache back to the pool.
+ */
+static void mempool_thread_cache_release(BLI_mempool_thread_cache *cache, const uint len)
+{
+  BLI_mempool *pool = cache->pool;
+  BLI_freenode *first = cache->free;
+  BLI_freenode *last = NULL;
+
+  if (len > 0) {
+    last = first;
+    for (uint i = 1; i < len; i++) {
+      last = last->next;
+    }
+    cache->free = last->next;
+    cache->free_len -= len;
+  }
+
+  mempool_lock(pool);
+  if (last != NULL) {
+    last->next = pool->free;
+    pool->free = first;
+  }
+  mempool_thread_cache_sync_totused(cache);
+  mempool_unlock(pool);
+}
+
+/**
+ * Initialize an empty cache, it gets elements from the pool once it is used.
+ */
+void BLI_mempool_thread_cache_init(BLI_mempool *pool, BLI_mempool_thread_cache *cache)
+{
+  cache->pool = pool;
+  cache->free = NULL;
+  cache->free_len = 0;
+  cache->totused_delta = 0;
+}
+
+void *BLI_mempool_thread_cache_alloc(BLI_mempool_thread_cache *cache)
+{
+  if (UNLIKELY(cache->free == NULL)) {
+    mempool_thread_cache_refill(cache);
+  }
+
+  BLI_mempool *pool = cache->pool;
+  BLI_freenode *free_pop = cache->free;
+
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    free_pop->freeword = USEDWORD;
+  }
+
+  cache->free = free_pop->next;
+  cache->free_len--;
+  cache->totused_delta++;
 
 #ifdef WITH_MEM_VALGRIND
-    VALGRIND_MEMPOOL_FREE(pool, CHUNK_DATA(first));
+  VALGRIND_MEMPOOL_ALLOC(pool, free_pop, pool->esize);
 #endif
+
+  return (void *)free_pop;
+}
+
+void *BLI_mempool_thread_cache_calloc(BLI_mempool_thread_cache *cache)
+{
+  void *retval = BLI_mempool_thread_cache_alloc(cache);
+  memset(retval, 0, (size_t)cache->pool->esize);
+  return retval;
+}
+
+/**
+ * Free an element into the cache, the element may have been allocated by any thread.
+ *
+ * \note Unlike #BLI_mempool_free, chunks are never freed here, even when nothing is in use.
+ */
+void BLI_mempool_thread_cache_free(BLI_mempool_thread_cache *cache, void *addr)
+{
+  BLI_mempool *pool = cache->pool;
+  BLI_freenode *newhead = addr;
+
+#ifndef NDEBUG
+  if (UNLIKELY(mempool_debug_memset)) {
+    memset(addr, 255, pool->esize);
+  }
+#endif
+
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    BLI_assert(newhead->freeword != FREEWORD);
+    newhead->freeword = FREEWORD;
+  }
+
+  newhead->next = cache->free;
+  cache->free = newhead;
+  cache->free_len++;
+  cache->totused_delta--;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_FREE(pool, addr);
+#endif
+
+  /* Keep one batch around, so alternating allocations and frees don't lock the pool. */
+  const uint batch_len = mempool_thread_cache_batch_len(pool);
+  if (UNLIKELY(cache->free_len >= batch_len * 2)) {
+    mempool_thread_cache_release(cache, batch_len);
   }
 }
 
+/**
+ * Give all free elements back to the pool and update its number of used elements.
+ * The cache can be used again afterwards.
+ */
+void BLI_mempool_thread_cache_flush(BLI_mempool_thread_cache *cache)
+{
+  mempool_thread_cache_release(cache, cache->free_len);
+  BLI_assert(cache->free == NULL);
+}
+
+/** \} */
+
 int BLI_mempool_len(BLI_mempool *pool)
 {
   return (int)pool->totused;
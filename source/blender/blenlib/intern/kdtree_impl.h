@@ -22,9 +22,14 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 #include "BLI_utildefines.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #define _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2) MACRO_ARG1##MACRO_ARG2
 #define _CONCAT(MACRO_ARG1, MACRO_ARG2) _CONCAT_AUX(MACRO_ARG1, MACRO_ARG2)
 #define BLI_kdtree_nd_(id) _CONCAT(KDTREE_PREFIX_ID, _##id)
@@ -64,6 +69,12 @@ struct KDTree {
  */
 #define KD_NODE_ROOT_IS_INIT ((uint)-2)
 
+/**
+ * Sub-trees with this number of nodes or less are scanned as a whole
+ * by the batched queries, see #kdtree_find_nearest_bucketed.
+ */
+#define KD_LEAF_BUCKET_SIZE 8
+
 /* -------------------------------------------------------------------- */
 /** \name Local Math API
  * \{ */
@@ -332,6 +343,181 @@ int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
   return min_node->index;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_kdtree_3d_find_nearest_multi
+ *
+ * Balancing stores every sub-tree in a contiguous range of the nodes array, with its root in the
+ * middle of the range. The batched queries use this to scan small sub-trees linearly as leaf
+ * buckets, instead of traversing them node by node.
+ * \{ */
+
+typedef struct KDTreeNodeRange {
+  uint begin, end;
+  /** Squared distance from the search point to the splitting planes bounding the range. */
+  float dist_min;
+} KDTreeNodeRange;
+
+static void kdtree_nearest_bucket_scan(const KDTreeNode *nodes,
+                                       uint begin,
+                                       const uint end,
+                                       const float co[KD_DIMS],
+                                       float *min_dist,
+                                       const KDTreeNode **min_node)
+{
+#ifdef __SSE2__
+  for (; begin + 4 <= end; begin += 4) {
+    const KDTreeNode *node = &nodes[begin];
+    __m128 dist = _mm_setzero_ps();
+    for (uint j = 0; j < KD_DIMS; j++) {
+      const __m128 d = _mm_sub_ps(
+          _mm_setr_ps(node[0].co[j], node[1].co[j], node[2].co[j], node[3].co[j]),
+          _mm_set1_ps(co[j]));
+      dist = _mm_add_ps(dist, _mm_mul_ps(d, d));
+    }
+    if (_mm_movemask_ps(_mm_cmplt_ps(dist, _mm_set1_ps(*min_dist)))) {
+      float dist_array[4];
+      _mm_storeu_ps(dist_array, dist);
+      for (uint k = 0; k < 4; k++) {
+        if (dist_array[k] < *min_dist) {
+          *min_dist = dist_array[k];
+          *min_node = &node[k];
+        }
+      }
+    }
+  }
+#endif
+  for (; begin < end; begin++) {
+    const float dist = len_squared_vnvn(nodes[begin].co, co);
+    if (dist < *min_dist) {
+      *min_dist = dist;
+      *min_node = &nodes[begin];
+    }
+  }
+}
+
+/**
+ * Same as #BLI_kdtree_3d_find_nearest, using node ranges instead of the left/right links.
+ * Ranges are pushed with the distance to their bounding plane, so they can be skipped when a
+ * closer point was found since, and small ranges are scanned as leaf buckets.
+ */
+static const KDTreeNode *kdtree_find_nearest_bucketed(const KDTree *tree,
+                                                      const float co[KD_DIMS],
+                                                      float *r_min_dist)
+{
+  const KDTreeNode *nodes = tree->nodes;
+  const KDTreeNode *min_node = NULL;
+  float min_dist = FLT_MAX;
+
+  /* At most one range is pushed per level of the tree, plus the one being split. */
+  KDTreeNodeRange stack[sizeof(uint) * 8 + 1];
+  uint cur = 0;
+
+  stack[cur++] = (KDTreeNodeRange){0, tree->nodes_len, 0.0f};
+
+  while (cur--) {
+    const KDTreeNodeRange range = stack[cur];
+    if (range.dist_min >= min_dist) {
+      continue;
+    }
+    if (range.end - range.begin <= KD_LEAF_BUCKET_SIZE) {
+      kdtree_nearest_bucket_scan(nodes, range.begin, range.end, co, &min_dist, &min_node);
+      continue;
+    }
+
+    /* Matches the median used by #kdtree_balance. */
+    const uint mid = range.begin + (range.end - range.begin) / 2;
+    const KDTreeNode *node = &nodes[mid];
+
+    const float dist = len_squared_vnvn(node->co, co);
+    if (dist < min_dist) {
+      min_dist = dist;
+      min_node = node;
+    }
+
+    const KDTreeNodeRange left = {range.begin, mid, range.dist_min};
+    const KDTreeNodeRange right = {mid + 1, range.end, range.dist_min};
+    const float dist_plane = co[node->d] - node->co[node->d];
+    const float dist_plane_sq = max_ff(range.dist_min, dist_plane * dist_plane);
+
+    /* Push the far side first, so the near side is searched first. */
+    if (dist_plane < 0.0f) {
+      stack[cur] = right;
+      stack[cur++].dist_min = dist_plane_sq;
+      stack[cur++] = left;
+    }
+    else {
+      stack[cur] = left;
+      stack[cur++].dist_min = dist_plane_sq;
+      stack[cur++] = right;
+    }
+  }
+
+  *r_min_dist = min_dist;
+  return min_node;
+}
+
+typedef struct KDTreeFindNearestMultiData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  int *r_index;
+  KDTreeNearest *r_nearest;
+} KDTreeFindNearestMultiData;
+
+static void kdtree_find_nearest_multi_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeFindNearestMultiData *data = userdata;
+  float min_dist;
+  const KDTreeNode *min_node = kdtree_find_nearest_bucketed(data->tree, data->co[i], &min_dist);
+  const int index = min_node ? min_node->index : -1;
+
+  if (data->r_index) {
+    data->r_index[i] = index;
+  }
+  if (data->r_nearest) {
+    KDTreeNearest *nearest = &data->r_nearest[i];
+    nearest->index = index;
+    if (min_node) {
+      nearest->dist = sqrtf(min_dist);
+      copy_vn_vn(nearest->co, min_node->co);
+    }
+  }
+}
+
+/**
+ * Find the nearest point of every coordinate in \a co, in parallel.
+ * Gives the same results as calling #BLI_kdtree_3d_find_nearest for each of them (except for
+ * points at exactly the same distance), but much faster for many queries.
+ *
+ * \param r_index: Optional array of \a co_len indices, -1 when the tree is empty.
+ * \param r_nearest: Optional array of \a co_len results.
+ */
+void BLI_kdtree_nd_(find_nearest_multi)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        int *r_index,
+                                        KDTreeNearest *r_nearest)
+{
+#ifdef DEBUG
+  BLI_assert(tree->is_balanced == true);
+#endif
+
+  KDTreeFindNearestMultiData data = {
+      .tree = tree,
+      .co = co,
+      .r_index = r_index,
+      .r_nearest = r_nearest,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_find_nearest_multi_cb, &settings);
+}
+
+/** \} */
+
 /**
  * A version of #BLI_kdtree_3d_find_nearest which runs a callback
  * to filter out values.
@@ -76,3 +76,12 @@ int BLI_task_scheduler_num_threads()
 {
   return task_scheduler_num_threads;
 }
+
+void BLI_task_isolate(void (*func)(void *userdata), void *userdata)
+{
+#ifdef WITH_TBB
+  tbb::this_task_arena::isolate([&] { func(userdata); });
+#else
+  func(userdata);
+#endif
+}
@@ -181,6 +181,8 @@ void *BLO_read_get_new_data_address(BlendDataReader *reader, const void *old_add
 
 #define BLO_read_data_address(reader, ptr_p) \
   *((void **)ptr_p) = BLO_read_get_new_data_address((reader), *(ptr_p))
+/* Update every pointer in an array of data pointers, in place. */
+void BLO_read_data_address_array(BlendDataReader *reader, int array_size, void **ptr_array);
 
 typedef void (*BlendReadListFn)(BlendDataReader *reader, void *data);
 void BLO_read_list_cb(BlendDataReader *reader, struct ListBase *list, BlendReadListFn callback);
@@ -208,6 +210,11 @@ ID *BLO_read_get_new_id_address(BlendLibReader *reader, struct Library *lib, str
 
 #define BLO_read_id_address(reader, lib, id_ptr_p) \
   *(id_ptr_p) = (void *)BLO_read_get_new_id_address((reader), (lib), (ID *)*(id_ptr_p))
+/* Update every pointer in an array of ID pointers, in place. */
+void BLO_read_id_address_array(BlendLibReader *reader,
+                               struct Library *lib,
+                               int array_size,
+                               struct ID **id_array);
 
 /* Blend Expand API
  * ===================
@@ -42,6 +42,9 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the chunk content, used to find identical chunks in previous memundo step
+   * when they are not at the same position (see #MemFileWriteData.chunk_hash_mapping). */
+  uint hash;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -58,6 +61,9 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Maps the content hash (combined with the ID session uuid) of reference MemFileChunk's
+   * to the first chunk with that key, so identical data can be shared regardless of ordering. */
+  struct GHash *chunk_hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -33,7 +33,8 @@
 
 #include "BLI_utildefines.h"
 #ifndef WIN32
-#  include <unistd.h>  // for read close
+#  include <sys/mman.h> /* for mmap. */
+#  include <unistd.h>   // for read close
 #else
 #  include "BLI_winstuff.h"
 #  include "winsock2.h"
@@ -107,6 +108,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -238,6 +240,23 @@
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Memory-map uncompressed files instead of reading them through the file descriptor,
+ * this avoids a system call per block and allows the data of blocks read on demand
+ * to be used in-place (without a temporary copy).
+ *
+ * \note Requires #USE_BHEAD_READ_ON_DEMAND.
+ */
+#ifndef WIN32
+#  define USE_BHEAD_MMAP
+#endif
+
+/**
+ * Data blocks belonging to an ID are reconstructed in parallel when they are all
+ * directly addressable (see #USE_BHEAD_MMAP) and their total size exceeds this threshold.
+ */
+#define READ_DATA_THREADED_MIN_SIZE (1 << 16)
+
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
@@ -327,12 +346,19 @@ typedef struct OldNew {
   int nr;
 } OldNew;
 
+typedef struct OldNewSlot {
+  /* Hash of the key, so most mismatching entries can be skipped without reading them. */
+  uint32_t hash;
+  /* Index into the `entries` array, -1 for empty slots. */
+  int32_t index;
+} OldNewSlot;
+
 typedef struct OldNewMap {
   /* Array that stores the actual entries. */
   OldNew *entries;
   int nentries;
   /* Hashmap that stores indices into the `entries` array. */
-  int32_t *map;
+  OldNewSlot *map;
 
   int capacity_exp;
 } OldNewMap;
@@ -344,21 +370,29 @@ typedef struct OldNewMap {
 #define PERTURB_SHIFT 5
 
 /* based on the probing algorithm used in Python dicts. */
-#define ITER_SLOTS(onm, KEY, SLOT_NAME, INDEX_NAME) \
-  uint32_t hash = BLI_ghashutil_ptrhash(KEY); \
+#define ITER_SLOTS(onm, HASH, SLOT_NAME, INDEX_NAME) \
   uint32_t mask = SLOT_MASK(onm); \
-  uint perturb = hash; \
-  int SLOT_NAME = mask & hash; \
-  int INDEX_NAME = onm->map[SLOT_NAME]; \
+  uint perturb = HASH; \
+  int SLOT_NAME = mask & HASH; \
+  int INDEX_NAME = onm->map[SLOT_NAME].index; \
   for (;; SLOT_NAME = mask & ((5 * SLOT_NAME) + 1 + perturb), \
           perturb >>= PERTURB_SHIFT, \
-          INDEX_NAME = onm->map[SLOT_NAME])
+          INDEX_NAME = onm->map[SLOT_NAME].index)
+
+/* Same as #BLI_ghashutil_ptrhash, inlined since it's used for every pointer that is read. */
+BLI_INLINE uint32_t oldnewmap_hash(const void *ptr)
+{
+  const size_t y = (size_t)ptr;
+  return (uint32_t)(y >> 4) | ((uint32_t)y << (8 * sizeof(uint32_t) - 4));
+}
 
 static void oldnewmap_insert_index_in_map(OldNewMap *onm, const void *ptr, int index)
 {
-  ITER_SLOTS (onm, ptr, slot, stored_index) {
+  const uint32_t hash = oldnewmap_hash(ptr);
+  ITER_SLOTS (onm, hash, slot, stored_index) {
     if (stored_index == -1) {
-      onm->map[slot] = index;
+      onm->map[slot].hash = hash;
+      onm->map[slot].index = index;
       break;
     }
   }
@@ -366,27 +400,37 @@ static void oldnewmap_insert_index_in_map(OldNewMap *onm, const void *ptr, int i
 
 static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
 {
-  ITER_SLOTS (onm, entry.oldp, slot, index) {
+  const uint32_t hash = oldnewmap_hash(entry.oldp);
+  ITER_SLOTS (onm, hash, slot, index) {
     if (index == -1) {
       onm->entries[onm->nentries] = entry;
-      onm->map[slot] = onm->nentries;
+      onm->map[slot].hash = hash;
+      onm->map[slot].index = onm->nentries;
       onm->nentries++;
       break;
     }
-    else if (onm->entries[index].oldp == entry.oldp) {
+    else if (onm->map[slot].hash == hash && onm->entries[index].oldp == entry.oldp) {
       onm->entries[index] = entry;
       break;
     }
   }
 }
 
-static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
+BLI_INLINE OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
 {
-  ITER_SLOTS (onm, addr, slot, index) {
+  /* NULL is never added, checking it here avoids probing for the many unset pointers. */
+  if (addr == NULL) {
+    return NULL;
+  }
+
+  const uint32_t hash = oldnewmap_hash(addr);
+  ITER_SLOTS (onm, hash, slot, index) {
     if (index >= 0) {
-      OldNew *entry = &onm->entries[index];
-      if (entry->oldp == addr) {
-        return entry;
+      if (onm->map[slot].hash == hash) {
+        OldNew *entry = &onm->entries[index];
+        if (entry->oldp == addr) {
+          return entry;
+        }
       }
     }
     else {
@@ -400,9 +444,9 @@ static void oldnewmap_clear_map(OldNewMap *onm)
   memset(onm->map, 0xFF, MAP_CAPACITY(onm) * sizeof(*onm->map));
 }
 
-static void oldnewmap_increase_size(OldNewMap *onm)
+static void oldnewmap_resize(OldNewMap *onm, int capacity_exp)
 {
-  onm->capacity_exp++;
+  onm->capacity_exp = capacity_exp;
   onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * ENTRIES_CAPACITY(onm));
   onm->map = MEM_reallocN(onm->map, sizeof(*onm->map) * MAP_CAPACITY(onm));
   oldnewmap_clear_map(onm);
@@ -411,6 +455,11 @@ static void oldnewmap_increase_size(OldNewMap *onm)
   }
 }
 
+static void oldnewmap_increase_size(OldNewMap *onm)
+{
+  oldnewmap_resize(onm, onm->capacity_exp + 1);
+}
+
 /* Public OldNewMap API */
 
 static OldNewMap *oldnewmap_new(void)
@@ -448,7 +497,24 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void
   oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
-static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
+#ifdef USE_BHEAD_MMAP
+/**
+ * Make room for \a nentries entries in total,
+ * to avoid growing the map multiple times when the number of insertions is known up-front.
+ */
+static void oldnewmap_reserve(OldNewMap *onm, int nentries)
+{
+  int capacity_exp = onm->capacity_exp;
+  while ((1ll << capacity_exp) < nentries) {
+    capacity_exp++;
+  }
+  if (capacity_exp != onm->capacity_exp) {
+    oldnewmap_resize(onm, capacity_exp);
+  }
+}
+#endif
+
+BLI_INLINE void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
 {
   OldNew *entry = oldnewmap_lookup_entry(onm, addr);
   if (entry == NULL) {
@@ -460,13 +526,23 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool inc
   return entry->newp;
 }
 
-/* for libdata, OldNew.nr has ID code, no increment */
-static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *lib)
+/**
+ * Replace all addresses in the array with their new address (NULL when not found).
+ * Resolving a whole array at once avoids a function call per pointer.
+ */
+static void oldnewmap_lookup_and_inc_array(OldNewMap *onm,
+                                           void **addrs,
+                                           int addrs_len,
+                                           bool increase_users)
 {
-  if (addr == NULL) {
-    return NULL;
+  for (int i = 0; i < addrs_len; i++) {
+    addrs[i] = oldnewmap_lookup_and_inc(onm, addrs[i], increase_users);
   }
+}
 
+/* for libdata, OldNew.nr has ID code, no increment */
+BLI_INLINE void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *lib)
+{
   ID *id = oldnewmap_lookup_and_inc(onm, addr, false);
   if (id == NULL) {
     return NULL;
@@ -477,6 +553,16 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
   return NULL;
 }
 
+static void oldnewmap_liblookup_array(OldNewMap *onm,
+                                      void **addrs,
+                                      int addrs_len,
+                                      const void *lib)
+{
+  for (int i = 0; i < addrs_len; i++) {
+    addrs[i] = oldnewmap_liblookup(onm, addrs[i], lib);
+  }
+}
+
 static void oldnewmap_clear(OldNewMap *onm)
 {
   /* Free unused data. */
@@ -1029,6 +1115,29 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 }
 #endif /* USE_BHEAD_READ_ON_DEMAND */
 
+/**
+ * Return the data of a block when it can be accessed without reading from the file,
+ * either because it has been read already or because the file is memory-mapped.
+ * Unlike #blo_bhead_read_data this doesn't change the file position,
+ * so it's safe to use from multiple threads.
+ */
+static const void *blo_bhead_data_direct(const FileData *fd, const BHead *thisblock)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  const BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  if (new_bhead->has_data == false) {
+#  ifdef USE_BHEAD_MMAP
+    if (fd->mmap_data != NULL) {
+      return fd->mmap_data + new_bhead->file_offset;
+    }
+#  endif
+    return NULL;
+  }
+#endif
+  UNUSED_VARS(fd);
+  return thisblock + 1;
+}
+
 /* Warning! Caller's responsibility to ensure given bhead **is** and ID one! */
 const char *blo_bhead_id_name(const FileData *fd, const BHead *bhead)
 {
@@ -1107,6 +1216,8 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       if (fd->filesdna) {
         blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
         fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+        fd->reconstruct_info = DNA_reconstruct_info_create(
+            fd->filesdna, fd->memsdna, fd->compflags);
         /* used to retrieve ID names from (bhead+1) */
         fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
 
@@ -1196,6 +1307,72 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+#ifdef USE_BHEAD_MMAP
+
+/* Memory-mapped file reading. */
+
+static int fd_read_from_mmap(FileData *filedata,
+                             void *buffer,
+                             uint size,
+                             bool *UNUSED(r_is_memchunck_identical))
+{
+  /* don't read more bytes then there are available in the mapping */
+  const size_t readsize = MIN2((size_t)size, filedata->mmap_size - (size_t)filedata->file_offset);
+
+  memcpy(buffer, filedata->mmap_data + filedata->file_offset, readsize);
+  filedata->file_offset += readsize;
+
+  return (int)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t offset_new;
+  switch (whence) {
+    case SEEK_SET:
+      offset_new = offset;
+      break;
+    case SEEK_CUR:
+      offset_new = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      offset_new = (off64_t)filedata->mmap_size + offset;
+      break;
+    default:
+      return -1;
+  }
+  if (offset_new < 0 || offset_new > (off64_t)filedata->mmap_size) {
+    return -1;
+  }
+  filedata->file_offset = offset_new;
+  return filedata->file_offset;
+}
+
+/**
+ * Map the whole file into memory (read-only), returns false when mapping isn't possible,
+ * in that case regular file reading is used.
+ */
+static bool fd_mmap_file(FileData *filedata, int file)
+{
+  const size_t size = BLI_file_descriptor_size(file);
+  if (ELEM(size, 0, (size_t)-1)) {
+    return false;
+  }
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+#  ifdef MADV_WILLNEED
+  /* The whole file is typically read, let the kernel read ahead. */
+  madvise(data, size, MADV_WILLNEED);
+#  endif
+  filedata->mmap_data = data;
+  filedata->mmap_size = size;
+  return true;
+}
+
+#endif /* USE_BHEAD_MMAP */
+
 /* GZip file reading. */
 
 static int fd_read_gzip_from_file(FileData *filedata,
@@ -1418,6 +1595,13 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   fd->read = read_fn;
   fd->seek = seek_fn;
 
+#ifdef USE_BHEAD_MMAP
+  if ((read_fn == fd_read_data_from_file) && fd_mmap_file(fd, file)) {
+    fd->read = fd_read_from_mmap;
+    fd->seek = fd_seek_from_mmap;
+  }
+#endif
+
   return fd;
 }
 
@@ -1576,6 +1760,13 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+#ifdef USE_BHEAD_MMAP
+    if (fd->mmap_data != NULL) {
+      munmap((void *)fd->mmap_data, fd->mmap_size);
+      fd->mmap_data = NULL;
+    }
+#endif
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1600,6 +1791,9 @@ void blo_filedata_free(FileData *fd)
     }
 #endif
 
+    if (fd->reconstruct_info) {
+      DNA_reconstruct_info_free(fd->reconstruct_info);
+    }
     if (fd->filesdna) {
       DNA_sdna_free(fd->filesdna);
     }
@@ -2164,6 +2358,31 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
+/**
+ * Reconstruct (or copy) the structs of a block from data that is already in memory.
+ * Doesn't access the file, so it's safe to call from multiple threads.
+ */
+static void *read_struct_from_data(const FileData *fd,
+                                   const BHead *bh,
+                                   const void *data,
+                                   const char *blockname)
+{
+  void *temp = NULL;
+
+  if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
+    if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+      temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
+    }
+    else {
+      /* SDNA_CMP_EQUAL */
+      temp = MEM_mallocN(bh->len, blockname);
+      memcpy(temp, data, bh->len);
+    }
+  }
+
+  return temp;
+}
+
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = NULL;
@@ -2187,43 +2406,33 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       switch_endian_structs(fd->filesdna, bh);
     }
 
-    if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
-      if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+    const void *data = blo_bhead_data_direct(fd, bh);
+    if (data != NULL) {
+      temp = read_struct_from_data(fd, bh, data, blockname);
+    }
 #ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
-          }
+    else if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
+      if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        bh = blo_bhead_read_full(fd, bh);
+        if (UNLIKELY(bh == NULL)) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+          return NULL;
         }
-#endif
-        temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
       }
       else {
         /* SDNA_CMP_EQUAL */
         temp = MEM_mallocN(bh->len, blockname);
-#ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data) {
-          memcpy(temp, (bh + 1), bh->len);
-        }
-        else {
-          /* Instead of allocating the bhead, then copying it,
-           * read the data from the file directly into the memory. */
-          if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            MEM_freeN(temp);
-            temp = NULL;
-          }
+        /* Instead of allocating the bhead, then copying it,
+         * read the data from the file directly into the memory. */
+        if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+          MEM_freeN(temp);
+          temp = NULL;
         }
-#else
-        memcpy(temp, (bh + 1), bh->len);
-#endif
       }
     }
 
-#ifdef USE_BHEAD_READ_ON_DEMAND
     if (bh_orig != bh) {
       MEM_freeN(BHEADN_FROM_BHEAD(bh));
     }
@@ -3962,9 +4171,7 @@ static void direct_link_key(BlendDataReader *reader, Key *key)
 
 static void lib_link_mball(BlendLibReader *reader, MetaBall *mb)
 {
-  for (int a = 0; a < mb->totcol; a++) {
-    BLO_read_id_address(reader, mb->id.lib, &mb->mat[a]);
-  }
+  BLO_read_id_address_array(reader, mb->id.lib, mb->totcol, (ID **)mb->mat);
 
   BLO_read_id_address(reader, mb->id.lib, &mb->ipo);  // XXX deprecated - old animation system
 }
@@ -4127,9 +4334,7 @@ static void direct_link_image(BlendDataReader *reader, Image *ima)
 
 static void lib_link_curve(BlendLibReader *reader, Curve *cu)
 {
-  for (int a = 0; a < cu->totcol; a++) {
-    BLO_read_id_address(reader, cu->id.lib, &cu->mat[a]);
-  }
+  BLO_read_id_address_array(reader, cu->id.lib, cu->totcol, (ID **)cu->mat);
 
   BLO_read_id_address(reader, cu->id.lib, &cu->bevobj);
   BLO_read_id_address(reader, cu->id.lib, &cu->taperobj);
@@ -4637,9 +4842,7 @@ static void lib_link_mesh(BlendLibReader *reader, Mesh *me)
 {
   /* this check added for python created meshes */
   if (me->mat) {
-    for (int i = 0; i < me->totcol; i++) {
-      BLO_read_id_address(reader, me->id.lib, &me->mat[i]);
-    }
+    BLO_read_id_address_array(reader, me->id.lib, me->totcol, (ID **)me->mat);
   }
   else {
     me->totcol = 0;
@@ -4745,6 +4948,7 @@ static void direct_link_customdata(BlendDataReader *reader, CustomData *data, in
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -4938,7 +5142,6 @@ static void lib_link_shaderfxs(BlendLibReader *reader, Object *ob)
 static void lib_link_object(BlendLibReader *reader, Object *ob)
 {
   bool warn = false;
-  int a;
 
   // XXX deprecated - old animation system <<<
   BLO_read_id_address(reader, ob->id.lib, &ob->ipo);
@@ -5017,9 +5220,7 @@ static void lib_link_object(BlendLibReader *reader, Object *ob)
       ob->mode &= ~OB_MODE_POSE;
     }
   }
-  for (a = 0; a < ob->totcol; a++) {
-    BLO_read_id_address(reader, ob->id.lib, &ob->mat[a]);
-  }
+  BLO_read_id_address_array(reader, ob->id.lib, ob->totcol, (ID **)ob->mat);
 
   /* When the object is local and the data is library its possible
    * the material list size gets out of sync. [#22663] */
@@ -6693,9 +6894,7 @@ static void lib_link_gpencil(BlendLibReader *reader, bGPdata *gpd)
   }
 
   /* materials */
-  for (int a = 0; a < gpd->totcol; a++) {
-    BLO_read_id_address(reader, gpd->id.lib, &gpd->mat[a]);
-  }
+  BLO_read_id_address_array(reader, gpd->id.lib, gpd->totcol, (ID **)gpd->mat);
 }
 
 /* relinks grease-pencil data - used for direct_link and old file linkage */
@@ -8169,12 +8368,9 @@ static void direct_link_moviePlaneTracks(BlendDataReader *reader, ListBase *plan
   BLO_read_list(reader, plane_tracks_base);
 
   for (plane_track = plane_tracks_base->first; plane_track; plane_track = plane_track->next) {
-    int i;
-
     BLO_read_pointer_array(reader, (void **)&plane_track->point_tracks);
-    for (i = 0; i < plane_track->point_tracksnr; i++) {
-      BLO_read_data_address(reader, &plane_track->point_tracks[i]);
-    }
+    BLO_read_data_address_array(
+        reader, plane_track->point_tracksnr, (void **)plane_track->point_tracks);
 
     BLO_read_data_address(reader, &plane_track->markers);
   }
@@ -8594,9 +8790,7 @@ static void direct_link_linestyle(BlendDataReader *reader, FreestyleLineStyle *l
 
 static void lib_link_hair(BlendLibReader *reader, Hair *hair)
 {
-  for (int a = 0; a < hair->totcol; a++) {
-    BLO_read_id_address(reader, hair->id.lib, &hair->mat[a]);
-  }
+  BLO_read_id_address_array(reader, hair->id.lib, hair->totcol, (ID **)hair->mat);
 }
 
 static void direct_link_hair(BlendDataReader *reader, Hair *hair)
@@ -8621,9 +8815,8 @@ static void direct_link_hair(BlendDataReader *reader, Hair *hair)
 
 static void lib_link_pointcloud(BlendLibReader *reader, PointCloud *pointcloud)
 {
-  for (int a = 0; a < pointcloud->totcol; a++) {
-    BLO_read_id_address(reader, pointcloud->id.lib, &pointcloud->mat[a]);
-  }
+  BLO_read_id_address_array(
+      reader, pointcloud->id.lib, pointcloud->totcol, (ID **)pointcloud->mat);
 }
 
 static void direct_link_pointcloud(BlendDataReader *reader, PointCloud *pointcloud)
@@ -8652,9 +8845,7 @@ static void lib_link_volume(BlendLibReader *reader, Volume *volume)
    * lib_link... */
   BKE_volume_init_grids(volume);
 
-  for (int a = 0; a < volume->totcol; a++) {
-    BLO_read_id_address(reader, volume->id.lib, &volume->mat[a]);
-  }
+  BLO_read_id_address_array(reader, volume->id.lib, volume->totcol, (ID **)volume->mat);
 }
 
 static void direct_link_volume(BlendDataReader *reader, Volume *volume)
@@ -8982,11 +9173,114 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+#ifdef USE_BHEAD_MMAP
+
+typedef struct ReadDataThreadedData {
+  const FileData *fd;
+  BHead **bheads;
+  void **data;
+  const char *allocname;
+} ReadDataThreadedData;
+
+static void read_data_into_datamap_threaded_cb(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadDataThreadedData *data = userdata;
+  const BHead *bhead = data->bheads[i];
+  if (bhead->len) {
+    data->data[i] = read_struct_from_data(
+        data->fd, bhead, blo_bhead_data_direct(data->fd, bhead), data->allocname);
+  }
+}
+
+/**
+ * Read the data of all blocks up to the next non-data block in parallel.
+ * This is only possible when the data of every block can be accessed without reading
+ * from the file (see #blo_bhead_data_direct) and no endian switching is needed,
+ * otherwise all blocks are read one after the other as usual.
+ *
+ * Block headers are still read in order (this is cheap for memory-mapped files),
+ * the reconstructed data is added to the data-map in file order too.
+ */
+static BHead *read_data_into_datamap_threaded(FileData *fd, BHead *bhead, const char *allocname)
+{
+  BHead *bheads_static[64];
+  BHead **bheads = bheads_static;
+  int bheads_len = 0, bheads_len_alloc = ARRAY_SIZE(bheads_static);
+  size_t data_size = 0;
+  bool is_direct = true;
+
+  while (bhead && bhead->code == DATA) {
+    if (UNLIKELY(bheads_len == bheads_len_alloc)) {
+      bheads_len_alloc *= 2;
+      if (bheads == bheads_static) {
+        bheads = MEM_mallocN(sizeof(*bheads) * bheads_len_alloc, __func__);
+        memcpy(bheads, bheads_static, sizeof(bheads_static));
+      }
+      else {
+        bheads = MEM_reallocN(bheads, sizeof(*bheads) * bheads_len_alloc);
+      }
+    }
+    bheads[bheads_len++] = bhead;
+    data_size += (size_t)bhead->len;
+    if (bhead->len && blo_bhead_data_direct(fd, bhead) == NULL) {
+      is_direct = false;
+    }
+    bhead = blo_bhead_next(fd, bhead);
+  }
+
+  oldnewmap_reserve(fd->datamap, fd->datamap->nentries + bheads_len);
+
+  if (is_direct && (bheads_len > 1) && (data_size >= READ_DATA_THREADED_MIN_SIZE)) {
+    ReadDataThreadedData data = {
+        .fd = fd,
+        .bheads = bheads,
+        .data = MEM_callocN(sizeof(void *) * bheads_len, __func__),
+        .allocname = allocname,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, bheads_len, &data, read_data_into_datamap_threaded_cb, &settings);
+
+    for (int i = 0; i < bheads_len; i++) {
+      if (data.data[i]) {
+        oldnewmap_insert(fd->datamap, bheads[i]->old, data.data[i], 0);
+      }
+    }
+    MEM_freeN(data.data);
+  }
+  else {
+    for (int i = 0; i < bheads_len; i++) {
+      void *data = read_struct(fd, bheads[i], allocname);
+      if (data) {
+        oldnewmap_insert(fd->datamap, bheads[i]->old, data, 0);
+      }
+    }
+  }
+
+  if (bheads != bheads_static) {
+    MEM_freeN(bheads);
+  }
+
+  return bhead;
+}
+
+#endif /* USE_BHEAD_MMAP */
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+#ifdef USE_BHEAD_MMAP
+  if ((fd->mmap_data != NULL) && !(fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    return read_data_into_datamap_threaded(fd, bhead, allocname);
+  }
+#endif
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -9340,15 +9634,15 @@ static BHead *read_libblock(FileData *fd,
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   const char *allocname = dataname(idcode);
+  const void *id_old_address = bhead->old;
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
-     * However, it is absolutely **not** handled correctly: it is freeing an ID pointer that has
-     * been added to the fd->libmap mapping, which in theory could lead to nice crashes...
-     * This should be properly solved at some point. */
+     * The freed ID is cleared from the fd->libmap mapping, pointers to it are read as NULL. */
+    oldnewmap_lookup_entry(fd->libmap, id_old_address)->newp = NULL;
     BKE_id_free(main, id);
     if (r_id != NULL) {
       *r_id = NULL;
@@ -10143,6 +10437,18 @@ static BHead *find_bhead_from_idname(FileData *fd, const char *idname)
 static ID *is_yet_read(FileData *fd, Main *mainvar, BHead *bhead)
 {
   const char *idname = blo_bhead_id_name(fd, bhead);
+
+  /* Data-blocks already read (or linked) through this file are in its lib-map.
+   * Check it first since searching the list by name is quadratic when expanding
+   * libraries with thousands of data-blocks, only fall back to it on a miss
+   * (the data-block may have been added to `mainvar` through another file).
+   * The entry is only trusted when it was made for this ID block, the ID itself is not read
+   * since it may have been freed (see #read_libblock). */
+  const OldNew *entry = oldnewmap_lookup_entry(fd->libmap, bhead->old);
+  if (entry != NULL && entry->newp != NULL && entry->nr == bhead->code) {
+    return entry->newp;
+  }
+
   /* which_libbase can be NULL, intentionally not using idname+2 */
   return BLI_findstring(which_libbase(mainvar, GS(idname)), idname, offsetof(ID, name));
 }
@@ -12130,11 +12436,21 @@ void *BLO_read_get_new_data_address(BlendDataReader *reader, const void *old_add
   return newdataadr(reader->fd, old_address);
 }
 
+void BLO_read_data_address_array(BlendDataReader *reader, int array_size, void **ptr_array)
+{
+  oldnewmap_lookup_and_inc_array(reader->fd->datamap, ptr_array, array_size, true);
+}
+
 ID *BLO_read_get_new_id_address(BlendLibReader *reader, Library *lib, ID *id)
 {
   return newlibadr(reader->fd, lib, id);
 }
 
+void BLO_read_id_address_array(BlendLibReader *reader, Library *lib, int array_size, ID **id_array)
+{
+  oldnewmap_liblookup_array(reader->fd->libmap, (void **)id_array, array_size, lib);
+}
+
 bool BLO_read_requires_endian_switch(BlendDataReader *reader)
 {
   return (reader->fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
@@ -31,6 +31,7 @@
 #include "zlib.h"
 
 struct BLOCacheStorage;
+struct DNA_ReconstructInfo;
 struct GSet;
 struct IDNameLib_Map;
 struct Key;
@@ -84,6 +85,9 @@ typedef struct FileData {
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
+  /** Variables needed for reading from a memory-mapped file (regular file reading). */
+  const char *mmap_data;
+  size_t mmap_size;
   /** Variables needed for reading from memfile (undo). */
   struct MemFile *memfile;
   /** Whether we are undoing (< 0) or redoing (> 0), used to choose which 'unchanged' flag to use
@@ -103,6 +107,8 @@ typedef struct FileData {
   const struct SDNA *memsdna;
   /** Array of #eSDNA_StructCompare. */
   const char *compflags;
+  /** Conversion of structs from #filesdna to #memsdna, computed once per file. */
+  struct DNA_ReconstructInfo *reconstruct_info;
 
   int fileversion;
   /** Used to retrieve ID names from (bhead+1). */
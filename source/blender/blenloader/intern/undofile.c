@@ -42,6 +42,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -113,6 +114,15 @@ void BLO_memfile_clear_future(MemFile *memfile)
   }
 }
 
+/**
+ * Key of a chunk in #MemFileWriteData.chunk_hash_mapping, only chunks of the same ID are
+ * considered for sharing (see #BLO_memfile_chunk_add).
+ */
+static uint memfile_chunk_key(const MemFileChunk *chunk)
+{
+  return chunk->hash ^ (chunk->id_session_uuid * 2654435761u);
+}
+
 void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
@@ -129,8 +139,16 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   if (reference_memfile != NULL) {
     mem_data->id_session_uuid_mapping = BLI_ghash_new(
         BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+    mem_data->chunk_hash_mapping = BLI_ghash_new(
+        BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
     uint current_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
     LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      void **hash_entry;
+      if (!BLI_ghash_ensure_p(mem_data->chunk_hash_mapping,
+                              POINTER_FROM_UINT(memfile_chunk_key(mem_chunk)),
+                              &hash_entry)) {
+        *hash_entry = mem_chunk;
+      }
       if (!ELEM(mem_chunk->id_session_uuid, MAIN_ID_SESSION_UUID_UNSET, current_session_uuid)) {
         current_session_uuid = mem_chunk->id_session_uuid;
         void **entry;
@@ -152,6 +170,29 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->chunk_hash_mapping != NULL) {
+    BLI_ghash_free(mem_data->chunk_hash_mapping, NULL, NULL);
+  }
+}
+
+/**
+ * A reference chunk can be shared when it's identical and not already shared by another chunk
+ * of the memfile being written (#MemFileChunk.is_identical_future is cleared before writing).
+ */
+static bool memfile_chunk_is_shareable(const MemFileChunk *compchunk,
+                                       const MemFileChunk *curchunk,
+                                       const char *buf)
+{
+  return (compchunk->is_identical_future == false) && (compchunk->size == curchunk->size) &&
+         (memcmp(compchunk->buf, buf, curchunk->size) == 0);
+}
+
+static void memfile_chunk_share(MemFileChunk *curchunk, MemFileChunk *compchunk)
+{
+  curchunk->buf = compchunk->buf;
+  curchunk->hash = compchunk->hash;
+  curchunk->is_identical = true;
+  compchunk->is_identical_future = true;
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint size)
@@ -168,21 +209,32 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->hash = 0;
   BLI_addtail(&memfile->chunks, curchunk);
 
   /* we compare compchunk with buf */
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
-    if (compchunk->size == curchunk->size) {
-      if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
-        curchunk->is_identical = true;
-        compchunk->is_identical_future = true;
-      }
+    if (memfile_chunk_is_shareable(compchunk, curchunk, buf)) {
+      memfile_chunk_share(curchunk, compchunk);
     }
     *compchunk_step = compchunk->next;
   }
 
+  /* Not equal to the chunk at the same position, data of this ID may have moved
+   * (e.g. when other data was inserted before it), look for identical content. */
+  if (curchunk->buf == NULL) {
+    curchunk->hash = BLI_hash_mm2((const uchar *)buf, size, 0);
+    if (mem_data->chunk_hash_mapping != NULL) {
+      MemFileChunk *compchunk = BLI_ghash_lookup(mem_data->chunk_hash_mapping,
+                                                 POINTER_FROM_UINT(memfile_chunk_key(curchunk)));
+      if ((compchunk != NULL) && (compchunk->id_session_uuid == curchunk->id_session_uuid) &&
+          memfile_chunk_is_shareable(compchunk, curchunk, buf)) {
+        memfile_chunk_share(curchunk, compchunk);
+      }
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
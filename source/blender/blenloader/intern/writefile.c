@@ -149,6 +149,8 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"  // MEM_freeN
 
 #include "BKE_action.h"
@@ -223,7 +225,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct ZLibWriteData *zlib_data;
   } _user_data;
 };
 
@@ -254,30 +256,198 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib
+ *
+ * Compression runs on worker threads: the data is split into chunks of #ZLIB_CHUNK_SIZE which
+ * are compressed independently, each one as a complete gzip member. A sequence of gzip members
+ * is a valid gzip file, `gzread()` (used for reading) decompresses them transparently.
+ *
+ * Chunks are compressed in batches, while one batch is being compressed the next batch is
+ * filled by the writer, so serializing data-blocks and compressing them overlap.
+ * Batches have their own task pool so they can be waited for separately. */
+
+#define ZLIB_CHUNK_SIZE (1 << 20) /* 1mb */
+#define ZLIB_LEVEL 1
+
+typedef struct ZLibChunk {
+  /** Uncompressed data (#ZLIB_CHUNK_SIZE). */
+  uchar *in;
+  size_t in_len;
+  /** Compressed data (a complete gzip member). */
+  uchar *out;
+  size_t out_len;
+  bool error;
+} ZLibChunk;
 
-static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+typedef struct ZLibBatch {
+  TaskPool *task_pool;
+  ZLibChunk *chunks;
+  /** Number of chunks pushed to #ZLibBatch.task_pool. */
+  int chunks_len;
+} ZLibBatch;
+
+typedef struct ZLibWriteData {
+  int file_handle;
+  bool error;
+  /** The batch being filled is `batches[batch_active]`, the other one may be compressing. */
+  ZLibBatch batches[2];
+  int batch_active;
+  int batch_chunks_num;
+} ZLibWriteData;
+
+#define FILE_HANDLE(ww) (ww)->_user_data.zlib_data
+
+static void ww_zlib_chunk_compress_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
 {
-  gzFile file;
+  ZLibChunk *chunk = taskdata;
+  z_stream strm = {NULL};
 
-  file = BLI_gzopen(filepath, "wb1");
+  /* Window bits of 16 + #MAX_WBITS writes a gzip header & trailer. */
+  if (deflateInit2(&strm, ZLIB_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    chunk->error = true;
+    return;
+  }
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
-    return true;
+  const size_t out_len_max = deflateBound(&strm, chunk->in_len);
+  chunk->out = MEM_mallocN(out_len_max, __func__);
+
+  strm.next_in = chunk->in;
+  strm.avail_in = chunk->in_len;
+  strm.next_out = chunk->out;
+  strm.avail_out = out_len_max;
+
+  if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+    chunk->out_len = strm.total_out;
   }
   else {
+    chunk->error = true;
+  }
+  deflateEnd(&strm);
+}
+
+/** Wait for all chunks of the batch to be compressed, then write them in order. */
+static void ww_zlib_batch_finish(ZLibWriteData *zd, ZLibBatch *batch)
+{
+  if (batch->chunks_len == 0) {
+    return;
+  }
+
+  BLI_task_pool_work_and_wait(batch->task_pool);
+
+  for (int i = 0; i < batch->chunks_len; i++) {
+    ZLibChunk *chunk = &batch->chunks[i];
+    if (chunk->error) {
+      zd->error = true;
+    }
+    else if (!zd->error) {
+      if ((size_t)write(zd->file_handle, chunk->out, chunk->out_len) != chunk->out_len) {
+        zd->error = true;
+      }
+    }
+    MEM_SAFE_FREE(chunk->out);
+    chunk->out_len = 0;
+    chunk->in_len = 0;
+    chunk->error = false;
+  }
+  batch->chunks_len = 0;
+}
+
+static void ww_zlib_chunk_push(ZLibWriteData *zd)
+{
+  ZLibBatch *batch = &zd->batches[zd->batch_active];
+  ZLibChunk *chunk = &batch->chunks[batch->chunks_len];
+  if (chunk->in_len == 0) {
+    return;
+  }
+
+  BLI_task_pool_push(batch->task_pool, ww_zlib_chunk_compress_task, chunk, false, NULL);
+  batch->chunks_len += 1;
+
+  if (batch->chunks_len == zd->batch_chunks_num) {
+    /* Write the previous batch, then start filling it again. */
+    zd->batch_active ^= 1;
+    ww_zlib_batch_finish(zd, &zd->batches[zd->batch_active]);
+  }
+}
+
+static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+{
+  int file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file == -1) {
     return false;
   }
+
+  ZLibWriteData *zd = MEM_callocN(sizeof(*zd), __func__);
+  zd->file_handle = file;
+  /* One chunk per thread, the chunk input buffers are allocated on first use. */
+  zd->batch_chunks_num = BLI_system_thread_count();
+
+  for (int i = 0; i < ARRAY_SIZE(zd->batches); i++) {
+    ZLibBatch *batch = &zd->batches[i];
+    batch->task_pool = BLI_task_pool_create(zd, TASK_PRIORITY_HIGH);
+    batch->chunks = MEM_callocN(sizeof(*batch->chunks) * zd->batch_chunks_num, __func__);
+  }
+
+  FILE_HANDLE(ww) = zd;
+  return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  ZLibWriteData *zd = FILE_HANDLE(ww);
+
+  /* Push the partially filled chunk, then write the oldest batch first. */
+  const int batch_active = zd->batch_active;
+  ww_zlib_chunk_push(zd);
+  if (batch_active == zd->batch_active) {
+    ww_zlib_batch_finish(zd, &zd->batches[batch_active ^ 1]);
+    ww_zlib_batch_finish(zd, &zd->batches[batch_active]);
+  }
+  else {
+    /* Pushing filled the batch, which swapped & wrote the previous one. */
+    ww_zlib_batch_finish(zd, &zd->batches[batch_active]);
+  }
+
+  for (int i = 0; i < ARRAY_SIZE(zd->batches); i++) {
+    ZLibBatch *batch = &zd->batches[i];
+    BLI_task_pool_free(batch->task_pool);
+    for (int j = 0; j < zd->batch_chunks_num; j++) {
+      MEM_SAFE_FREE(batch->chunks[j].in);
+    }
+    MEM_freeN(batch->chunks);
+  }
+
+  bool ok = !zd->error;
+  if (close(zd->file_handle) == -1) {
+    ok = false;
+  }
+  MEM_freeN(zd);
+  return ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  ZLibWriteData *zd = FILE_HANDLE(ww);
+  size_t buf_remain = buf_len;
+
+  while (buf_remain != 0) {
+    ZLibBatch *batch = &zd->batches[zd->batch_active];
+    ZLibChunk *chunk = &batch->chunks[batch->chunks_len];
+    if (chunk->in == NULL) {
+      chunk->in = MEM_mallocN(ZLIB_CHUNK_SIZE, __func__);
+    }
+    const size_t len = MIN2(buf_remain, ZLIB_CHUNK_SIZE - chunk->in_len);
+    memcpy(chunk->in + chunk->in_len, buf, len);
+    chunk->in_len += len;
+    buf += len;
+    buf_remain -= len;
+
+    if (chunk->in_len == ZLIB_CHUNK_SIZE) {
+      ww_zlib_chunk_push(zd);
+    }
+  }
+
+  return zd->error ? 0 : buf_len;
 }
 #undef FILE_HANDLE
 
@@ -292,6 +462,7 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->open = ww_open_zlib;
       r_ww->close = ww_close_zlib;
       r_ww->write = ww_write_zlib;
+      /* Already buffered per chunk. */
       r_ww->use_buf = false;
       break;
     }
@@ -820,7 +820,7 @@ static void bm_kill_only_face(BMesh *bm, BMFace *f)
  * low level function, only frees the loop,
  * doesn't change or adjust surrounding geometry
  */
-static void bm_kill_only_loop(BMesh *bm, BMLoop *l)
+static void bm_kill_only_loop_data(BMesh *bm, BMLoop *l)
 {
   bm->totloop--;
   bm->elem_index_dirty |= BM_LOOP;
@@ -829,7 +829,11 @@ static void bm_kill_only_loop(BMesh *bm, BMLoop *l)
   if (l->head.data) {
     CustomData_bmesh_free_block(&bm->ldata, &l->head.data);
   }
+}
 
+static void bm_kill_only_loop(BMesh *bm, BMLoop *l)
+{
+  bm_kill_only_loop_data(bm, l);
   BLI_mempool_free(bm->lpool, l);
 }
 
@@ -906,14 +910,25 @@ void BM_face_kill(BMesh *bm, BMFace *f)
     l_iter = l_first = f->l_first;
 #endif
 
+    /* Return the loops to the pool in batches. */
+    BMLoop *loops_kill[BM_DEFAULT_NGON_STACK_SIZE];
+    uint loops_kill_len = 0;
+
     do {
       l_next = l_iter->next;
 
       bmesh_radial_loop_remove(l_iter->e, l_iter);
-      bm_kill_only_loop(bm, l_iter);
+      bm_kill_only_loop_data(bm, l_iter);
 
+      if (loops_kill_len == ARRAY_SIZE(loops_kill)) {
+        BLI_mempool_free_multi(bm->lpool, (void **)loops_kill, loops_kill_len);
+        loops_kill_len = 0;
+      }
+      loops_kill[loops_kill_len++] = l_iter;
     } while ((l_iter = l_next) != l_first);
 
+    BLI_mempool_free_multi(bm->lpool, (void **)loops_kill, loops_kill_len);
+
 #ifdef USE_BMESH_HOLES
     BLI_mempool_free(bm->looplistpool, ls);
 #endif
@@ -2768,21 +2768,39 @@ void BM_mesh_rebuild(BMesh *bm,
                                             NULL;
 
   const bool use_toolflags = params->use_toolflags;
+  /* Keep existing tool-flags when only repacking the elements. */
+  const bool keep_toolflags = use_toolflags && bm->use_toolflags;
+
+  /* Allocate all destination elements up front, in order, filling the tables directly. */
+  if (remap & BM_VERT) {
+    BLI_mempool_alloc_multi(vpool_dst, (void **)vtable_dst, (uint)bm->totvert);
+  }
+  if (remap & BM_EDGE) {
+    BLI_mempool_alloc_multi(epool_dst, (void **)etable_dst, (uint)bm->totedge);
+  }
+  if (remap & BM_LOOP) {
+    BLI_mempool_alloc_multi(lpool_dst, (void **)ltable_dst, (uint)bm->totloop);
+  }
+  if (remap & BM_FACE) {
+    BLI_mempool_alloc_multi(fpool_dst, (void **)ftable_dst, (uint)bm->totface);
+  }
 
   if (remap & BM_VERT) {
     BMIter iter;
     int index;
     BMVert *v_src;
     BM_ITER_MESH_INDEX (v_src, &iter, bm, BM_VERTS_OF_MESH, index) {
-      BMVert *v_dst = BLI_mempool_alloc(vpool_dst);
+      BMVert *v_dst = vtable_dst[index];
       memcpy(v_dst, v_src, sizeof(BMVert));
-      if (use_toolflags) {
+      if (keep_toolflags) {
+        ((BMVert_OFlag *)v_dst)->oflags = ((BMVert_OFlag *)v_src)->oflags;
+      }
+      else if (use_toolflags) {
         ((BMVert_OFlag *)v_dst)->oflags = bm->vtoolflagpool ?
                                               BLI_mempool_calloc(bm->vtoolflagpool) :
                                               NULL;
       }
 
-      vtable_dst[index] = v_dst;
       BM_elem_index_set(v_src, index); /* set_ok */
     }
   }
@@ -2792,15 +2810,17 @@ void BM_mesh_rebuild(BMesh *bm,
     int index;
     BMEdge *e_src;
     BM_ITER_MESH_INDEX (e_src, &iter, bm, BM_EDGES_OF_MESH, index) {
-      BMEdge *e_dst = BLI_mempool_alloc(epool_dst);
+      BMEdge *e_dst = etable_dst[index];
       memcpy(e_dst, e_src, sizeof(BMEdge));
-      if (use_toolflags) {
+      if (keep_toolflags) {
+        ((BMEdge_OFlag *)e_dst)->oflags = ((BMEdge_OFlag *)e_src)->oflags;
+      }
+      else if (use_toolflags) {
         ((BMEdge_OFlag *)e_dst)->oflags = bm->etoolflagpool ?
                                               BLI_mempool_calloc(bm->etoolflagpool) :
                                               NULL;
       }
 
-      etable_dst[index] = e_dst;
       BM_elem_index_set(e_src, index); /* set_ok */
     }
   }
@@ -2812,15 +2832,17 @@ void BM_mesh_rebuild(BMesh *bm,
     BM_ITER_MESH_INDEX (f_src, &iter, bm, BM_FACES_OF_MESH, index) {
 
       if (remap & BM_FACE) {
-        BMFace *f_dst = BLI_mempool_alloc(fpool_dst);
+        BMFace *f_dst = ftable_dst[index];
         memcpy(f_dst, f_src, sizeof(BMFace));
-        if (use_toolflags) {
+        if (keep_toolflags) {
+          ((BMFace_OFlag *)f_dst)->oflags = ((BMFace_OFlag *)f_src)->oflags;
+        }
+        else if (use_toolflags) {
           ((BMFace_OFlag *)f_dst)->oflags = bm->ftoolflagpool ?
                                                 BLI_mempool_calloc(bm->ftoolflagpool) :
                                                 NULL;
         }
 
-        ftable_dst[index] = f_dst;
         BM_elem_index_set(f_src, index); /* set_ok */
       }
 
@@ -2829,9 +2851,8 @@ void BM_mesh_rebuild(BMesh *bm,
         BMLoop *l_iter_src, *l_first_src;
         l_iter_src = l_first_src = BM_FACE_FIRST_LOOP((BMFace *)f_src);
         do {
-          BMLoop *l_dst = BLI_mempool_alloc(lpool_dst);
+          BMLoop *l_dst = ltable_dst[index_loop];
           memcpy(l_dst, l_iter_src, sizeof(BMLoop));
-          ltable_dst[index_loop] = l_dst;
           BM_elem_index_set(l_iter_src, index_loop++); /* set_ok */
         } while ((l_iter_src = l_iter_src->next) != l_first_src);
       }
@@ -3038,6 +3059,40 @@ void BM_mesh_toolflags_set(BMesh *bm, bool use_toolflags)
   bm->use_toolflags = use_toolflags;
 }
 
+/**
+ * Re-allocates all elements in iteration order, so they use as few memory chunks as possible
+ * and the loops of every face are next to each other in memory.
+ * Useful after heavy topology edits, which leave the memory pools fragmented.
+ *
+ * \warning Pointers to elements and element tables kept outside of the mesh are invalidated.
+ */
+void BM_mesh_compact(BMesh *bm)
+{
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_BM(bm);
+
+  BLI_mempool *vpool_dst = NULL;
+  BLI_mempool *epool_dst = NULL;
+  BLI_mempool *lpool_dst = NULL;
+  BLI_mempool *fpool_dst = NULL;
+
+  bm_mempool_init_ex(
+      &allocsize, bm->use_toolflags, &vpool_dst, &epool_dst, &lpool_dst, &fpool_dst);
+
+  BM_mesh_rebuild(bm,
+                  &((struct BMeshCreateParams){
+                      .use_toolflags = bm->use_toolflags,
+                  }),
+                  vpool_dst,
+                  epool_dst,
+                  lpool_dst,
+                  fpool_dst);
+
+  /* The copied elements still have their old indices and the loop normal spaces reference the
+   * old loops. */
+  bm->elem_index_dirty |= BM_ALL;
+  bm->spacearr_dirty |= BM_SPACEARR_DIRTY_ALL;
+}
+
 /* -------------------------------------------------------------------- */
 /** \name BMesh Coordinate Access
  * \{ */
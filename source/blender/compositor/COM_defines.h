@@ -68,8 +68,8 @@ typedef enum CompositorPriority {
 
 // workscheduler threading models
 /**
- * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
- * This is the default option.
+ * COM_TM_QUEUE is a multi-threaded model, CPU work is executed by a BLI_task pool, OpenCL work
+ * uses the BLI_thread_queue pattern. This is the default option.
  */
 #define COM_TM_QUEUE 1
 
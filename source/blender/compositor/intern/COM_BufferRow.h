@@ -0,0 +1,327 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_BUFFERROW_H__
+#define __COM_BUFFERROW_H__
+
+#include "COM_MemoryBuffer.h"
+
+#include <math.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/** \name Row vectors
+ *
+ * Row kernels calculate 4 floats at once: the 4 channels of a color element, or 4 adjacent
+ * elements of a value row. When SSE2 is available the floats are held in a single register.
+ *
+ * Every operation is done per lane, in the same order as the scalar code of the operations,
+ * so the results are identical to calculating each lane on its own. Kernels are written as
+ * templates that are instantiated for float and for RowVector, scalar and vectorized code
+ * then share the same source. Branches are written with row_select, which evaluates both
+ * sides.
+ * \{ */
+
+/**
+ * \brief result of comparing the lanes of two RowVector's
+ * \ingroup Execution
+ */
+class RowMask {
+ public:
+#ifdef __SSE2__
+  __m128 m_mask;
+
+  explicit RowMask(__m128 mask) : m_mask(mask)
+  {
+  }
+#else
+  bool m_mask[4];
+#endif
+
+  RowMask()
+  {
+  }
+
+  /**
+   * \brief mask selecting the alpha lane of a color
+   */
+  static RowMask alpha()
+  {
+#ifdef __SSE2__
+    return RowMask(_mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0)));
+#else
+    RowMask mask;
+    mask.m_mask[0] = mask.m_mask[1] = mask.m_mask[2] = false;
+    mask.m_mask[3] = true;
+    return mask;
+#endif
+  }
+};
+
+/**
+ * \brief 4 floats calculated at once
+ * \ingroup Execution
+ */
+class RowVector {
+ public:
+#ifdef __SSE2__
+  __m128 m_value;
+
+  explicit RowVector(__m128 value) : m_value(value)
+  {
+  }
+#else
+  float m_value[4];
+#endif
+
+  RowVector()
+  {
+  }
+
+  /**
+   * \brief all lanes set to the same value
+   */
+  RowVector(float value)
+  {
+#ifdef __SSE2__
+    m_value = _mm_set1_ps(value);
+#else
+    m_value[0] = m_value[1] = m_value[2] = m_value[3] = value;
+#endif
+  }
+
+  /**
+   * \brief load 4 floats, there is no alignment requirement
+   */
+  static RowVector load(const float *values)
+  {
+#ifdef __SSE2__
+    return RowVector(_mm_loadu_ps(values));
+#else
+    RowVector result;
+    for (int i = 0; i < 4; i++) {
+      result.m_value[i] = values[i];
+    }
+    return result;
+#endif
+  }
+
+  void store(float *values) const
+  {
+#ifdef __SSE2__
+    _mm_storeu_ps(values, m_value);
+#else
+    for (int i = 0; i < 4; i++) {
+      values[i] = m_value[i];
+    }
+#endif
+  }
+};
+
+#ifdef __SSE2__
+#  define ROW_VECTOR_OPERATOR(op, intrinsic) \
+    inline RowVector operator op(const RowVector &a, const RowVector &b) \
+    { \
+      return RowVector(intrinsic(a.m_value, b.m_value)); \
+    }
+#  define ROW_MASK_OPERATOR(op, intrinsic) \
+    inline RowMask operator op(const RowVector &a, const RowVector &b) \
+    { \
+      return RowMask(intrinsic(a.m_value, b.m_value)); \
+    }
+#else
+#  define ROW_VECTOR_OPERATOR(op, intrinsic) \
+    inline RowVector operator op(const RowVector &a, const RowVector &b) \
+    { \
+      RowVector result; \
+      for (int i = 0; i < 4; i++) { \
+        result.m_value[i] = a.m_value[i] op b.m_value[i]; \
+      } \
+      return result; \
+    }
+#  define ROW_MASK_OPERATOR(op, intrinsic) \
+    inline RowMask operator op(const RowVector &a, const RowVector &b) \
+    { \
+      RowMask result; \
+      for (int i = 0; i < 4; i++) { \
+        result.m_mask[i] = a.m_value[i] op b.m_value[i]; \
+      } \
+      return result; \
+    }
+#endif
+
+ROW_VECTOR_OPERATOR(+, _mm_add_ps)
+ROW_VECTOR_OPERATOR(-, _mm_sub_ps)
+ROW_VECTOR_OPERATOR(*, _mm_mul_ps)
+ROW_VECTOR_OPERATOR(/, _mm_div_ps)
+
+ROW_MASK_OPERATOR(<, _mm_cmplt_ps)
+ROW_MASK_OPERATOR(<=, _mm_cmple_ps)
+ROW_MASK_OPERATOR(>, _mm_cmpgt_ps)
+ROW_MASK_OPERATOR(>=, _mm_cmpge_ps)
+ROW_MASK_OPERATOR(==, _mm_cmpeq_ps)
+ROW_MASK_OPERATOR(!=, _mm_cmpneq_ps)
+
+#undef ROW_VECTOR_OPERATOR
+#undef ROW_MASK_OPERATOR
+
+inline RowVector operator-(const RowVector &a)
+{
+#ifdef __SSE2__
+  return RowVector(_mm_xor_ps(a.m_value, _mm_set1_ps(-0.0f)));
+#else
+  RowVector result;
+  for (int i = 0; i < 4; i++) {
+    result.m_value[i] = -a.m_value[i];
+  }
+  return result;
+#endif
+}
+
+inline RowMask operator&(const RowMask &a, const RowMask &b)
+{
+#ifdef __SSE2__
+  return RowMask(_mm_and_ps(a.m_mask, b.m_mask));
+#else
+  RowMask result;
+  for (int i = 0; i < 4; i++) {
+    result.m_mask[i] = a.m_mask[i] && b.m_mask[i];
+  }
+  return result;
+#endif
+}
+
+inline RowMask operator|(const RowMask &a, const RowMask &b)
+{
+#ifdef __SSE2__
+  return RowMask(_mm_or_ps(a.m_mask, b.m_mask));
+#else
+  RowMask result;
+  for (int i = 0; i < 4; i++) {
+    result.m_mask[i] = a.m_mask[i] || b.m_mask[i];
+  }
+  return result;
+#endif
+}
+
+/**
+ * \brief lanes of a where the mask is set, lanes of b otherwise
+ */
+inline RowVector row_select(const RowMask &mask, const RowVector &a, const RowVector &b)
+{
+#ifdef __SSE2__
+  return RowVector(
+      _mm_or_ps(_mm_and_ps(mask.m_mask, a.m_value), _mm_andnot_ps(mask.m_mask, b.m_value)));
+#else
+  RowVector result;
+  for (int i = 0; i < 4; i++) {
+    result.m_value[i] = mask.m_mask[i] ? a.m_value[i] : b.m_value[i];
+  }
+  return result;
+#endif
+}
+
+inline float row_select(bool mask, float a, float b)
+{
+  return mask ? a : b;
+}
+
+inline RowVector row_abs(const RowVector &a)
+{
+#ifdef __SSE2__
+  return RowVector(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.m_value));
+#else
+  RowVector result;
+  for (int i = 0; i < 4; i++) {
+    result.m_value[i] = fabsf(a.m_value[i]);
+  }
+  return result;
+#endif
+}
+
+inline float row_abs(float a)
+{
+  return fabsf(a);
+}
+
+inline RowVector row_sqrt(const RowVector &a)
+{
+#ifdef __SSE2__
+  return RowVector(_mm_sqrt_ps(a.m_value));
+#else
+  RowVector result;
+  for (int i = 0; i < 4; i++) {
+    result.m_value[i] = sqrtf(a.m_value[i]);
+  }
+  return result;
+#endif
+}
+
+inline float row_sqrt(float a)
+{
+  return sqrtf(a);
+}
+
+/**
+ * \brief clamp to [0, 1] the way CLAMP does
+ */
+template<typename T> inline T row_clamp(const T &a)
+{
+  const T result = row_select(a < 0.0f, T(0.0f), a);
+  return row_select(result > 1.0f, T(1.0f), result);
+}
+
+/** \} */
+
+/**
+ * \brief the elements of a row of a MemoryBuffer, starting at a position.
+ * Buffers storing a single element return that element for every index.
+ * \ingroup Execution
+ */
+class BufferRow {
+ private:
+  float *m_elem;
+  int m_elem_stride;
+
+ public:
+  BufferRow(MemoryBuffer *buffer, int x, int y)
+      : m_elem(buffer->getElem(x, y)), m_elem_stride(buffer->getElemStride())
+  {
+  }
+
+  inline float *elem(int index) const
+  {
+    return m_elem + index * m_elem_stride;
+  }
+
+  /**
+   * \brief the values of 4 adjacent elements, starting at an index
+   * \note only for buffers storing values, see MemoryBuffer.getElemStride
+   */
+  inline RowVector loadValues(int index) const
+  {
+    if (m_elem_stride == 0) {
+      return RowVector(m_elem[0]);
+    }
+    return RowVector::load(m_elem + index);
+  }
+};
+
+#endif /* __COM_BUFFERROW_H__ */
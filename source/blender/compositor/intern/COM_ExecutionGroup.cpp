@@ -21,8 +21,6 @@
 #include <sstream>
 #include <stdlib.h>
 
-#include "atomic_ops.h"
-
 #include "COM_ChunkOrder.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
@@ -59,6 +57,14 @@ ExecutionGroup::ExecutionGroup()
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  BLI_mutex_init(&this->m_chunksFinishedMutex);
+  BLI_condition_init(&this->m_chunksFinishedCondition);
+}
+
+ExecutionGroup::~ExecutionGroup()
+{
+  BLI_condition_end(&this->m_chunksFinishedCondition);
+  BLI_mutex_end(&this->m_chunksFinishedMutex);
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -150,6 +156,24 @@ void ExecutionGroup::initExecution()
   this->m_cachedMaxReadBufferOffset = maxNumber;
 }
 
+bool ExecutionGroup::isExecuted() const
+{
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return false;
+    }
+  }
+  return this->m_numberOfChunks != 0;
+}
+
+void ExecutionGroup::setExecuted()
+{
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+  }
+  this->m_chunksFinished = this->m_numberOfChunks;
+}
+
 void ExecutionGroup::deinitExecution()
 {
   if (this->m_chunkExecutionStates != NULL) {
@@ -188,29 +212,9 @@ void ExecutionGroup::determineNumberOfChunks()
   }
 }
 
-/**
- * this method is called for the top execution groups. containing the compositor node or the
- * preview node or the viewer node)
- */
-void ExecutionGroup::execute(ExecutionSystem *graph)
+unsigned int *ExecutionGroup::determineChunkOrder() const
 {
-  const CompositorContext &context = graph->getContext();
-  const bNodeTree *bTree = context.getbNodeTree();
-  if (this->m_width == 0 || this->m_height == 0) {
-    return;
-  }  /// \note Break out... no pixels to calculate.
-  if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-    return;
-  }  /// \note Early break out for blur and preview nodes.
-  if (this->m_numberOfChunks == 0) {
-    return;
-  }  /// \note Early break out.
   unsigned int chunkNumber;
-
-  this->m_executionStartTime = PIL_check_seconds_timer();
-
-  this->m_chunksFinished = 0;
-  this->m_bTree = bTree;
   unsigned int index;
   unsigned int *chunkOrder = (unsigned int *)MEM_mallocN(
       sizeof(unsigned int) * this->m_numberOfChunks, __func__);
@@ -319,6 +323,35 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       break;
   }
 
+  return chunkOrder;
+}
+
+/**
+ * this method is called for the top execution groups. containing the compositor node or the
+ * preview node or the viewer node)
+ */
+void ExecutionGroup::execute(ExecutionSystem *graph)
+{
+  const CompositorContext &context = graph->getContext();
+  const bNodeTree *bTree = context.getbNodeTree();
+  if (this->m_width == 0 || this->m_height == 0) {
+    return;
+  }  /// \note Break out... no pixels to calculate.
+  if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+    return;
+  }  /// \note Early break out for blur and preview nodes.
+  if (this->m_numberOfChunks == 0) {
+    return;
+  }  /// \note Early break out.
+  unsigned int chunkNumber;
+
+  this->m_executionStartTime = PIL_check_seconds_timer();
+
+  this->m_chunksFinished = 0;
+  this->m_bTree = bTree;
+  unsigned int index;
+  unsigned int *chunkOrder = determineChunkOrder();
+
   DebugInfo::execution_group_started(this);
   DebugInfo::graphviz(graph);
 
@@ -340,7 +373,9 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
       int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
       const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
       if (state == COM_ES_NOT_SCHEDULED) {
-        scheduleChunkWhenPossible(graph, xChunk, yChunk);
+        /* the chunks this chunk depends on are scheduled with the same priority, so they are
+         * executed before the chunks further away from the hotspots */
+        scheduleChunkWhenPossible(graph, xChunk, yChunk, index);
         finished = false;
         startEvaluated = true;
         numberEvaluated++;
@@ -371,6 +406,49 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   MEM_freeN(chunkOrder);
 }
 
+void ExecutionGroup::executeFullFrame(ExecutionSystem *graph)
+{
+  const CompositorContext &context = graph->getContext();
+  const bNodeTree *bTree = context.getbNodeTree();
+  if (this->m_width == 0 || this->m_height == 0) {
+    return;
+  }
+  if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+    return;
+  }
+  if (this->m_numberOfChunks == 0) {
+    return;
+  }
+
+  this->m_executionStartTime = PIL_check_seconds_timer();
+
+  this->m_chunksFinished = 0;
+  this->m_bTree = bTree;
+  unsigned int *chunkOrder = determineChunkOrder();
+
+  DebugInfo::execution_group_started(this);
+
+  /* all input groups are already executed, so every chunk can be scheduled at once */
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    scheduleChunk(chunkOrder[index], index);
+  }
+  WorkScheduler::finish();
+  /* CPU chunks are executed when finishing returns, OpenCL chunks are only picked up from the
+   * queue by their device at that point */
+  BLI_mutex_lock(&this->m_chunksFinishedMutex);
+  while (this->m_chunksFinished < this->m_numberOfChunks) {
+    BLI_condition_wait(&this->m_chunksFinishedCondition, &this->m_chunksFinishedMutex);
+  }
+  BLI_mutex_unlock(&this->m_chunksFinishedMutex);
+
+  if (bTree->update_draw) {
+    bTree->update_draw(bTree->udh);
+  }
+  DebugInfo::execution_group_finished(this);
+
+  MEM_freeN(chunkOrder);
+}
+
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
 {
   rcti rect;
@@ -409,7 +487,10 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_EXECUTED;
   }
 
-  atomic_add_and_fetch_u(&this->m_chunksFinished, 1);
+  BLI_mutex_lock(&this->m_chunksFinishedMutex);
+  this->m_chunksFinished++;
+  BLI_condition_notify_all(&this->m_chunksFinishedCondition);
+  BLI_mutex_unlock(&this->m_chunksFinishedMutex);
   if (memoryBuffers) {
     for (unsigned int index = 0; index < this->m_cachedMaxReadBufferOffset; index++) {
       MemoryBuffer *buffer = memoryBuffers[index];
@@ -481,10 +562,12 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/, rcti *re
   return NULL;
 }
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph,
+                                              rcti *area,
+                                              unsigned int priority)
 {
   if (this->m_singleThreaded) {
-    return scheduleChunkWhenPossible(graph, 0, 0);
+    return scheduleChunkWhenPossible(graph, 0, 0, priority);
   }
   // find all chunks inside the rect
   // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -506,7 +589,7 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   bool result = true;
   for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
     for (indexy = minychunk; indexy < maxychunk; indexy++) {
-      if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
+      if (!scheduleChunkWhenPossible(graph, indexx, indexy, priority)) {
         result = false;
       }
     }
@@ -515,17 +598,20 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   return result;
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber, unsigned int priority)
 {
   if (this->m_chunkExecutionStates[chunkNumber] == COM_ES_NOT_SCHEDULED) {
     this->m_chunkExecutionStates[chunkNumber] = COM_ES_SCHEDULED;
-    WorkScheduler::schedule(this, chunkNumber);
+    WorkScheduler::schedule(this, chunkNumber, priority);
     return true;
   }
   return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk)
+bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                               int xChunk,
+                                               int yChunk,
+                                               unsigned int priority)
 {
   if (xChunk < 0 || xChunk >= (int)this->m_numberOfXChunks) {
     return true;
@@ -563,7 +649,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
     ExecutionGroup *group = memoryProxy->getExecutor();
 
     if (group != NULL) {
-      if (!group->scheduleAreaWhenPossible(graph, &area)) {
+      if (!group->scheduleAreaWhenPossible(graph, &area, priority)) {
         canBeExecuted = false;
       }
     }
@@ -573,7 +659,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
   }
 
   if (canBeExecuted) {
-    scheduleChunk(chunkNumber);
+    scheduleChunk(chunkNumber, priority);
   }
 
   return false;
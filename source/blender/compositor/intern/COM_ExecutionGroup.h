@@ -24,6 +24,7 @@
 #endif
 
 #include "BLI_rect.h"
+#include "BLI_threads.h"
 #include "COM_CompositorContext.h"
 #include "COM_Device.h"
 #include "COM_MemoryProxy.h"
@@ -151,6 +152,13 @@ class ExecutionGroup {
    */
   unsigned int m_chunksFinished;
 
+  /**
+   * \brief lock and condition to wait for the scheduled chunks to finish,
+   * see executeFullFrame
+   */
+  ThreadMutex m_chunksFinishedMutex;
+  ThreadCondition m_chunksFinishedCondition;
+
   /**
    * \brief the chunkExecutionStates holds per chunk the execution state. this state can be
    *   - COM_ES_NOT_SCHEDULED: not scheduled
@@ -210,6 +218,13 @@ class ExecutionGroup {
    */
   void determineNumberOfChunks();
 
+  /**
+   * \brief determine the order in which the chunks are scheduled,
+   * based on the chunk order of the ViewerOperation.
+   * \return array of chunk numbers, to be freed by the caller with MEM_freeN
+   */
+  unsigned int *determineChunkOrder() const;
+
   /**
    * \brief try to schedule a specific chunk.
    * \note scheduling succeeds when all input requirements are met and the chunks hasn't been
@@ -217,11 +232,15 @@ class ExecutionGroup {
    * \param graph:
    * \param xChunk:
    * \param yChunk:
+   * \param priority: the priority of the chunk, see WorkScheduler.schedule
    * \return [true:false]
    * true: package(s) are scheduled
    * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
+  bool scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                 int xChunk,
+                                 int yChunk,
+                                 unsigned int priority);
 
   /**
    * \brief try to schedule a specific area.
@@ -229,17 +248,19 @@ class ExecutionGroup {
    * \note This method is called from other ExecutionGroup's.
    * \param graph:
    * \param rect:
+   * \param priority: the priority of the chunks, see WorkScheduler.schedule
    * \return [true:false]
    * true: package(s) are scheduled
    * false: scheduling is deferred (depending workpackages are scheduled)
    */
-  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect);
+  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *rect, unsigned int priority);
 
   /**
    * \brief add a chunk to the WorkScheduler.
    * \param chunknumber:
+   * \param priority: see WorkScheduler.schedule
    */
-  bool scheduleChunk(unsigned int chunkNumber);
+  bool scheduleChunk(unsigned int chunkNumber, unsigned int priority);
 
   /**
    * \brief determine the area of interest of a certain input area
@@ -255,6 +276,7 @@ class ExecutionGroup {
  public:
   // constructors
   ExecutionGroup();
+  ~ExecutionGroup();
 
   // methods
   /**
@@ -333,6 +355,14 @@ class ExecutionGroup {
    */
   NodeOperation *getOutputOperation() const;
 
+  /**
+   * \brief get all operations of this ExecutionGroup
+   */
+  const Operations &getOperations() const
+  {
+    return this->m_operations;
+  }
+
   /**
    * \brief compose multiple chunks into a single chunk
    * \return Memorybuffer *consolidated chunk
@@ -376,6 +406,16 @@ class ExecutionGroup {
    */
   void finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers);
 
+  /**
+   * \brief are all chunks of this ExecutionGroup executed
+   */
+  bool isExecuted() const;
+
+  /**
+   * \brief mark all chunks as executed, used when the result is restored from the ResultCache
+   */
+  void setExecuted();
+
   /**
    * \brief deinitExecution is called just after execution the whole graph.
    * \note It will release all needed resources
@@ -400,6 +440,14 @@ class ExecutionGroup {
    */
   void execute(ExecutionSystem *system);
 
+  /**
+   * \brief schedule all chunks of an ExecutionGroup at once
+   * \note the ExecutionGroup's this group depends on must have been executed before.
+   * \see FullFrameExecutionModel
+   * \param system:
+   */
+  void executeFullFrame(ExecutionSystem *system);
+
   /**
    * \brief this method determines the MemoryProxy's where this execution group depends on.
    * \note After this method determineDependingAreaOfInterest can be called to determine
@@ -28,10 +28,13 @@
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #  include "MEM_guardedalloc.h"
@@ -147,16 +150,21 @@ void ExecutionSystem::execute()
   }
   unsigned int index;
 
+  const bool fullFrame = this->m_context.isFullFrame();
+
   // First allocale all write buffer
+  // (full frame execution allocates them when their group is executed)
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
     if (operation->isWriteBufferOperation()) {
       operation->setbNodeTree(this->m_context.getbNodeTree());
-      operation->initExecution();
+      if (!fullFrame) {
+        operation->initExecution();
+      }
     }
   }
   // Connect read buffers to their write buffers
-  for (index = 0; index < this->m_operations.size(); index++) {
+  for (index = 0; index < this->m_operations.size() && !fullFrame; index++) {
     NodeOperation *operation = this->m_operations[index];
     if (operation->isReadBufferOperation()) {
       ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
@@ -177,17 +185,41 @@ void ExecutionSystem::execute()
     executionGroup->initExecution();
   }
 
+  determineCachedResults();
+  // Restore cached results, their groups will not be scheduled
+  // (full frame execution restores them when their group is executed)
+  for (index = 0; index < this->m_groups.size() && !fullFrame; index++) {
+    restoreCachedResult(this->m_groups[index]);
+  }
+
   WorkScheduler::start(this->m_context);
 
-  executeGroups(COM_PRIORITY_HIGH);
-  if (!this->getContext().isFastCalculation()) {
-    executeGroups(COM_PRIORITY_MEDIUM);
-    executeGroups(COM_PRIORITY_LOW);
+  if (fullFrame) {
+    vector<ExecutionGroup *> executionGroups;
+    this->findOutputExecutionGroup(&executionGroups, COM_PRIORITY_HIGH);
+    if (!this->getContext().isFastCalculation()) {
+      this->findOutputExecutionGroup(&executionGroups, COM_PRIORITY_MEDIUM);
+      this->findOutputExecutionGroup(&executionGroups, COM_PRIORITY_LOW);
+    }
+    FullFrameExecutionModel model(this, executionGroups);
+    model.execute();
+  }
+  else {
+    executeGroups(COM_PRIORITY_HIGH);
+    if (!this->getContext().isFastCalculation()) {
+      executeGroups(COM_PRIORITY_MEDIUM);
+      executeGroups(COM_PRIORITY_LOW);
+    }
   }
 
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  for (index = 0; index < this->m_groups.size() && !fullFrame; index++) {
+    storeResult(this->m_groups[index]);
+  }
+  releaseCachedResults();
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -199,6 +231,80 @@ void ExecutionSystem::execute()
   }
 }
 
+void ExecutionSystem::determineCachedResults()
+{
+  ResultCache::OperationKeys keys;
+  for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+    ExecutionGroup *group = this->m_groups[index];
+    NodeOperation *operation = group->getOutputOperation();
+    /* single values are not worth caching */
+    if (!operation->isWriteBufferOperation() ||
+        ((WriteBufferOperation *)operation)->isSingleValue()) {
+      continue;
+    }
+    uint64_t key = ResultCache::determineKey(this->m_context, operation, keys);
+    if (key != 0) {
+      this->m_cacheKeys[group] = key;
+    }
+  }
+
+  /* acquire after all keys are determined, determining a key can clear the cache */
+  if (this->m_context.isRendering()) {
+    return;
+  }
+  for (std::map<ExecutionGroup *, uint64_t>::iterator it = this->m_cacheKeys.begin();
+       it != this->m_cacheKeys.end();
+       ++it) {
+    MemoryBuffer *buffer = ResultCache::acquire(it->second);
+    if (buffer) {
+      this->m_cachedResults[it->first] = buffer;
+    }
+  }
+}
+
+void ExecutionSystem::releaseCachedResults()
+{
+  for (std::map<ExecutionGroup *, MemoryBuffer *>::iterator it = this->m_cachedResults.begin();
+       it != this->m_cachedResults.end();
+       ++it) {
+    ResultCache::release(this->m_cacheKeys[it->first]);
+  }
+  this->m_cachedResults.clear();
+  this->m_cacheKeys.clear();
+}
+
+bool ExecutionSystem::restoreCachedResult(ExecutionGroup *group)
+{
+  std::map<ExecutionGroup *, MemoryBuffer *>::iterator it = this->m_cachedResults.find(group);
+  if (it == this->m_cachedResults.end()) {
+    return false;
+  }
+  WriteBufferOperation *operation = (WriteBufferOperation *)group->getOutputOperation();
+  operation->getMemoryProxy()->getBuffer()->copyContentFrom(it->second);
+  group->setExecuted();
+  return true;
+}
+
+void ExecutionSystem::storeResult(ExecutionGroup *group)
+{
+  /* cached results are not used when rendering, storing them would only hold on to memory */
+  if (this->m_context.isRendering()) {
+    return;
+  }
+  const bNodeTree *editingtree = this->m_context.getbNodeTree();
+  /* chunks are marked executed when the execution is broken off halfway */
+  if (isCachedResult(group) || !group->isExecuted() ||
+      editingtree->test_break(editingtree->tbh)) {
+    return;
+  }
+  std::map<ExecutionGroup *, uint64_t>::iterator it = this->m_cacheKeys.find(group);
+  if (it == this->m_cacheKeys.end()) {
+    return;
+  }
+  WriteBufferOperation *operation = (WriteBufferOperation *)group->getOutputOperation();
+  ResultCache::store(it->second, operation->getMemoryProxy()->getBuffer());
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
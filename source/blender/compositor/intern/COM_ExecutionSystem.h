@@ -28,6 +28,8 @@ class ExecutionGroup;
 #include "DNA_color_types.h"
 #include "DNA_node_types.h"
 
+#include <map>
+
 /**
  * \page execution Execution model
  * In order to get to an efficient model for execution, several steps are being done. these steps
@@ -134,6 +136,16 @@ class ExecutionSystem {
    */
   Groups m_groups;
 
+  /**
+   * \brief ResultCache keys of the groups writing to a MemoryProxy
+   */
+  std::map<ExecutionGroup *, uint64_t> m_cacheKeys;
+
+  /**
+   * \brief results acquired from the ResultCache, restored instead of executing their group
+   */
+  std::map<ExecutionGroup *, MemoryBuffer *> m_cachedResults;
+
  private:  // methods
   /**
    * find all execution group with output nodes
@@ -186,9 +198,36 @@ class ExecutionSystem {
     return this->m_context;
   }
 
+  /**
+   * \brief is the result of the group restored from the ResultCache
+   */
+  bool isCachedResult(ExecutionGroup *group) const
+  {
+    return this->m_cachedResults.find(group) != this->m_cachedResults.end();
+  }
+
+  /**
+   * \brief restore the result of a group from the ResultCache and mark its chunks executed
+   * \note the MemoryProxy of the group must be allocated
+   * \return false when no result is cached for the group
+   */
+  bool restoreCachedResult(ExecutionGroup *group);
+
+  /**
+   * \brief store the result of a group in the ResultCache when all its chunks are executed
+   */
+  void storeResult(ExecutionGroup *group);
+
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief determine the ResultCache keys of the groups and acquire their cached results
+   * \note results are not restored when rendering, but stored so they are up to date.
+   */
+  void determineCachedResults();
+  void releaseCachedResults();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -0,0 +1,542 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include "COM_FullFrameExecutionModel.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "MEM_guardedalloc.h"
+
+#include <algorithm>
+
+/* number of rows calculated by a single task */
+#define COM_FULL_FRAME_TASK_ROWS 32
+
+typedef struct BufferRegionTaskData {
+  NodeOperation *operation;
+  MemoryBuffer *output;
+  /* NULL when the operation is calculated per pixel */
+  MemoryBuffer **inputs;
+} BufferRegionTaskData;
+
+static void buffer_region_task(void *__restrict userdata,
+                               const int index,
+                               const TaskParallelTLS *__restrict /*tls*/)
+{
+  BufferRegionTaskData *data = (BufferRegionTaskData *)userdata;
+  MemoryBuffer *output = data->output;
+  rcti area;
+  BLI_rcti_init(&area,
+                0,
+                output->getWidth(),
+                index * COM_FULL_FRAME_TASK_ROWS,
+                min_ii((index + 1) * COM_FULL_FRAME_TASK_ROWS, output->getHeight()));
+
+  if (data->inputs) {
+    data->operation->executeBufferRegion(output, &area, data->inputs);
+    return;
+  }
+
+  const int num_channels = output->get_num_channels();
+  float color[4];
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *elem = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++) {
+      data->operation->readSampled(color, x, y, COM_PS_NEAREST);
+      memcpy(elem, color, sizeof(float) * num_channels);
+      elem += num_channels;
+    }
+  }
+}
+
+static void execute_buffer_regions(NodeOperation *operation,
+                                   MemoryBuffer *output,
+                                   MemoryBuffer **inputs)
+{
+  BufferRegionTaskData data;
+  data.operation = operation;
+  data.output = output;
+  data.inputs = inputs;
+
+  const int num_tasks = (output->getHeight() + COM_FULL_FRAME_TASK_ROWS - 1) /
+                        COM_FULL_FRAME_TASK_ROWS;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, num_tasks, &data, buffer_region_task, &settings);
+}
+
+static unsigned int datatype_num_channels(DataType datatype)
+{
+  switch (datatype) {
+    case COM_DT_VALUE:
+      return COM_NUM_CHANNELS_VALUE;
+    case COM_DT_VECTOR:
+      return COM_NUM_CHANNELS_VECTOR;
+    case COM_DT_COLOR:
+    default:
+      return COM_NUM_CHANNELS_COLOR;
+  }
+}
+
+/* operations that give the same result for every pixel */
+static bool is_constant_operation(NodeOperation *operation)
+{
+  if (operation->isSetOperation()) {
+    return true;
+  }
+  if (operation->isReadBufferOperation()) {
+    ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+    return readOperation->getMemoryProxy()->getWriteBufferOperation()->isSingleValue();
+  }
+  return false;
+}
+
+/* sort the operations of a group so inputs come before the operations reading them */
+static void sort_operations_recursive(NodeOperation *operation,
+                                      const std::set<NodeOperation *> &groupOperations,
+                                      std::set<NodeOperation *> &visited,
+                                      vector<NodeOperation *> &sorted)
+{
+  if (visited.find(operation) != visited.end()) {
+    return;
+  }
+  visited.insert(operation);
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (input->isConnected()) {
+      NodeOperation *inputOperation = &input->getLink()->getOperation();
+      if (groupOperations.find(inputOperation) != groupOperations.end()) {
+        sort_operations_recursive(inputOperation, groupOperations, visited, sorted);
+      }
+    }
+  }
+  sorted.push_back(operation);
+}
+
+FullFrameExecutionModel::FullFrameExecutionModel(ExecutionSystem *system,
+                                                 const vector<ExecutionGroup *> &outputGroups)
+{
+  this->m_system = system;
+  this->m_bTree = system->getContext().getbNodeTree();
+
+  std::set<ExecutionGroup *> addedGroups;
+  for (unsigned int index = 0; index < outputGroups.size(); index++) {
+    addGroup(outputGroups[index], addedGroups);
+  }
+
+  for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+    ExecutionGroup *group = this->m_groups[index];
+    if (this->m_system->isCachedResult(group)) {
+      continue;
+    }
+    vector<MemoryProxy *> proxies;
+    determineReadProxies(group, &proxies);
+    for (unsigned int proxyIndex = 0; proxyIndex < proxies.size(); proxyIndex++) {
+      this->m_proxyUsers[proxies[proxyIndex]]++;
+    }
+
+    BufferSizes sizes;
+    determineBufferSizes(group, &sizes);
+    for (BufferSizes::iterator iter = sizes.begin(); iter != sizes.end(); ++iter) {
+      this->m_bufferSizeUsers[*iter]++;
+    }
+
+    const ExecutionGroup::Operations &operations = group->getOperations();
+    for (unsigned int operationIndex = 0; operationIndex < operations.size(); operationIndex++) {
+      NodeOperation *operation = operations[operationIndex];
+      if (operation->isReadBufferOperation()) {
+        ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+        this->m_proxyReaders[readOperation->getMemoryProxy()].push_back(readOperation);
+      }
+    }
+  }
+}
+
+FullFrameExecutionModel::~FullFrameExecutionModel()
+{
+  for (unsigned int index = 0; index < this->m_bufferPool.size(); index++) {
+    delete this->m_bufferPool[index];
+  }
+  this->m_bufferPool.clear();
+}
+
+void FullFrameExecutionModel::addGroup(ExecutionGroup *group,
+                                       std::set<ExecutionGroup *> &addedGroups)
+{
+  if (addedGroups.find(group) != addedGroups.end()) {
+    return;
+  }
+  addedGroups.insert(group);
+
+  /* the groups a cached result is read from do not need to be executed */
+  if (this->m_system->isCachedResult(group)) {
+    this->m_groups.push_back(group);
+    return;
+  }
+
+  vector<MemoryProxy *> proxies;
+  determineReadProxies(group, &proxies);
+  for (unsigned int index = 0; index < proxies.size(); index++) {
+    ExecutionGroup *inputGroup = proxies[index]->getExecutor();
+    if (inputGroup) {
+      addGroup(inputGroup, addedGroups);
+    }
+  }
+
+  this->m_groups.push_back(group);
+}
+
+void FullFrameExecutionModel::determineReadProxies(ExecutionGroup *group,
+                                                   vector<MemoryProxy *> *proxies) const
+{
+  const ExecutionGroup::Operations &operations = group->getOperations();
+  for (unsigned int index = 0; index < operations.size(); index++) {
+    NodeOperation *operation = operations[index];
+    if (operation->isReadBufferOperation()) {
+      MemoryProxy *proxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+      if (std::find(proxies->begin(), proxies->end(), proxy) == proxies->end()) {
+        proxies->push_back(proxy);
+      }
+    }
+  }
+}
+
+bool FullFrameExecutionModel::isBraked() const
+{
+  return this->m_bTree->test_break && this->m_bTree->test_break(this->m_bTree->tbh);
+}
+
+void FullFrameExecutionModel::execute()
+{
+  for (unsigned int index = 0; index < this->m_groups.size() && !isBraked(); index++) {
+    ExecutionGroup *group = this->m_groups[index];
+    allocateProxy(group);
+    if (this->m_system->restoreCachedResult(group)) {
+      continue;
+    }
+    executeGroup(group);
+    this->m_system->storeResult(group);
+    releaseProxies(group);
+    releaseBufferSizes(group);
+  }
+}
+
+void FullFrameExecutionModel::allocateProxy(ExecutionGroup *group)
+{
+  NodeOperation *operation = group->getOutputOperation();
+  if (!operation->isWriteBufferOperation()) {
+    return;
+  }
+
+  MemoryProxy *proxy = ((WriteBufferOperation *)operation)->getMemoryProxy();
+  operation->initExecution();
+
+  vector<ReadBufferOperation *> &readers = this->m_proxyReaders[proxy];
+  for (unsigned int index = 0; index < readers.size(); index++) {
+    readers[index]->updateMemoryBuffer();
+  }
+}
+
+void FullFrameExecutionModel::releaseProxies(ExecutionGroup *group)
+{
+  vector<MemoryProxy *> proxies;
+  determineReadProxies(group, &proxies);
+  for (unsigned int index = 0; index < proxies.size(); index++) {
+    MemoryProxy *proxy = proxies[index];
+    if (--this->m_proxyUsers[proxy] > 0) {
+      continue;
+    }
+
+    proxy->getWriteBufferOperation()->deinitExecution();
+    vector<ReadBufferOperation *> &readers = this->m_proxyReaders[proxy];
+    for (unsigned int readerIndex = 0; readerIndex < readers.size(); readerIndex++) {
+      readers[readerIndex]->updateMemoryBuffer();
+    }
+  }
+}
+
+/**
+ * Sizes of the buffers the operations of a group may acquire, every operation except the
+ * output operation can be calculated on a buffer.
+ */
+void FullFrameExecutionModel::determineBufferSizes(ExecutionGroup *group,
+                                                   BufferSizes *sizes) const
+{
+  NodeOperation *outputOperation = group->getOutputOperation();
+  if (group->isComplex() || outputOperation->isPreviewOperation()) {
+    return;
+  }
+
+  const ExecutionGroup::Operations &operations = group->getOperations();
+  for (unsigned int index = 0; index < operations.size(); index++) {
+    NodeOperation *operation = operations[index];
+    if (operation == outputOperation || operation->getNumberOfOutputSockets() == 0 ||
+        operation->isReadBufferOperation() || is_constant_operation(operation)) {
+      continue;
+    }
+    const unsigned int num_channels = datatype_num_channels(
+        operation->getOutputSocket()->getDataType());
+    sizes->insert(BufferSize(num_channels, operation->getWidth(), operation->getHeight()));
+  }
+}
+
+/**
+ * Free the recycled buffers of sizes that none of the remaining groups acquires.
+ */
+void FullFrameExecutionModel::releaseBufferSizes(ExecutionGroup *group)
+{
+  BufferSizes sizes;
+  determineBufferSizes(group, &sizes);
+  for (BufferSizes::iterator iter = sizes.begin(); iter != sizes.end(); ++iter) {
+    this->m_bufferSizeUsers[*iter]--;
+  }
+
+  for (unsigned int index = 0; index < this->m_bufferPool.size();) {
+    MemoryBuffer *buffer = this->m_bufferPool[index];
+    const BufferSize size(buffer->get_num_channels(), buffer->getWidth(), buffer->getHeight());
+    if (this->m_bufferSizeUsers[size] > 0) {
+      index++;
+      continue;
+    }
+    delete buffer;
+    this->m_bufferPool.erase(this->m_bufferPool.begin() + index);
+  }
+}
+
+bool FullFrameExecutionModel::canExecuteFullFrame(NodeOperation *operation,
+                                                  const OperationSet &groupOperations) const
+{
+  if (!operation->isFullFrame() || operation->getWidth() == 0 || operation->getHeight() == 0) {
+    return false;
+  }
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (!input->isConnected()) {
+      return false;
+    }
+    NodeOperation *inputOperation = &input->getLink()->getOperation();
+    if (groupOperations.find(inputOperation) == groupOperations.end() ||
+        inputOperation->isComplex()) {
+      return false;
+    }
+    if (input->getDataType() != input->getLink()->getDataType()) {
+      return false;
+    }
+    /* inputs of other resolutions are sampled, which only the pixel execution does */
+    if (!is_constant_operation(inputOperation) &&
+        (inputOperation->getWidth() != operation->getWidth() ||
+         inputOperation->getHeight() != operation->getHeight())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FullFrameExecutionModel::executeGroup(ExecutionGroup *group)
+{
+  NodeOperation *outputOperation = group->getOutputOperation();
+  const ExecutionGroup::Operations &operations = group->getOperations();
+  OperationSet groupOperations(operations.begin(), operations.end());
+  OperationBuffers buffers;
+
+  /* Previews only sample a few pixels of their inputs, and complex groups contain no other
+   * operations than the complex operation and its inputs. */
+  if (!group->isComplex() && !outputOperation->isPreviewOperation()) {
+    vector<NodeOperation *> sorted;
+    OperationSet visited;
+    sort_operations_recursive(outputOperation, groupOperations, visited, sorted);
+
+    OperationSet fullFrameOperations;
+    for (unsigned int index = 0; index < sorted.size(); index++) {
+      NodeOperation *operation = sorted[index];
+      if (operation != outputOperation && canExecuteFullFrame(operation, groupOperations)) {
+        fullFrameOperations.insert(operation);
+      }
+    }
+
+    /* Count the users of every buffer. Operations that are not calculated on buffers read
+     * their inputs during the execution of the chunks, so buffers they read are kept until the
+     * chunks have been executed. */
+    OperationSet pixelReaders;
+    for (unsigned int index = 0; index < sorted.size(); index++) {
+      NodeOperation *operation = sorted[index];
+      const bool isFullFrame = fullFrameOperations.find(operation) != fullFrameOperations.end();
+      for (unsigned int inputIndex = 0; inputIndex < operation->getNumberOfInputSockets();
+           inputIndex++) {
+        NodeOperationInput *input = operation->getInputSocket(inputIndex);
+        if (!input->isConnected()) {
+          continue;
+        }
+        NodeOperation *inputOperation = &input->getLink()->getOperation();
+        if (isFullFrame) {
+          OperationBuffer &buffer = buffers[inputOperation];
+          buffer.users++;
+        }
+        else if (fullFrameOperations.find(inputOperation) != fullFrameOperations.end()) {
+          pixelReaders.insert(inputOperation);
+        }
+      }
+    }
+    for (OperationSet::iterator iter = pixelReaders.begin(); iter != pixelReaders.end(); ++iter) {
+      buffers[*iter].users++;
+    }
+
+    for (unsigned int index = 0; index < sorted.size() && !isBraked(); index++) {
+      NodeOperation *operation = sorted[index];
+      if (buffers.find(operation) == buffers.end()) {
+        continue;
+      }
+      if (fullFrameOperations.find(operation) != fullFrameOperations.end()) {
+        materializeOperation(operation, buffers);
+      }
+      else {
+        /* input of a full frame operation that is itself calculated per pixel */
+        OperationBuffer &buffer = buffers[operation];
+        const DataType datatype = operation->getOutputSocket()->getDataType();
+        if (is_constant_operation(operation)) {
+          rcti rect;
+          BLI_rcti_init(&rect, 0, operation->getWidth(), 0, operation->getHeight());
+          buffer.buffer = new MemoryBuffer(datatype, &rect, true);
+          buffer.owned = true;
+          float color[4];
+          operation->readSampled(color, 0, 0, COM_PS_NEAREST);
+          memcpy(buffer.buffer->getBuffer(),
+                 color,
+                 sizeof(float) * buffer.buffer->get_num_channels());
+        }
+        else if (operation->isReadBufferOperation()) {
+          buffer.buffer = ((ReadBufferOperation *)operation)->getMemoryProxy()->getBuffer();
+          buffer.owned = false;
+        }
+        else {
+          buffer.buffer = acquireBuffer(datatype, operation->getWidth(), operation->getHeight());
+          buffer.owned = true;
+          execute_buffer_regions(operation, buffer.buffer, NULL);
+        }
+      }
+    }
+  }
+
+  if (!isBraked() && !writeOperationBuffer(group, buffers)) {
+    group->executeFullFrame(this->m_system);
+  }
+
+  for (OperationBuffers::iterator iter = buffers.begin(); iter != buffers.end(); ++iter) {
+    if (iter->second.buffer) {
+      releaseOperationBuffer(iter->first, iter->second);
+    }
+  }
+}
+
+void FullFrameExecutionModel::materializeOperation(NodeOperation *operation,
+                                                   OperationBuffers &buffers)
+{
+  const unsigned int numInputs = operation->getNumberOfInputSockets();
+  vector<MemoryBuffer *> inputs(numInputs);
+  for (unsigned int index = 0; index < numInputs; index++) {
+    NodeOperation *inputOperation = &operation->getInputSocket(index)->getLink()->getOperation();
+    inputs[index] = buffers[inputOperation].buffer;
+  }
+
+  OperationBuffer &buffer = buffers[operation];
+  buffer.buffer = acquireBuffer(
+      operation->getOutputSocket()->getDataType(), operation->getWidth(), operation->getHeight());
+  buffer.owned = true;
+  execute_buffer_regions(operation, buffer.buffer, inputs.data());
+  /* also serve pixel reads from the buffer */
+  operation->setFullFrameBuffer(buffer.buffer);
+
+  for (unsigned int index = 0; index < numInputs; index++) {
+    NodeOperation *inputOperation = &operation->getInputSocket(index)->getLink()->getOperation();
+    OperationBuffer &inputBuffer = buffers[inputOperation];
+    if (--inputBuffer.users == 0) {
+      releaseOperationBuffer(inputOperation, inputBuffer);
+    }
+  }
+}
+
+/**
+ * Copy the buffer of the input of a WriteBufferOperation to its MemoryProxy, so the chunks of the
+ * group don't have to be executed.
+ */
+bool FullFrameExecutionModel::writeOperationBuffer(ExecutionGroup *group,
+                                                   OperationBuffers &buffers)
+{
+  NodeOperation *outputOperation = group->getOutputOperation();
+  if (!outputOperation->isWriteBufferOperation() || group->isOpenCL()) {
+    return false;
+  }
+
+  NodeOperation *inputOperation = &outputOperation->getInputSocket(0)->getLink()->getOperation();
+  OperationBuffers::iterator iter = buffers.find(inputOperation);
+  if (iter == buffers.end() || iter->second.buffer == NULL) {
+    return false;
+  }
+
+  MemoryBuffer *input = iter->second.buffer;
+  MemoryBuffer *output = ((WriteBufferOperation *)outputOperation)->getMemoryProxy()->getBuffer();
+  if (input->isASingleElem() || input->get_num_channels() != output->get_num_channels() ||
+      input->getWidth() != output->getWidth() || input->getHeight() != output->getHeight()) {
+    return false;
+  }
+
+  output->copyContentFrom(input);
+  output->setCreatedState();
+  group->setExecuted();
+  return true;
+}
+
+void FullFrameExecutionModel::releaseOperationBuffer(NodeOperation *operation,
+                                                     OperationBuffer &buffer)
+{
+  if (buffer.owned) {
+    operation->setFullFrameBuffer(NULL);
+    if (buffer.buffer->isASingleElem()) {
+      delete buffer.buffer;
+    }
+    else {
+      this->m_bufferPool.push_back(buffer.buffer);
+    }
+  }
+  buffer.buffer = NULL;
+}
+
+MemoryBuffer *FullFrameExecutionModel::acquireBuffer(DataType datatype,
+                                                     unsigned int width,
+                                                     unsigned int height)
+{
+  const unsigned int num_channels = datatype_num_channels(datatype);
+  for (unsigned int index = 0; index < this->m_bufferPool.size(); index++) {
+    MemoryBuffer *buffer = this->m_bufferPool[index];
+    if (buffer->get_num_channels() == num_channels && buffer->getWidth() == (int)width &&
+        buffer->getHeight() == (int)height) {
+      this->m_bufferPool.erase(this->m_bufferPool.begin() + index);
+      return buffer;
+    }
+  }
+
+  rcti rect;
+  BLI_rcti_init(&rect, 0, width, 0, height);
+  return new MemoryBuffer(datatype, &rect);
+}
@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_FULLFRAMEEXECUTIONMODEL_H__
+#define __COM_FULLFRAMEEXECUTIONMODEL_H__
+
+#include "COM_ExecutionGroup.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+#include "COM_NodeOperation.h"
+
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+class ExecutionSystem;
+class ReadBufferOperation;
+
+/**
+ * \brief Executes ExecutionGroup's on whole images instead of on demand per chunk.
+ *
+ * The groups are executed one after another, every group after the groups it reads from, so
+ * each group is calculated only once and memory of a MemoryProxy is allocated just before its
+ * group is executed and freed as soon as the last group reading it has been executed.
+ *
+ * Inside a group the operations supporting NodeOperation.executeBufferRegion are calculated
+ * first, operation by operation on whole buffers. Buffers are recycled as soon as all
+ * operations reading them are calculated. The chunks of the group are executed afterwards,
+ * reading the calculated operations from their buffers, see SocketReader.readSampled. When the
+ * input of the WriteBufferOperation of a group is calculated on a buffer, the buffer is copied to
+ * the MemoryProxy instead of executing the chunks.
+ * Recycled buffers of a size no remaining group can use are freed after each group.
+ *
+ * Groups with a result in the ResultCache are restored instead, without executing the groups
+ * they read from.
+ *
+ * \see CompositorContext.isFullFrame
+ * \ingroup Execution
+ */
+class FullFrameExecutionModel {
+ private:
+  /**
+   * \brief buffer of an operation during the execution of a group
+   */
+  typedef struct OperationBuffer {
+    MemoryBuffer *buffer;
+    /** false when the buffer belongs to a MemoryProxy */
+    bool owned;
+    /** number of operations that still need to read the buffer */
+    int users;
+  } OperationBuffer;
+
+  typedef std::set<NodeOperation *> OperationSet;
+  typedef std::map<NodeOperation *, OperationBuffer> OperationBuffers;
+  /** number of channels, width and height of a buffer */
+  typedef std::tuple<unsigned int, int, int> BufferSize;
+  typedef std::set<BufferSize> BufferSizes;
+
+  ExecutionSystem *m_system;
+
+  const bNodeTree *m_bTree;
+
+  /**
+   * \brief groups in execution order, groups are ordered after the groups they read from
+   */
+  vector<ExecutionGroup *> m_groups;
+
+  /**
+   * \brief number of groups that still need to read a MemoryProxy
+   */
+  std::map<MemoryProxy *, int> m_proxyUsers;
+
+  /**
+   * \brief ReadBufferOperation's of every MemoryProxy
+   */
+  std::map<MemoryProxy *, vector<ReadBufferOperation *>> m_proxyReaders;
+
+  /**
+   * \brief released buffers that can be reused by other operations
+   */
+  vector<MemoryBuffer *> m_bufferPool;
+
+  /**
+   * \brief number of groups that still need to execute and may acquire buffers of a size
+   */
+  std::map<BufferSize, int> m_bufferSizeUsers;
+
+  void addGroup(ExecutionGroup *group, std::set<ExecutionGroup *> &addedGroups);
+  void determineReadProxies(ExecutionGroup *group, vector<MemoryProxy *> *proxies) const;
+
+  void allocateProxy(ExecutionGroup *group);
+  void releaseProxies(ExecutionGroup *group);
+  void determineBufferSizes(ExecutionGroup *group, BufferSizes *sizes) const;
+  void releaseBufferSizes(ExecutionGroup *group);
+
+  void executeGroup(ExecutionGroup *group);
+  bool canExecuteFullFrame(NodeOperation *operation, const OperationSet &groupOperations) const;
+  void materializeOperation(NodeOperation *operation, OperationBuffers &buffers);
+  bool writeOperationBuffer(ExecutionGroup *group, OperationBuffers &buffers);
+  void releaseOperationBuffer(NodeOperation *operation, OperationBuffer &buffer);
+
+  MemoryBuffer *acquireBuffer(DataType datatype, unsigned int width, unsigned int height);
+  bool isBraked() const;
+
+ public:
+  /**
+   * \param outputGroups: the output ExecutionGroup's in order of execution.
+   */
+  FullFrameExecutionModel(ExecutionSystem *system, const vector<ExecutionGroup *> &outputGroups);
+  ~FullFrameExecutionModel();
+
+  void execute();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
+
+#endif /* __COM_FULLFRAMEEXECUTIONMODEL_H__ */
@@ -95,6 +95,11 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief whether the buffer stores a single element for its whole rect
+   */
+  bool m_is_a_single_elem;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -111,6 +116,13 @@ class MemoryBuffer {
    */
   MemoryBuffer(DataType datatype, rcti *rect);
 
+  /**
+   * \brief construct new temporarily MemoryBuffer for an area
+   * \param is_a_single_elem: store a single element used for every pixel of the area,
+   * as done for constant operations.
+   */
+  MemoryBuffer(DataType datatype, rcti *rect, bool is_a_single_elem);
+
   /**
    * \brief destructor
    */
@@ -129,6 +141,11 @@ class MemoryBuffer {
     return this->m_num_channels;
   }
 
+  DataType get_data_type() const
+  {
+    return this->m_datatype;
+  }
+
   /**
    * \brief get the data of this MemoryBuffer
    * \note buffer should already be available in memory
@@ -138,6 +155,41 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  /**
+   * \brief whether this buffer stores a single element for its whole rect
+   * \note only #getElem and the strides can be used to access such buffers
+   */
+  bool isASingleElem() const
+  {
+    return this->m_is_a_single_elem;
+  }
+
+  /**
+   * \brief number of floats between two horizontally adjacent elements (0 for a single element)
+   */
+  int getElemStride() const
+  {
+    return this->m_is_a_single_elem ? 0 : this->m_num_channels;
+  }
+
+  /**
+   * \brief number of floats between two vertically adjacent elements (0 for a single element)
+   */
+  int getRowStride() const
+  {
+    return this->m_is_a_single_elem ? 0 : this->m_width * this->m_num_channels;
+  }
+
+  /**
+   * \brief get a pointer to the element at a position inside the rect of this buffer
+   */
+  inline float *getElem(int x, int y)
+  {
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    return this->m_buffer + (y - m_rect.ymin) * getRowStride() +
+           (x - m_rect.xmin) * getElemStride();
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
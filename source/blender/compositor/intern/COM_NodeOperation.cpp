@@ -36,7 +36,13 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_fullFrame = false;
   this->m_btree = NULL;
+  this->m_bnode = NULL;
+  this->m_bnodeIndex = 0;
+  this->m_fullFrameBuffer = NULL;
+  this->m_fullFrameElemStride = 0;
+  this->m_fullFrameNumChannels = 0;
 }
 
 NodeOperation::~NodeOperation()
@@ -51,6 +57,18 @@ NodeOperation::~NodeOperation()
   }
 }
 
+void NodeOperation::setFullFrameBuffer(MemoryBuffer *buffer)
+{
+  if (buffer) {
+    this->m_fullFrameBuffer = buffer->getBuffer();
+    this->m_fullFrameElemStride = buffer->getElemStride();
+    this->m_fullFrameNumChannels = buffer->get_num_channels();
+  }
+  else {
+    this->m_fullFrameBuffer = NULL;
+  }
+}
+
 NodeOperationOutput *NodeOperation::getOutputSocket(unsigned int index) const
 {
   BLI_assert(index < m_outputs.size());
@@ -103,6 +103,12 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief can this operation calculate whole buffers at once.
+   * \see executeBufferRegion
+   */
+  bool m_fullFrame;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -119,6 +125,19 @@ class NodeOperation : public SocketReader {
    */
   const bNodeTree *m_btree;
 
+  /**
+   * \brief the bNode this operation has been created for,
+   * NULL for operations added by the compositor itself
+   * \see ResultCache
+   */
+  const bNode *m_bnode;
+
+  /**
+   * \brief identifies this operation among the operations of m_bnode
+   * \see NodeOperationBuilder.addOperation
+   */
+  int m_bnodeIndex;
+
   /**
    * \brief set to truth when resolution for this operation is set
    */
@@ -188,6 +207,20 @@ class NodeOperation : public SocketReader {
   {
     this->m_btree = tree;
   }
+
+  void setbNode(const bNode *node, int index)
+  {
+    this->m_bnode = node;
+    this->m_bnodeIndex = index;
+  }
+  const bNode *getbNode() const
+  {
+    return this->m_bnode;
+  }
+  int getbNodeIndex() const
+  {
+    return this->m_bnodeIndex;
+  }
   virtual void initExecution();
 
   /**
@@ -201,6 +234,22 @@ class NodeOperation : public SocketReader {
   {
   }
 
+  /**
+   * \brief when the operation is executed by a FullFrameExecutionModel, this method is called
+   * \ingroup execution
+   * \note only called for operations that are full frame.
+   * \param output: buffer of the size of this operation to write the result to
+   * \param area: the area of the output to calculate
+   * \param inputs: buffers of the input operations, indexed by input socket. Buffers of
+   * constant operations store a single element, see #MemoryBuffer.getElemStride
+   * \see isFullFrame
+   */
+  virtual void executeBufferRegion(MemoryBuffer * /*output*/,
+                                   const rcti * /*area*/,
+                                   MemoryBuffer ** /*inputs*/)
+  {
+  }
+
   /**
    * \brief when a chunk is executed by an OpenCLDevice, this method is called
    * \ingroup execution
@@ -282,6 +331,22 @@ class NodeOperation : public SocketReader {
     return false;
   }
 
+  /**
+   * \brief can this operation calculate whole buffers at once
+   * \see executeBufferRegion
+   */
+  bool isFullFrame() const
+  {
+    return this->m_fullFrame;
+  }
+
+  /**
+   * \brief serve reads of this operation from its full frame output,
+   * pass NULL to calculate pixels again.
+   * \see FullFrameExecutionModel
+   */
+  void setFullFrameBuffer(MemoryBuffer *buffer);
+
   /**
    * \brief is this operation of type ReadBufferOperation
    * \return [true:false]
@@ -421,6 +486,14 @@ class NodeOperation : public SocketReader {
     this->m_openCL = openCL;
   }
 
+  /**
+   * \brief set if this NodeOperation implements executeBufferRegion
+   */
+  void setFullFrame(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
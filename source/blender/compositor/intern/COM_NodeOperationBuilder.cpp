@@ -38,7 +38,10 @@
 #include "COM_NodeOperationBuilder.h" /* own include */
 
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree)
-    : m_context(context), m_current_node(NULL), m_active_viewer(NULL)
+    : m_context(context),
+      m_current_node(NULL),
+      m_current_node_operations(0),
+      m_active_viewer(NULL)
 {
   m_graph.from_bNodeTree(*context, b_nodetree);
 }
@@ -56,6 +59,7 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
     Node *node = (Node *)m_graph.nodes()[index];
 
     m_current_node = node;
+    m_current_node_operations = 0;
 
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
@@ -126,6 +130,14 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
   m_operations.push_back(operation);
+
+  /* Operations are identified by the node output they are mapped to, see mapOutputSocket,
+   * other operations of the node by the order in which they are added. */
+  if (m_current_node) {
+    operation->setbNode(m_current_node->getbNode(),
+                        m_current_node->getNumberOfOutputSockets() + m_current_node_operations);
+    m_current_node_operations++;
+  }
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket,
@@ -148,6 +160,13 @@ void NodeOperationBuilder::mapOutputSocket(NodeOutput *node_socket,
   BLI_assert(node_socket->getNode() == m_current_node);
 
   m_output_map[node_socket] = operation_socket;
+
+  for (unsigned int index = 0; index < m_current_node->getNumberOfOutputSockets(); index++) {
+    if (m_current_node->getOutputSocket(index) == node_socket) {
+      operation_socket->getOperation().setbNode(m_current_node->getbNode(), index);
+      break;
+    }
+  }
 }
 
 void NodeOperationBuilder::addLink(NodeOperationOutput *from, NodeOperationInput *to)
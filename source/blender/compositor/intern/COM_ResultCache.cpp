@@ -0,0 +1,422 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <string.h>
+#include <typeinfo>
+
+#include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "MEM_CacheLimiterC-Api.h"
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_color_types.h"
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_image.h"
+#include "BKE_node.h"
+
+#include "IMB_imbuf_types.h"
+
+#include "RE_pipeline.h"
+
+typedef struct ResultCacheItem {
+  /* NULL when the result has been freed by the MEM_CacheLimiter */
+  MemoryBuffer *buffer;
+  MEM_CacheLimiterHandleC *handle;
+} ResultCacheItem;
+
+static MEM_CacheLimiterC *g_limiter = NULL;
+static std::map<uint64_t, ResultCacheItem *> g_items;
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ * \{ */
+
+/* FNV-1a, 64 bit */
+#define COM_RESULT_CACHE_HASH_INIT 0xcbf29ce484222325ULL
+
+static void hash_bytes(uint64_t *hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t index = 0; index < size; index++) {
+    *hash = (*hash ^ bytes[index]) * 0x100000001b3ULL;
+  }
+}
+
+template<typename T> static void hash_value(uint64_t *hash, const T &value)
+{
+  hash_bytes(hash, &value, sizeof(T));
+}
+
+static void hash_string(uint64_t *hash, const char *str)
+{
+  if (str) {
+    hash_bytes(hash, str, strlen(str) + 1);
+  }
+  else {
+    hash_value(hash, 0);
+  }
+}
+
+/* Allocated data is hashed by its contents, so changes made to it in place are noticed. */
+static void hash_alloc(uint64_t *hash, const void *data)
+{
+  if (data) {
+    hash_bytes(hash, data, MEM_allocN_len(data));
+  }
+  else {
+    hash_value(hash, 0);
+  }
+}
+
+static void hash_curve_mapping(uint64_t *hash, const CurveMapping *cumap)
+{
+  hash_alloc(hash, cumap);
+  for (int index = 0; index < CM_TOT; index++) {
+    const CurveMap *cuma = &cumap->cm[index];
+    if (cuma->curve) {
+      hash_bytes(hash, cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+    }
+  }
+}
+
+static void hash_context(uint64_t *hash, const CompositorContext &context)
+{
+  hash_value(hash, context.getScene());
+  hash_value(hash, context.getFramenumber());
+  hash_value(hash, (int)context.getQuality());
+  hash_value(hash, context.isFastCalculation());
+  hash_string(hash, context.getViewName());
+
+  const RenderData *rd = context.getRenderData();
+  if (rd) {
+    hash_value(hash, rd->size);
+  }
+
+  const ColorManagedViewSettings *viewSettings = context.getViewSettings();
+  if (viewSettings) {
+    hash_value(hash, viewSettings->flag);
+    hash_string(hash, viewSettings->look);
+    hash_string(hash, viewSettings->view_transform);
+    hash_value(hash, viewSettings->exposure);
+    hash_value(hash, viewSettings->gamma);
+    if (viewSettings->curve_mapping) {
+      hash_curve_mapping(hash, viewSettings->curve_mapping);
+    }
+  }
+
+  const ColorManagedDisplaySettings *displaySettings = context.getDisplaySettings();
+  if (displaySettings) {
+    hash_string(hash, displaySettings->display_device);
+  }
+}
+
+/* The buffers of the render result are hashed. Their addresses can be reused after a render
+ * result is freed and passes can be written to in place, the generation of the render results
+ * changes in both cases. */
+static void hash_render_result(uint64_t *hash, Scene *scene)
+{
+  Render *re = (scene) ? RE_GetSceneRender(scene) : NULL;
+  RenderResult *rr = (re) ? RE_AcquireResultRead(re) : NULL;
+  hash_value(hash, RE_GetResultGeneration());
+  hash_value(hash, rr);
+  if (rr) {
+    LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+      LISTBASE_FOREACH (RenderPass *, rpass, &rl->passes) {
+        hash_value(hash, rpass->rect);
+      }
+    }
+  }
+  if (re) {
+    RE_ReleaseResult(re);
+  }
+}
+
+/* The buffer of the image is hashed. Reloading the image can allocate the new buffer at the
+ * address of the freed one, the generation of the image buffers changes then. */
+static bool hash_image(uint64_t *hash, const bNode *node)
+{
+  Image *image = (Image *)node->id;
+  if (ELEM(image->type, IMA_TYPE_R_RESULT, IMA_TYPE_COMPOSITE) || node->storage == NULL) {
+    return false;
+  }
+  /* Painting changes the buffer in place, results of the image before it was painted on must
+   * not be restored afterwards. */
+  if (BKE_image_is_dirty(image)) {
+    ResultCache::clear();
+    return false;
+  }
+
+  hash_string(hash, image->filepath);
+  hash_value(hash, image->source);
+
+  ImageUser iuser = *(ImageUser *)node->storage;
+  ImBuf *ibuf = BKE_image_acquire_ibuf(image, &iuser, NULL);
+  hash_value(hash, BKE_image_buffers_generation());
+  hash_value(hash, ibuf);
+  if (ibuf) {
+    hash_value(hash, ibuf->rect);
+    hash_value(hash, ibuf->rect_float);
+  }
+  BKE_image_release_ibuf(image, ibuf, NULL);
+  return true;
+}
+
+static bool hash_node(uint64_t *hash, const CompositorContext &context, const bNode *node)
+{
+  /* Depends on the camera of the scene. */
+  if (node->type == CMP_NODE_DEFOCUS) {
+    return false;
+  }
+
+  hash_value(hash, node->type);
+  hash_value(hash, node->custom1);
+  hash_value(hash, node->custom2);
+  hash_value(hash, node->custom3);
+  hash_value(hash, node->custom4);
+
+  if (ELEM(node->type,
+           CMP_NODE_CURVE_VEC,
+           CMP_NODE_CURVE_RGB,
+           CMP_NODE_TIME,
+           CMP_NODE_HUECORRECT)) {
+    hash_curve_mapping(hash, (const CurveMapping *)node->storage);
+  }
+  else {
+    hash_alloc(hash, node->storage);
+  }
+  if (node->type == CMP_NODE_CRYPTOMATTE && node->storage) {
+    hash_string(hash, ((const NodeCryptomatte *)node->storage)->matte_id);
+  }
+
+  LISTBASE_FOREACH (bNodeSocket *, sock, &node->inputs) {
+    hash_alloc(hash, sock->default_value);
+  }
+  LISTBASE_FOREACH (bNodeSocket *, sock, &node->outputs) {
+    hash_alloc(hash, sock->default_value);
+  }
+
+  if (node->type == CMP_NODE_R_LAYERS) {
+    Scene *scene = node->id ? (Scene *)node->id : context.getScene();
+    hash_value(hash, scene);
+    hash_render_result(hash, scene);
+    return true;
+  }
+
+  if (node->id) {
+    hash_value(hash, node->id);
+    switch (GS(node->id->name)) {
+      case ID_IM:
+        return hash_image(hash, node);
+      case ID_SCE:
+      case ID_NT:
+        return true;
+      default:
+        /* Masks, movie clips and textures change without the node changing. */
+        return false;
+    }
+  }
+  return true;
+}
+
+static uint64_t determine_operation_key(const CompositorContext &context,
+                                        NodeOperation *operation,
+                                        ResultCache::OperationKeys &keys)
+{
+  ResultCache::OperationKeys::iterator it = keys.find(operation);
+  if (it != keys.end()) {
+    return it->second;
+  }
+  keys[operation] = 0;
+
+  uint64_t hash = COM_RESULT_CACHE_HASH_INIT;
+  hash_string(&hash, typeid(*operation).name());
+  hash_value(&hash, operation->getWidth());
+  hash_value(&hash, operation->getHeight());
+  for (unsigned int index = 0; index < operation->getNumberOfOutputSockets(); index++) {
+    hash_value(&hash, (int)operation->getOutputSocket(index)->getDataType());
+  }
+
+  const bNode *node = operation->getbNode();
+  if (node) {
+    if (!hash_node(&hash, context, node)) {
+      return 0;
+    }
+    hash_value(&hash, operation->getbNodeIndex());
+  }
+
+  if (operation->isSetOperation()) {
+    float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    operation->readSampled(color, 0.0f, 0.0f, COM_PS_NEAREST);
+    hash_value(&hash, color);
+  }
+
+  if (operation->isReadBufferOperation()) {
+    MemoryProxy *proxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+    uint64_t inputKey = determine_operation_key(
+        context, proxy->getWriteBufferOperation(), keys);
+    if (inputKey == 0) {
+      return 0;
+    }
+    hash_value(&hash, inputKey);
+  }
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    uint64_t inputKey = 1;
+    if (input->isConnected()) {
+      inputKey = determine_operation_key(context, &input->getLink()->getOperation(), keys);
+      if (inputKey == 0) {
+        return 0;
+      }
+    }
+    hash_value(&hash, inputKey);
+  }
+
+  /* 0 is reserved for results that can not be cached */
+  if (hash == 0) {
+    hash = 1;
+  }
+  keys[operation] = hash;
+  return hash;
+}
+
+uint64_t ResultCache::determineKey(const CompositorContext &context,
+                                   NodeOperation *operation,
+                                   OperationKeys &keys)
+{
+  uint64_t operationKey = determine_operation_key(context, operation, keys);
+  if (operationKey == 0) {
+    return 0;
+  }
+
+  uint64_t hash = COM_RESULT_CACHE_HASH_INIT;
+  hash_context(&hash, context);
+  hash_value(&hash, operationKey);
+  return (hash != 0) ? hash : 1;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Results
+ * \{ */
+
+static void result_cache_destructor(void *data)
+{
+  ResultCacheItem *item = (ResultCacheItem *)data;
+  delete item->buffer;
+  item->buffer = NULL;
+  item->handle = NULL;
+}
+
+static size_t result_cache_item_size(void *data)
+{
+  ResultCacheItem *item = (ResultCacheItem *)data;
+  MemoryBuffer *buffer = item->buffer;
+  if (buffer == NULL) {
+    return 0;
+  }
+  return sizeof(float) * buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels();
+}
+
+static void remove_item(std::map<uint64_t, ResultCacheItem *>::iterator it)
+{
+  ResultCacheItem *item = it->second;
+  if (item->buffer) {
+    MEM_CacheLimiter_unmanage(item->handle);
+    delete item->buffer;
+  }
+  MEM_freeN(item);
+  g_items.erase(it);
+}
+
+MemoryBuffer *ResultCache::acquire(uint64_t key)
+{
+  std::map<uint64_t, ResultCacheItem *>::iterator it = g_items.find(key);
+  if (it == g_items.end() || it->second->buffer == NULL) {
+    return NULL;
+  }
+  ResultCacheItem *item = it->second;
+  MEM_CacheLimiter_touch(item->handle);
+  MEM_CacheLimiter_ref(item->handle);
+  return item->buffer;
+}
+
+void ResultCache::release(uint64_t key)
+{
+  std::map<uint64_t, ResultCacheItem *>::iterator it = g_items.find(key);
+  if (it != g_items.end() && it->second->buffer) {
+    MEM_CacheLimiter_unref(it->second->handle);
+  }
+}
+
+void ResultCache::store(uint64_t key, MemoryBuffer *buffer)
+{
+  if (g_limiter == NULL) {
+    g_limiter = new_MEM_CacheLimiter(result_cache_destructor, result_cache_item_size);
+  }
+
+  std::map<uint64_t, ResultCacheItem *>::iterator it = g_items.find(key);
+  if (it != g_items.end()) {
+    if (it->second->buffer && MEM_CacheLimiter_get_refcount(it->second->handle) != 0) {
+      return;
+    }
+    remove_item(it);
+  }
+
+  ResultCacheItem *item = (ResultCacheItem *)MEM_mallocN(sizeof(ResultCacheItem), __func__);
+  item->buffer = new MemoryBuffer(buffer->get_data_type(), buffer->getRect());
+  item->buffer->copyContentFrom(buffer);
+  item->handle = MEM_CacheLimiter_insert(g_limiter, item);
+  g_items[key] = item;
+
+  MEM_CacheLimiter_ref(item->handle);
+  MEM_CacheLimiter_enforce_limits(g_limiter);
+  MEM_CacheLimiter_unref(item->handle);
+
+  /* remove the items of the results freed by the limiter */
+  for (it = g_items.begin(); it != g_items.end();) {
+    std::map<uint64_t, ResultCacheItem *>::iterator next = it;
+    ++next;
+    if (it->second->buffer == NULL) {
+      remove_item(it);
+    }
+    it = next;
+  }
+}
+
+void ResultCache::clear()
+{
+  while (!g_items.empty()) {
+    remove_item(g_items.begin());
+  }
+  if (g_limiter) {
+    delete_MEM_CacheLimiter(g_limiter);
+    g_limiter = NULL;
+  }
+}
+
+/** \} */
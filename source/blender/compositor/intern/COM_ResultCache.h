@@ -0,0 +1,80 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_RESULTCACHE_H__
+#define __COM_RESULTCACHE_H__
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+
+#include <map>
+
+/**
+ * \brief keeps the results of ExecutionGroup's between executions of the compositor.
+ *
+ * Results are stored under a key that is a hash of everything the result depends on: the
+ * settings of the nodes the operations have been created for, the operations themselves, their
+ * resolutions and their inputs, down to the input operations of the node tree. When a node is
+ * changed only the keys of the operations depending on it change, so the results of the
+ * unchanged parts of the node tree are restored instead of calculated again.
+ *
+ * The memory used by the results is limited by the MEM_CacheLimiter, least recently used results
+ * are freed first.
+ *
+ * \note the compositor executes a single node tree at a time, so the cache is not locked.
+ * \see ExecutionSystem.determineCachedResults
+ * \ingroup Memory
+ */
+class ResultCache {
+ public:
+  typedef std::map<NodeOperation *, uint64_t> OperationKeys;
+
+  /**
+   * \brief determine the key of the result of an operation
+   * \param keys: keys of the operations that have already been determined
+   * \return 0 when the result of the operation can not be cached, for example when it depends
+   * on data that can change without the node tree changing (masks, movie clips, textures).
+   */
+  static uint64_t determineKey(const CompositorContext &context,
+                               NodeOperation *operation,
+                               OperationKeys &keys);
+
+  /**
+   * \brief get a cached result, the result is kept until it is released again
+   * \return NULL when no result has been cached for the key
+   */
+  static MemoryBuffer *acquire(uint64_t key);
+
+  /**
+   * \brief release a result acquired by acquire
+   */
+  static void release(uint64_t key);
+
+  /**
+   * \brief store a copy of a result, replacing the result cached for the key before
+   */
+  static void store(uint64_t key, MemoryBuffer *buffer);
+
+  /**
+   * \brief free all cached results
+   */
+  static void clear();
+};
+
+#endif /* __COM_RESULTCACHE_H__ */
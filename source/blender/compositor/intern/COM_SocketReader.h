@@ -50,6 +50,15 @@ class SocketReader {
    */
   unsigned int m_height;
 
+  /**
+   * \brief output of this operation calculated by a full frame execution.
+   * When set, nearest reads of pixel positions are served from it.
+   * \see FullFrameExecutionModel
+   */
+  const float *m_fullFrameBuffer;
+  int m_fullFrameElemStride;
+  int m_fullFrameNumChannels;
+
   /**
    * \brief calculate a single pixel
    * \note this method is called for non-complex
@@ -97,6 +106,19 @@ class SocketReader {
  public:
   inline void readSampled(float result[4], float x, float y, PixelSampler sampler)
   {
+    if (this->m_fullFrameBuffer && sampler == COM_PS_NEAREST) {
+      const int xi = (int)x;
+      const int yi = (int)y;
+      if (xi == x && yi == y && xi >= 0 && yi >= 0 && xi < (int)this->m_width &&
+          yi < (int)this->m_height) {
+        const float *elem = this->m_fullFrameBuffer +
+                            (yi * (int)this->m_width + xi) * this->m_fullFrameElemStride;
+        for (int i = 0; i < this->m_fullFrameNumChannels; i++) {
+          result[i] = elem[i];
+        }
+        return;
+      }
+    }
     executePixelSampled(result, x, y, sampler);
   }
   inline void read(float result[4], int x, int y, void *chunkData)
@@ -17,6 +17,7 @@
  */
 
 #include <list>
+#include <queue>
 #include <stdio.h>
 
 #include "COM_CPUDevice.h"
@@ -29,6 +30,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "PIL_time.h"
 
@@ -49,11 +51,35 @@ static vector<CPUDevice *> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-/// \brief list of all thread for every CPUDevice in cpudevices a thread exists
-static ListBase g_cputhreads;
+/// \brief work scheduled for the cpu, with its priority
+typedef struct CPUWork {
+  unsigned int priority;
+  /** order of scheduling, for work with the same priority */
+  unsigned int order;
+  WorkPackage *package;
+
+  bool operator<(const CPUWork &other) const
+  {
+    /* std::priority_queue puts the largest element on top */
+    if (priority != other.priority) {
+      return priority > other.priority;
+    }
+    return order > other.order;
+  }
+} CPUWork;
+
 static bool g_cpuInitialized = false;
-/// \brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+/// \brief task pool executing the work for the cpu, one task for every CPUDevice at most
+static TaskPool *g_cpupool;
+/// \brief all scheduled work for the cpu, that isn't picked up by a task yet
+static std::priority_queue<CPUWork> g_cpuwork;
+static unsigned int g_cpuworkOrder = 0;
+/// \brief number of tasks in the task pool
+static unsigned int g_cputasks = 0;
+/// \brief CPUDevices not used by a task
+static vector<CPUDevice *> g_cpufreedevices;
+/// \brief protects g_cpuwork, g_cputasks and g_cpufreedevices
+static ThreadMutex g_cpumutex = BLI_MUTEX_INITIALIZER;
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -72,17 +98,53 @@ static bool g_openclInitialized = false;
 #endif
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-void *WorkScheduler::thread_execute_cpu(void *data)
+/**
+ * Execute the scheduled work with the highest priority on a free CPUDevice, until no work is
+ * left. Work is picked up when the task starts running, so work scheduled after the task was
+ * pushed is executed before work further away from the hotspots.
+ */
+static void execute_cpu_task(TaskPool *__restrict /*pool*/, void * /*taskdata*/)
 {
-  CPUDevice *device = (CPUDevice *)data;
-  WorkPackage *work;
+  BLI_mutex_lock(&g_cpumutex);
+  CPUDevice *device = g_cpufreedevices.back();
+  g_cpufreedevices.pop_back();
   BLI_thread_local_set(g_thread_device, device);
-  while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
+
+  while (!g_cpuwork.empty()) {
+    WorkPackage *work = g_cpuwork.top().package;
+    g_cpuwork.pop();
+    BLI_mutex_unlock(&g_cpumutex);
+
     device->execute(work);
     delete work;
+
+    BLI_mutex_lock(&g_cpumutex);
   }
 
-  return NULL;
+  g_cpufreedevices.push_back(device);
+  g_cputasks--;
+  BLI_mutex_unlock(&g_cpumutex);
+}
+
+static void schedule_cpu(WorkPackage *package, unsigned int priority)
+{
+  CPUWork work;
+  work.priority = priority;
+  work.package = package;
+
+  BLI_mutex_lock(&g_cpumutex);
+  work.order = g_cpuworkOrder++;
+  g_cpuwork.push(work);
+  const bool push_task = g_cputasks < g_cpudevices.size();
+  if (push_task) {
+    g_cputasks++;
+  }
+  BLI_mutex_unlock(&g_cpumutex);
+
+  /* pushed outside the lock, without threads the task is executed immediately */
+  if (push_task) {
+    BLI_task_pool_push(g_cpupool, execute_cpu_task, NULL, false, NULL);
+  }
 }
 
 void *WorkScheduler::thread_execute_gpu(void *data)
@@ -99,23 +161,24 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 }
 #endif
 
-void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
+void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber, unsigned int priority)
 {
   WorkPackage *package = new WorkPackage(group, chunkNumber);
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
   CPUDevice device(0);
   device.execute(package);
   delete package;
+  (void)priority;
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 #  ifdef COM_OPENCL_ENABLED
   if (group->isOpenCL() && g_openclActive) {
     BLI_thread_queue_push(g_gpuqueue, package);
   }
   else {
-    BLI_thread_queue_push(g_cpuqueue, package);
+    schedule_cpu(package, priority);
   }
 #  else
-  BLI_thread_queue_push(g_cpuqueue, package);
+  schedule_cpu(package, priority);
 #  endif
 #endif
 }
@@ -123,15 +186,13 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  unsigned int index;
-  g_cpuqueue = BLI_thread_queue_init();
-  BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
-  for (index = 0; index < g_cpudevices.size(); index++) {
-    Device *device = g_cpudevices[index];
-    BLI_threadpool_insert(&g_cputhreads, device);
-  }
+  g_cpupool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  g_cpufreedevices = g_cpudevices;
+  g_cputasks = 0;
+  g_cpuworkOrder = 0;
 #  ifdef COM_OPENCL_ENABLED
   if (context.getHasActiveOpenCLDevices()) {
+    unsigned int index;
     g_gpuqueue = BLI_thread_queue_init();
     BLI_threadpool_init(&g_gputhreads, thread_execute_gpu, g_gpudevices.size());
     for (index = 0; index < g_gpudevices.size(); index++) {
@@ -152,23 +213,18 @@ void WorkScheduler::finish()
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_wait_finish(g_gpuqueue);
-    BLI_thread_queue_wait_finish(g_cpuqueue);
   }
-  else {
-    BLI_thread_queue_wait_finish(g_cpuqueue);
-  }
-#  else
-  BLI_thread_queue_wait_finish(cpuqueue);
 #  endif
+  BLI_task_pool_work_and_wait(g_cpupool);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-  BLI_thread_queue_nowait(g_cpuqueue);
-  BLI_threadpool_end(&g_cputhreads);
-  BLI_thread_queue_free(g_cpuqueue);
-  g_cpuqueue = NULL;
+  BLI_task_pool_work_and_wait(g_cpupool);
+  BLI_task_pool_free(g_cpupool);
+  g_cpupool = NULL;
+  g_cpufreedevices.clear();
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
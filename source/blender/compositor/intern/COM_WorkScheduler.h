@@ -38,12 +38,6 @@ class WorkScheduler {
    */
   static bool isStopping();
 
-  /**
-   * \brief main thread loop for cpudevices
-   * inside this loop new work is queried and being executed
-   */
-  static void *thread_execute_cpu(void *data);
-
   /**
    * \brief main thread loop for gpudevices
    * inside this loop new work is queried and being executed
@@ -59,8 +53,11 @@ class WorkScheduler {
    * \see ExecutionGroup.execute
    * \param group: the execution group
    * \param chunkNumber: the number of the chunk in the group to be executed
+   * \param priority: scheduled chunks with a lower priority value are executed first, chunks
+   * with the same priority in the order they are scheduled.
+   * \see ExecutionGroup.determineChunkOrder
    */
-  static void schedule(ExecutionGroup *group, int chunkNumber);
+  static void schedule(ExecutionGroup *group, int chunkNumber, unsigned int priority);
 
   /**
    * \brief initialize the WorkScheduler
@@ -84,15 +81,16 @@ class WorkScheduler {
 
   /**
    * \brief Start the execution
-   * this methods will start the WorkScheduler. Inside this method all threads are initialized.
-   * for every device a thread is created.
+   * this methods will start the WorkScheduler. Work for the CPUDevices is executed by a task
+   * pool, so it shares the threads of the task scheduler with the rest of Blender. For every
+   * OpenCLDevice a thread is created.
    * \see initialize Initialization and query of the number of devices
    */
   static void start(CompositorContext &context);
 
   /**
    * \brief stop the execution
-   * All created thread by the start method are destroyed.
+   * The task pool and the threads created by the start method are destroyed.
    * \see start
    */
   static void stop();
@@ -18,6 +18,7 @@
 
 #include "COM_BlurBaseOperation.h"
 #include "BLI_math.h"
+#include "COM_FastGaussianBlurOperation.h"
 #include "MEM_guardedalloc.h"
 
 #include "RE_pipeline.h"
@@ -152,6 +153,78 @@ float *BlurBaseOperation::make_dist_fac_inverse(float rad, int size, int falloff
   return dist_fac_invert;
 }
 
+bool BlurBaseOperation::isRecursiveGauss(int filtersize, int image_size) const
+{
+  if (this->m_data.filtertype != R_FILTER_GAUSS) {
+    return false;
+  }
+  const int taps = min_ii(2 * filtersize + 1, image_size) / getStep();
+  return taps >= COM_BLUR_RECURSIVE_MIN_TAPS;
+}
+
+MemoryBuffer *BlurBaseOperation::recursiveGauss(MemoryBuffer *buffer, float rad, unsigned int xy)
+{
+  BLI_assert(xy == 1 || xy == 2);
+  /* the standard deviation of R_FILTER_GAUSS is a third of its radius */
+  const float sigma = rad / 3.0f;
+  const int num_channels = buffer->get_num_channels();
+  const int width = buffer->getWidth();
+  const int height = buffer->getHeight();
+
+  /* The gauss table is normalized by its part inside the image, the recursive filter repeats
+   * the border elements instead. To give the same result the image is padded with zeros up to
+   * the radius of the table, and divided by the padding mask blurred by the same filter. */
+  const int pad = ceilf(rad);
+  const int pad_x = (xy == 1) ? pad : 0;
+  const int pad_y = (xy == 2) ? pad : 0;
+  rcti rect;
+  BLI_rcti_init(&rect, 0, width + 2 * pad_x, 0, height + 2 * pad_y);
+  MemoryBuffer *padded = new MemoryBuffer(buffer->get_data_type(), &rect);
+  memset(padded->getBuffer(), 0, sizeof(float) * num_channels * rect.xmax * rect.ymax);
+  for (int y = 0; y < height; y++) {
+    memcpy(&padded->getBuffer()[((y + pad_y) * rect.xmax + pad_x) * num_channels],
+           &buffer->getBuffer()[y * width * num_channels],
+           sizeof(float) * width * num_channels);
+  }
+
+  const int length = (xy == 1) ? rect.xmax : rect.ymax;
+  if (xy == 1) {
+    BLI_rcti_init(&rect, 0, length, 0, 1);
+  }
+  else {
+    BLI_rcti_init(&rect, 0, 1, 0, length);
+  }
+  MemoryBuffer *mask = new MemoryBuffer(COM_DT_VALUE, &rect);
+  float *mask_buffer = mask->getBuffer();
+  for (int i = 0; i < length; i++) {
+    mask_buffer[i] = (i >= pad && i < length - pad) ? 1.0f : 0.0f;
+  }
+
+  for (int c = 0; c < num_channels; c++) {
+    FastGaussianBlurOperation::IIR_gauss(padded, sigma, c, xy);
+  }
+  FastGaussianBlurOperation::IIR_gauss(mask, sigma, 0, xy);
+
+  MemoryBuffer *result = new MemoryBuffer(buffer->get_data_type(), buffer->getRect());
+  float *elem = result->getBuffer();
+  for (int y = 0; y < height; y++) {
+    const float *padded_elem =
+        &padded->getBuffer()[((y + pad_y) * padded->getWidth() + pad_x) * num_channels];
+    for (int x = 0; x < width; x++) {
+      const float weight = 1.0f / mask_buffer[(xy == 1) ? x + pad : y + pad];
+      for (int c = 0; c < num_channels; c++) {
+        elem[c] = padded_elem[c] * weight;
+      }
+      elem += num_channels;
+      padded_elem += num_channels;
+    }
+  }
+
+  delete mask;
+  delete padded;
+  return result;
+}
+
 void BlurBaseOperation::deinitExecution()
 {
   this->m_inputProgram = NULL;
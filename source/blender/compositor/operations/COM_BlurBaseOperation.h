@@ -23,6 +23,12 @@
 
 #define MAX_GAUSSTAB_RADIUS 30000
 
+/**
+ * Number of gauss table elements read per pixel from which a Gaussian blur is calculated by a
+ * recursive filter instead, see BlurBaseOperation.isRecursiveGauss.
+ */
+#define COM_BLUR_RECURSIVE_MIN_TAPS 128
+
 #ifdef __SSE2__
 #  include <emmintrin.h>
 #endif
@@ -37,6 +43,25 @@ class BlurBaseOperation : public NodeOperation, public QualityStepHelper {
 #endif
   float *make_dist_fac_inverse(float rad, int size, int falloff);
 
+  /**
+   * \brief is a blur along one axis faster with the recursive filter of
+   * FastGaussianBlurOperation than with the gauss table.
+   * Only Gaussian filters can be recursive. The gauss table is only read up to the image
+   * borders, so its cost is limited by the image size as well as the radius.
+   * \param filtersize: radius of the gauss table
+   * \param image_size: width or height of the image, along the axis of the blur
+   * \note only valid after initExecution
+   */
+  bool isRecursiveGauss(int filtersize, int image_size) const;
+
+  /**
+   * \brief blur a buffer with the recursive filter of FastGaussianBlurOperation, the way the
+   * gauss table of a radius blurs it
+   * \param xy: 1 blurs horizontally, 2 vertically
+   * \return a new buffer with the rect of the blurred buffer
+   */
+  MemoryBuffer *recursiveGauss(MemoryBuffer *buffer, float rad, unsigned int xy);
+
   void updateSize();
 
   /**
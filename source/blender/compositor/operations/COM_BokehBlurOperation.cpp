@@ -18,7 +18,9 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 #include "RE_pipeline.h"
 
@@ -39,6 +41,8 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
   this->m_inputBoundingBoxReader = NULL;
 
   this->m_extend_bounds = false;
+  this->m_useFFT = false;
+  this->m_fftResult = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -48,6 +52,12 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
     updateSize();
   }
   void *buffer = getInputOperation(0)->initializeTileData(NULL);
+  if (this->m_useFFT) {
+    if (this->m_fftResult == NULL) {
+      this->m_fftResult = convolveFFT((MemoryBuffer *)buffer);
+    }
+    buffer = this->m_fftResult;
+  }
   unlockMutex();
   return buffer;
 }
@@ -68,6 +78,92 @@ void BokehBlurOperation::initExecution()
   this->m_bokehMidY = height / 2.0f;
   this->m_bokehDimension = dimension / 2.0f;
   QualityStepHelper::initExecution(COM_QH_INCREASE);
+
+  /* The cost of the direct convolution grows with the number of bokeh elements read per pixel,
+   * which is limited by the image size. A size read from the input socket is only known once
+   * the input is calculated, the direct convolution is used then. */
+  if (this->m_sizeavailable) {
+    const float max_dim = max(this->getWidth(), this->getHeight());
+    const int pixelSize = this->m_size * max_dim / 100.0f;
+    const int step = this->getStep();
+    const int taps = (min(2 * pixelSize, (int)this->getWidth()) / step) *
+                     (min(2 * pixelSize, (int)this->getHeight()) / step);
+    this->m_useFFT = pixelSize >= 2 && taps >= COM_FFT_CONVOLUTION_MIN_TAPS;
+  }
+}
+
+MemoryBuffer *BokehBlurOperation::convolveFFT(MemoryBuffer *inputBuffer)
+{
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  const int pixelSize = this->m_size * max_dim / 100.0f;
+  const float m = this->m_bokehDimension / pixelSize;
+
+  /* Element (i, j) of the kernel weights the image at offset (pixelSize - i, pixelSize - j),
+   * offsets range from -pixelSize to pixelSize - 1 like in executePixel. */
+  const int kernelSize = 2 * pixelSize + 1;
+  rcti kernelRect;
+  BLI_rcti_init(&kernelRect, 0, kernelSize, 0, kernelSize);
+  MemoryBuffer *kernel = new MemoryBuffer(COM_DT_COLOR, &kernelRect);
+  for (int j = 0; j < kernelSize; j++) {
+    for (int i = 0; i < kernelSize; i++) {
+      float bokeh[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      if (i > 0 && j > 0) {
+        float u = this->m_bokehMidX - (pixelSize - i) * m;
+        float v = this->m_bokehMidY - (pixelSize - j) * m;
+        this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+      }
+      kernel->writePixel(i, j, bokeh);
+    }
+  }
+
+  MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+  FFTConvolution::convolve(result->getBuffer(), inputBuffer, kernel, COM_NUM_CHANNELS_COLOR);
+
+  /* Near the borders only part of the kernel overlaps the image, the result is divided by the
+   * sum of that part. The sums are read from a summed area table of the kernel, element
+   * (tx, ty) of the table is the sum of the weights of offsets below
+   * (tx - pixelSize, ty - pixelSize). */
+  const int tableSize = kernelSize;
+  double *table = (double *)MEM_callocN(
+      sizeof(double) * tableSize * tableSize * COM_NUM_CHANNELS_COLOR, __func__);
+  float *kernelBuffer = kernel->getBuffer();
+  for (int ty = 1; ty < tableSize; ty++) {
+    for (int tx = 1; tx < tableSize; tx++) {
+      const float *weight = &kernelBuffer[((kernelSize - ty) * kernelSize + kernelSize - tx) *
+                                          COM_NUM_CHANNELS_COLOR];
+      double *elem = &table[(ty * tableSize + tx) * COM_NUM_CHANNELS_COLOR];
+      const double *left = elem - COM_NUM_CHANNELS_COLOR;
+      const double *below = elem - tableSize * COM_NUM_CHANNELS_COLOR;
+      const double *below_left = below - COM_NUM_CHANNELS_COLOR;
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        elem[c] = weight[c] + left[c] + below[c] - below_left[c];
+      }
+    }
+  }
+
+  const rcti &rect = *inputBuffer->getRect();
+  float *elem = result->getBuffer();
+  for (int y = rect.ymin; y < rect.ymax; y++) {
+    const int ty0 = max(rect.ymin - y + pixelSize, 0);
+    const int ty1 = min(rect.ymax - y + pixelSize, tableSize - 1);
+    for (int x = rect.xmin; x < rect.xmax; x++) {
+      const int tx0 = max(rect.xmin - x + pixelSize, 0);
+      const int tx1 = min(rect.xmax - x + pixelSize, tableSize - 1);
+      const double *t00 = &table[(ty0 * tableSize + tx0) * COM_NUM_CHANNELS_COLOR];
+      const double *t01 = &table[(ty0 * tableSize + tx1) * COM_NUM_CHANNELS_COLOR];
+      const double *t10 = &table[(ty1 * tableSize + tx0) * COM_NUM_CHANNELS_COLOR];
+      const double *t11 = &table[(ty1 * tableSize + tx1) * COM_NUM_CHANNELS_COLOR];
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        const float multiplier = t11[c] - t10[c] - t01[c] + t00[c];
+        elem[c] *= 1.0f / multiplier;
+      }
+      elem += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+
+  MEM_freeN(table);
+  delete kernel;
+  return result;
 }
 
 void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
@@ -78,6 +174,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 
   this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
   if (tempBoundingBox[0] > 0.0f) {
+    if (this->m_useFFT) {
+      ((MemoryBuffer *)data)->read(output, x, y);
+      return;
+    }
     float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
     float *buffer = inputBuffer->getBuffer();
@@ -132,6 +232,11 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 
 void BokehBlurOperation::deinitExecution()
 {
+  if (this->m_fftResult) {
+    delete this->m_fftResult;
+    this->m_fftResult = NULL;
+  }
+  this->m_useFFT = false;
   deinitMutex();
   this->m_inputProgram = NULL;
   this->m_inputBokehProgram = NULL;
@@ -146,7 +251,13 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input,
   rcti bokehInput;
   const float max_dim = max(this->getWidth(), this->getHeight());
 
-  if (this->m_sizeavailable) {
+  if (this->m_useFFT) {
+    newInput.xmax = this->getWidth();
+    newInput.xmin = 0;
+    newInput.ymax = this->getHeight();
+    newInput.ymin = 0;
+  }
+  else if (this->m_sizeavailable) {
     newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
     newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
     newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
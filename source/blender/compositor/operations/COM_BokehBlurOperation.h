@@ -35,6 +35,11 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   float m_bokehDimension;
   bool m_extend_bounds;
 
+  /** convolved at once by FFTConvolution instead of per pixel, see initExecution */
+  bool m_useFFT;
+  MemoryBuffer *m_fftResult;
+  MemoryBuffer *convolveFFT(MemoryBuffer *inputBuffer);
+
  public:
   BokehBlurOperation();
 
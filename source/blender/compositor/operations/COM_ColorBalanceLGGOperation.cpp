@@ -17,6 +17,7 @@
  */
 
 #include "COM_ColorBalanceLGGOperation.h"
+#include "COM_BufferRow.h"
 #include "BLI_math.h"
 
 inline float colorbalance_lgg(float in, float lift_lgg, float gamma_inv, float gain)
@@ -44,6 +45,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation() : NodeOperation()
   this->m_inputValueOperation = NULL;
   this->m_inputColorOperation = NULL;
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrame(true);
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -52,6 +54,26 @@ void ColorBalanceLGGOperation::initExecution()
   this->m_inputColorOperation = this->getInputSocketReader(1);
 }
 
+inline void ColorBalanceLGGOperation::colorBalanceElem(float output[4],
+                                                       float value,
+                                                       const float inputColor[4])
+{
+  float fac = value;
+  fac = min(1.0f, fac);
+  const float mfac = 1.0f - fac;
+
+  float balanced[4];
+  for (int i = 0; i < 3; i++) {
+    balanced[i] = colorbalance_lgg(
+        inputColor[i], this->m_lift[i], this->m_gamma_inv[i], this->m_gain[i]);
+  }
+  balanced[3] = inputColor[3];
+
+  const RowVector color = RowVector::load(inputColor);
+  const RowVector result = mfac * color + fac * RowVector::load(balanced);
+  row_select(RowMask::alpha(), color, result).store(output);
+}
+
 void ColorBalanceLGGOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -63,20 +85,22 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4],
   this->m_inputValueOperation->readSampled(value, x, y, sampler);
   this->m_inputColorOperation->readSampled(inputColor, x, y, sampler);
 
-  float fac = value[0];
-  fac = min(1.0f, fac);
-  const float mfac = 1.0f - fac;
+  colorBalanceElem(output, value[0], inputColor);
+}
 
-  output[0] = mfac * inputColor[0] +
-              fac * colorbalance_lgg(
-                        inputColor[0], this->m_lift[0], this->m_gamma_inv[0], this->m_gain[0]);
-  output[1] = mfac * inputColor[1] +
-              fac * colorbalance_lgg(
-                        inputColor[1], this->m_lift[1], this->m_gamma_inv[1], this->m_gain[1]);
-  output[2] = mfac * inputColor[2] +
-              fac * colorbalance_lgg(
-                        inputColor[2], this->m_lift[2], this->m_gamma_inv[2], this->m_gain[2]);
-  output[3] = inputColor[3];
+void ColorBalanceLGGOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const BufferRow value(inputs[0], area->xmin, y);
+    const BufferRow color(inputs[1], area->xmin, y);
+    const BufferRow result(output, area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      colorBalanceElem(result.elem(i), value.elem(i)[0], color.elem(i));
+    }
+  }
 }
 
 void ColorBalanceLGGOperation::deinitExecution()
@@ -36,6 +36,8 @@ class ColorBalanceLGGOperation : public NodeOperation {
   float m_lift[3];
   float m_gamma_inv[3];
 
+  inline void colorBalanceElem(float output[4], float value, const float inputColor[4]);
+
  public:
   /**
    * Default constructor
@@ -46,6 +48,7 @@ class ColorBalanceLGGOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 
   /**
    * Initialize the execution
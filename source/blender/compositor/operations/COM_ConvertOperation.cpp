@@ -23,6 +23,7 @@
 ConvertBaseOperation::ConvertBaseOperation()
 {
   this->m_inputOperation = NULL;
+  this->setFullFrame(true);
 }
 
 void ConvertBaseOperation::initExecution()
@@ -35,6 +36,39 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = NULL;
 }
 
+void ConvertBaseOperation::executePixelSampled(float output[4],
+                                               float x,
+                                               float y,
+                                               PixelSampler sampler)
+{
+  float input[4];
+  this->m_inputOperation->readSampled(input, x, y, sampler);
+  convertPixel(output, input);
+}
+
+template<typename Operation>
+void ConvertBaseOperation::executeConvertRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  Operation *operation = static_cast<Operation *>(this);
+  MemoryBuffer *input = inputs[0];
+  const int input_stride = input->getElemStride();
+  const int output_channels = output->get_num_channels();
+  float result[4];
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *in = input->getElem(area->xmin, y);
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      /* qualified call, so the conversion is inlined instead of a virtual call per pixel */
+      operation->Operation::convertPixel(result, in);
+      memcpy(out, result, sizeof(float) * output_channels);
+      in += input_stride;
+      out += output_channels;
+    }
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
@@ -43,17 +77,19 @@ ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperat
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertValueToColorOperation::executePixelSampled(float output[4],
-                                                       float x,
-                                                       float y,
-                                                       PixelSampler sampler)
+void ConvertValueToColorOperation::convertPixel(float output[4], const float input[4])
 {
-  float value;
-  this->m_inputOperation->readSampled(&value, x, y, sampler);
-  output[0] = output[1] = output[2] = value;
+  output[0] = output[1] = output[2] = input[0];
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeBufferRegion(MemoryBuffer *output,
+                                                       const rcti *area,
+                                                       MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertValueToColorOperation>(output, area, inputs);
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
@@ -62,14 +98,16 @@ ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperat
   this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertColorToValueOperation::executePixelSampled(float output[4],
-                                                       float x,
-                                                       float y,
-                                                       PixelSampler sampler)
+void ConvertColorToValueOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
+  output[0] = (input[0] + input[1] + input[2]) / 3.0f;
+}
+
+void ConvertColorToValueOperation::executeBufferRegion(MemoryBuffer *output,
+                                                       const rcti *area,
+                                                       MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertColorToValueOperation>(output, area, inputs);
 }
 
 /* ******** Color to BW ******** */
@@ -80,14 +118,16 @@ ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
   this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertColorToBWOperation::executePixelSampled(float output[4],
-                                                    float x,
-                                                    float y,
-                                                    PixelSampler sampler)
+void ConvertColorToBWOperation::convertPixel(float output[4], const float input[4])
+{
+  output[0] = IMB_colormanagement_get_luminance(input);
+}
+
+void ConvertColorToBWOperation::executeBufferRegion(MemoryBuffer *output,
+                                                    const rcti *area,
+                                                    MemoryBuffer **inputs)
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  output[0] = IMB_colormanagement_get_luminance(inputColor);
+  executeConvertRegion<ConvertColorToBWOperation>(output, area, inputs);
 }
 
 /* ******** Color to Vector ******** */
@@ -98,14 +138,16 @@ ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOper
   this->addOutputSocket(COM_DT_VECTOR);
 }
 
-void ConvertColorToVectorOperation::executePixelSampled(float output[4],
-                                                        float x,
-                                                        float y,
-                                                        PixelSampler sampler)
+void ConvertColorToVectorOperation::convertPixel(float output[4], const float input[4])
 {
-  float color[4];
-  this->m_inputOperation->readSampled(color, x, y, sampler);
-  copy_v3_v3(output, color);
+  copy_v3_v3(output, input);
+}
+
+void ConvertColorToVectorOperation::executeBufferRegion(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertColorToVectorOperation>(output, area, inputs);
 }
 
 /* ******** Value to Vector ******** */
@@ -116,14 +158,16 @@ ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOper
   this->addOutputSocket(COM_DT_VECTOR);
 }
 
-void ConvertValueToVectorOperation::executePixelSampled(float output[4],
-                                                        float x,
-                                                        float y,
-                                                        PixelSampler sampler)
+void ConvertValueToVectorOperation::convertPixel(float output[4], const float input[4])
+{
+  output[0] = output[1] = output[2] = input[0];
+}
+
+void ConvertValueToVectorOperation::executeBufferRegion(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
 {
-  float value;
-  this->m_inputOperation->readSampled(&value, x, y, sampler);
-  output[0] = output[1] = output[2] = value;
+  executeConvertRegion<ConvertValueToVectorOperation>(output, area, inputs);
 }
 
 /* ******** Vector to Color ******** */
@@ -134,15 +178,19 @@ ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOper
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertVectorToColorOperation::executePixelSampled(float output[4],
-                                                        float x,
-                                                        float y,
-                                                        PixelSampler sampler)
+void ConvertVectorToColorOperation::convertPixel(float output[4], const float input[4])
 {
-  this->m_inputOperation->readSampled(output, x, y, sampler);
+  copy_v3_v3(output, input);
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeBufferRegion(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertVectorToColorOperation>(output, area, inputs);
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
@@ -151,16 +199,18 @@ ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOper
   this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertVectorToValueOperation::executePixelSampled(float output[4],
-                                                        float x,
-                                                        float y,
-                                                        PixelSampler sampler)
+void ConvertVectorToValueOperation::convertPixel(float output[4], const float input[4])
 {
-  float input[4];
-  this->m_inputOperation->readSampled(input, x, y, sampler);
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeBufferRegion(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertVectorToValueOperation>(output, area, inputs);
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -185,22 +235,23 @@ void ConvertRGBToYCCOperation::setMode(int mode)
   }
 }
 
-void ConvertRGBToYCCOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void ConvertRGBToYCCOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
   float color[3];
 
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  rgb_to_ycc(
-      inputColor[0], inputColor[1], inputColor[2], &color[0], &color[1], &color[2], this->m_mode);
+  rgb_to_ycc(input[0], input[1], input[2], &color[0], &color[1], &color[2], this->m_mode);
 
   /* divided by 255 to normalize for viewing in */
   /* R,G,B --> Y,Cb,Cr */
   mul_v3_v3fl(output, color, 1.0f / 255.0f);
-  output[3] = inputColor[3];
+  output[3] = input[3];
+}
+
+void ConvertRGBToYCCOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertRGBToYCCOperation>(output, area, inputs);
 }
 
 /* ******** YCC to RGB ******** */
@@ -227,17 +278,13 @@ void ConvertYCCToRGBOperation::setMode(int mode)
   }
 }
 
-void ConvertYCCToRGBOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void ConvertYCCToRGBOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
+  float inputColor[3];
 
   /* need to un-normalize the data */
   /* R,G,B --> Y,Cb,Cr */
-  mul_v3_fl(inputColor, 255.0f);
+  mul_v3_v3fl(inputColor, input, 255.0f);
 
   ycc_to_rgb(inputColor[0],
              inputColor[1],
@@ -246,7 +293,14 @@ void ConvertYCCToRGBOperation::executePixelSampled(float output[4],
              &output[1],
              &output[2],
              this->m_mode);
-  output[3] = inputColor[3];
+  output[3] = input[3];
+}
+
+void ConvertYCCToRGBOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertYCCToRGBOperation>(output, area, inputs);
 }
 
 /* ******** RGB to YUV ******** */
@@ -257,21 +311,17 @@ ConvertRGBToYUVOperation::ConvertRGBToYUVOperation() : ConvertBaseOperation()
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertRGBToYUVOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void ConvertRGBToYUVOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  rgb_to_yuv(inputColor[0],
-             inputColor[1],
-             inputColor[2],
-             &output[0],
-             &output[1],
-             &output[2],
-             BLI_YUV_ITU_BT709);
-  output[3] = inputColor[3];
+  rgb_to_yuv(input[0], input[1], input[2], &output[0], &output[1], &output[2], BLI_YUV_ITU_BT709);
+  output[3] = input[3];
+}
+
+void ConvertRGBToYUVOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertRGBToYUVOperation>(output, area, inputs);
 }
 
 /* ******** YUV to RGB ******** */
@@ -282,21 +332,17 @@ ConvertYUVToRGBOperation::ConvertYUVToRGBOperation() : ConvertBaseOperation()
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertYUVToRGBOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void ConvertYUVToRGBOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  yuv_to_rgb(inputColor[0],
-             inputColor[1],
-             inputColor[2],
-             &output[0],
-             &output[1],
-             &output[2],
-             BLI_YUV_ITU_BT709);
-  output[3] = inputColor[3];
+  yuv_to_rgb(input[0], input[1], input[2], &output[0], &output[1], &output[2], BLI_YUV_ITU_BT709);
+  output[3] = input[3];
+}
+
+void ConvertYUVToRGBOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertYUVToRGBOperation>(output, area, inputs);
 }
 
 /* ******** RGB to HSV ******** */
@@ -307,15 +353,17 @@ ConvertRGBToHSVOperation::ConvertRGBToHSVOperation() : ConvertBaseOperation()
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertRGBToHSVOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void ConvertRGBToHSVOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  rgb_to_hsv_v(inputColor, output);
-  output[3] = inputColor[3];
+  rgb_to_hsv_v(input, output);
+  output[3] = input[3];
+}
+
+void ConvertRGBToHSVOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertRGBToHSVOperation>(output, area, inputs);
 }
 
 /* ******** HSV to RGB ******** */
@@ -326,18 +374,20 @@ ConvertHSVToRGBOperation::ConvertHSVToRGBOperation() : ConvertBaseOperation()
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertHSVToRGBOperation::executePixelSampled(float output[4],
-                                                   float x,
-                                                   float y,
-                                                   PixelSampler sampler)
+void ConvertHSVToRGBOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputColor[4];
-  this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-  hsv_to_rgb_v(inputColor, output);
+  hsv_to_rgb_v(input, output);
   output[0] = max_ff(output[0], 0.0f);
   output[1] = max_ff(output[1], 0.0f);
   output[2] = max_ff(output[2], 0.0f);
-  output[3] = inputColor[3];
+  output[3] = input[3];
+}
+
+void ConvertHSVToRGBOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertHSVToRGBOperation>(output, area, inputs);
 }
 
 /* ******** Premul to Straight ******** */
@@ -348,28 +398,28 @@ ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBa
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertPremulToStraightOperation::executePixelSampled(float output[4],
-                                                           float x,
-                                                           float y,
-                                                           PixelSampler sampler)
+void ConvertPremulToStraightOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputValue[4];
-  float alpha;
-
-  this->m_inputOperation->readSampled(inputValue, x, y, sampler);
-  alpha = inputValue[3];
+  const float alpha = input[3];
 
   if (fabsf(alpha) < 1e-5f) {
     zero_v3(output);
   }
   else {
-    mul_v3_v3fl(output, inputValue, 1.0f / alpha);
+    mul_v3_v3fl(output, input, 1.0f / alpha);
   }
 
   /* never touches the alpha */
   output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::executeBufferRegion(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertPremulToStraightOperation>(output, area, inputs);
+}
+
 /* ******** Straight to Premul ******** */
 
 ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBaseOperation()
@@ -378,23 +428,23 @@ ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBa
   this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertStraightToPremulOperation::executePixelSampled(float output[4],
-                                                           float x,
-                                                           float y,
-                                                           PixelSampler sampler)
+void ConvertStraightToPremulOperation::convertPixel(float output[4], const float input[4])
 {
-  float inputValue[4];
-  float alpha;
-
-  this->m_inputOperation->readSampled(inputValue, x, y, sampler);
-  alpha = inputValue[3];
+  const float alpha = input[3];
 
-  mul_v3_v3fl(output, inputValue, alpha);
+  mul_v3_v3fl(output, input, alpha);
 
   /* never touches the alpha */
   output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::executeBufferRegion(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  executeConvertRegion<ConvertStraightToPremulOperation>(output, area, inputs);
+}
+
 /* ******** Separate Channels ******** */
 
 SeparateChannelOperation::SeparateChannelOperation() : NodeOperation()
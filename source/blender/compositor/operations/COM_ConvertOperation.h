@@ -25,9 +25,22 @@ class ConvertBaseOperation : public NodeOperation {
  protected:
   SocketReader *m_inputOperation;
 
+  /**
+   * Convert a single pixel, shared by the pixel and the buffer execution.
+   */
+  virtual void convertPixel(float output[4], const float input[4]) = 0;
+
+  /**
+   * executeBufferRegion of a derived operation, calling its convertPixel for every pixel.
+   */
+  template<typename Operation>
+  void executeConvertRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
  public:
   ConvertBaseOperation();
 
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
   void initExecution();
   void deinitExecution();
 };
@@ -36,49 +49,56 @@ class ConvertValueToColorOperation : public ConvertBaseOperation {
  public:
   ConvertValueToColorOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertColorToValueOperation : public ConvertBaseOperation {
  public:
   ConvertColorToValueOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertColorToBWOperation : public ConvertBaseOperation {
  public:
   ConvertColorToBWOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertColorToVectorOperation : public ConvertBaseOperation {
  public:
   ConvertColorToVectorOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertValueToVectorOperation : public ConvertBaseOperation {
  public:
   ConvertValueToVectorOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertVectorToColorOperation : public ConvertBaseOperation {
  public:
   ConvertVectorToColorOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertVectorToValueOperation : public ConvertBaseOperation {
  public:
   ConvertVectorToValueOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertRGBToYCCOperation : public ConvertBaseOperation {
@@ -89,7 +109,8 @@ class ConvertRGBToYCCOperation : public ConvertBaseOperation {
  public:
   ConvertRGBToYCCOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 
   /** Set the YCC mode */
   void setMode(int mode);
@@ -103,7 +124,8 @@ class ConvertYCCToRGBOperation : public ConvertBaseOperation {
  public:
   ConvertYCCToRGBOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 
   /** Set the YCC mode */
   void setMode(int mode);
@@ -113,42 +135,48 @@ class ConvertRGBToYUVOperation : public ConvertBaseOperation {
  public:
   ConvertRGBToYUVOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertYUVToRGBOperation : public ConvertBaseOperation {
  public:
   ConvertYUVToRGBOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertRGBToHSVOperation : public ConvertBaseOperation {
  public:
   ConvertRGBToHSVOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertHSVToRGBOperation : public ConvertBaseOperation {
  public:
   ConvertHSVToRGBOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertPremulToStraightOperation : public ConvertBaseOperation {
  public:
   ConvertPremulToStraightOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertStraightToPremulOperation : public ConvertBaseOperation {
  public:
   ConvertStraightToPremulOperation();
 
-  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void convertPixel(float output[4], const float input[4]);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class SeparateChannelOperation : public NodeOperation {
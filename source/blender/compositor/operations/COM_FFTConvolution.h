@@ -0,0 +1,50 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_FFTCONVOLUTION_H__
+#define __COM_FFTCONVOLUTION_H__
+#include "COM_MemoryBuffer.h"
+
+/**
+ * Number of kernel elements read per pixel from which a direct convolution is slower than
+ * the FFT convolution of the whole image.
+ */
+#define COM_FFT_CONVOLUTION_MIN_TAPS 32
+
+/**
+ * \brief convolution with large kernels, using the Fast Hartley Transform.
+ *
+ * The image is split in blocks that are transformed and convolved separately, the results are
+ * added to each other where the blocks overlap. The blocks are calculated by the BLI task
+ * scheduler, the cost per pixel only grows with the logarithm of the kernel size.
+ * \ingroup Operation
+ */
+class FFTConvolution {
+ public:
+  /**
+   * \brief convolve the first channels of a color image with a color kernel
+   * \param dst: result of the size of the image, channels after num_channels are set to 0
+   * \param image: the image to convolve
+   * \param kernel: element (i, j) is the weight of the image element at offset
+   * (kernel_width / 2 - i, kernel_height / 2 - j). The kernel is not normalized.
+   * \param num_channels: number of channels to convolve
+   */
+  static void convolve(float *dst, MemoryBuffer *image, MemoryBuffer *kernel, int num_channels);
+};
+
+#endif
@@ -18,6 +18,7 @@
 
 #include <limits.h>
 
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "COM_FastGaussianBlurOperation.h"
 #include "MEM_guardedalloc.h"
@@ -111,19 +112,99 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
   return this->m_iirgaus;
 }
 
+/* number of lines filtered by a single task */
+#define COM_IIR_GAUSS_TASK_LINES 16
+
+typedef struct IIRGaussTaskData {
+  double cf[4], tsM[9];
+  float *buffer;
+  unsigned int src_width;
+  unsigned int src_height;
+  unsigned int num_channels;
+  unsigned int chan;
+  /* filter columns instead of rows */
+  bool vertical;
+} IIRGaussTaskData;
+
+static void IIR_gauss_task(void *__restrict userdata,
+                           const int index,
+                           const TaskParallelTLS *__restrict /*tls*/)
+{
+  const IIRGaussTaskData *data = (const IIRGaussTaskData *)userdata;
+  const double *cf = data->cf;
+  const double *tsM = data->tsM;
+  double tsu[3], tsv[3];
+  double *X, *Y, *W;
+  float *buffer = data->buffer;
+  const unsigned int num_channels = data->num_channels;
+  unsigned int i;
+
+#define YVV(L) \
+  { \
+    W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0]; \
+    W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0]; \
+    W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0]; \
+    for (i = 3; i < L; i++) { \
+      W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3]; \
+    } \
+    tsu[0] = W[L - 1] - X[L - 1]; \
+    tsu[1] = W[L - 2] - X[L - 1]; \
+    tsu[2] = W[L - 3] - X[L - 1]; \
+    tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1]; \
+    tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1]; \
+    tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1]; \
+    Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2]; \
+    Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1]; \
+    Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0]; \
+    /* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */ \
+    for (i = L - 4; i != UINT_MAX; i--) { \
+      Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3]; \
+    } \
+  } \
+  (void)0
+
+  /* the lines are rows, or columns when filtering vertically */
+  const unsigned int len = data->vertical ? data->src_height : data->src_width;
+  const unsigned int num_lines = data->vertical ? data->src_width : data->src_height;
+  const unsigned int line_add = data->vertical ? num_channels : data->src_width * num_channels;
+  const unsigned int add = data->vertical ? data->src_width * num_channels : num_channels;
+  const unsigned int line_start = index * COM_IIR_GAUSS_TASK_LINES;
+  const unsigned int line_end = min(line_start + COM_IIR_GAUSS_TASK_LINES, num_lines);
+
+  // intermediate buffers
+  X = (double *)MEM_callocN(len * sizeof(double), "IIR_gauss X buf");
+  Y = (double *)MEM_callocN(len * sizeof(double), "IIR_gauss Y buf");
+  W = (double *)MEM_callocN(len * sizeof(double), "IIR_gauss W buf");
+  for (unsigned int line = line_start; line < line_end; line++) {
+    int offset = line * line_add + data->chan;
+    for (i = 0; i < len; i++) {
+      X[i] = buffer[offset];
+      offset += add;
+    }
+    YVV(len);
+    offset = line * line_add + data->chan;
+    for (i = 0; i < len; i++) {
+      buffer[offset] = Y[i];
+      offset += add;
+    }
+  }
+
+  MEM_freeN(X);
+  MEM_freeN(W);
+  MEM_freeN(Y);
+#undef YVV
+}
+
 void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
                                           float sigma,
                                           unsigned int chan,
                                           unsigned int xy)
 {
-  double q, q2, sc, cf[4], tsM[9], tsu[3], tsv[3];
-  double *X, *Y, *W;
+  double q, q2, sc;
+  IIRGaussTaskData data;
+  double *cf = data.cf, *tsM = data.tsM;
   const unsigned int src_width = src->getWidth();
   const unsigned int src_height = src->getHeight();
-  unsigned int x, y, sz;
-  unsigned int i;
-  float *buffer = src->getBuffer();
-  const unsigned int num_channels = src->get_num_channels();
 
   // <0.5 not valid, though can have a possibly useful sort of sharpening effect
   if (sigma < 0.5f) {
@@ -134,7 +215,7 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
     xy = 3;
   }
 
-  // XXX The YVV macro defined below explicitly expects sources of at least 3x3 pixels,
+  // XXX The YVV macro defined above explicitly expects sources of at least 3x3 pixels,
   //     so just skipping blur along faulty direction if src's def is below that limit!
   if (src_width < 3) {
     xy &= ~1;
@@ -185,75 +266,32 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src,
                  cf[3] * cf[3] * cf[3] - cf[3] * cf[2] + cf[3]);
   tsM[8] = sc * (cf[3] * (cf[1] + cf[3] * cf[2]));
 
-#define YVV(L) \
-  { \
-    W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0]; \
-    W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0]; \
-    W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0]; \
-    for (i = 3; i < L; i++) { \
-      W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3]; \
-    } \
-    tsu[0] = W[L - 1] - X[L - 1]; \
-    tsu[1] = W[L - 2] - X[L - 1]; \
-    tsu[2] = W[L - 3] - X[L - 1]; \
-    tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1]; \
-    tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1]; \
-    tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1]; \
-    Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2]; \
-    Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1]; \
-    Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0]; \
-    /* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */ \
-    for (i = L - 4; i != UINT_MAX; i--) { \
-      Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3]; \
-    } \
-  } \
-  (void)0
+  data.buffer = src->getBuffer();
+  data.src_width = src_width;
+  data.src_height = src_height;
+  data.num_channels = src->get_num_channels();
+  data.chan = chan;
 
-  // intermediate buffers
-  sz = max(src_width, src_height);
-  X = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss X buf");
-  Y = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss Y buf");
-  W = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss W buf");
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
   if (xy & 1) {  // H
-    int offset;
-    for (y = 0; y < src_height; y++) {
-      const int yx = y * src_width;
-      offset = yx * num_channels + chan;
-      for (x = 0; x < src_width; x++) {
-        X[x] = buffer[offset];
-        offset += num_channels;
-      }
-      YVV(src_width);
-      offset = yx * num_channels + chan;
-      for (x = 0; x < src_width; x++) {
-        buffer[offset] = Y[x];
-        offset += num_channels;
-      }
-    }
+    data.vertical = false;
+    BLI_task_parallel_range(0,
+                            (src_height + COM_IIR_GAUSS_TASK_LINES - 1) /
+                                COM_IIR_GAUSS_TASK_LINES,
+                            &data,
+                            IIR_gauss_task,
+                            &settings);
   }
   if (xy & 2) {  // V
-    int offset;
-    const int add = src_width * num_channels;
-
-    for (x = 0; x < src_width; x++) {
-      offset = x * num_channels + chan;
-      for (y = 0; y < src_height; y++) {
-        X[y] = buffer[offset];
-        offset += add;
-      }
-      YVV(src_height);
-      offset = x * num_channels + chan;
-      for (y = 0; y < src_height; y++) {
-        buffer[offset] = Y[y];
-        offset += add;
-      }
-    }
+    data.vertical = true;
+    BLI_task_parallel_range(0,
+                            (src_width + COM_IIR_GAUSS_TASK_LINES - 1) /
+                                COM_IIR_GAUSS_TASK_LINES,
+                            &data,
+                            IIR_gauss_task,
+                            &settings);
   }
-
-  MEM_freeN(X);
-  MEM_freeN(W);
-  MEM_freeN(Y);
-#undef YVV
 }
 
 ///
@@ -17,6 +17,7 @@
  */
 
 #include "COM_GammaOperation.h"
+#include "COM_BufferRow.h"
 #include "BLI_math.h"
 
 GammaOperation::GammaOperation() : NodeOperation()
@@ -26,6 +27,7 @@ GammaOperation::GammaOperation() : NodeOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputProgram = NULL;
   this->m_inputGammaProgram = NULL;
+  this->setFullFrame(true);
 }
 void GammaOperation::initExecution()
 {
@@ -33,6 +35,16 @@ void GammaOperation::initExecution()
   this->m_inputGammaProgram = this->getInputSocketReader(1);
 }
 
+static void gamma_elem(float output[4], const float inputValue[4], const float gamma)
+{
+  /* check for negative to avoid nan's */
+  output[0] = inputValue[0] > 0.0f ? powf(inputValue[0], gamma) : inputValue[0];
+  output[1] = inputValue[1] > 0.0f ? powf(inputValue[1], gamma) : inputValue[1];
+  output[2] = inputValue[2] > 0.0f ? powf(inputValue[2], gamma) : inputValue[2];
+
+  output[3] = inputValue[3];
+}
+
 void GammaOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue[4];
@@ -40,13 +52,22 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
 
   this->m_inputProgram->readSampled(inputValue, x, y, sampler);
   this->m_inputGammaProgram->readSampled(inputGamma, x, y, sampler);
-  const float gamma = inputGamma[0];
-  /* check for negative to avoid nan's */
-  output[0] = inputValue[0] > 0.0f ? powf(inputValue[0], gamma) : inputValue[0];
-  output[1] = inputValue[1] > 0.0f ? powf(inputValue[1], gamma) : inputValue[1];
-  output[2] = inputValue[2] > 0.0f ? powf(inputValue[2], gamma) : inputValue[2];
+  gamma_elem(output, inputValue, inputGamma[0]);
+}
 
-  output[3] = inputValue[3];
+void GammaOperation::executeBufferRegion(MemoryBuffer *output,
+                                         const rcti *area,
+                                         MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const BufferRow color(inputs[0], area->xmin, y);
+    const BufferRow gamma(inputs[1], area->xmin, y);
+    const BufferRow result(output, area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      gamma_elem(result.elem(i), color.elem(i), gamma.elem(i)[0]);
+    }
+  }
 }
 
 void GammaOperation::deinitExecution()
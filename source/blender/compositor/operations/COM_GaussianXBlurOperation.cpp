@@ -30,6 +30,8 @@ GaussianXBlurOperation::GaussianXBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->m_recursive = false;
+  this->m_iirgaus = NULL;
 }
 
 void *GaussianXBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -39,6 +41,13 @@ void *GaussianXBlurOperation::initializeTileData(rcti * /*rect*/)
     updateGauss();
   }
   void *buffer = getInputOperation(0)->initializeTileData(NULL);
+  if (this->m_recursive) {
+    if (this->m_iirgaus == NULL) {
+      float rad = max_ff(m_size * m_data.sizex, 0.0f);
+      this->m_iirgaus = recursiveGauss((MemoryBuffer *)buffer, rad, 1);
+    }
+    buffer = this->m_iirgaus;
+  }
   unlockMutex();
   return buffer;
 }
@@ -58,6 +67,7 @@ void GaussianXBlurOperation::initExecution()
 #ifdef __SSE2__
     this->m_gausstab_sse = BlurBaseOperation::convert_gausstab_sse(this->m_gausstab, m_filtersize);
 #endif
+    this->m_recursive = isRecursiveGauss(m_filtersize, this->getWidth());
   }
 }
 
@@ -72,11 +82,17 @@ void GaussianXBlurOperation::updateGauss()
 #ifdef __SSE2__
     this->m_gausstab_sse = BlurBaseOperation::convert_gausstab_sse(this->m_gausstab, m_filtersize);
 #endif
+    this->m_recursive = isRecursiveGauss(m_filtersize, this->getWidth());
   }
 }
 
 void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+  if (this->m_recursive) {
+    ((MemoryBuffer *)data)->read(output, x, y);
+    return;
+  }
+
   float ATTR_ALIGN(16) color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
   float multiplier_accum = 0.0f;
   MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
@@ -168,6 +184,12 @@ void GaussianXBlurOperation::deinitExecution()
   }
 #endif
 
+  if (this->m_iirgaus) {
+    delete this->m_iirgaus;
+    this->m_iirgaus = NULL;
+  }
+  this->m_recursive = false;
+
   deinitMutex();
 }
 
@@ -189,7 +211,8 @@ bool GaussianXBlurOperation::determineDependingAreaOfInterest(rcti *input,
     }
   }
   {
-    if (this->m_sizeavailable && this->m_gausstab != NULL) {
+    /* the recursive filter blurs the whole image at once, see initializeTileData */
+    if (this->m_sizeavailable && this->m_gausstab != NULL && !this->m_recursive) {
       newInput.xmax = input->xmax + this->m_filtersize + 1;
       newInput.xmin = input->xmin - this->m_filtersize - 1;
       newInput.ymax = input->ymax;
@@ -28,6 +28,9 @@ class GaussianXBlurOperation : public BlurBaseOperation {
   __m128 *m_gausstab_sse;
 #endif
   int m_filtersize;
+  /** blurred by the recursive filter instead of the gauss table, see isRecursiveGauss */
+  bool m_recursive;
+  MemoryBuffer *m_iirgaus;
   void updateGauss();
 
  public:
@@ -30,6 +30,8 @@ GaussianYBlurOperation::GaussianYBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->m_recursive = false;
+  this->m_iirgaus = NULL;
 }
 
 void *GaussianYBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -39,6 +41,13 @@ void *GaussianYBlurOperation::initializeTileData(rcti * /*rect*/)
     updateGauss();
   }
   void *buffer = getInputOperation(0)->initializeTileData(NULL);
+  if (this->m_recursive) {
+    if (this->m_iirgaus == NULL) {
+      float rad = max_ff(m_size * m_data.sizey, 0.0f);
+      this->m_iirgaus = recursiveGauss((MemoryBuffer *)buffer, rad, 2);
+    }
+    buffer = this->m_iirgaus;
+  }
   unlockMutex();
   return buffer;
 }
@@ -57,6 +66,7 @@ void GaussianYBlurOperation::initExecution()
 #ifdef __SSE2__
     this->m_gausstab_sse = BlurBaseOperation::convert_gausstab_sse(this->m_gausstab, m_filtersize);
 #endif
+    this->m_recursive = isRecursiveGauss(m_filtersize, this->getHeight());
   }
 }
 
@@ -71,11 +81,17 @@ void GaussianYBlurOperation::updateGauss()
 #ifdef __SSE2__
     this->m_gausstab_sse = BlurBaseOperation::convert_gausstab_sse(this->m_gausstab, m_filtersize);
 #endif
+    this->m_recursive = isRecursiveGauss(m_filtersize, this->getHeight());
   }
 }
 
 void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+  if (this->m_recursive) {
+    ((MemoryBuffer *)data)->read(output, x, y);
+    return;
+  }
+
   float ATTR_ALIGN(16) color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
   float multiplier_accum = 0.0f;
   MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
@@ -168,6 +184,12 @@ void GaussianYBlurOperation::deinitExecution()
   }
 #endif
 
+  if (this->m_iirgaus) {
+    delete this->m_iirgaus;
+    this->m_iirgaus = NULL;
+  }
+  this->m_recursive = false;
+
   deinitMutex();
 }
 
@@ -189,7 +211,8 @@ bool GaussianYBlurOperation::determineDependingAreaOfInterest(rcti *input,
     }
   }
   {
-    if (this->m_sizeavailable && this->m_gausstab != NULL) {
+    /* the recursive filter blurs the whole image at once, see initializeTileData */
+    if (this->m_sizeavailable && this->m_gausstab != NULL && !this->m_recursive) {
       newInput.xmax = input->xmax;
       newInput.xmin = input->xmin;
       newInput.ymax = input->ymax + this->m_filtersize + 1;
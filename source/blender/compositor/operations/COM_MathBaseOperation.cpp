@@ -30,6 +30,7 @@ MathBaseOperation::MathBaseOperation() : NodeOperation()
   this->m_inputValue2Operation = NULL;
   this->m_inputValue3Operation = NULL;
   this->m_useClamp = false;
+  this->setFullFrame(true);
 }
 
 void MathBaseOperation::initExecution()
@@ -71,33 +72,128 @@ void MathBaseOperation::clampIfNeeded(float *color)
   }
 }
 
-void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+template<MathBaseOperation::MathFunction calculate, int num_inputs>
+void MathBaseOperation::executeMathPixel(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue1[4];
   float inputValue2[4];
+  float inputValue3[4];
 
   this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  if (num_inputs > 1) {
+    this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  }
+  else {
+    inputValue2[0] = 0.0f;
+  }
+  if (num_inputs > 2) {
+    this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
+  }
+  else {
+    inputValue3[0] = 0.0f;
+  }
 
-  output[0] = inputValue1[0] + inputValue2[0];
+  output[0] = calculate(inputValue1[0], inputValue2[0], inputValue3[0]);
 
   clampIfNeeded(output);
 }
 
+template<MathBaseOperation::MathFunction calculate>
+void MathBaseOperation::executeMathRegion(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const BufferRow value1(inputs[0], area->xmin, y);
+    const BufferRow value2(inputs[1], area->xmin, y);
+    const BufferRow value3(inputs[2], area->xmin, y);
+    const BufferRow result(output, area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      float *elem = result.elem(i);
+      elem[0] = calculate(value1.elem(i)[0], value2.elem(i)[0], value3.elem(i)[0]);
+      clampIfNeeded(elem);
+    }
+  }
+}
+
+template<MathBaseOperation::MathFunction calculate,
+         MathBaseOperation::MathVectorFunction calculate_vector>
+void MathBaseOperation::executeMathVectorRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  /* vectors are loaded from contiguous values or from single elements */
+  if (output->getElemStride() != 1 || inputs[0]->getElemStride() > 1 ||
+      inputs[1]->getElemStride() > 1 || inputs[2]->getElemStride() > 1) {
+    executeMathRegion<calculate>(output, area, inputs);
+    return;
+  }
+
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const BufferRow value1(inputs[0], area->xmin, y);
+    const BufferRow value2(inputs[1], area->xmin, y);
+    const BufferRow value3(inputs[2], area->xmin, y);
+    const BufferRow result(output, area->xmin, y);
+    int i = 0;
+    for (; i + 4 <= width; i += 4) {
+      RowVector values = calculate_vector(
+          value1.loadValues(i), value2.loadValues(i), value3.loadValues(i));
+      if (this->m_useClamp) {
+        values = row_clamp(values);
+      }
+      values.store(result.elem(i));
+    }
+    /* remaining elements of the row */
+    for (; i < width; i++) {
+      float *elem = result.elem(i);
+      elem[0] = calculate(value1.elem(i)[0], value2.elem(i)[0], value3.elem(i)[0]);
+      clampIfNeeded(elem);
+    }
+  }
+}
+
+template<typename T> static T math_add(T value1, T value2, T /*value3*/)
+{
+  return value1 + value2;
+}
+
+void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+  executeMathPixel<math_add, 2>(output, x, y, sampler);
+}
+
+void MathAddOperation::executeBufferRegion(MemoryBuffer *output,
+                                           const rcti *area,
+                                           MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_add, math_add>(output, area, inputs);
+}
+
+template<typename T> static T math_subtract(T value1, T value2, T /*value3*/)
+{
+  return value1 - value2;
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_subtract, 2>(output, x, y, sampler);
+}
 
-  output[0] = inputValue1[0] - inputValue2[0];
+void MathSubtractOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_subtract, math_subtract>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_multiply(T value1, T value2, T /*value3*/)
+{
+  return value1 * value2;
 }
 
 void MathMultiplyOperation::executePixelSampled(float output[4],
@@ -105,15 +201,20 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_multiply, 2>(output, x, y, sampler);
+}
 
-  output[0] = inputValue1[0] * inputValue2[0];
+void MathMultiplyOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_multiply, math_multiply>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_divide(T value1, T value2, T /*value3*/)
+{
+  /* We don't want to divide by zero. */
+  return row_select(value2 == 0.0f, T(0.0f), value1 / value2);
 }
 
 void MathDivideOperation::executePixelSampled(float output[4],
@@ -121,20 +222,19 @@ void MathDivideOperation::executePixelSampled(float output[4],
                                               float y,
                                               PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_divide, 2>(output, x, y, sampler);
+}
 
-  if (inputValue2[0] == 0) { /* We don't want to divide by zero. */
-    output[0] = 0.0;
-  }
-  else {
-    output[0] = inputValue1[0] / inputValue2[0];
-  }
+void MathDivideOperation::executeBufferRegion(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_divide, math_divide>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_sine(float value1, float /*value2*/, float /*value3*/)
+{
+  return sin(value1);
 }
 
 void MathSineOperation::executePixelSampled(float output[4],
@@ -142,15 +242,19 @@ void MathSineOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_sine, 1>(output, x, y, sampler);
+}
 
-  output[0] = sin(inputValue1[0]);
+void MathSineOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMathRegion<math_sine>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_cosine(float value1, float /*value2*/, float /*value3*/)
+{
+  return cos(value1);
 }
 
 void MathCosineOperation::executePixelSampled(float output[4],
@@ -158,15 +262,19 @@ void MathCosineOperation::executePixelSampled(float output[4],
                                               float y,
                                               PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_cosine, 1>(output, x, y, sampler);
+}
 
-  output[0] = cos(inputValue1[0]);
+void MathCosineOperation::executeBufferRegion(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  executeMathRegion<math_cosine>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_tangent(float value1, float /*value2*/, float /*value3*/)
+{
+  return tan(value1);
 }
 
 void MathTangentOperation::executePixelSampled(float output[4],
@@ -174,15 +282,19 @@ void MathTangentOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_tangent, 1>(output, x, y, sampler);
+}
 
-  output[0] = tan(inputValue1[0]);
+void MathTangentOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathRegion<math_tangent>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_hyperbolic_sine(float value1, float /*value2*/, float /*value3*/)
+{
+  return sinh(value1);
 }
 
 void MathHyperbolicSineOperation::executePixelSampled(float output[4],
@@ -190,15 +302,19 @@ void MathHyperbolicSineOperation::executePixelSampled(float output[4],
                                                       float y,
                                                       PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_hyperbolic_sine, 1>(output, x, y, sampler);
+}
 
-  output[0] = sinh(inputValue1[0]);
+void MathHyperbolicSineOperation::executeBufferRegion(MemoryBuffer *output,
+                                                      const rcti *area,
+                                                      MemoryBuffer **inputs)
+{
+  executeMathRegion<math_hyperbolic_sine>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_hyperbolic_cosine(float value1, float /*value2*/, float /*value3*/)
+{
+  return cosh(value1);
 }
 
 void MathHyperbolicCosineOperation::executePixelSampled(float output[4],
@@ -206,15 +322,19 @@ void MathHyperbolicCosineOperation::executePixelSampled(float output[4],
                                                         float y,
                                                         PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_hyperbolic_cosine, 1>(output, x, y, sampler);
+}
 
-  output[0] = cosh(inputValue1[0]);
+void MathHyperbolicCosineOperation::executeBufferRegion(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
+{
+  executeMathRegion<math_hyperbolic_cosine>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_hyperbolic_tangent(float value1, float /*value2*/, float /*value3*/)
+{
+  return tanh(value1);
 }
 
 void MathHyperbolicTangentOperation::executePixelSampled(float output[4],
@@ -222,15 +342,24 @@ void MathHyperbolicTangentOperation::executePixelSampled(float output[4],
                                                          float y,
                                                          PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_hyperbolic_tangent, 1>(output, x, y, sampler);
+}
 
-  output[0] = tanh(inputValue1[0]);
+void MathHyperbolicTangentOperation::executeBufferRegion(MemoryBuffer *output,
+                                                         const rcti *area,
+                                                         MemoryBuffer **inputs)
+{
+  executeMathRegion<math_hyperbolic_tangent>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_arc_sine(float value1, float /*value2*/, float /*value3*/)
+{
+  if (value1 <= 1 && value1 >= -1) {
+    return asin(value1);
+  }
+  else {
+    return 0.0;
+  }
 }
 
 void MathArcSineOperation::executePixelSampled(float output[4],
@@ -238,20 +367,24 @@ void MathArcSineOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
+  executeMathPixel<math_arc_sine, 1>(output, x, y, sampler);
+}
 
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+void MathArcSineOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathRegion<math_arc_sine>(output, area, inputs);
+}
 
-  if (inputValue1[0] <= 1 && inputValue1[0] >= -1) {
-    output[0] = asin(inputValue1[0]);
+static float math_arc_cosine(float value1, float /*value2*/, float /*value3*/)
+{
+  if (value1 <= 1 && value1 >= -1) {
+    return acos(value1);
   }
   else {
-    output[0] = 0.0;
+    return 0.0;
   }
-
-  clampIfNeeded(output);
 }
 
 void MathArcCosineOperation::executePixelSampled(float output[4],
@@ -259,20 +392,19 @@ void MathArcCosineOperation::executePixelSampled(float output[4],
                                                  float y,
                                                  PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_arc_cosine, 1>(output, x, y, sampler);
+}
 
-  if (inputValue1[0] <= 1 && inputValue1[0] >= -1) {
-    output[0] = acos(inputValue1[0]);
-  }
-  else {
-    output[0] = 0.0;
-  }
+void MathArcCosineOperation::executeBufferRegion(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  executeMathRegion<math_arc_cosine>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_arc_tangent(float value1, float /*value2*/, float /*value3*/)
+{
+  return atan(value1);
 }
 
 void MathArcTangentOperation::executePixelSampled(float output[4],
@@ -280,15 +412,31 @@ void MathArcTangentOperation::executePixelSampled(float output[4],
                                                   float y,
                                                   PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_arc_tangent, 1>(output, x, y, sampler);
+}
 
-  output[0] = atan(inputValue1[0]);
+void MathArcTangentOperation::executeBufferRegion(MemoryBuffer *output,
+                                                  const rcti *area,
+                                                  MemoryBuffer **inputs)
+{
+  executeMathRegion<math_arc_tangent>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_power(float value1, float value2, float /*value3*/)
+{
+  if (value1 >= 0) {
+    return pow(value1, value2);
+  }
+  else {
+    float y_mod_1 = fmod(value2, 1);
+    /* if input value is not nearly an integer, fall back to zero, nicer than straight rounding */
+    if (y_mod_1 > 0.999f || y_mod_1 < 0.001f) {
+      return pow(value1, floorf(value2 + 0.5f));
+    }
+    else {
+      return 0.0;
+    }
+  }
 }
 
 void MathPowerOperation::executePixelSampled(float output[4],
@@ -296,27 +444,24 @@ void MathPowerOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
+  executeMathPixel<math_power, 2>(output, x, y, sampler);
+}
 
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+void MathPowerOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMathRegion<math_power>(output, area, inputs);
+}
 
-  if (inputValue1[0] >= 0) {
-    output[0] = pow(inputValue1[0], inputValue2[0]);
+static float math_logarithm(float value1, float value2, float /*value3*/)
+{
+  if (value1 > 0 && value2 > 0) {
+    return log(value1) / log(value2);
   }
   else {
-    float y_mod_1 = fmod(inputValue2[0], 1);
-    /* if input value is not nearly an integer, fall back to zero, nicer than straight rounding */
-    if (y_mod_1 > 0.999f || y_mod_1 < 0.001f) {
-      output[0] = pow(inputValue1[0], floorf(inputValue2[0] + 0.5f));
-    }
-    else {
-      output[0] = 0.0;
-    }
+    return 0.0;
   }
-
-  clampIfNeeded(output);
 }
 
 void MathLogarithmOperation::executePixelSampled(float output[4],
@@ -324,20 +469,20 @@ void MathLogarithmOperation::executePixelSampled(float output[4],
                                                  float y,
                                                  PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_logarithm, 2>(output, x, y, sampler);
+}
 
-  if (inputValue1[0] > 0 && inputValue2[0] > 0) {
-    output[0] = log(inputValue1[0]) / log(inputValue2[0]);
-  }
-  else {
-    output[0] = 0.0;
-  }
+void MathLogarithmOperation::executeBufferRegion(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  executeMathRegion<math_logarithm>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_minimum(T value1, T value2, T /*value3*/)
+{
+  /* same as min() */
+  return row_select(value2 < value1, value2, value1);
 }
 
 void MathMinimumOperation::executePixelSampled(float output[4],
@@ -345,15 +490,20 @@ void MathMinimumOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_minimum, 2>(output, x, y, sampler);
+}
 
-  output[0] = min(inputValue1[0], inputValue2[0]);
+void MathMinimumOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_minimum, math_minimum>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_maximum(T value1, T value2, T /*value3*/)
+{
+  /* same as max() */
+  return row_select(value1 < value2, value2, value1);
 }
 
 void MathMaximumOperation::executePixelSampled(float output[4],
@@ -361,15 +511,19 @@ void MathMaximumOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_maximum, 2>(output, x, y, sampler);
+}
 
-  output[0] = max(inputValue1[0], inputValue2[0]);
+void MathMaximumOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_maximum, math_maximum>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_round(float value1, float /*value2*/, float /*value3*/)
+{
+  return round(value1);
 }
 
 void MathRoundOperation::executePixelSampled(float output[4],
@@ -377,15 +531,19 @@ void MathRoundOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_round, 1>(output, x, y, sampler);
+}
 
-  output[0] = round(inputValue1[0]);
+void MathRoundOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMathRegion<math_round>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_less_than(T value1, T value2, T /*value3*/)
+{
+  return row_select(value1 < value2, T(1.0f), T(0.0f));
 }
 
 void MathLessThanOperation::executePixelSampled(float output[4],
@@ -393,15 +551,19 @@ void MathLessThanOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_less_than, 2>(output, x, y, sampler);
+}
 
-  output[0] = inputValue1[0] < inputValue2[0] ? 1.0f : 0.0f;
+void MathLessThanOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_less_than, math_less_than>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_greater_than(T value1, T value2, T /*value3*/)
+{
+  return row_select(value1 > value2, T(1.0f), T(0.0f));
 }
 
 void MathGreaterThanOperation::executePixelSampled(float output[4],
@@ -409,15 +571,24 @@ void MathGreaterThanOperation::executePixelSampled(float output[4],
                                                    float y,
                                                    PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_greater_than, 2>(output, x, y, sampler);
+}
 
-  output[0] = inputValue1[0] > inputValue2[0] ? 1.0f : 0.0f;
+void MathGreaterThanOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_greater_than, math_greater_than>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_modulo(float value1, float value2, float /*value3*/)
+{
+  if (value2 == 0) {
+    return 0.0;
+  }
+  else {
+    return fmod(value1, value2);
+  }
 }
 
 void MathModuloOperation::executePixelSampled(float output[4],
@@ -425,20 +596,19 @@ void MathModuloOperation::executePixelSampled(float output[4],
                                               float y,
                                               PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_modulo, 2>(output, x, y, sampler);
+}
 
-  if (inputValue2[0] == 0) {
-    output[0] = 0.0;
-  }
-  else {
-    output[0] = fmod(inputValue1[0], inputValue2[0]);
-  }
+void MathModuloOperation::executeBufferRegion(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  executeMathRegion<math_modulo>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_absolute(T value1, T /*value2*/, T /*value3*/)
+{
+  return row_abs(value1);
 }
 
 void MathAbsoluteOperation::executePixelSampled(float output[4],
@@ -446,13 +616,19 @@ void MathAbsoluteOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_absolute, 1>(output, x, y, sampler);
+}
 
-  output[0] = fabs(inputValue1[0]);
+void MathAbsoluteOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_absolute, math_absolute>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_radians(T value1, T /*value2*/, T /*value3*/)
+{
+  return DEG2RADF(value1);
 }
 
 void MathRadiansOperation::executePixelSampled(float output[4],
@@ -460,13 +636,19 @@ void MathRadiansOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_radians, 1>(output, x, y, sampler);
+}
 
-  output[0] = DEG2RADF(inputValue1[0]);
+void MathRadiansOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_radians, math_radians>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_degrees(T value1, T /*value2*/, T /*value3*/)
+{
+  return RAD2DEGF(value1);
 }
 
 void MathDegreesOperation::executePixelSampled(float output[4],
@@ -474,13 +656,19 @@ void MathDegreesOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_degrees, 1>(output, x, y, sampler);
+}
 
-  output[0] = RAD2DEGF(inputValue1[0]);
+void MathDegreesOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_degrees, math_degrees>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_arc_tan2(float value1, float value2, float /*value3*/)
+{
+  return atan2(value1, value2);
 }
 
 void MathArcTan2Operation::executePixelSampled(float output[4],
@@ -488,15 +676,19 @@ void MathArcTan2Operation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_arc_tan2, 2>(output, x, y, sampler);
+}
 
-  output[0] = atan2(inputValue1[0], inputValue2[0]);
+void MathArcTan2Operation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathRegion<math_arc_tan2>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_floor(float value1, float /*value2*/, float /*value3*/)
+{
+  return floor(value1);
 }
 
 void MathFloorOperation::executePixelSampled(float output[4],
@@ -504,13 +696,19 @@ void MathFloorOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_floor, 1>(output, x, y, sampler);
+}
 
-  output[0] = floor(inputValue1[0]);
+void MathFloorOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMathRegion<math_floor>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_ceil(float value1, float /*value2*/, float /*value3*/)
+{
+  return ceil(value1);
 }
 
 void MathCeilOperation::executePixelSampled(float output[4],
@@ -518,13 +716,19 @@ void MathCeilOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_ceil, 1>(output, x, y, sampler);
+}
 
-  output[0] = ceil(inputValue1[0]);
+void MathCeilOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMathRegion<math_ceil>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_fract(float value1, float /*value2*/, float /*value3*/)
+{
+  return value1 - floor(value1);
 }
 
 void MathFractOperation::executePixelSampled(float output[4],
@@ -532,13 +736,19 @@ void MathFractOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_fract, 1>(output, x, y, sampler);
+}
 
-  output[0] = inputValue1[0] - floor(inputValue1[0]);
+void MathFractOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMathRegion<math_fract>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_sqrt(T value1, T /*value2*/, T /*value3*/)
+{
+  return row_select(value1 > 0.0f, row_sqrt(value1), T(0.0f));
 }
 
 void MathSqrtOperation::executePixelSampled(float output[4],
@@ -546,18 +756,24 @@ void MathSqrtOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputValue1[4];
+  executeMathPixel<math_sqrt, 1>(output, x, y, sampler);
+}
 
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+void MathSqrtOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_sqrt, math_sqrt>(output, area, inputs);
+}
 
-  if (inputValue1[0] > 0) {
-    output[0] = sqrt(inputValue1[0]);
+static float math_inverse_sqrt(float value1, float /*value2*/, float /*value3*/)
+{
+  if (value1 > 0) {
+    return 1.0f / sqrt(value1);
   }
   else {
-    output[0] = 0.0f;
+    return 0.0f;
   }
-
-  clampIfNeeded(output);
 }
 
 void MathInverseSqrtOperation::executePixelSampled(float output[4],
@@ -565,18 +781,19 @@ void MathInverseSqrtOperation::executePixelSampled(float output[4],
                                                    float y,
                                                    PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_inverse_sqrt, 1>(output, x, y, sampler);
+}
 
-  if (inputValue1[0] > 0) {
-    output[0] = 1.0f / sqrt(inputValue1[0]);
-  }
-  else {
-    output[0] = 0.0f;
-  }
+void MathInverseSqrtOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeMathRegion<math_inverse_sqrt>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_sign(float value1, float /*value2*/, float /*value3*/)
+{
+  return compatible_signf(value1);
 }
 
 void MathSignOperation::executePixelSampled(float output[4],
@@ -584,13 +801,19 @@ void MathSignOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_sign, 1>(output, x, y, sampler);
+}
 
-  output[0] = compatible_signf(inputValue1[0]);
+void MathSignOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMathRegion<math_sign>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_exponent(float value1, float /*value2*/, float /*value3*/)
+{
+  return expf(value1);
 }
 
 void MathExponentOperation::executePixelSampled(float output[4],
@@ -598,13 +821,19 @@ void MathExponentOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_exponent, 1>(output, x, y, sampler);
+}
 
-  output[0] = expf(inputValue1[0]);
+void MathExponentOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMathRegion<math_exponent>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_trunc(float value1, float /*value2*/, float /*value3*/)
+{
+  return (value1 >= 0.0f) ? floor(value1) : ceil(value1);
 }
 
 void MathTruncOperation::executePixelSampled(float output[4],
@@ -612,13 +841,24 @@ void MathTruncOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputValue1[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
+  executeMathPixel<math_trunc, 1>(output, x, y, sampler);
+}
 
-  output[0] = (inputValue1[0] >= 0.0f) ? floor(inputValue1[0]) : ceil(inputValue1[0]);
+void MathTruncOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMathRegion<math_trunc>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_snap(float value1, float value2, float /*value3*/)
+{
+  if (value1 == 0 || value2 == 0) { /* We don't want to divide by zero. */
+    return 0.0f;
+  }
+  else {
+    return floorf(value1 / value2) * value2;
+  }
 }
 
 void MathSnapOperation::executePixelSampled(float output[4],
@@ -626,20 +866,19 @@ void MathSnapOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_snap, 2>(output, x, y, sampler);
+}
 
-  if (inputValue1[0] == 0 || inputValue2[0] == 0) { /* We don't want to divide by zero. */
-    output[0] = 0.0f;
-  }
-  else {
-    output[0] = floorf(inputValue1[0] / inputValue2[0]) * inputValue2[0];
-  }
+void MathSnapOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMathRegion<math_snap>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_wrap(float value1, float value2, float value3)
+{
+  return wrapf(value1, value2, value3);
 }
 
 void MathWrapOperation::executePixelSampled(float output[4],
@@ -647,17 +886,19 @@ void MathWrapOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
+  executeMathPixel<math_wrap, 3>(output, x, y, sampler);
+}
 
-  output[0] = wrapf(inputValue1[0], inputValue2[0], inputValue3[0]);
+void MathWrapOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMathRegion<math_wrap>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_pingpong(float value1, float value2, float /*value3*/)
+{
+  return fabsf(fractf((value1 - value2) / (value2 * 2.0f)) * value2 * 2.0f - value2);
 }
 
 void MathPingpongOperation::executePixelSampled(float output[4],
@@ -665,17 +906,21 @@ void MathPingpongOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
+  executeMathPixel<math_pingpong, 2>(output, x, y, sampler);
+}
 
-  output[0] = fabsf(fractf((inputValue1[0] - inputValue2[0]) / (inputValue2[0] * 2.0f)) *
-                        inputValue2[0] * 2.0f -
-                    inputValue2[0]);
+void MathPingpongOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMathRegion<math_pingpong>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_compare(T value1, T value2, T value3)
+{
+  return row_select(row_abs(value1 - value2) <= row_select(value3 > 1e-5f, value3, T(1e-5f)),
+                    T(1.0f),
+                    T(0.0f));
 }
 
 void MathCompareOperation::executePixelSampled(float output[4],
@@ -683,18 +928,19 @@ void MathCompareOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
+  executeMathPixel<math_compare, 3>(output, x, y, sampler);
+}
 
-  output[0] = (fabsf(inputValue1[0] - inputValue2[0]) <= MAX2(inputValue3[0], 1e-5f)) ? 1.0f :
-                                                                                        0.0f;
+void MathCompareOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_compare, math_compare>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+template<typename T> static T math_multiply_add(T value1, T value2, T value3)
+{
+  return value1 * value2 + value3;
 }
 
 void MathMultiplyAddOperation::executePixelSampled(float output[4],
@@ -702,17 +948,19 @@ void MathMultiplyAddOperation::executePixelSampled(float output[4],
                                                    float y,
                                                    PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
+  executeMathPixel<math_multiply_add, 3>(output, x, y, sampler);
+}
 
-  output[0] = inputValue1[0] * inputValue2[0] + inputValue3[0];
+void MathMultiplyAddOperation::executeBufferRegion(MemoryBuffer *output,
+                                                   const rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  executeMathVectorRegion<math_multiply_add, math_multiply_add>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_smooth_min(float value1, float value2, float value3)
+{
+  return smoothminf(value1, value2, value3);
 }
 
 void MathSmoothMinOperation::executePixelSampled(float output[4],
@@ -720,17 +968,19 @@ void MathSmoothMinOperation::executePixelSampled(float output[4],
                                                  float y,
                                                  PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
+  executeMathPixel<math_smooth_min, 3>(output, x, y, sampler);
+}
 
-  output[0] = smoothminf(inputValue1[0], inputValue2[0], inputValue3[0]);
+void MathSmoothMinOperation::executeBufferRegion(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  executeMathRegion<math_smooth_min>(output, area, inputs);
+}
 
-  clampIfNeeded(output);
+static float math_smooth_max(float value1, float value2, float value3)
+{
+  return -smoothminf(-value1, -value2, value3);
 }
 
 void MathSmoothMaxOperation::executePixelSampled(float output[4],
@@ -738,15 +988,12 @@ void MathSmoothMaxOperation::executePixelSampled(float output[4],
                                                  float y,
                                                  PixelSampler sampler)
 {
-  float inputValue1[4];
-  float inputValue2[4];
-  float inputValue3[4];
-
-  this->m_inputValue1Operation->readSampled(inputValue1, x, y, sampler);
-  this->m_inputValue2Operation->readSampled(inputValue2, x, y, sampler);
-  this->m_inputValue3Operation->readSampled(inputValue3, x, y, sampler);
-
-  output[0] = -smoothminf(-inputValue1[0], -inputValue2[0], inputValue3[0]);
+  executeMathPixel<math_smooth_max, 3>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MathSmoothMaxOperation::executeBufferRegion(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  executeMathRegion<math_smooth_max>(output, area, inputs);
 }
@@ -18,6 +18,7 @@
 
 #ifndef __COM_MATHBASEOPERATION_H__
 #define __COM_MATHBASEOPERATION_H__
+#include "COM_BufferRow.h"
 #include "COM_NodeOperation.h"
 
 /**
@@ -43,6 +44,33 @@ class MathBaseOperation : public NodeOperation {
 
   void clampIfNeeded(float color[4]);
 
+  /**
+   * Calculate the value of an element from the values of the inputs.
+   * Functions that are also instantiated for RowVector calculate 4 elements at once.
+   */
+  typedef float (*MathFunction)(float value1, float value2, float value3);
+  typedef RowVector (*MathVectorFunction)(RowVector value1, RowVector value2, RowVector value3);
+
+  /**
+   * executePixelSampled of the operations implemented by a MathFunction,
+   * only the first num_inputs inputs are read.
+   */
+  template<MathFunction calculate, int num_inputs>
+  void executeMathPixel(float output[4], float x, float y, PixelSampler sampler);
+
+  /**
+   * executeBufferRegion of the operations implemented by a MathFunction
+   */
+  template<MathFunction calculate>
+  void executeMathRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
+  /**
+   * executeBufferRegion of the operations implemented by a MathFunction and a
+   * MathVectorFunction, the rows are calculated 4 elements at once.
+   */
+  template<MathFunction calculate, MathVectorFunction calculate_vector>
+  void executeMathVectorRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
  public:
   /**
    * the inner loop of this program
@@ -76,6 +104,7 @@ class MathAddOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
@@ -83,6 +112,7 @@ class MathSubtractOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
@@ -90,6 +120,7 @@ class MathMultiplyOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
@@ -97,6 +128,7 @@ class MathDivideOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
@@ -104,6 +136,7 @@ class MathSineOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathCosineOperation : public MathBaseOperation {
  public:
@@ -111,6 +144,7 @@ class MathCosineOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathTangentOperation : public MathBaseOperation {
  public:
@@ -118,6 +152,7 @@ class MathTangentOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathHyperbolicSineOperation : public MathBaseOperation {
@@ -126,6 +161,7 @@ class MathHyperbolicSineOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathHyperbolicCosineOperation : public MathBaseOperation {
  public:
@@ -133,6 +169,7 @@ class MathHyperbolicCosineOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathHyperbolicTangentOperation : public MathBaseOperation {
  public:
@@ -140,6 +177,7 @@ class MathHyperbolicTangentOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathArcSineOperation : public MathBaseOperation {
@@ -148,6 +186,7 @@ class MathArcSineOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathArcCosineOperation : public MathBaseOperation {
  public:
@@ -155,6 +194,7 @@ class MathArcCosineOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathArcTangentOperation : public MathBaseOperation {
  public:
@@ -162,6 +202,7 @@ class MathArcTangentOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathPowerOperation : public MathBaseOperation {
  public:
@@ -169,6 +210,7 @@ class MathPowerOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathLogarithmOperation : public MathBaseOperation {
  public:
@@ -176,6 +218,7 @@ class MathLogarithmOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathMinimumOperation : public MathBaseOperation {
  public:
@@ -183,6 +226,7 @@ class MathMinimumOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
@@ -190,6 +234,7 @@ class MathMaximumOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
@@ -197,6 +242,7 @@ class MathRoundOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathLessThanOperation : public MathBaseOperation {
  public:
@@ -204,6 +250,7 @@ class MathLessThanOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathGreaterThanOperation : public MathBaseOperation {
  public:
@@ -211,6 +258,7 @@ class MathGreaterThanOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathModuloOperation : public MathBaseOperation {
@@ -219,6 +267,7 @@ class MathModuloOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathAbsoluteOperation : public MathBaseOperation {
@@ -227,6 +276,7 @@ class MathAbsoluteOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathRadiansOperation : public MathBaseOperation {
@@ -235,6 +285,7 @@ class MathRadiansOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathDegreesOperation : public MathBaseOperation {
@@ -243,6 +294,7 @@ class MathDegreesOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathArcTan2Operation : public MathBaseOperation {
@@ -251,6 +303,7 @@ class MathArcTan2Operation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathFloorOperation : public MathBaseOperation {
@@ -259,6 +312,7 @@ class MathFloorOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathCeilOperation : public MathBaseOperation {
@@ -267,6 +321,7 @@ class MathCeilOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathFractOperation : public MathBaseOperation {
@@ -275,6 +330,7 @@ class MathFractOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathSqrtOperation : public MathBaseOperation {
@@ -283,6 +339,7 @@ class MathSqrtOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathInverseSqrtOperation : public MathBaseOperation {
@@ -291,6 +348,7 @@ class MathInverseSqrtOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathSignOperation : public MathBaseOperation {
@@ -299,6 +357,7 @@ class MathSignOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathExponentOperation : public MathBaseOperation {
@@ -307,6 +366,7 @@ class MathExponentOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathTruncOperation : public MathBaseOperation {
@@ -315,6 +375,7 @@ class MathTruncOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathSnapOperation : public MathBaseOperation {
@@ -323,6 +384,7 @@ class MathSnapOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathWrapOperation : public MathBaseOperation {
@@ -331,6 +393,7 @@ class MathWrapOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathPingpongOperation : public MathBaseOperation {
@@ -339,6 +402,7 @@ class MathPingpongOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathCompareOperation : public MathBaseOperation {
@@ -347,6 +411,7 @@ class MathCompareOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathMultiplyAddOperation : public MathBaseOperation {
@@ -355,6 +420,7 @@ class MathMultiplyAddOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathSmoothMinOperation : public MathBaseOperation {
@@ -363,6 +429,7 @@ class MathSmoothMinOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MathSmoothMaxOperation : public MathBaseOperation {
@@ -371,5 +438,6 @@ class MathSmoothMaxOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 #endif
@@ -95,14 +95,28 @@ void MixBaseOperation::deinitExecution()
   this->m_inputColor2Operation = NULL;
 }
 
-/* ******** Mix Add Operation ******** */
-
-MixAddOperation::MixAddOperation() : MixBaseOperation()
+template<MixBaseOperation::MixFunction mix>
+inline void MixBaseOperation::mixElem(float output[4],
+                                      float value,
+                                      const float inputColor1[4],
+                                      const float inputColor2[4])
 {
-  /* pass */
+  if (this->useValueAlphaMultiply()) {
+    value *= inputColor2[3];
+  }
+  const RowVector color1 = RowVector::load(inputColor1);
+  RowVector result = mix(color1, RowVector::load(inputColor2), value);
+
+  /* the alpha is always the alpha of the first color */
+  result = row_select(RowMask::alpha(), color1, result);
+  if (this->m_useClamp) {
+    result = row_clamp(result);
+  }
+  result.store(output);
 }
 
-void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+template<MixBaseOperation::MixFunction mix>
+void MixBaseOperation::executeMixPixel(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputColor1[4];
   float inputColor2[4];
@@ -112,23 +126,61 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
   this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
 
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
+  mixElem<mix>(output, inputValue[0], inputColor1, inputColor2);
+}
+
+template<MixBaseOperation::MixFunction mix>
+void MixBaseOperation::executeMixRegion(MemoryBuffer *output,
+                                        const rcti *area,
+                                        MemoryBuffer **inputs)
+{
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const BufferRow value(inputs[0], area->xmin, y);
+    const BufferRow color1(inputs[1], area->xmin, y);
+    const BufferRow color2(inputs[2], area->xmin, y);
+    const BufferRow result(output, area->xmin, y);
+    for (int i = 0; i < width; i++) {
+      mixElem<mix>(result.elem(i), value.elem(i)[0], color1.elem(i), color2.elem(i));
+    }
   }
-  output[0] = inputColor1[0] + value * inputColor2[0];
-  output[1] = inputColor1[1] + value * inputColor2[1];
-  output[2] = inputColor1[2] + value * inputColor2[2];
-  output[3] = inputColor1[3];
+}
+
+/* ******** Mix Add Operation ******** */
+
+static RowVector mix_add(const RowVector &color1, const RowVector &color2, float value)
+{
+  return color1 + value * color2;
+}
+
+MixAddOperation::MixAddOperation() : MixBaseOperation()
+{
+  this->setFullFrame(true);
+}
+
+void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+  executeMixPixel<mix_add>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixAddOperation::executeBufferRegion(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_add>(output, area, inputs);
 }
 
 /* ******** Mix Blend Operation ******** */
 
+static RowVector mix_blend(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  return valuem * color1 + value * color2;
+}
+
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -136,33 +188,29 @@ void MixBlendOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float value;
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-  value = inputValue[0];
-
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = valuem * (inputColor1[0]) + value * (inputColor2[0]);
-  output[1] = valuem * (inputColor1[1]) + value * (inputColor2[1]);
-  output[2] = valuem * (inputColor1[2]) + value * (inputColor2[2]);
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_blend>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixBlendOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_blend>(output, area, inputs);
 }
 
 /* ******** Mix Burn Operation ******** */
 
+static RowVector mix_color_burn(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  const RowVector tmp = valuem + value * color2;
+  const RowVector burn = 1.0f - (1.0f - color1) / tmp;
+  return row_select(tmp <= 0.0f, RowVector(0.0f), row_clamp(burn));
+}
+
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixColorBurnOperation::executePixelSampled(float output[4],
@@ -170,101 +218,25 @@ void MixColorBurnOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float tmp;
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  tmp = valuem + value * inputColor2[0];
-  if (tmp <= 0.0f) {
-    output[0] = 0.0f;
-  }
-  else {
-    tmp = 1.0f - (1.0f - inputColor1[0]) / tmp;
-    if (tmp < 0.0f) {
-      output[0] = 0.0f;
-    }
-    else if (tmp > 1.0f) {
-      output[0] = 1.0f;
-    }
-    else {
-      output[0] = tmp;
-    }
-  }
-
-  tmp = valuem + value * inputColor2[1];
-  if (tmp <= 0.0f) {
-    output[1] = 0.0f;
-  }
-  else {
-    tmp = 1.0f - (1.0f - inputColor1[1]) / tmp;
-    if (tmp < 0.0f) {
-      output[1] = 0.0f;
-    }
-    else if (tmp > 1.0f) {
-      output[1] = 1.0f;
-    }
-    else {
-      output[1] = tmp;
-    }
-  }
-
-  tmp = valuem + value * inputColor2[2];
-  if (tmp <= 0.0f) {
-    output[2] = 0.0f;
-  }
-  else {
-    tmp = 1.0f - (1.0f - inputColor1[2]) / tmp;
-    if (tmp < 0.0f) {
-      output[2] = 0.0f;
-    }
-    else if (tmp > 1.0f) {
-      output[2] = 1.0f;
-    }
-    else {
-      output[2] = tmp;
-    }
-  }
-
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  executeMixPixel<mix_color_burn>(output, x, y, sampler);
 }
 
-/* ******** Mix Color Operation ******** */
-
-MixColorOperation::MixColorOperation() : MixBaseOperation()
+void MixColorBurnOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
 {
-  /* pass */
+  executeMixRegion<mix_color_burn>(output, area, inputs);
 }
 
-void MixColorOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+/* ******** Mix Color Operation ******** */
+
+static RowVector mix_color(const RowVector &color1, const RowVector &color2, float value)
 {
   float inputColor1[4];
   float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
+  float output[4];
+  color1.store(inputColor1);
+  color2.store(inputColor2);
   float valuem = 1.0f - value;
 
   float colH, colS, colV;
@@ -283,14 +255,42 @@ void MixColorOperation::executePixelSampled(float output[4],
   }
   output[3] = inputColor1[3];
 
-  clampIfNeeded(output);
+  return RowVector::load(output);
+}
+
+MixColorOperation::MixColorOperation() : MixBaseOperation()
+{
+  this->setFullFrame(true);
+}
+
+void MixColorOperation::executePixelSampled(float output[4],
+                                            float x,
+                                            float y,
+                                            PixelSampler sampler)
+{
+  executeMixPixel<mix_color>(output, x, y, sampler);
+}
+
+void MixColorOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_color>(output, area, inputs);
 }
 
 /* ******** Mix Darken Operation ******** */
 
+static RowVector mix_darken(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  /* same as min_ff */
+  const RowVector darken = row_select(color1 < color2, color1, color2);
+  return darken * value + color1 * valuem;
+}
+
 MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDarkenOperation::executePixelSampled(float output[4],
@@ -298,32 +298,27 @@ void MixDarkenOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = min_ff(inputColor1[0], inputColor2[0]) * value + inputColor1[0] * valuem;
-  output[1] = min_ff(inputColor1[1], inputColor2[1]) * value + inputColor1[1] * valuem;
-  output[2] = min_ff(inputColor1[2], inputColor2[2]) * value + inputColor1[2] * valuem;
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_darken>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixDarkenOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_darken>(output, area, inputs);
 }
 
 /* ******** Mix Difference Operation ******** */
 
+static RowVector mix_difference(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  return valuem * color1 + value * row_abs(color1 - color2);
+}
+
 MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4],
@@ -331,32 +326,27 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
                                                  float y,
                                                  PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = valuem * inputColor1[0] + value * fabsf(inputColor1[0] - inputColor2[0]);
-  output[1] = valuem * inputColor1[1] + value * fabsf(inputColor1[1] - inputColor2[1]);
-  output[2] = valuem * inputColor1[2] + value * fabsf(inputColor1[2] - inputColor2[2]);
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_difference>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixDifferenceOperation::executeBufferRegion(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_difference>(output, area, inputs);
 }
 
 /* ******** Mix Difference Operation ******** */
 
+static RowVector mix_divide(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  return row_select(color2 != 0.0f, valuem * color1 + value * color1 / color2, RowVector(0.0f));
+}
+
 MixDivideOperation::MixDivideOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDivideOperation::executePixelSampled(float output[4],
@@ -364,49 +354,30 @@ void MixDivideOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-
-  if (inputColor2[0] != 0.0f) {
-    output[0] = valuem * (inputColor1[0]) + value * (inputColor1[0]) / inputColor2[0];
-  }
-  else {
-    output[0] = 0.0f;
-  }
-  if (inputColor2[1] != 0.0f) {
-    output[1] = valuem * (inputColor1[1]) + value * (inputColor1[1]) / inputColor2[1];
-  }
-  else {
-    output[1] = 0.0f;
-  }
-  if (inputColor2[2] != 0.0f) {
-    output[2] = valuem * (inputColor1[2]) + value * (inputColor1[2]) / inputColor2[2];
-  }
-  else {
-    output[2] = 0.0f;
-  }
-
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_divide>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixDivideOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_divide>(output, area, inputs);
 }
 
 /* ******** Mix Dodge Operation ******** */
 
+static RowVector mix_dodge(const RowVector &color1, const RowVector &color2, float value)
+{
+  const RowVector tmp = 1.0f - value * color2;
+  const RowVector dodge = color1 / tmp;
+  const RowVector result = row_select(
+      tmp <= 0.0f, RowVector(1.0f), row_select(dodge > 1.0f, RowVector(1.0f), dodge));
+  return row_select(color1 != 0.0f, result, RowVector(0.0f));
+}
+
 MixDodgeOperation::MixDodgeOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDodgeOperation::executePixelSampled(float output[4],
@@ -414,87 +385,30 @@ void MixDodgeOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float tmp;
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-
-  if (inputColor1[0] != 0.0f) {
-    tmp = 1.0f - value * inputColor2[0];
-    if (tmp <= 0.0f) {
-      output[0] = 1.0f;
-    }
-    else {
-      tmp = inputColor1[0] / tmp;
-      if (tmp > 1.0f) {
-        output[0] = 1.0f;
-      }
-      else {
-        output[0] = tmp;
-      }
-    }
-  }
-  else {
-    output[0] = 0.0f;
-  }
-
-  if (inputColor1[1] != 0.0f) {
-    tmp = 1.0f - value * inputColor2[1];
-    if (tmp <= 0.0f) {
-      output[1] = 1.0f;
-    }
-    else {
-      tmp = inputColor1[1] / tmp;
-      if (tmp > 1.0f) {
-        output[1] = 1.0f;
-      }
-      else {
-        output[1] = tmp;
-      }
-    }
-  }
-  else {
-    output[1] = 0.0f;
-  }
-
-  if (inputColor1[2] != 0.0f) {
-    tmp = 1.0f - value * inputColor2[2];
-    if (tmp <= 0.0f) {
-      output[2] = 1.0f;
-    }
-    else {
-      tmp = inputColor1[2] / tmp;
-      if (tmp > 1.0f) {
-        output[2] = 1.0f;
-      }
-      else {
-        output[2] = tmp;
-      }
-    }
-  }
-  else {
-    output[2] = 0.0f;
-  }
-
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_dodge>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixDodgeOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_dodge>(output, area, inputs);
 }
 
 /* ******** Mix Glare Operation ******** */
 
+static RowVector mix_glare(const RowVector &color1, const RowVector &color2, float value)
+{
+  float mf = 2.0f - 2.0f * fabsf(value - 0.5f);
+  const RowVector color = row_select(color1 < 0.0f, RowVector(0.0f), color1);
+  const RowVector glare = color + value * (color2 - color);
+  /* same as max(glare, 0.0f) */
+  return mf * row_select(glare < 0.0f, RowVector(0.0f), glare);
+}
+
 MixGlareOperation::MixGlareOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixGlareOperation::executePixelSampled(float output[4],
@@ -502,56 +416,25 @@ void MixGlareOperation::executePixelSampled(float output[4],
                                             float y,
                                             PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float value;
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-  value = inputValue[0];
-  float mf = 2.0f - 2.0f * fabsf(value - 0.5f);
-
-  if (inputColor1[0] < 0.0f) {
-    inputColor1[0] = 0.0f;
-  }
-  if (inputColor1[1] < 0.0f) {
-    inputColor1[1] = 0.0f;
-  }
-  if (inputColor1[2] < 0.0f) {
-    inputColor1[2] = 0.0f;
-  }
-
-  output[0] = mf * max(inputColor1[0] + value * (inputColor2[0] - inputColor1[0]), 0.0f);
-  output[1] = mf * max(inputColor1[1] + value * (inputColor2[1] - inputColor1[1]), 0.0f);
-  output[2] = mf * max(inputColor1[2] + value * (inputColor2[2] - inputColor1[2]), 0.0f);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
-}
-
-/* ******** Mix Hue Operation ******** */
+  executeMixPixel<mix_glare>(output, x, y, sampler);
+}
 
-MixHueOperation::MixHueOperation() : MixBaseOperation()
+void MixGlareOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
 {
-  /* pass */
+  executeMixRegion<mix_glare>(output, area, inputs);
 }
 
-void MixHueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+/* ******** Mix Hue Operation ******** */
+
+static RowVector mix_hue(const RowVector &color1, const RowVector &color2, float value)
 {
   float inputColor1[4];
   float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
+  float output[4];
+  color1.store(inputColor1);
+  color2.store(inputColor2);
   float valuem = 1.0f - value;
 
   float colH, colS, colV;
@@ -570,14 +453,37 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
   }
   output[3] = inputColor1[3];
 
-  clampIfNeeded(output);
+  return RowVector::load(output);
+}
+
+MixHueOperation::MixHueOperation() : MixBaseOperation()
+{
+  this->setFullFrame(true);
+}
+
+void MixHueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+  executeMixPixel<mix_hue>(output, x, y, sampler);
+}
+
+void MixHueOperation::executeBufferRegion(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_hue>(output, area, inputs);
 }
 
 /* ******** Mix Lighten Operation ******** */
 
+static RowVector mix_lighten(const RowVector &color1, const RowVector &color2, float value)
+{
+  const RowVector tmp = value * color2;
+  return row_select(tmp > color1, tmp, color1);
+}
+
 MixLightenOperation::MixLightenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixLightenOperation::executePixelSampled(float output[4],
@@ -585,50 +491,28 @@ void MixLightenOperation::executePixelSampled(float output[4],
                                               float y,
                                               PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float tmp;
-  tmp = value * inputColor2[0];
-  if (tmp > inputColor1[0]) {
-    output[0] = tmp;
-  }
-  else {
-    output[0] = inputColor1[0];
-  }
-  tmp = value * inputColor2[1];
-  if (tmp > inputColor1[1]) {
-    output[1] = tmp;
-  }
-  else {
-    output[1] = inputColor1[1];
-  }
-  tmp = value * inputColor2[2];
-  if (tmp > inputColor1[2]) {
-    output[2] = tmp;
-  }
-  else {
-    output[2] = inputColor1[2];
-  }
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_lighten>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixLightenOperation::executeBufferRegion(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_lighten>(output, area, inputs);
 }
 
 /* ******** Mix Linear Light Operation ******** */
 
+static RowVector mix_linear_light(const RowVector &color1, const RowVector &color2, float value)
+{
+  return row_select(color2 > 0.5f,
+                    color1 + value * (2.0f * (color2 - 0.5f)),
+                    color1 + value * (2.0f * color2 - 1.0f));
+}
+
 MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixLinearLightOperation::executePixelSampled(float output[4],
@@ -636,47 +520,27 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
                                                   float y,
                                                   PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  if (inputColor2[0] > 0.5f) {
-    output[0] = inputColor1[0] + value * (2.0f * (inputColor2[0] - 0.5f));
-  }
-  else {
-    output[0] = inputColor1[0] + value * (2.0f * (inputColor2[0]) - 1.0f);
-  }
-  if (inputColor2[1] > 0.5f) {
-    output[1] = inputColor1[1] + value * (2.0f * (inputColor2[1] - 0.5f));
-  }
-  else {
-    output[1] = inputColor1[1] + value * (2.0f * (inputColor2[1]) - 1.0f);
-  }
-  if (inputColor2[2] > 0.5f) {
-    output[2] = inputColor1[2] + value * (2.0f * (inputColor2[2] - 0.5f));
-  }
-  else {
-    output[2] = inputColor1[2] + value * (2.0f * (inputColor2[2]) - 1.0f);
-  }
-
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_linear_light>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixLinearLightOperation::executeBufferRegion(MemoryBuffer *output,
+                                                  const rcti *area,
+                                                  MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_linear_light>(output, area, inputs);
 }
 
 /* ******** Mix Multiply Operation ******** */
 
+static RowVector mix_multiply(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  return color1 * (valuem + value * color2);
+}
+
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -684,32 +548,29 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  output[0] = inputColor1[0] * (valuem + value * inputColor2[0]);
-  output[1] = inputColor1[1] * (valuem + value * inputColor2[1]);
-  output[2] = inputColor1[2] * (valuem + value * inputColor2[2]);
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_multiply>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixMultiplyOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_multiply>(output, area, inputs);
 }
 
 /* ******** Mix Ovelray Operation ******** */
 
+static RowVector mix_overlay(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  return row_select(color1 < 0.5f,
+                    color1 * (valuem + 2.0f * value * color2),
+                    1.0f - (valuem + 2.0f * value * (1.0f - color2)) * (1.0f - color1));
+}
+
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixOverlayOperation::executePixelSampled(float output[4],
@@ -717,68 +578,25 @@ void MixOverlayOperation::executePixelSampled(float output[4],
                                               float y,
                                               PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-
-  float valuem = 1.0f - value;
-
-  if (inputColor1[0] < 0.5f) {
-    output[0] = inputColor1[0] * (valuem + 2.0f * value * inputColor2[0]);
-  }
-  else {
-    output[0] = 1.0f - (valuem + 2.0f * value * (1.0f - inputColor2[0])) * (1.0f - inputColor1[0]);
-  }
-  if (inputColor1[1] < 0.5f) {
-    output[1] = inputColor1[1] * (valuem + 2.0f * value * inputColor2[1]);
-  }
-  else {
-    output[1] = 1.0f - (valuem + 2.0f * value * (1.0f - inputColor2[1])) * (1.0f - inputColor1[1]);
-  }
-  if (inputColor1[2] < 0.5f) {
-    output[2] = inputColor1[2] * (valuem + 2.0f * value * inputColor2[2]);
-  }
-  else {
-    output[2] = 1.0f - (valuem + 2.0f * value * (1.0f - inputColor2[2])) * (1.0f - inputColor1[2]);
-  }
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  executeMixPixel<mix_overlay>(output, x, y, sampler);
 }
 
-/* ******** Mix Saturation Operation ******** */
-
-MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
+void MixOverlayOperation::executeBufferRegion(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
 {
-  /* pass */
+  executeMixRegion<mix_overlay>(output, area, inputs);
 }
 
-void MixSaturationOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+/* ******** Mix Saturation Operation ******** */
+
+static RowVector mix_saturation(const RowVector &color1, const RowVector &color2, float value)
 {
   float inputColor1[4];
   float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
+  float output[4];
+  color1.store(inputColor1);
+  color2.store(inputColor2);
   float valuem = 1.0f - value;
 
   float rH, rS, rV;
@@ -794,14 +612,40 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
   output[3] = inputColor1[3];
 
-  clampIfNeeded(output);
+  return RowVector::load(output);
+}
+
+MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
+{
+  this->setFullFrame(true);
+}
+
+void MixSaturationOperation::executePixelSampled(float output[4],
+                                                 float x,
+                                                 float y,
+                                                 PixelSampler sampler)
+{
+  executeMixPixel<mix_saturation>(output, x, y, sampler);
+}
+
+void MixSaturationOperation::executeBufferRegion(MemoryBuffer *output,
+                                                 const rcti *area,
+                                                 MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_saturation>(output, area, inputs);
 }
 
 /* ******** Mix Screen Operation ******** */
 
+static RowVector mix_screen(const RowVector &color1, const RowVector &color2, float value)
+{
+  float valuem = 1.0f - value;
+  return 1.0f - (valuem + value * (1.0f - color2)) * (1.0f - color1);
+}
+
 MixScreenOperation::MixScreenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4],
@@ -809,33 +653,31 @@ void MixScreenOperation::executePixelSampled(float output[4],
                                              float y,
                                              PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
+  executeMixPixel<mix_screen>(output, x, y, sampler);
+}
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
+void MixScreenOperation::executeBufferRegion(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_screen>(output, area, inputs);
+}
 
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
+/* ******** Mix Soft Light Operation ******** */
+
+static RowVector mix_soft_light(const RowVector &color1, const RowVector &color2, float value)
+{
   float valuem = 1.0f - value;
 
-  output[0] = 1.0f - (valuem + value * (1.0f - inputColor2[0])) * (1.0f - inputColor1[0]);
-  output[1] = 1.0f - (valuem + value * (1.0f - inputColor2[1])) * (1.0f - inputColor1[1]);
-  output[2] = 1.0f - (valuem + value * (1.0f - inputColor2[2])) * (1.0f - inputColor1[2]);
-  output[3] = inputColor1[3];
+  /* first calculate non-fac based Screen mix */
+  const RowVector screen = 1.0f - (1.0f - color2) * (1.0f - color1);
 
-  clampIfNeeded(output);
+  return valuem * (color1) + value * (((1.0f - color1) * color2 * (color1)) + (color1 * screen));
 }
 
-/* ******** Mix Soft Light Operation ******** */
-
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixSoftLightOperation::executePixelSampled(float output[4],
@@ -843,45 +685,26 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
                                                 float y,
                                                 PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  float valuem = 1.0f - value;
-  float scr, scg, scb;
-
-  /* first calculate non-fac based Screen mix */
-  scr = 1.0f - (1.0f - inputColor2[0]) * (1.0f - inputColor1[0]);
-  scg = 1.0f - (1.0f - inputColor2[1]) * (1.0f - inputColor1[1]);
-  scb = 1.0f - (1.0f - inputColor2[2]) * (1.0f - inputColor1[2]);
-
-  output[0] = valuem * (inputColor1[0]) +
-              value * (((1.0f - inputColor1[0]) * inputColor2[0] * (inputColor1[0])) +
-                       (inputColor1[0] * scr));
-  output[1] = valuem * (inputColor1[1]) +
-              value * (((1.0f - inputColor1[1]) * inputColor2[1] * (inputColor1[1])) +
-                       (inputColor1[1] * scg));
-  output[2] = valuem * (inputColor1[2]) +
-              value * (((1.0f - inputColor1[2]) * inputColor2[2] * (inputColor1[2])) +
-                       (inputColor1[2] * scb));
-  output[3] = inputColor1[3];
+  executeMixPixel<mix_soft_light>(output, x, y, sampler);
+}
 
-  clampIfNeeded(output);
+void MixSoftLightOperation::executeBufferRegion(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_soft_light>(output, area, inputs);
 }
 
 /* ******** Mix Subtract Operation ******** */
 
+static RowVector mix_subtract(const RowVector &color1, const RowVector &color2, float value)
+{
+  return color1 - value * (color2);
+}
+
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -889,50 +712,25 @@ void MixSubtractOperation::executePixelSampled(float output[4],
                                                float y,
                                                PixelSampler sampler)
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
-  output[0] = inputColor1[0] - value * (inputColor2[0]);
-  output[1] = inputColor1[1] - value * (inputColor2[1]);
-  output[2] = inputColor1[2] - value * (inputColor2[2]);
-  output[3] = inputColor1[3];
-
-  clampIfNeeded(output);
+  executeMixPixel<mix_subtract>(output, x, y, sampler);
 }
 
-/* ******** Mix Value Operation ******** */
-
-MixValueOperation::MixValueOperation() : MixBaseOperation()
+void MixSubtractOperation::executeBufferRegion(MemoryBuffer *output,
+                                               const rcti *area,
+                                               MemoryBuffer **inputs)
 {
-  /* pass */
+  executeMixRegion<mix_subtract>(output, area, inputs);
 }
 
-void MixValueOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+/* ******** Mix Value Operation ******** */
+
+static RowVector mix_value(const RowVector &color1, const RowVector &color2, float value)
 {
   float inputColor1[4];
   float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
-  float value = inputValue[0];
-  if (this->useValueAlphaMultiply()) {
-    value *= inputColor2[3];
-  }
+  float output[4];
+  color1.store(inputColor1);
+  color2.store(inputColor2);
   float valuem = 1.0f - value;
 
   float rH, rS, rV;
@@ -942,5 +740,25 @@ void MixValueOperation::executePixelSampled(float output[4],
   hsv_to_rgb(rH, rS, (valuem * rV + value * colV), &output[0], &output[1], &output[2]);
   output[3] = inputColor1[3];
 
-  clampIfNeeded(output);
+  return RowVector::load(output);
+}
+
+MixValueOperation::MixValueOperation() : MixBaseOperation()
+{
+  this->setFullFrame(true);
+}
+
+void MixValueOperation::executePixelSampled(float output[4],
+                                            float x,
+                                            float y,
+                                            PixelSampler sampler)
+{
+  executeMixPixel<mix_value>(output, x, y, sampler);
+}
+
+void MixValueOperation::executeBufferRegion(MemoryBuffer *output,
+                                            const rcti *area,
+                                            MemoryBuffer **inputs)
+{
+  executeMixRegion<mix_value>(output, area, inputs);
 }
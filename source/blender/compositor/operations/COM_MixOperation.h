@@ -18,6 +18,7 @@
 
 #ifndef __COM_MIXOPERATION_H__
 #define __COM_MIXOPERATION_H__
+#include "COM_BufferRow.h"
 #include "COM_NodeOperation.h"
 
 /**
@@ -43,6 +44,30 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * Mix the colors of a pixel, the alpha of the result is replaced by the alpha of the first
+   * color. Mix functions work on RowVector's, so the channels of a pixel are calculated at once.
+   */
+  typedef RowVector (*MixFunction)(const RowVector &color1, const RowVector &color2, float value);
+
+  template<MixFunction mix>
+  inline void mixElem(float output[4],
+                      float value,
+                      const float inputColor1[4],
+                      const float inputColor2[4]);
+
+  /**
+   * executePixelSampled of the operations implemented by a MixFunction
+   */
+  template<MixFunction mix>
+  void executeMixPixel(float output[4], float x, float y, PixelSampler sampler);
+
+  /**
+   * executeBufferRegion of the operations implemented by a MixFunction
+   */
+  template<MixFunction mix>
+  void executeMixRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
  public:
   /**
    * Default constructor
@@ -84,114 +109,133 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
  public:
   MixColorBurnOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixColorOperation : public MixBaseOperation {
  public:
   MixColorOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixDivideOperation : public MixBaseOperation {
  public:
   MixDivideOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixDodgeOperation : public MixBaseOperation {
  public:
   MixDodgeOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixGlareOperation : public MixBaseOperation {
  public:
   MixGlareOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixHueOperation : public MixBaseOperation {
  public:
   MixHueOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
  public:
   MixLinearLightOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
  public:
   MixOverlayOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixSaturationOperation : public MixBaseOperation {
  public:
   MixSaturationOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
  public:
   MixSoftLightOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixValueOperation : public MixBaseOperation {
  public:
   MixValueOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBufferRegion(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 #endif
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BLI_rand.h"
+#include "BLI_rect.h"
+
+#include "PIL_time.h"
+
+#include "COM_ColorBalanceLGGOperation.h"
+#include "COM_ConvertOperation.h"
+#include "COM_GammaOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MixOperation.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* The timings are only of interest when changing the operations, so the tests are disabled.
+ * Run them with `--gtest_also_run_disabled_tests --gtest_filter=buffer_operations_performance.*`.
+ * A namespace of their own keeps the helper classes apart from the ones of the other tests. */
+namespace blender::compositor::tests::performance {
+
+/* Full HD, the size of a common render. */
+static const int WIDTH = 1920;
+static const int HEIGHT = 1080;
+
+/* Serves the elements of a buffer, the way a ReadBufferOperation does in tiled execution. */
+class BufferInputOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+
+ public:
+  BufferInputOperation(DataType datatype, MemoryBuffer *buffer) : m_buffer(buffer)
+  {
+    this->addOutputSocket(datatype);
+    unsigned int resolution[2] = {(unsigned int)WIDTH, (unsigned int)HEIGHT};
+    this->setResolution(resolution);
+  }
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler /*sampler*/)
+  {
+    const float *elem = m_buffer->getElem((int)x, (int)y);
+    for (unsigned int i = 0; i < m_buffer->get_num_channels(); i++) {
+      output[i] = elem[i];
+    }
+  }
+};
+
+/**
+ * Time the execution of an operation per pixel and per buffer region on the same random inputs.
+ * Checking the results is left to the buffer operations test.
+ */
+static void perf_operation(NodeOperation *operation, const char *name)
+{
+  RNG *rng = BLI_rng_new(0);
+  rcti area;
+  BLI_rcti_init(&area, 0, WIDTH, 0, HEIGHT);
+
+  const int num_inputs = (int)operation->getNumberOfInputSockets();
+  MemoryBuffer *input_buffers[4];
+  BufferInputOperation *input_operations[4];
+  for (int i = 0; i < num_inputs; i++) {
+    const DataType datatype = operation->getInputSocket(i)->getDataType();
+    input_buffers[i] = new MemoryBuffer(datatype, &area);
+    float *values = input_buffers[i]->getBuffer();
+    const int num_floats = WIDTH * HEIGHT * (int)input_buffers[i]->get_num_channels();
+    for (int j = 0; j < num_floats; j++) {
+      values[j] = BLI_rng_get_float(rng) * 2.0f - 0.5f;
+    }
+    input_operations[i] = new BufferInputOperation(datatype, input_buffers[i]);
+    operation->getInputSocket(i)->setLink(input_operations[i]->getOutputSocket());
+  }
+  unsigned int resolution[2] = {(unsigned int)WIDTH, (unsigned int)HEIGHT};
+  operation->setResolution(resolution);
+  operation->initExecution();
+
+  MemoryBuffer output(operation->getOutputSocket()->getDataType(), &area);
+  const int num_channels = (int)output.get_num_channels();
+
+  const double pixel_start = PIL_check_seconds_timer();
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      float result[4];
+      operation->readSampled(result, x, y, COM_PS_NEAREST);
+      memcpy(output.getElem(x, y), result, sizeof(float) * num_channels);
+    }
+  }
+  const double region_start = PIL_check_seconds_timer();
+  operation->executeBufferRegion(&output, &area, input_buffers);
+  const double region_end = PIL_check_seconds_timer();
+
+  printf("%s: per pixel %.3f ms, buffer region %.3f ms\n",
+         name,
+         (region_start - pixel_start) * 1000.0,
+         (region_end - region_start) * 1000.0);
+
+  operation->deinitExecution();
+  for (int i = 0; i < num_inputs; i++) {
+    delete input_operations[i];
+    delete input_buffers[i];
+  }
+  delete operation;
+  BLI_rng_free(rng);
+}
+
+TEST(buffer_operations_performance, DISABLED_Mix)
+{
+  perf_operation(new MixAddOperation(), "MixAdd");
+  perf_operation(new MixBlendOperation(), "MixBlend");
+  perf_operation(new MixColorBurnOperation(), "MixColorBurn");
+  perf_operation(new MixColorOperation(), "MixColor");
+  perf_operation(new MixDarkenOperation(), "MixDarken");
+  perf_operation(new MixDifferenceOperation(), "MixDifference");
+  perf_operation(new MixDivideOperation(), "MixDivide");
+  perf_operation(new MixDodgeOperation(), "MixDodge");
+  perf_operation(new MixGlareOperation(), "MixGlare");
+  perf_operation(new MixHueOperation(), "MixHue");
+  perf_operation(new MixLightenOperation(), "MixLighten");
+  perf_operation(new MixLinearLightOperation(), "MixLinearLight");
+  perf_operation(new MixMultiplyOperation(), "MixMultiply");
+  perf_operation(new MixOverlayOperation(), "MixOverlay");
+  perf_operation(new MixSaturationOperation(), "MixSaturation");
+  perf_operation(new MixScreenOperation(), "MixScreen");
+  perf_operation(new MixSoftLightOperation(), "MixSoftLight");
+  perf_operation(new MixSubtractOperation(), "MixSubtract");
+  perf_operation(new MixValueOperation(), "MixValue");
+}
+
+TEST(buffer_operations_performance, DISABLED_Math)
+{
+  perf_operation(new MathAddOperation(), "MathAdd");
+  perf_operation(new MathMultiplyOperation(), "MathMultiply");
+  perf_operation(new MathDivideOperation(), "MathDivide");
+  perf_operation(new MathSineOperation(), "MathSine");
+  perf_operation(new MathPowerOperation(), "MathPower");
+  perf_operation(new MathLogarithmOperation(), "MathLogarithm");
+  perf_operation(new MathMinimumOperation(), "MathMinimum");
+  perf_operation(new MathRoundOperation(), "MathRound");
+  perf_operation(new MathModuloOperation(), "MathModulo");
+  perf_operation(new MathArcTan2Operation(), "MathArcTan2");
+  perf_operation(new MathSqrtOperation(), "MathSqrt");
+  perf_operation(new MathPingpongOperation(), "MathPingpong");
+  perf_operation(new MathCompareOperation(), "MathCompare");
+  perf_operation(new MathMultiplyAddOperation(), "MathMultiplyAdd");
+  perf_operation(new MathSmoothMinOperation(), "MathSmoothMin");
+}
+
+TEST(buffer_operations_performance, DISABLED_Color)
+{
+  const float lift[3] = {0.9f, 1.0f, 1.1f};
+  const float gamma_inv[3] = {1.2f, 1.0f, 0.8f};
+  const float gain[3] = {1.1f, 0.9f, 1.0f};
+  ColorBalanceLGGOperation *color_balance = new ColorBalanceLGGOperation();
+  color_balance->setLift(lift);
+  color_balance->setGammaInv(gamma_inv);
+  color_balance->setGain(gain);
+  perf_operation(color_balance, "ColorBalanceLGG");
+  perf_operation(new GammaOperation(), "Gamma");
+  perf_operation(new ConvertRGBToYUVOperation(), "ConvertRGBToYUV");
+  perf_operation(new ConvertRGBToHSVOperation(), "ConvertRGBToHSV");
+}
+
+}  // namespace blender::compositor::tests::performance
@@ -0,0 +1,409 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_rect.h"
+#include "BLI_rand.h"
+
+#include "COM_ColorBalanceLGGOperation.h"
+#include "COM_ConvertOperation.h"
+#include "COM_GammaOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MixOperation.h"
+
+#include <functional>
+#include <math.h>
+
+namespace blender::compositor::tests {
+
+static const int WIDTH = 67;
+static const int HEIGHT = 31;
+
+/* Serves the elements of a buffer, the way a ReadBufferOperation does in tiled execution. */
+class BufferInputOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+
+ public:
+  BufferInputOperation(DataType datatype, MemoryBuffer *buffer) : m_buffer(buffer)
+  {
+    this->addOutputSocket(datatype);
+    unsigned int resolution[2] = {(unsigned int)WIDTH, (unsigned int)HEIGHT};
+    this->setResolution(resolution);
+  }
+
+  void executePixelSampled(float output[4], float x, float y, PixelSampler /*sampler*/)
+  {
+    const float *elem = m_buffer->getElem((int)x, (int)y);
+    for (unsigned int i = 0; i < m_buffer->get_num_channels(); i++) {
+      output[i] = elem[i];
+    }
+  }
+};
+
+static MemoryBuffer *random_buffer(DataType datatype, RNG *rng, bool single)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, WIDTH, 0, HEIGHT);
+  MemoryBuffer *buffer = new MemoryBuffer(datatype, &rect, single);
+  const int num_elems = single ? 1 : WIDTH * HEIGHT;
+  const int num_floats = num_elems * (int)buffer->get_num_channels();
+  float *values = buffer->getBuffer();
+  for (int i = 0; i < num_floats; i++) {
+    /* Include values outside [0, 1] and exact zeros, the kernels branch on both. */
+    values[i] = (i % 13 == 0) ? 0.0f : BLI_rng_get_float(rng) * 2.0f - 0.5f;
+  }
+  return buffer;
+}
+
+static bool elems_equal(const float *a, const float *b, int num_channels)
+{
+  for (int i = 0; i < num_channels; i++) {
+    if (!(a[i] == b[i] || (isnan(a[i]) && isnan(b[i])))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Formula of an operation for a single pixel, written the way the operation calculated it before
+ * it got a buffer region execution. Gets the input elements of the pixel.
+ */
+using ReferenceFunction = std::function<void(const float *inputs[4], float output[4])>;
+
+/* The references may use other operations in a different order than the operation does. */
+static bool elems_near(const float *a, const float *b, int num_channels)
+{
+  for (int i = 0; i < num_channels; i++) {
+    if (!(fabsf(a[i] - b[i]) <= 1e-5f * max_ff(1.0f, fabsf(b[i])) ||
+          (isnan(a[i]) && isnan(b[i])))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Execute an operation per pixel and per buffer region on the same random inputs, the results
+ * have to be identical. When a reference is given the results have to match it as well.
+ */
+static void test_operation(NodeOperation *operation,
+                           bool single_last_input = false,
+                           const ReferenceFunction &reference = nullptr)
+{
+  RNG *rng = BLI_rng_new(0);
+  const int num_inputs = (int)operation->getNumberOfInputSockets();
+  MemoryBuffer *input_buffers[4];
+  BufferInputOperation *input_operations[4];
+
+  for (int i = 0; i < num_inputs; i++) {
+    const DataType datatype = operation->getInputSocket(i)->getDataType();
+    const bool single = single_last_input && i == num_inputs - 1;
+    input_buffers[i] = random_buffer(datatype, rng, single);
+    input_operations[i] = new BufferInputOperation(datatype, input_buffers[i]);
+    operation->getInputSocket(i)->setLink(input_operations[i]->getOutputSocket());
+  }
+  unsigned int resolution[2] = {(unsigned int)WIDTH, (unsigned int)HEIGHT};
+  operation->setResolution(resolution);
+  operation->initExecution();
+
+  rcti area;
+  BLI_rcti_init(&area, 0, WIDTH, 0, HEIGHT);
+  const DataType datatype = operation->getOutputSocket()->getDataType();
+  MemoryBuffer region_output(datatype, &area);
+  const int num_channels = (int)region_output.get_num_channels();
+  operation->executeBufferRegion(&region_output, &area, input_buffers);
+
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      float result[4];
+      operation->readSampled(result, x, y, COM_PS_NEAREST);
+      ASSERT_TRUE(elems_equal(result, region_output.getElem(x, y), num_channels))
+          << "pixel " << x << ", " << y;
+
+      if (reference) {
+        const float *inputs[4];
+        for (int i = 0; i < num_inputs; i++) {
+          const bool single = single_last_input && i == num_inputs - 1;
+          inputs[i] = single ? input_buffers[i]->getBuffer() : input_buffers[i]->getElem(x, y);
+        }
+        float expected[4];
+        reference(inputs, expected);
+        ASSERT_TRUE(elems_near(result, expected, num_channels))
+            << "pixel " << x << ", " << y << " differs from the reference";
+      }
+    }
+  }
+
+  operation->deinitExecution();
+  for (int i = 0; i < num_inputs; i++) {
+    delete input_operations[i];
+    delete input_buffers[i];
+  }
+  delete operation;
+  BLI_rng_free(rng);
+}
+
+/**
+ * Formula of a mix operation for the color channels, the alpha of the first color and clamping
+ * are applied by #test_mix_operation.
+ */
+using MixFunction = void (*)(float value,
+                             const float color1[4],
+                             const float color2[4],
+                             float output[4]);
+
+static void mix_color_burn(float value,
+                           const float color1[4],
+                           const float color2[4],
+                           float output[4])
+{
+  const float valuem = 1.0f - value;
+  for (int i = 0; i < 3; i++) {
+    float tmp = valuem + value * color2[i];
+    if (tmp <= 0.0f) {
+      output[i] = 0.0f;
+    }
+    else {
+      tmp = 1.0f - (1.0f - color1[i]) / tmp;
+      if (tmp < 0.0f) {
+        output[i] = 0.0f;
+      }
+      else if (tmp > 1.0f) {
+        output[i] = 1.0f;
+      }
+      else {
+        output[i] = tmp;
+      }
+    }
+  }
+}
+
+static void mix_divide(float value, const float color1[4], const float color2[4], float output[4])
+{
+  const float valuem = 1.0f - value;
+  for (int i = 0; i < 3; i++) {
+    if (color2[i] != 0.0f) {
+      output[i] = valuem * (color1[i]) + value * (color1[i]) / color2[i];
+    }
+    else {
+      output[i] = 0.0f;
+    }
+  }
+}
+
+static void mix_dodge(float value, const float color1[4], const float color2[4], float output[4])
+{
+  for (int i = 0; i < 3; i++) {
+    if (color1[i] != 0.0f) {
+      float tmp = 1.0f - value * color2[i];
+      if (tmp <= 0.0f) {
+        output[i] = 1.0f;
+      }
+      else {
+        tmp = color1[i] / tmp;
+        if (tmp > 1.0f) {
+          output[i] = 1.0f;
+        }
+        else {
+          output[i] = tmp;
+        }
+      }
+    }
+    else {
+      output[i] = 0.0f;
+    }
+  }
+}
+
+template<typename Operation> static void test_mix_operation(MixFunction mix = nullptr)
+{
+  for (int variant = 0; variant < 4; variant++) {
+    const bool use_clamp = variant & 1;
+    const bool use_alpha_multiply = variant & 2;
+    Operation *operation = new Operation();
+    operation->setUseClamp(use_clamp);
+    operation->setUseValueAlphaMultiply(use_alpha_multiply);
+
+    ReferenceFunction reference = nullptr;
+    if (mix) {
+      reference = [=](const float *inputs[4], float output[4]) {
+        float value = inputs[0][0];
+        if (use_alpha_multiply) {
+          value *= inputs[2][3];
+        }
+        mix(value, inputs[1], inputs[2], output);
+        output[3] = inputs[1][3];
+        if (use_clamp) {
+          clamp_v4(output, 0.0f, 1.0f);
+        }
+      };
+    }
+    test_operation(operation, false, reference);
+  }
+}
+
+TEST(buffer_operations, Mix)
+{
+  test_mix_operation<MixAddOperation>();
+  test_mix_operation<MixBlendOperation>();
+  test_mix_operation<MixColorBurnOperation>(mix_color_burn);
+  test_mix_operation<MixColorOperation>();
+  test_mix_operation<MixDarkenOperation>();
+  test_mix_operation<MixDifferenceOperation>();
+  test_mix_operation<MixDivideOperation>(mix_divide);
+  test_mix_operation<MixDodgeOperation>(mix_dodge);
+  test_mix_operation<MixGlareOperation>();
+  test_mix_operation<MixHueOperation>();
+  test_mix_operation<MixLightenOperation>();
+  test_mix_operation<MixLinearLightOperation>();
+  test_mix_operation<MixMultiplyOperation>();
+  test_mix_operation<MixOverlayOperation>();
+  test_mix_operation<MixSaturationOperation>();
+  test_mix_operation<MixScreenOperation>();
+  test_mix_operation<MixSoftLightOperation>();
+  test_mix_operation<MixSubtractOperation>();
+  test_mix_operation<MixValueOperation>();
+}
+
+/** Formula of a math operation, clamping is applied by #test_math_operation. */
+using MathFunction = float (*)(const float *inputs[4]);
+
+static float math_pingpong(const float *inputs[4])
+{
+  return fabsf(fractf((inputs[0][0] - inputs[1][0]) / (inputs[1][0] * 2.0f)) * inputs[1][0] *
+                   2.0f -
+               inputs[1][0]);
+}
+
+static float math_compare(const float *inputs[4])
+{
+  return (fabsf(inputs[0][0] - inputs[1][0]) <= MAX2(inputs[2][0], 1e-5f)) ? 1.0f : 0.0f;
+}
+
+template<typename Operation> static void test_math_operation(MathFunction math = nullptr)
+{
+  for (int variant = 0; variant < 3; variant++) {
+    const bool use_clamp = variant == 1;
+    Operation *operation = new Operation();
+    operation->setUseClamp(use_clamp);
+
+    ReferenceFunction reference = nullptr;
+    if (math) {
+      reference = [=](const float *inputs[4], float output[4]) {
+        output[0] = math(inputs);
+        if (use_clamp) {
+          CLAMP(output[0], 0.0f, 1.0f);
+        }
+      };
+    }
+    /* The last variant uses a constant input, as a value socket without link would. */
+    test_operation(operation, variant == 2, reference);
+  }
+}
+
+TEST(buffer_operations, Math)
+{
+  test_math_operation<MathAddOperation>();
+  test_math_operation<MathSubtractOperation>();
+  test_math_operation<MathMultiplyOperation>();
+  test_math_operation<MathDivideOperation>();
+  test_math_operation<MathSineOperation>();
+  test_math_operation<MathCosineOperation>();
+  test_math_operation<MathTangentOperation>();
+  test_math_operation<MathHyperbolicSineOperation>();
+  test_math_operation<MathHyperbolicCosineOperation>();
+  test_math_operation<MathHyperbolicTangentOperation>();
+  test_math_operation<MathArcSineOperation>();
+  test_math_operation<MathArcCosineOperation>();
+  test_math_operation<MathArcTangentOperation>();
+  test_math_operation<MathPowerOperation>();
+  test_math_operation<MathLogarithmOperation>();
+  test_math_operation<MathMinimumOperation>();
+  test_math_operation<MathMaximumOperation>();
+  test_math_operation<MathRoundOperation>();
+  test_math_operation<MathLessThanOperation>();
+  test_math_operation<MathGreaterThanOperation>();
+  test_math_operation<MathModuloOperation>();
+  test_math_operation<MathAbsoluteOperation>();
+  test_math_operation<MathRadiansOperation>();
+  test_math_operation<MathDegreesOperation>();
+  test_math_operation<MathArcTan2Operation>();
+  test_math_operation<MathFloorOperation>();
+  test_math_operation<MathCeilOperation>();
+  test_math_operation<MathFractOperation>();
+  test_math_operation<MathSqrtOperation>();
+  test_math_operation<MathInverseSqrtOperation>();
+  test_math_operation<MathSignOperation>();
+  test_math_operation<MathExponentOperation>();
+  test_math_operation<MathTruncOperation>();
+  test_math_operation<MathSnapOperation>();
+  test_math_operation<MathWrapOperation>();
+  test_math_operation<MathPingpongOperation>(math_pingpong);
+  test_math_operation<MathCompareOperation>(math_compare);
+  test_math_operation<MathMultiplyAddOperation>();
+  test_math_operation<MathSmoothMinOperation>();
+  test_math_operation<MathSmoothMaxOperation>();
+}
+
+TEST(buffer_operations, Gamma)
+{
+  test_operation(new GammaOperation());
+  test_operation(new GammaOperation(), true);
+}
+
+TEST(buffer_operations, ColorBalanceLGG)
+{
+  const float lift[3] = {0.9f, 1.0f, 1.1f};
+  const float gamma_inv[3] = {1.2f, 1.0f, 0.8f};
+  const float gain[3] = {1.1f, 0.9f, 1.0f};
+  ColorBalanceLGGOperation *operation = new ColorBalanceLGGOperation();
+  operation->setLift(lift);
+  operation->setGammaInv(gamma_inv);
+  operation->setGain(gain);
+  test_operation(operation);
+}
+
+TEST(buffer_operations, Convert)
+{
+  test_operation(new ConvertValueToColorOperation());
+  test_operation(new ConvertColorToValueOperation());
+  test_operation(new ConvertColorToVectorOperation());
+  test_operation(new ConvertValueToVectorOperation());
+  test_operation(new ConvertVectorToColorOperation());
+  test_operation(new ConvertVectorToValueOperation());
+  test_operation(new ConvertRGBToYUVOperation());
+  test_operation(new ConvertYUVToRGBOperation());
+  test_operation(new ConvertRGBToHSVOperation());
+  test_operation(new ConvertHSVToRGBOperation());
+  test_operation(new ConvertPremulToStraightOperation());
+  test_operation(new ConvertStraightToPremulOperation());
+  for (int mode = 0; mode < 3; mode++) {
+    ConvertRGBToYCCOperation *to_ycc = new ConvertRGBToYCCOperation();
+    to_ycc->setMode(mode);
+    test_operation(to_ycc);
+    ConvertYCCToRGBOperation *to_rgb = new ConvertYCCToRGBOperation();
+    to_rgb->setMode(mode);
+    test_operation(to_rgb);
+  }
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BLI_rand.h"
+#include "BLI_rect.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "COM_FFTConvolution.h"
+
+namespace blender::compositor::tests {
+
+static MemoryBuffer *random_color_buffer(RNG *rng, int width, int height)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, width, 0, height);
+  MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+  float *values = buffer->getBuffer();
+  for (int i = 0; i < width * height * COM_NUM_CHANNELS_COLOR; i++) {
+    values[i] = BLI_rng_get_float(rng);
+  }
+  return buffer;
+}
+
+/* Convolve an image with the FFT and directly, the results have to match. */
+static void test_convolution(int width, int height, int kernel_width, int kernel_height)
+{
+  RNG *rng = BLI_rng_new(0);
+  MemoryBuffer *image = random_color_buffer(rng, width, height);
+  MemoryBuffer *kernel = random_color_buffer(rng, kernel_width, kernel_height);
+  const int num_channels = 3;
+
+  float *result = (float *)MEM_mallocN(
+      sizeof(float) * width * height * COM_NUM_CHANNELS_COLOR, __func__);
+  FFTConvolution::convolve(result, image, kernel, num_channels);
+
+  const int hw = kernel_width / 2;
+  const int hh = kernel_height / 2;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float expected[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      for (int j = 0; j < kernel_height; j++) {
+        for (int i = 0; i < kernel_width; i++) {
+          const int ix = x + hw - i;
+          const int iy = y + hh - j;
+          if (ix < 0 || ix >= width || iy < 0 || iy >= height) {
+            continue;
+          }
+          const float *weight = kernel->getElem(i, j);
+          const float *elem = image->getElem(ix, iy);
+          for (int c = 0; c < num_channels; c++) {
+            expected[c] += weight[c] * elem[c];
+          }
+        }
+      }
+      const float *elem = &result[(y * width + x) * COM_NUM_CHANNELS_COLOR];
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        ASSERT_NEAR(elem[c], expected[c], 1e-5f * kernel_width * kernel_height)
+            << "element " << x << ", " << y << " channel " << c;
+      }
+    }
+  }
+
+  MEM_freeN(result);
+  delete kernel;
+  delete image;
+  BLI_rng_free(rng);
+}
+
+TEST(fft_convolution, OddKernel)
+{
+  test_convolution(37, 23, 5, 7);
+}
+
+TEST(fft_convolution, EvenKernel)
+{
+  test_convolution(37, 23, 8, 4);
+}
+
+TEST(fft_convolution, KernelLargerThanImage)
+{
+  test_convolution(13, 9, 16, 16);
+}
+
+TEST(fft_convolution, ManyBlocks)
+{
+  test_convolution(131, 97, 3, 3);
+}
+
+}  // namespace blender::compositor::tests
@@ -0,0 +1,242 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "DNA_image_types.h"
+#include "DNA_material_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+#include "BKE_scene.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "RNA_define.h"
+
+#include "COM_ResultCache.h"
+#include "COM_compositor.h"
+
+#include <math.h>
+#include <vector>
+
+namespace blender::compositor::tests {
+
+static const int WIDTH = 160;
+static const int HEIGHT = 96;
+
+static int test_break(void * /*handle*/)
+{
+  return 0;
+}
+
+static void progress(void * /*handle*/, float /*progress*/)
+{
+}
+
+static void stats_draw(void * /*handle*/, const char * /*str*/)
+{
+}
+
+class FullFrameExecutionTest : public testing::Test {
+ protected:
+  Main *bmain;
+  Scene *scene;
+  bNodeTree *ntree;
+  bNode *viewer;
+
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BKE_idtype_init();
+    RNA_init();
+    IMB_init();
+    BKE_images_init();
+    init_nodesystem();
+  }
+
+  static void TearDownTestCase()
+  {
+    COM_deinitialize();
+    free_nodesystem();
+    BKE_images_exit();
+    IMB_exit();
+    RNA_exit();
+    BLI_threadapi_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    G_MAIN = bmain;
+    scene = BKE_scene_add(bmain, "Scene");
+    ntree = ntreeAddTree(bmain, "Compositing", "CompositorNodeTree");
+    ntree->chunksize = 32;
+    ntree->test_break = test_break;
+    ntree->progress = progress;
+    ntree->stats_draw = stats_draw;
+  }
+
+  void TearDown() override
+  {
+    ResultCache::clear();
+    BKE_main_free(bmain);
+    G_MAIN = nullptr;
+  }
+
+  bNode *add_node(int type)
+  {
+    bNode *node = nodeAddStaticNode(nullptr, ntree, type);
+    /* Previews would add operations that are never executed on buffers. */
+    node->flag &= ~NODE_PREVIEW;
+    return node;
+  }
+
+  void link(bNode *fromnode, int fromindex, bNode *tonode, int toindex)
+  {
+    nodeAddLink(ntree,
+                fromnode,
+                (bNodeSocket *)BLI_findlink(&fromnode->outputs, fromindex),
+                tonode,
+                (bNodeSocket *)BLI_findlink(&tonode->inputs, toindex));
+  }
+
+  void set_input_value(bNode *node, int index, float value)
+  {
+    bNodeSocket *socket = (bNodeSocket *)BLI_findlink(&node->inputs, index);
+    ((bNodeSocketValueFloat *)socket->default_value)->value = value;
+  }
+
+  /**
+   * A tree mixing operations that are calculated on buffers with a complex operation, which
+   * splits it into a group writing to a MemoryProxy and a group writing to the viewer.
+   */
+  void build_tree()
+  {
+    const float color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    Image *image = BKE_image_add_generated(bmain,
+                                           WIDTH,
+                                           HEIGHT,
+                                           "Source",
+                                           24,
+                                           true,
+                                           IMA_GENTYPE_GRID_COLOR,
+                                           color,
+                                           false,
+                                           false,
+                                           false);
+
+    bNode *input = add_node(CMP_NODE_IMAGE);
+    input->id = &image->id;
+    ntreeUpdateTree(bmain, ntree);
+
+    bNode *gamma = add_node(CMP_NODE_GAMMA);
+    link(input, 0, gamma, 0);
+    set_input_value(gamma, 1, 2.2f);
+
+    bNode *bw = add_node(CMP_NODE_RGBTOBW);
+    link(input, 0, bw, 0);
+
+    bNode *math = add_node(CMP_NODE_MATH);
+    math->custom1 = NODE_MATH_MULTIPLY;
+    link(bw, 0, math, 0);
+    set_input_value(math, 1, 0.75f);
+
+    bNode *mix = add_node(CMP_NODE_MIX_RGB);
+    mix->custom1 = MA_RAMP_ADD;
+    set_input_value(mix, 0, 0.5f);
+    link(gamma, 0, mix, 1);
+    link(math, 0, mix, 2);
+
+    bNode *blur = add_node(CMP_NODE_BLUR);
+    NodeBlurData *blur_data = (NodeBlurData *)blur->storage;
+    blur_data->sizex = 4;
+    blur_data->sizey = 4;
+    link(mix, 0, blur, 0);
+
+    bNode *balance = add_node(CMP_NODE_COLORBALANCE);
+    link(blur, 0, balance, 1);
+
+    viewer = add_node(CMP_NODE_VIEWER);
+    link(balance, 0, viewer, 0);
+
+    ntreeUpdateTree(bmain, ntree);
+  }
+
+  /** Execute the tree and return the pixels of the viewer. */
+  std::vector<float> execute(bool full_frame)
+  {
+    SET_FLAG_FROM_TEST(ntree->flag, full_frame, NTREE_COM_FULL_FRAME);
+    viewer->flag |= NODE_DO_OUTPUT | NODE_DO_OUTPUT_RECALC;
+    /* Execute the groups instead of restoring the results of the previous execution. */
+    ResultCache::clear();
+
+    COM_execute(&scene->r,
+                scene,
+                ntree,
+                false,
+                &scene->view_settings,
+                &scene->display_settings,
+                "");
+
+    std::vector<float> pixels;
+    Image *image = (Image *)viewer->id;
+    void *lock;
+    ImBuf *ibuf = BKE_image_acquire_ibuf(image, nullptr, &lock);
+    if (ibuf && ibuf->rect_float) {
+      pixels.assign(ibuf->rect_float, ibuf->rect_float + ibuf->x * ibuf->y * 4);
+    }
+    BKE_image_release_ibuf(image, ibuf, lock);
+    /* The next execution has to write the viewer again. */
+    BKE_image_free_buffers(image);
+    return pixels;
+  }
+};
+
+TEST_F(FullFrameExecutionTest, MatchesTiledExecution)
+{
+  build_tree();
+
+  const std::vector<float> tiled = execute(false);
+  const std::vector<float> full_frame = execute(true);
+
+  ASSERT_EQ(tiled.size(), (size_t)WIDTH * HEIGHT * 4);
+  ASSERT_EQ(full_frame.size(), tiled.size());
+
+  float max_diff = 0.0f;
+  bool has_color = false;
+  for (size_t i = 0; i < tiled.size(); i++) {
+    max_diff = fmaxf(max_diff, fabsf(tiled[i] - full_frame[i]));
+    has_color |= tiled[i] != tiled[0];
+  }
+  /* A viewer that wasn't written to would trivially match. */
+  EXPECT_TRUE(has_color);
+  EXPECT_LE(max_diff, 1e-6f);
+}
+
+}  // namespace blender::compositor::tests
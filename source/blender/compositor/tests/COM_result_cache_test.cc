@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_rect.h"
+#include "BLI_threads.h"
+
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+
+#include "IMB_imbuf.h"
+
+#include "RE_pipeline.h"
+
+#include "COM_ResultCache.h"
+#include "COM_SetColorOperation.h"
+
+#include <string.h>
+
+namespace blender::compositor::tests {
+
+static const int WIDTH = 16;
+static const int HEIGHT = 8;
+
+static MemoryBuffer *filled_buffer(float value)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, WIDTH, 0, HEIGHT);
+  MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+  float *values = buffer->getBuffer();
+  for (int i = 0; i < WIDTH * HEIGHT * COM_NUM_CHANNELS_COLOR; i++) {
+    values[i] = value + (float)i;
+  }
+  return buffer;
+}
+
+static bool buffers_equal(MemoryBuffer *a, MemoryBuffer *b)
+{
+  return a->getWidth() == b->getWidth() && a->getHeight() == b->getHeight() &&
+         memcmp(a->getBuffer(),
+                b->getBuffer(),
+                sizeof(float) * WIDTH * HEIGHT * COM_NUM_CHANNELS_COLOR) == 0;
+}
+
+static void color_operation_init(SetColorOperation *operation, float value)
+{
+  const float color[4] = {value, value, value, 1.0f};
+  operation->setChannels(color);
+  unsigned int resolution[2] = {(unsigned int)WIDTH, (unsigned int)HEIGHT};
+  operation->setResolution(resolution);
+}
+
+static CompositorContext context_create()
+{
+  CompositorContext context;
+  /* Not set by the constructor, the compositor always sets it before execution. */
+  context.setViewName("");
+  return context;
+}
+
+static uint64_t operation_key(const CompositorContext &context, NodeOperation *operation)
+{
+  ResultCache::OperationKeys keys;
+  return ResultCache::determineKey(context, operation, keys);
+}
+
+class ResultCacheTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BKE_idtype_init();
+    IMB_init();
+    BKE_images_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_images_exit();
+    IMB_exit();
+    BLI_threadapi_exit();
+  }
+
+  void TearDown() override
+  {
+    ResultCache::clear();
+  }
+};
+
+TEST_F(ResultCacheTest, RestoreStoredResult)
+{
+  EXPECT_EQ(ResultCache::acquire(1), nullptr);
+
+  MemoryBuffer *result = filled_buffer(1.0f);
+  ResultCache::store(1, result);
+
+  /* The cache keeps a copy of the result. */
+  MemoryBuffer *restored = ResultCache::acquire(1);
+  ASSERT_NE(restored, nullptr);
+  EXPECT_NE(restored, result);
+  EXPECT_TRUE(buffers_equal(restored, result));
+  ResultCache::release(1);
+  EXPECT_EQ(ResultCache::acquire(2), nullptr);
+
+  /* Storing under the same key replaces the result. */
+  MemoryBuffer *result_new = filled_buffer(2.0f);
+  ResultCache::store(1, result_new);
+  restored = ResultCache::acquire(1);
+  ASSERT_NE(restored, nullptr);
+  EXPECT_TRUE(buffers_equal(restored, result_new));
+  ResultCache::release(1);
+
+  ResultCache::clear();
+  EXPECT_EQ(ResultCache::acquire(1), nullptr);
+
+  delete result;
+  delete result_new;
+}
+
+TEST_F(ResultCacheTest, KeyOfSetOperation)
+{
+  CompositorContext context = context_create();
+  SetColorOperation operation_a, operation_b, operation_c;
+  color_operation_init(&operation_a, 0.5f);
+  color_operation_init(&operation_b, 0.5f);
+  color_operation_init(&operation_c, 0.25f);
+
+  const uint64_t key_a = operation_key(context, &operation_a);
+  EXPECT_NE(key_a, 0);
+  EXPECT_EQ(key_a, operation_key(context, &operation_b));
+  EXPECT_NE(key_a, operation_key(context, &operation_c));
+}
+
+TEST_F(ResultCacheTest, KeyChangesWhenRenderResultIsFreed)
+{
+  CompositorContext context = context_create();
+  bNode node = {nullptr};
+  node.type = CMP_NODE_R_LAYERS;
+  SetColorOperation operation;
+  color_operation_init(&operation, 0.5f);
+  operation.setbNode(&node, 0);
+
+  const uint64_t key = operation_key(context, &operation);
+  EXPECT_NE(key, 0);
+  EXPECT_EQ(key, operation_key(context, &operation));
+
+  /* Passes of a new render result can be allocated at the addresses of the freed ones. */
+  RenderResult *rr = (RenderResult *)MEM_callocN(sizeof(RenderResult), __func__);
+  RE_FreeRenderResult(rr);
+  const uint64_t key_freed = operation_key(context, &operation);
+  EXPECT_NE(key_freed, 0);
+  EXPECT_NE(key_freed, key);
+}
+
+TEST_F(ResultCacheTest, KeyChangesWhenImageIsReloaded)
+{
+  Main *bmain = BKE_main_new();
+  const float color[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+  Image *image = BKE_image_add_generated(
+      bmain, WIDTH, HEIGHT, "Image", 32, false, IMA_GENTYPE_BLANK, color, false, false, false);
+
+  CompositorContext context = context_create();
+  ImageUser *iuser = (ImageUser *)MEM_callocN(sizeof(ImageUser), __func__);
+  iuser->ok = 1;
+  bNode node = {nullptr};
+  node.type = CMP_NODE_IMAGE;
+  node.id = &image->id;
+  node.storage = iuser;
+  SetColorOperation operation;
+  color_operation_init(&operation, 0.5f);
+  operation.setbNode(&node, 0);
+
+  const uint64_t key = operation_key(context, &operation);
+  EXPECT_NE(key, 0);
+  EXPECT_EQ(key, operation_key(context, &operation));
+
+  /* Reloading frees the buffers, the new ones can be allocated at the same addresses. */
+  BKE_image_signal(bmain, image, nullptr, IMA_SIGNAL_RELOAD);
+  const uint64_t key_reloaded = operation_key(context, &operation);
+  EXPECT_NE(key_reloaded, 0);
+  EXPECT_NE(key_reloaded, key);
+  EXPECT_EQ(key_reloaded, operation_key(context, &operation));
+
+  MEM_freeN(node.storage);
+  BKE_main_free(bmain);
+}
+
+}  // namespace blender::compositor::tests
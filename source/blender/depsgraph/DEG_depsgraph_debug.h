@@ -63,6 +63,13 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Timing of operations evaluated during the recent graph evaluations, in the Chrome trace event
+ * format (can be opened in chrome://tracing or Perfetto). */
+void DEG_debug_eval_profile_trace_json(const struct Depsgraph *graph, FILE *stream);
+
+/* Chain of operations which determined the duration of the last graph evaluation. */
+void DEG_debug_eval_profile_critical_path(const struct Depsgraph *graph, FILE *stream);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
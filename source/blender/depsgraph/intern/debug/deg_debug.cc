@@ -47,6 +47,8 @@ bool DepsgraphDebug::do_time_debug() const
 
 void DepsgraphDebug::begin_graph_evaluation()
 {
+  eval_profile.begin_evaluation();
+
   if (!do_time_debug()) {
     return;
   }
@@ -69,6 +71,7 @@ void DepsgraphDebug::end_graph_evaluation()
   const double graph_eval_end_time = PIL_check_seconds_timer();
   printf("Depsgraph updated in %f seconds.\n", graph_eval_end_time - graph_evaluation_start_time_);
   printf("Depsgraph evaluation FPS: %f\n", 1.0f / fps_samples_.get_averaged());
+  eval_profile.write_critical_path(stdout, name.empty() ? "Depsgraph" : name.c_str());
 
   is_ever_evaluated = true;
 }
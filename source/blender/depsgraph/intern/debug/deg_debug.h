@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include "intern/debug/deg_eval_profile.h"
 #include "intern/debug/deg_time_average.h"
 #include "intern/depsgraph_type.h"
 
@@ -53,6 +54,9 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  /* Timing of the operations evaluated during the recent graph evaluations. */
+  EvalProfile eval_profile;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
@@ -0,0 +1,243 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/debug/deg_eval_profile.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "DEG_depsgraph_debug.h"
+
+#include "atomic_ops.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace deg = blender::deg;
+
+namespace blender {
+namespace deg {
+
+namespace {
+
+int current_thread_id()
+{
+  static int32_t num_threads = 0;
+  static thread_local const int thread_id = atomic_fetch_and_add_int32(&num_threads, 1);
+  return thread_id;
+}
+
+void write_json_string(FILE *stream, const string &str)
+{
+  fputc('"', stream);
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      fputc('\\', stream);
+      fputc(c, stream);
+    }
+    else if ((unsigned char)c < 0x20) {
+      fprintf(stream, "\\u%04x", (unsigned char)c);
+    }
+    else {
+      fputc(c, stream);
+    }
+  }
+  fputc('"', stream);
+}
+
+/* Find the recorded event of the dependency of the given operation which finished last.
+ * No-op operations are not evaluated, so the search goes through them to their dependencies. */
+const EvalProfileEvent *find_last_finished_dependency(
+    const OperationNode *operation,
+    const Map<const OperationNode *, const EvalProfileEvent *> &events)
+{
+  const EvalProfileEvent *last_event = nullptr;
+  Set<const OperationNode *> visited;
+  Vector<const OperationNode *> stack;
+  stack.append(operation);
+  while (!stack.is_empty()) {
+    const OperationNode *node = stack.pop_last();
+    for (const Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      const OperationNode *from = (const OperationNode *)rel->from;
+      if (!visited.add(from)) {
+        continue;
+      }
+      const EvalProfileEvent *event = events.lookup_default(from, nullptr);
+      if (event != nullptr) {
+        if (last_event == nullptr || event->end_time > last_event->end_time) {
+          last_event = event;
+        }
+      }
+      else if (from->is_noop()) {
+        stack.append(from);
+      }
+    }
+  }
+  return last_event;
+}
+
+}  // namespace
+
+EvalProfile::EvalProfile() : events_(nullptr), num_events_(0), evaluation_(0)
+{
+}
+
+EvalProfile::~EvalProfile()
+{
+  MEM_SAFE_FREE(events_);
+}
+
+void EvalProfile::begin_evaluation()
+{
+  if (events_ == nullptr) {
+    events_ = (EvalProfileEvent *)MEM_malloc_arrayN(
+        MAX_EVENTS, sizeof(EvalProfileEvent), "depsgraph eval profile");
+  }
+  ++evaluation_;
+}
+
+void EvalProfile::record(const OperationNode *operation, double start_time, double end_time)
+{
+  BLI_assert(events_ != nullptr);
+  const uint64_t index = atomic_fetch_and_add_uint64(&num_events_, 1);
+  EvalProfileEvent &event = events_[index & (MAX_EVENTS - 1)];
+  event.operation = operation;
+  event.start_time = start_time;
+  event.end_time = end_time;
+  event.thread_id = current_thread_id();
+  event.evaluation = evaluation_;
+}
+
+void EvalProfile::clear()
+{
+  num_events_ = 0;
+}
+
+uint64_t EvalProfile::first_event_index() const
+{
+  return (num_events_ > MAX_EVENTS) ? num_events_ - MAX_EVENTS : 0;
+}
+
+void EvalProfile::write_trace_json(FILE *stream) const
+{
+  const uint64_t first_index = first_event_index();
+  const double base_time = (num_events_ != 0) ? event_at(first_index).start_time : 0.0;
+  fprintf(stream, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  for (uint64_t index = first_index; index < num_events_; index++) {
+    const EvalProfileEvent &event = event_at(index);
+    const OperationNode *operation = event.operation;
+    fprintf(stream, (index == first_index) ? "\n" : ",\n");
+    fprintf(stream, "{\"name\": ");
+    write_json_string(stream, operation->full_identifier());
+    fprintf(stream,
+            ", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, "
+            "\"dur\": %.3f, \"args\": {\"evaluation\": %d}}",
+            nodeTypeAsString(operation->owner->type),
+            event.thread_id,
+            (event.start_time - base_time) * 1e6,
+            (event.end_time - event.start_time) * 1e6,
+            event.evaluation);
+  }
+  fprintf(stream, "\n]}\n");
+}
+
+void EvalProfile::write_critical_path(FILE *stream, const char *label) const
+{
+  /* Gather events of the last evaluation. */
+  Map<const OperationNode *, const EvalProfileEvent *> events;
+  const EvalProfileEvent *last_event = nullptr;
+  double start_time = 0.0;
+  for (uint64_t index = first_event_index(); index < num_events_; index++) {
+    const EvalProfileEvent &event = event_at(index);
+    if (event.evaluation != evaluation_) {
+      continue;
+    }
+    events.add(event.operation, &event);
+    if (last_event == nullptr || event.end_time > last_event->end_time) {
+      last_event = &event;
+    }
+    if (events.size() == 1 || event.start_time < start_time) {
+      start_time = event.start_time;
+    }
+  }
+  if (last_event == nullptr) {
+    fprintf(stream, "Critical path of %s: no operations evaluated.\n", label);
+    return;
+  }
+
+  Vector<const EvalProfileEvent *> path;
+  for (const EvalProfileEvent *event = last_event; event != nullptr;
+       event = find_last_finished_dependency(event->operation, events)) {
+    path.append(event);
+  }
+
+  double path_time = 0.0;
+  for (const EvalProfileEvent *event : path) {
+    path_time += event->end_time - event->start_time;
+  }
+  fprintf(stream,
+          "Critical path of %s: %d operations, %.3f ms evaluating out of %.3f ms.\n",
+          label,
+          (int)path.size(),
+          path_time * 1000.0,
+          (last_event->end_time - start_time) * 1000.0);
+  fprintf(stream, "  %10s %10s %10s  %s\n", "start", "duration", "wait", "operation");
+  double previous_end_time = start_time;
+  for (int i = (int)path.size() - 1; i >= 0; i--) {
+    const EvalProfileEvent *event = path[i];
+    fprintf(stream,
+            "  %10.3f %10.3f %10.3f  %s\n",
+            (event->start_time - start_time) * 1000.0,
+            (event->end_time - event->start_time) * 1000.0,
+            (event->start_time - previous_end_time) * 1000.0,
+            event->operation->full_identifier().c_str());
+    previous_end_time = event->end_time;
+  }
+}
+
+}  // namespace deg
+}  // namespace blender
+
+void DEG_debug_eval_profile_trace_json(const Depsgraph *depsgraph, FILE *stream)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(depsgraph);
+  deg_graph->debug.eval_profile.write_trace_json(stream);
+}
+
+void DEG_debug_eval_profile_critical_path(const Depsgraph *depsgraph, FILE *stream)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(depsgraph);
+  const char *label = deg_graph->debug.name.empty() ? "Depsgraph" :
+                                                      deg_graph->debug.name.c_str();
+  deg_graph->debug.eval_profile.write_critical_path(stream, label);
+}
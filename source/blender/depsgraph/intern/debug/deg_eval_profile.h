@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#include "BLI_sys_types.h"
+
+namespace blender {
+namespace deg {
+
+struct OperationNode;
+
+/* Timing of a single operation evaluation. */
+struct EvalProfileEvent {
+  const OperationNode *operation;
+  double start_time;
+  double end_time;
+  /* Sequential number of the thread which evaluated the operation. */
+  int thread_id;
+  /* Number of the graph evaluation this event belongs to. */
+  int evaluation;
+};
+
+/* Ring buffer of operation timings of the most recent graph evaluations.
+ *
+ * Recording is cheap enough to be always enabled: it is a single atomic increment and a few
+ * stores. Events refer to the operation nodes, so the profile is to be cleared whenever nodes of
+ * the graph are freed. */
+class EvalProfile {
+ public:
+  EvalProfile();
+  ~EvalProfile();
+
+  EvalProfile(const EvalProfile &other) = delete;
+  EvalProfile &operator=(const EvalProfile &other) = delete;
+
+  /* Must be called before operations of a new graph evaluation are recorded. */
+  void begin_evaluation();
+
+  /* Thread-safe, can be called from evaluation threads. */
+  void record(const OperationNode *operation, double start_time, double end_time);
+
+  /* Forget all recorded events. */
+  void clear();
+
+  /* Write all recorded events in the Chrome trace event format, which can be opened in
+   * chrome://tracing or Perfetto. */
+  void write_trace_json(FILE *stream) const;
+
+  /* Write operations which were delaying the end of the last graph evaluation: starting from the
+   * operation which finished last, every step goes to the dependency which finished last. */
+  void write_critical_path(FILE *stream, const char *label) const;
+
+ protected:
+  /* Must be power of two. */
+  static const constexpr uint64_t MAX_EVENTS = (1 << 15);
+
+  uint64_t first_event_index() const;
+  const EvalProfileEvent &event_at(uint64_t index) const
+  {
+    return events_[index & (MAX_EVENTS - 1)];
+  }
+
+  /* Allocated on the first evaluation, so that graphs which are never evaluated do not use any
+   * memory for the profile. */
+  EvalProfileEvent *events_;
+  /* Total number of recorded events, including the overwritten ones. */
+  uint64_t num_events_;
+  int evaluation_;
+};
+
+}  // namespace deg
+}  // namespace blender
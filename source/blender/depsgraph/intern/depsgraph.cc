@@ -226,6 +226,8 @@ void Depsgraph::add_entry_tag(OperationNode *node)
 
 void Depsgraph::clear_all_nodes()
 {
+  /* Recorded timing refers to the operation nodes which are about to be freed. */
+  debug.eval_profile.clear();
   clear_id_nodes();
   delete time_source;
   time_source = nullptr;
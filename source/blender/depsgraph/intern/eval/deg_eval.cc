@@ -31,6 +31,7 @@
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -43,6 +44,8 @@
 
 #include "atomic_ops.h"
 
+#include <algorithm>
+
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
@@ -69,11 +72,27 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
+/* Storage for operations which became ready for evaluation. Most of the time only a few children
+ * become ready at once, so avoid heap allocation for those. */
+using ReadyOperations = Vector<OperationNode *, 16>;
+
 void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
 {
   BLI_task_pool_push(pool, deg_task_run_func, node, false, NULL);
 }
 
+void schedule_node_to_vector(OperationNode *node,
+                             const int UNUSED(thread_id),
+                             ReadyOperations *ready_operations)
+{
+  ready_operations->append(node);
+}
+
+bool operation_priority_greater(const OperationNode *a, const OperationNode *b)
+{
+  return a->priority > b->priority;
+}
+
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -104,14 +123,16 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  /* Perform operation. The timing is always gathered, it is used to prioritize operations on the
+   * next evaluation. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double end_time = PIL_check_seconds_timer();
+  const double time = end_time - start_time;
+  operation_node->stats.add_average_sample(time);
+  state->graph->debug.eval_profile.record(operation_node, start_time, end_time);
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
-  }
-  else {
-    operation_node->evaluate(depsgraph);
+    operation_node->stats.current_time += time;
   }
 }
 
@@ -120,12 +141,26 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  ReadyOperations ready_operations;
+  while (operation_node != nullptr) {
+    /* Evaluate node. */
+    evaluate_node(state, operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+    /* Schedule children. The one which is on the critical path is evaluated by this thread right
+     * away, avoiding the task scheduling overhead along long chains of operations (such as rigs).
+     * The rest is pushed to the pool, where idle threads can steal them. */
+    ready_operations.clear();
+    schedule_children(state, operation_node, schedule_node_to_vector, &ready_operations);
+    if (ready_operations.is_empty()) {
+      break;
+    }
+    std::sort(ready_operations.begin(), ready_operations.end(), operation_priority_greater);
+    for (OperationNode *ready_operation : ready_operations.as_span().drop_front(1)) {
+      schedule_node_to_pool(ready_operation, 0, pool);
+    }
+    operation_node = ready_operations[0];
+  }
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -178,10 +213,61 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+bool need_evaluate_operation(OperationNode *node)
+{
+  return check_operation_node_visible(node) && (node->flag & DEPSOP_FLAG_NEEDS_UPDATE);
+}
+
+/* Calculate priorities of operations which are to be evaluated: the average time of the longest
+ * path from the operation to the end of the graph. This way operations which are blocking a lot
+ * of expensive work (such as a long rig chain followed by a heavy mesh deformation) are started
+ * before cheap independent ones.
+ *
+ * Operations are visited in reverse topological order, so that the priorities of all children
+ * are known when the priority of their parent is calculated. The custom_flags of the nodes is
+ * used as a counter of children which are not yet visited. */
+void calculate_priorities(Depsgraph *graph)
+{
+  Vector<OperationNode *> stack;
+  for (OperationNode *node : graph->operations) {
+    node->priority = node->stats.average_time;
+    node->custom_flags = 0;
+    if (!need_evaluate_operation(node)) {
+      continue;
+    }
+    for (Relation *rel : node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+          need_evaluate_operation((OperationNode *)rel->to)) {
+        ++node->custom_flags;
+      }
+    }
+    if (node->custom_flags == 0) {
+      stack.append(node);
+    }
+  }
+  while (!stack.is_empty()) {
+    OperationNode *node = stack.pop_last();
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *from = (OperationNode *)rel->from;
+      if (!need_evaluate_operation(from)) {
+        continue;
+      }
+      from->priority = std::max(from->priority, from->stats.average_time + node->priority);
+      if (--from->custom_flags == 0) {
+        stack.append(from);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  calculate_priorities(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -276,13 +362,19 @@ void schedule_node(DepsgraphEvalState *state,
   }
 }
 
+/* Schedule all operations which are ready for evaluation, the most critical ones first. */
 template<typename ScheduleFunction, typename... ScheduleFunctionArgs>
 void schedule_graph(DepsgraphEvalState *state,
                     ScheduleFunction *schedule_function,
                     ScheduleFunctionArgs... schedule_function_args)
 {
+  ReadyOperations ready_operations;
   for (OperationNode *node : state->graph->operations) {
-    schedule_node(state, node, false, schedule_function, schedule_function_args...);
+    schedule_node(state, node, false, schedule_node_to_vector, &ready_operations);
+  }
+  std::stable_sort(ready_operations.begin(), ready_operations.end(), operation_priority_greater);
+  for (OperationNode *node : ready_operations) {
+    schedule_function(node, 0, schedule_function_args...);
   }
 }
 
@@ -41,11 +41,13 @@
 #include "BLI_utildefines.h"
 
 #include "BKE_curve.h"
+#include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_gpencil.h"
 #include "BKE_idprop.h"
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
+#include "BKE_mesh.h"
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
@@ -279,7 +281,7 @@ struct ValidateData {
 
 /* Similar to generic BKE_id_copy() but does not require main and assumes pointer
  * is already allocated. */
-bool id_copy_inplace_no_main(const ID *id, ID *newid)
+bool id_copy_inplace_no_main(const ID *id, ID *newid, const int extra_copy_flags = 0)
 {
   const ID *id_for_copy = id;
 
@@ -288,8 +290,8 @@ bool id_copy_inplace_no_main(const ID *id, ID *newid)
   id_for_copy = nested_id_hack_get_discarded_pointers(&id_hack_storage, id);
 #endif
 
-  bool result = BKE_id_copy_ex(
-      nullptr, (ID *)id_for_copy, &newid, (LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE));
+  const int flag = LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE | extra_copy_flags;
+  bool result = BKE_id_copy_ex(nullptr, (ID *)id_for_copy, &newid, flag);
 
 #ifdef NESTED_ID_NASTY_WORKAROUND
   if (result) {
@@ -833,16 +835,15 @@ int foreach_libblock_validate_callback(LibraryIDLinkCallbackData *cb_data)
   return IDWALK_RET_NOP;
 }
 
-}  // namespace
-
 /* Actual implementation of logic which "expands" all the data which was not
  * yet copied-on-write.
  *
  * NOTE: Expects that CoW datablock is empty. */
-ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
-                                       const IDNode *id_node,
-                                       DepsgraphNodeBuilder *node_builder,
-                                       bool create_placeholders)
+ID *expand_copy_on_write_datablock(const Depsgraph *depsgraph,
+                                   const IDNode *id_node,
+                                   DepsgraphNodeBuilder *node_builder,
+                                   bool create_placeholders,
+                                   const int extra_copy_flags)
 {
   const ID *id_orig = id_node->id_orig;
   ID *id_cow = id_node->id_cow;
@@ -895,7 +896,7 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
       break;
   }
   if (!done) {
-    done = id_copy_inplace_no_main(id_orig, id_cow);
+    done = id_copy_inplace_no_main(id_orig, id_cow, extra_copy_flags);
   }
   if (!done) {
     BLI_assert(!"No idea how to perform CoW on datablock");
@@ -927,6 +928,148 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
   return id_cow;
 }
 
+/* Geometry of a copy-on-write mesh, moved out of it while the rest of the mesh is re-copied from
+ * the original. */
+struct MeshGeometryStorage {
+  CustomData vdata, edata, fdata, ldata, pdata;
+  int totvert, totedge, totface, totloop, totpoly;
+};
+
+/* Recalc flags which do not affect geometry arrays of the original mesh. */
+const int MESH_RECALC_KEEP_GEOMETRY = (ID_RECALC_SHADING | ID_RECALC_ANIMATION |
+                                       ID_RECALC_PARAMETERS | ID_RECALC_EDITORS | ID_RECALC_TIME);
+
+/* Check whether geometry of the expanded copy-on-write mesh is still the same as the original
+ * one, so that it does not need to be copied again.
+ *
+ * Only trust explicit tags: updates coming from the flush, visibility changes or relations
+ * update do not tell what has changed in the original mesh. */
+bool mesh_can_keep_geometry(const IDNode *id_node)
+{
+  if (id_node->id_type != ID_ME || !check_datablock_expanded(id_node->id_cow)) {
+    return false;
+  }
+  const int tagged_recalc = id_node->tagged_recalc;
+  if (tagged_recalc == 0 || (tagged_recalc & ~MESH_RECALC_KEEP_GEOMETRY) != 0) {
+    return false;
+  }
+  const Mesh *mesh_orig = (const Mesh *)id_node->id_orig;
+  const Mesh *mesh_cow = (const Mesh *)id_node->id_cow;
+  /* Edit mode geometry lives in the edit-mesh, the arrays are updated on exit. */
+  if (mesh_orig->edit_mesh != nullptr) {
+    return false;
+  }
+  return mesh_cow->totvert == mesh_orig->totvert && mesh_cow->totedge == mesh_orig->totedge &&
+         mesh_cow->totloop == mesh_orig->totloop && mesh_cow->totpoly == mesh_orig->totpoly;
+}
+
+void mesh_geometry_move_to_storage(Mesh *mesh, MeshGeometryStorage *storage)
+{
+  storage->vdata = mesh->vdata;
+  storage->edata = mesh->edata;
+  storage->fdata = mesh->fdata;
+  storage->ldata = mesh->ldata;
+  storage->pdata = mesh->pdata;
+  storage->totvert = mesh->totvert;
+  storage->totedge = mesh->totedge;
+  storage->totface = mesh->totface;
+  storage->totloop = mesh->totloop;
+  storage->totpoly = mesh->totpoly;
+  CustomData_reset(&mesh->vdata);
+  CustomData_reset(&mesh->edata);
+  CustomData_reset(&mesh->fdata);
+  CustomData_reset(&mesh->ldata);
+  CustomData_reset(&mesh->pdata);
+  mesh->totvert = mesh->totedge = mesh->totface = mesh->totloop = mesh->totpoly = 0;
+  BKE_mesh_update_customdata_pointers(mesh, false);
+}
+
+bool customdata_layout_equals(const CustomData *a, const CustomData *b)
+{
+  if (a->totlayer != b->totlayer) {
+    return false;
+  }
+  for (int i = 0; i < a->totlayer; i++) {
+    const CustomDataLayer *layer_a = &a->layers[i];
+    const CustomDataLayer *layer_b = &b->layers[i];
+    if (layer_a->type != layer_b->type || !STREQ(layer_a->name, layer_b->name)) {
+      return false;
+    }
+    /* Active layers and flags are part of the layout as well. Ownership of the data differs
+     * between the stored layers and the ones referencing the original, so it is ignored. */
+    if (layer_a->active != layer_b->active || layer_a->active_rnd != layer_b->active_rnd ||
+        layer_a->active_clone != layer_b->active_clone ||
+        layer_a->active_mask != layer_b->active_mask || layer_a->uid != layer_b->uid ||
+        (layer_a->flag & ~CD_FLAG_NOFREE) != (layer_b->flag & ~CD_FLAG_NOFREE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Replace layers referencing the original mesh with the ones from the storage.
+ * Returns false and frees the storage when layout of the layers differs. */
+bool mesh_geometry_restore_from_storage(Mesh *mesh, MeshGeometryStorage *storage)
+{
+  const bool is_same_layout = customdata_layout_equals(&mesh->vdata, &storage->vdata) &&
+                              customdata_layout_equals(&mesh->edata, &storage->edata) &&
+                              customdata_layout_equals(&mesh->fdata, &storage->fdata) &&
+                              customdata_layout_equals(&mesh->ldata, &storage->ldata) &&
+                              customdata_layout_equals(&mesh->pdata, &storage->pdata);
+  if (!is_same_layout) {
+    CustomData_free(&storage->vdata, storage->totvert);
+    CustomData_free(&storage->edata, storage->totedge);
+    CustomData_free(&storage->fdata, storage->totface);
+    CustomData_free(&storage->ldata, storage->totloop);
+    CustomData_free(&storage->pdata, storage->totpoly);
+    return false;
+  }
+  /* Layers are only referencing the original, so this does not free the arrays. */
+  CustomData_free(&mesh->vdata, mesh->totvert);
+  CustomData_free(&mesh->edata, mesh->totedge);
+  CustomData_free(&mesh->fdata, mesh->totface);
+  CustomData_free(&mesh->ldata, mesh->totloop);
+  CustomData_free(&mesh->pdata, mesh->totpoly);
+  mesh->vdata = storage->vdata;
+  mesh->edata = storage->edata;
+  mesh->fdata = storage->fdata;
+  mesh->ldata = storage->ldata;
+  mesh->pdata = storage->pdata;
+  mesh->totface = storage->totface;
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  return true;
+}
+
+/* Update copy-on-write mesh without copying its geometry arrays, which are known to be the same
+ * as the original ones. */
+void mesh_update_copy_on_write_keep_geometry(const Depsgraph *depsgraph, const IDNode *id_node)
+{
+  Mesh *mesh_cow = (Mesh *)id_node->id_cow;
+  MeshGeometryStorage storage;
+  RuntimeBackup backup(depsgraph);
+  backup.init_from_id(&mesh_cow->id);
+  mesh_geometry_move_to_storage(mesh_cow, &storage);
+  deg_free_copy_on_write_datablock(&mesh_cow->id);
+  /* Only reference the geometry of the original, it is replaced with the stored one right away. */
+  expand_copy_on_write_datablock(depsgraph, id_node, nullptr, false, LIB_ID_COPY_CD_REFERENCE);
+  if (!mesh_geometry_restore_from_storage(mesh_cow, &storage)) {
+    /* Layers were added or removed without tagging geometry for update, expand it again. */
+    deg_free_copy_on_write_datablock(&mesh_cow->id);
+    expand_copy_on_write_datablock(depsgraph, id_node, nullptr, false, 0);
+  }
+  backup.restore_to_id(&mesh_cow->id);
+}
+
+}  // namespace
+
+ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
+                                       const IDNode *id_node,
+                                       DepsgraphNodeBuilder *node_builder,
+                                       bool create_placeholders)
+{
+  return expand_copy_on_write_datablock(depsgraph, id_node, node_builder, create_placeholders, 0);
+}
+
 /* NOTE: Depsgraph is supposed to have ID node already. */
 ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
                                        ID *id_orig,
@@ -946,6 +1089,11 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
   if (!deg_copy_on_write_is_needed(id_orig)) {
     return id_cow;
   }
+  /* Changes which do not affect geometry (such as materials) do not need to copy it again. */
+  if (mesh_can_keep_geometry(id_node)) {
+    mesh_update_copy_on_write_keep_geometry(depsgraph, id_node);
+    return id_cow;
+  }
   RuntimeBackup backup(depsgraph);
   backup.init_from_id(id_cow);
   deg_free_copy_on_write_datablock(id_cow);
@@ -279,6 +279,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -286,6 +287,18 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::add_average_sample(double time)
+{
+  /* Exponential moving average, so the scheduling adapts quickly when the
+   * cost of an operation changes (different modifier settings, etc). */
+  if (average_time == 0.0) {
+    average_time = time;
+  }
+  else {
+    average_time = average_time * 0.75 + time * 0.25;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
@@ -161,8 +161,14 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Accumulate time of a single evaluation into the running average. */
+    void add_average_sample(double time);
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Smoothed evaluation time over the previous graph evaluations.
+     * Unlike current_time it is gathered for operations even when time debug
+     * is disabled, the scheduler uses it to start expensive operations first. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -110,6 +110,11 @@ struct IDNode : public Node {
   /* Accumulated flag from operation. Is initialized and used during updates flush. */
   bool is_user_modified;
 
+  /* Recalc flags this ID was explicitly tagged with since the last evaluation.
+   * Unlike recalc of the copy-on-write datablock it does not contain flags of components which
+   * were updated as a result of the flush, so it tells which parts of the original ID changed. */
+  int tagged_recalc;
+
   IDComponentsMask visible_components_mask;
   IDComponentsMask previously_visible_components_mask;
 
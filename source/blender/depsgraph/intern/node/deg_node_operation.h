@@ -266,6 +266,11 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time needed to evaluate this operation and all operations which
+   * depend on it (the longest path of average evaluation times to the end of
+   * the graph). Operations with higher priority are scheduled first. */
+  double priority;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
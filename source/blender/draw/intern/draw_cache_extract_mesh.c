@@ -3974,28 +3974,44 @@ static void statvis_calc_thickness(const MeshRenderData *mr, float *r_thickness)
       const float *cos[3] = {mr->mvert[mr->mloop[mlooptri->tri[0]].v].co,
                              mr->mvert[mr->mloop[mlooptri->tri[1]].v].co,
                              mr->mvert[mr->mloop[mlooptri->tri[2]].v].co};
-      float ray_co[3];
-      float ray_no[3];
+      float ray_cos[32][3];
+      float ray_nos[32][3];
+      BVHTreeRayHit hits[32];
 
-      normal_tri_v3(ray_no, cos[2], cos[1], cos[0]);
+      normal_tri_v3(ray_nos[0], cos[2], cos[1], cos[0]);
 
       for (int j = 0; j < samples; j++) {
-        interp_v3_v3v3v3_uv(ray_co, cos[0], cos[1], cos[2], jit_ofs[j]);
-        madd_v3_v3fl(ray_co, ray_no, eps_offset);
+        interp_v3_v3v3v3_uv(ray_cos[j], cos[0], cos[1], cos[2], jit_ofs[j]);
+        madd_v3_v3fl(ray_cos[j], ray_nos[0], eps_offset);
+        copy_v3_v3(ray_nos[j], ray_nos[0]);
 
-        BVHTreeRayHit hit;
-        hit.index = -1;
-        hit.dist = face_dists[index];
-        if ((BLI_bvhtree_ray_cast(
-                 tree, ray_co, ray_no, 0.0f, &hit, treeData.raycast_callback, &treeData) != -1) &&
-            hit.dist < face_dists[index]) {
-          float angle_fac = fabsf(dot_v3v3(mr->poly_normals[index], hit.no));
+        hits[j].index = -1;
+        hits[j].dist = face_dists[index];
+      }
+
+      /* The samples of a triangle are coherent, cast them together as packets.
+       * Limiting all of them by the distance before the packet gives the same result: hits further
+       * than the closest one found so far never decrease it, since `angle_fac` is at most one. */
+      BLI_bvhtree_ray_cast_packet(tree,
+                                  (const float(*)[3])ray_cos,
+                                  (const float(*)[3])ray_nos,
+                                  samples,
+                                  0.0f,
+                                  hits,
+                                  treeData.raycast_callback,
+                                  &treeData,
+                                  BVH_RAYCAST_DEFAULT);
+
+      for (int j = 0; j < samples; j++) {
+        BVHTreeRayHit *hit = &hits[j];
+        if (hit->index != -1 && hit->dist < face_dists[index]) {
+          float angle_fac = fabsf(dot_v3v3(mr->poly_normals[index], hit->no));
           angle_fac = 1.0f - angle_fac;
           angle_fac = angle_fac * angle_fac * angle_fac;
           angle_fac = 1.0f - angle_fac;
-          hit.dist /= angle_fac;
-          if (hit.dist < face_dists[index]) {
-            face_dists[index] = hit.dist;
+          hit->dist /= angle_fac;
+          if (hit->dist < face_dists[index]) {
+            face_dists[index] = hit->dist;
           }
         }
       }
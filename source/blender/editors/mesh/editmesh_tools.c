@@ -5568,6 +5568,9 @@ static int edbm_decimate_exec(bContext *C, wmOperator *op)
 
     MEM_freeN(vweights);
 
+    /* Collapsing leaves most of the element pools empty, re-pack the remaining elements. */
+    BM_mesh_compact(em->bm);
+
     {
       short selectmode = em->selectmode;
       if ((selectmode & (SCE_SELECT_VERTEX | SCE_SELECT_EDGE)) == 0) {
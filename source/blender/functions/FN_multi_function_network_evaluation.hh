@@ -21,6 +21,8 @@
  * \ingroup fn
  */
 
+#include "BLI_linear_allocator.hh"
+
 #include "FN_multi_function_network.hh"
 
 namespace blender::fn {
@@ -31,6 +33,7 @@ class MFNetworkEvaluator : public MultiFunction {
  private:
   Vector<const MFOutputSocket *> inputs_;
   Vector<const MFInputSocket *> outputs_;
+  bool has_vector_params_ = false;
 
  public:
   MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs, Vector<const MFInputSocket *> outputs);
@@ -40,6 +43,17 @@ class MFNetworkEvaluator : public MultiFunction {
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  void evaluate_in_chunks(IndexMask mask, MFParams params, MFContext context) const;
+  void evaluate_chunk(IndexMask mask,
+                      IndexRange chunk,
+                      MFParams params,
+                      MFContext context,
+                      LinearAllocator<> &allocator) const;
+  void evaluate_mask(IndexMask mask,
+                     MFParams params,
+                     MFContext context,
+                     LinearAllocator<> &allocator) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
@@ -165,6 +165,14 @@ class GMutableSpan {
     return POINTER_OFFSET(buffer_, type_->size() * index);
   }
 
+  GMutableSpan slice(int64_t start, int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= size_ || size == 0);
+    return GMutableSpan(*type_, POINTER_OFFSET(buffer_, type_->size() * start), size);
+  }
+
   template<typename T> MutableSpan<T> typed()
   {
     BLI_assert(type_->is<T>());
@@ -209,6 +217,24 @@ template<typename T> struct VSpanBase {
     return false;
   }
 
+  /**
+   * Returns true when all elements are stored in one contiguous array. This is the case when the
+   * span is backed up by a full array or when there is only a single element.
+   */
+  bool is_full_array() const
+  {
+    switch (category_) {
+      case VSpanCategory::Single:
+        return virtual_size_ == 1;
+      case VSpanCategory::FullArray:
+        return true;
+      case VSpanCategory::FullPointerArray:
+        return virtual_size_ <= 1;
+    }
+    BLI_assert(false);
+    return false;
+  }
+
   bool is_empty() const
   {
     return this->virtual_size_ == 0;
@@ -285,6 +311,25 @@ template<typename T> class VSpan : public VSpanBase<T> {
     BLI_assert(false);
     return *this->data_.single.data;
   }
+
+  const T &as_single_element() const
+  {
+    BLI_assert(this->is_single_element());
+    return (*this)[0];
+  }
+
+  /**
+   * Returns the contiguous array backing up this span. This should only be called after the caller
+   * made sure that #is_full_array is true.
+   */
+  Span<T> as_full_array() const
+  {
+    BLI_assert(this->is_full_array());
+    if (this->virtual_size_ == 0) {
+      return {};
+    }
+    return Span<T>(&(*this)[0], this->virtual_size_);
+  }
 };
 
 /**
@@ -395,6 +440,29 @@ class GVSpan : public VSpanBase<void> {
     return (*this)[0];
   }
 
+  /**
+   * Returns a virtual span that references the given part of this span. Index 0 of the new span
+   * corresponds to index \a start of this span.
+   */
+  GVSpan slice(int64_t start, int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= this->virtual_size_ || size == 0);
+    switch (this->category_) {
+      case VSpanCategory::Single:
+        return GVSpan::FromSingle(*type_, this->data_.single.data, size);
+      case VSpanCategory::FullArray:
+        return GVSpan(GSpan(
+            *type_, POINTER_OFFSET(this->data_.full_array.data, type_->size() * start), size));
+      case VSpanCategory::FullPointerArray:
+        return GVSpan::FromFullPointerArray(
+            *type_, this->data_.full_pointer_array.data + start, size);
+    }
+    BLI_assert(false);
+    return GVSpan(*type_);
+  }
+
   void materialize_to_uninitialized(void *dst) const
   {
     this->materialize_to_uninitialized(IndexRange(virtual_size_), dst);
@@ -28,16 +28,22 @@
  * - Avoids data copies in many cases.
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
+ * - Large masks are split into chunks that are evaluated in parallel. The intermediate buffers of
+ *   a chunk are small enough to stay in the CPU cache, and their memory is reused by the next
+ *   chunk evaluated on the same thread.
  *
  * Possible improvements:
- * - Cache and reuse buffers.
+ * - Evaluate independent branches of the network in parallel, for masks that are too small to
+ *   be split into chunks.
  * - Use "deepest depth first" heuristic to decide which order the inputs of a node should be
  *   computed. This reduces the number of required temporary buffers when they are reused.
  */
 
 #include "FN_multi_function_network_evaluation.hh"
 
+#include "BLI_map.hh"
 #include "BLI_stack.hh"
+#include "BLI_task.h"
 
 namespace blender::fn {
 
@@ -52,13 +58,19 @@ struct Value;
  */
 class MFNetworkEvaluationStorage {
  private:
-  LinearAllocator<> allocator_;
+  LinearAllocator<> &allocator_;
   IndexMask mask_;
   Array<Value *> value_per_output_id_;
   int64_t min_array_size_;
+  /**
+   * Buffers of intermediate values that have no users anymore, by their size in bytes. The linear
+   * allocator never frees memory, so buffers are reused for later values instead. That way only
+   * the values used at the same time take memory.
+   */
+  Map<int64_t, Stack<void *>> unused_buffers_;
 
  public:
-  MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount);
+  MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount, LinearAllocator<> &allocator);
   ~MFNetworkEvaluationStorage();
 
   /* Add the values that have been provided by the caller of the multi-function network. */
@@ -97,6 +109,10 @@ class MFNetworkEvaluationStorage {
   bool socket_is_computed(const MFOutputSocket &socket);
   bool is_same_value_for_every_index(const MFOutputSocket &socket);
   bool socket_has_buffer_for_output(const MFOutputSocket &socket);
+
+ private:
+  void *allocate_array_buffer(const CPPType &type);
+  void free_array_buffer(void *buffer, const CPPType &type);
 };
 
 MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
@@ -116,6 +132,7 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
       case MFDataType::Vector:
         signature.vector_input(socket->name(), type.vector_base_type());
+        has_vector_params_ = true;
         break;
     }
   }
@@ -130,19 +147,140 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
       case MFDataType::Vector:
         signature.vector_output(socket->name(), type.vector_base_type());
+        has_vector_params_ = true;
         break;
     }
   }
 }
 
+/**
+ * Number of indices that are evaluated at once. Smaller chunks keep the intermediate buffers in
+ * the CPU cache, larger chunks reduce the per node overhead.
+ */
+static constexpr int64_t evaluation_chunk_size = 4096;
+
 void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context) const
 {
   if (mask.size() == 0) {
     return;
   }
 
+  /* Vector parameters are not split into chunks, because a #GVectorArray cannot be sliced. */
+  if (mask.size() > evaluation_chunk_size && !has_vector_params_) {
+    this->evaluate_in_chunks(mask, params, context);
+  }
+  else {
+    LinearAllocator<> allocator;
+    this->evaluate_mask(mask, params, context, allocator);
+  }
+}
+
+struct ChunkEvaluationData {
+  const MFNetworkEvaluator *evaluator;
+  IndexMask mask;
+  MFParams params;
+  MFContext context;
+};
+
+struct ChunkEvaluationTLS {
+  /* Created lazily and reused for all chunks evaluated with the same TLS. */
+  LinearAllocator<> *allocator;
+};
+
+BLI_NOINLINE void MFNetworkEvaluator::evaluate_in_chunks(IndexMask mask,
+                                                         MFParams params,
+                                                         MFContext context) const
+{
+  const int chunks_num = (int)((mask.size() + evaluation_chunk_size - 1) / evaluation_chunk_size);
+
+  ChunkEvaluationData data{this, mask, params, context};
+  ChunkEvaluationTLS tls_data{nullptr};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = [](const void *__restrict UNUSED(userdata), void *__restrict chunk) {
+    delete ((ChunkEvaluationTLS *)chunk)->allocator;
+  };
+
+  BLI_task_parallel_range(
+      0,
+      chunks_num,
+      &data,
+      [](void *__restrict userdata, const int chunk_index, const TaskParallelTLS *__restrict tls) {
+        ChunkEvaluationData &data = *(ChunkEvaluationData *)userdata;
+        ChunkEvaluationTLS &tls_data = *(ChunkEvaluationTLS *)tls->userdata_chunk;
+        if (tls_data.allocator == nullptr) {
+          tls_data.allocator = new LinearAllocator<>();
+        }
+
+        const int64_t start = chunk_index * evaluation_chunk_size;
+        const IndexRange chunk(start, std::min(evaluation_chunk_size, data.mask.size() - start));
+        data.evaluator->evaluate_chunk(
+            data.mask, chunk, data.params, data.context, *tls_data.allocator);
+        tls_data.allocator->reset();
+      },
+      &settings);
+}
+
+/**
+ * Evaluate the indices in the \a chunk part of \a mask. The parameters are sliced, so that the
+ * intermediate buffers only have to be as large as the chunk.
+ */
+void MFNetworkEvaluator::evaluate_chunk(IndexMask mask,
+                                        IndexRange chunk,
+                                        MFParams params,
+                                        MFContext context,
+                                        LinearAllocator<> &allocator) const
+{
+  const Span<int64_t> indices = mask.indices().slice(chunk);
+  const int64_t offset = indices.first();
+  const int64_t slice_size = indices.last() - offset + 1;
+
+  IndexMask chunk_mask;
+  if (slice_size == indices.size()) {
+    chunk_mask = IndexRange(slice_size);
+  }
+  else {
+    MutableSpan<int64_t> chunk_indices = allocator.allocate_array<int64_t>(indices.size());
+    for (int64_t i : indices.index_range()) {
+      chunk_indices[i] = indices[i] - offset;
+    }
+    chunk_mask = chunk_indices.as_span();
+  }
+
+  MFParamsBuilder chunk_params{*this, slice_size};
+  for (int param_index : this->param_indices()) {
+    MFParamType param_type = this->param_type(param_index);
+    switch (param_type.category()) {
+      case MFParamType::SingleInput: {
+        GVSpan values = params.readonly_single_input(param_index);
+        chunk_params.add_readonly_single_input(values.slice(offset, slice_size));
+        break;
+      }
+      case MFParamType::SingleOutput: {
+        GMutableSpan values = params.uninitialized_single_output(param_index);
+        chunk_params.add_uninitialized_single_output(values.slice(offset, slice_size));
+        break;
+      }
+      default: {
+        BLI_assert(false);
+        break;
+      }
+    }
+  }
+
+  this->evaluate_mask(chunk_mask, chunk_params, context, allocator);
+}
+
+void MFNetworkEvaluator::evaluate_mask(IndexMask mask,
+                                       MFParams params,
+                                       MFContext context,
+                                       LinearAllocator<> &allocator) const
+{
   const MFNetwork &network = outputs_[0]->node().network();
-  Storage storage(mask, network.socket_id_amount());
+  Storage storage(mask, network.socket_id_amount(), allocator);
 
   Vector<const MFInputSocket *> outputs_to_initialize_in_the_end;
 
@@ -506,8 +644,11 @@ struct OwnVectorValue : public Value {
 /** \name Storage methods
  * \{ */
 
-MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount)
-    : mask_(mask),
+MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask,
+                                                       int socket_id_amount,
+                                                       LinearAllocator<> &allocator)
+    : allocator_(allocator),
+      mask_(mask),
       value_per_output_id_(socket_id_amount, nullptr),
       min_array_size_(mask.min_array_size())
 {
@@ -528,7 +669,6 @@ MFNetworkEvaluationStorage::~MFNetworkEvaluationStorage()
       }
       else {
         type.destruct_indices(span.buffer(), mask_);
-        MEM_freeN(span.buffer());
       }
     }
     else if (any_value->type == ValueType::OwnVector) {
@@ -538,6 +678,27 @@ MFNetworkEvaluationStorage::~MFNetworkEvaluationStorage()
   }
 }
 
+/* Alignment of all array buffers, so that buffers of types with the same size can be reused for
+ * each other. */
+static constexpr int64_t array_buffer_alignment = 64;
+
+void *MFNetworkEvaluationStorage::allocate_array_buffer(const CPPType &type)
+{
+  BLI_assert(type.alignment() <= array_buffer_alignment);
+  const int64_t size = min_array_size_ * type.size();
+  Stack<void *> *buffers = unused_buffers_.lookup_ptr(size);
+  if (buffers != nullptr && !buffers->is_empty()) {
+    return buffers->pop();
+  }
+  return allocator_.allocate(size, array_buffer_alignment);
+}
+
+void MFNetworkEvaluationStorage::free_array_buffer(void *buffer, const CPPType &type)
+{
+  const int64_t size = min_array_size_ * type.size();
+  unused_buffers_.lookup_or_add_default(size).push(buffer);
+}
+
 IndexMask MFNetworkEvaluationStorage::mask() const
 {
   return mask_;
@@ -638,7 +799,7 @@ void MFNetworkEvaluationStorage::finish_input_socket(const MFInputSocket &socket
         }
         else {
           type.destruct_indices(span.buffer(), mask_);
-          MEM_freeN(span.buffer());
+          this->free_array_buffer(span.buffer(), type);
         }
         value_per_output_id_[origin.id()] = nullptr;
       }
@@ -702,7 +863,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_single_output__full(const MFOutputS
   Value *any_value = value_per_output_id_[socket.id()];
   if (any_value == nullptr) {
     const CPPType &type = socket.data_type().single_type();
-    void *buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
+    void *buffer = this->allocate_array_buffer(type);
     GMutableSpan span(type, buffer, min_array_size_);
 
     auto *value = allocator_.construct<OwnSingleValue>(span, socket.targets().size(), false);
@@ -806,7 +967,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_mutable_single__full(const MFInputS
   }
 
   GVSpan virtual_span = this->get_single_input__full(input);
-  void *new_buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
+  void *new_buffer = this->allocate_array_buffer(type);
   GMutableSpan new_array_ref(type, new_buffer, min_array_size_);
   virtual_span.materialize_to_uninitialized(mask_, new_array_ref.buffer());
 
@@ -25,6 +25,8 @@
 #include "FN_multi_function_network_evaluation.hh"
 #include "FN_multi_function_network_optimization.hh"
 
+#include <algorithm>
+
 #include "BLI_disjoint_set.hh"
 #include "BLI_ghash.h"
 #include "BLI_map.hh"
@@ -500,4 +502,266 @@ void common_subnetwork_elimination(MFNetwork &network)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Function Chain Fusion
+ *
+ * \{ */
+
+/**
+ * Calls a chain of functions, where every function gets the output of the previous one as input.
+ * The values passed between the functions are computed for small chunks of the mask at a time, so
+ * that they stay in the CPU cache, instead of going through full sized buffers in the network
+ * evaluator.
+ */
+class FusedFunctionChain : public MultiFunction {
+ public:
+  /** Source of an input parameter that gets the output of the previous function in the chain. */
+  static constexpr int previous_output = -1;
+
+ private:
+  static constexpr int64_t chunk_size = 4096;
+
+  Vector<const MultiFunction *> functions_;
+  /**
+   * For every function, the index of the input of the fused function that is passed to each input
+   * parameter, or #previous_output. The outputs of the last function are the output of the fused
+   * function.
+   */
+  Vector<Array<int>> param_sources_;
+  /** Types of the values passed from each function to the next one. */
+  Vector<const CPPType *> intermediate_types_;
+
+ public:
+  FusedFunctionChain(Vector<const MultiFunction *> functions,
+                     Vector<Array<int>> param_sources,
+                     Span<const MFInputSocket *> inputs)
+      : functions_(std::move(functions)), param_sources_(std::move(param_sources))
+  {
+    std::string name;
+    for (const MultiFunction *function : functions_) {
+      name += (name.empty() ? "" : " -> ") + function->name();
+    }
+    MFSignatureBuilder signature = this->get_builder(std::move(name));
+
+    for (const MFInputSocket *socket : inputs) {
+      signature.single_input(socket->name(), socket->data_type().single_type());
+    }
+    for (const MultiFunction *function : functions_) {
+      for (int param_index : function->param_indices()) {
+        MFParamType param_type = function->param_type(param_index);
+        if (param_type.category() == MFParamType::SingleOutput) {
+          intermediate_types_.append(&param_type.data_type().single_type());
+          if (function == functions_.last()) {
+            signature.single_output(function->param_name(param_index),
+                                    param_type.data_type().single_type());
+          }
+        }
+      }
+    }
+    intermediate_types_.remove_last();
+  }
+
+  void call(IndexMask mask, MFParams params, MFContext context) const override
+  {
+    const int output_param_index = this->param_indices().last();
+
+    LinearAllocator<> allocator;
+    Array<void *> buffers(intermediate_types_.size());
+    for (int i : buffers.index_range()) {
+      const CPPType &type = *intermediate_types_[i];
+      buffers[i] = allocator.allocate(chunk_size * type.size(), type.alignment());
+    }
+    MutableSpan<int64_t> chunk_indices = allocator.allocate_array<int64_t>(chunk_size);
+
+    const Span<int64_t> indices = mask.indices();
+    int64_t chunk_begin = 0;
+    while (chunk_begin < indices.size()) {
+      /* Find the indices that fit into buffers of the chunk size. */
+      const int64_t offset = indices[chunk_begin];
+      const int64_t *chunk_end_ptr = std::lower_bound(
+          indices.begin() + chunk_begin,
+          indices.begin() + std::min(chunk_begin + chunk_size, indices.size()),
+          offset + chunk_size);
+      const Span<int64_t> chunk = indices.slice(chunk_begin,
+                                                chunk_end_ptr - indices.begin() - chunk_begin);
+      const int64_t slice_size = chunk.last() - offset + 1;
+
+      IndexMask chunk_mask;
+      if (slice_size == chunk.size()) {
+        chunk_mask = IndexRange(slice_size);
+      }
+      else {
+        for (int64_t i : chunk.index_range()) {
+          chunk_indices[i] = chunk[i] - offset;
+        }
+        chunk_mask = chunk_indices.as_span().take_front(chunk.size());
+      }
+
+      for (int function_index : functions_.index_range()) {
+        const MultiFunction &function = *functions_[function_index];
+        const bool is_last = function_index == functions_.size() - 1;
+
+        MFParamsBuilder function_params{function, slice_size};
+        for (int param_index : function.param_indices()) {
+          MFParamType param_type = function.param_type(param_index);
+          const CPPType &type = param_type.data_type().single_type();
+          if (param_type.category() == MFParamType::SingleInput) {
+            const int source = param_sources_[function_index][param_index];
+            if (source == previous_output) {
+              function_params.add_readonly_single_input(
+                  GSpan(type, buffers[function_index - 1], slice_size));
+            }
+            else {
+              GVSpan values = params.readonly_single_input(source);
+              function_params.add_readonly_single_input(values.slice(offset, slice_size));
+            }
+          }
+          else if (is_last) {
+            GMutableSpan values = params.uninitialized_single_output(output_param_index);
+            function_params.add_uninitialized_single_output(values.slice(offset, slice_size));
+          }
+          else {
+            function_params.add_uninitialized_single_output(
+                GMutableSpan(type, buffers[function_index], slice_size));
+          }
+        }
+
+        function.call(chunk_mask, function_params, context);
+
+        if (function_index > 0) {
+          intermediate_types_[function_index - 1]->destruct_indices(buffers[function_index - 1],
+                                                                   chunk_mask);
+        }
+      }
+
+      chunk_begin += chunk.size();
+    }
+  }
+};
+
+static bool function_node_can_be_fused(const MFFunctionNode &node)
+{
+  const MultiFunction &function = node.function();
+  if (function.depends_on_context()) {
+    return false;
+  }
+  if (node.has_unlinked_inputs()) {
+    return false;
+  }
+  if (node.outputs().size() != 1) {
+    return false;
+  }
+  for (int param_index : function.param_indices()) {
+    MFParamType::Category category = function.param_type(param_index).category();
+    if (!ELEM(category, MFParamType::SingleInput, MFParamType::SingleOutput)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the node that gets the output of the given node, when that is the only target and both
+ * nodes can be fused.
+ */
+static MFFunctionNode *try_find_fusable_target(MFFunctionNode &node)
+{
+  if (!function_node_can_be_fused(node)) {
+    return nullptr;
+  }
+  Span<MFInputSocket *> targets = node.output(0).targets();
+  if (targets.size() != 1) {
+    return nullptr;
+  }
+  MFNode &target_node = targets[0]->node();
+  if (target_node.is_dummy()) {
+    return nullptr;
+  }
+  if (!function_node_can_be_fused(target_node.as_function())) {
+    return nullptr;
+  }
+  return &target_node.as_function();
+}
+
+static void fuse_function_chain(MFNetwork &network,
+                                Span<MFFunctionNode *> chain,
+                                ResourceCollector &resources)
+{
+  Vector<const MultiFunction *> functions;
+  Vector<Array<int>> param_sources;
+  Vector<MFInputSocket *> fused_inputs;
+
+  for (int i : chain.index_range()) {
+    MFFunctionNode &node = *chain[i];
+    const MultiFunction &function = node.function();
+    Array<int> sources(function.param_amount(), FusedFunctionChain::previous_output);
+
+    for (int param_index : function.param_indices()) {
+      if (function.param_type(param_index).category() != MFParamType::SingleInput) {
+        continue;
+      }
+      MFInputSocket &socket = node.input(node.input_for_param(param_index).index());
+      if (i > 0 && &socket.origin()->node() == chain[i - 1]) {
+        continue;
+      }
+      sources[param_index] = fused_inputs.append_and_get_index(&socket);
+    }
+
+    functions.append(&function);
+    param_sources.append(std::move(sources));
+  }
+
+  const MultiFunction &fused_function = resources.construct<FusedFunctionChain>(
+      AT, std::move(functions), std::move(param_sources), fused_inputs.as_span());
+  MFFunctionNode &fused_node = network.add_function(fused_function);
+
+  for (int i : fused_inputs.index_range()) {
+    network.add_link(*fused_inputs[i]->origin(), fused_node.input(i));
+  }
+  network.relink(chain.last()->output(0), fused_node.output(0));
+
+  Vector<MFNode *> nodes_to_remove;
+  for (MFFunctionNode *node : chain) {
+    nodes_to_remove.append(node);
+  }
+  network.remove(nodes_to_remove);
+}
+
+/**
+ * Replaces chains of function nodes, where every node only passes its output to the next node, by
+ * a single node that evaluates the entire chain. This avoids computing and storing full arrays of
+ * the intermediate values.
+ */
+void function_chain_fusion(MFNetwork &network, ResourceCollector &resources)
+{
+  Array<bool> is_fusable_target(network.node_id_amount(), false);
+  for (MFFunctionNode *node : network.function_nodes()) {
+    MFFunctionNode *target = try_find_fusable_target(*node);
+    if (target != nullptr) {
+      is_fusable_target[target->id()] = true;
+    }
+  }
+
+  Vector<Vector<MFFunctionNode *>> chains;
+  for (MFFunctionNode *node : network.function_nodes()) {
+    if (is_fusable_target[node->id()]) {
+      continue;
+    }
+    Vector<MFFunctionNode *> chain;
+    for (MFFunctionNode *current = node; current != nullptr;
+         current = try_find_fusable_target(*current)) {
+      chain.append(current);
+    }
+    if (chain.size() >= 2) {
+      chains.append(std::move(chain));
+    }
+  }
+
+  for (Span<MFFunctionNode *> chain : chains) {
+    fuse_function_chain(network, chain, resources);
+  }
+}
+
+/** \} */
+
 }  // namespace blender::fn::mf_network_optimization
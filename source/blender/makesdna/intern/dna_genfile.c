@@ -795,102 +795,97 @@ static eSDNA_Type sdna_type_nr(const char *dna_type)
 }
 
 /**
- * Converts a value of one primitive type to another.
- * Note there is no optimization for the case where otype and ctype are the same:
+ * Converts values of one primitive type to another.
+ * Note there is no optimization for the case where old_type and new_type are the same:
  * assumption is that caller will handle this case.
  *
- * \param ctype: Name of type to convert to
- * \param otype: Name of type to convert from
- * \param name_array_len: Result of #DNA_elem_array_size for this element.
- * \param curdata: Where to put converted data
- * \param olddata: Data of type otype to convert
+ * \param old_type: Type to convert from.
+ * \param new_type: Type to convert to.
+ * \param array_len: Number of elements to convert.
+ * \param old_data: Data of type old_type to convert.
+ * \param new_data: Where to put converted data.
  */
-static void cast_elem(
-    const char *ctype, const char *otype, int name_array_len, char *curdata, const char *olddata)
+static void cast_primitive_type(const eSDNA_Type old_type,
+                                const eSDNA_Type new_type,
+                                int array_len,
+                                const char *old_data,
+                                char *new_data)
 {
-  double val = 0.0;
-  int curlen = 1, oldlen = 1;
-
-  eSDNA_Type ctypenr, otypenr;
-
-  if ((otypenr = sdna_type_nr(otype)) == -1 || (ctypenr = sdna_type_nr(ctype)) == -1) {
-    return;
-  }
-
   /* define lengths */
-  oldlen = DNA_elem_type_size(otypenr);
-  curlen = DNA_elem_type_size(ctypenr);
+  const int oldlen = DNA_elem_type_size(old_type);
+  const int curlen = DNA_elem_type_size(new_type);
+  double val = 0.0;
 
-  while (name_array_len > 0) {
-    switch (otypenr) {
+  while (array_len > 0) {
+    switch (old_type) {
       case SDNA_TYPE_CHAR:
-        val = *olddata;
+        val = *old_data;
         break;
       case SDNA_TYPE_UCHAR:
-        val = *((unsigned char *)olddata);
+        val = *((unsigned char *)old_data);
         break;
       case SDNA_TYPE_SHORT:
-        val = *((short *)olddata);
+        val = *((short *)old_data);
         break;
       case SDNA_TYPE_USHORT:
-        val = *((unsigned short *)olddata);
+        val = *((unsigned short *)old_data);
         break;
       case SDNA_TYPE_INT:
-        val = *((int *)olddata);
+        val = *((int *)old_data);
         break;
       case SDNA_TYPE_FLOAT:
-        val = *((float *)olddata);
+        val = *((float *)old_data);
         break;
       case SDNA_TYPE_DOUBLE:
-        val = *((double *)olddata);
+        val = *((double *)old_data);
         break;
       case SDNA_TYPE_INT64:
-        val = *((int64_t *)olddata);
+        val = *((int64_t *)old_data);
         break;
       case SDNA_TYPE_UINT64:
-        val = *((uint64_t *)olddata);
+        val = *((uint64_t *)old_data);
         break;
     }
 
-    switch (ctypenr) {
+    switch (new_type) {
       case SDNA_TYPE_CHAR:
-        *curdata = val;
+        *new_data = val;
         break;
       case SDNA_TYPE_UCHAR:
-        *((unsigned char *)curdata) = val;
+        *((unsigned char *)new_data) = val;
         break;
       case SDNA_TYPE_SHORT:
-        *((short *)curdata) = val;
+        *((short *)new_data) = val;
         break;
       case SDNA_TYPE_USHORT:
-        *((unsigned short *)curdata) = val;
+        *((unsigned short *)new_data) = val;
         break;
       case SDNA_TYPE_INT:
-        *((int *)curdata) = val;
+        *((int *)new_data) = val;
         break;
       case SDNA_TYPE_FLOAT:
-        if (otypenr < 2) {
+        if (old_type < 2) {
           val /= 255;
         }
-        *((float *)curdata) = val;
+        *((float *)new_data) = val;
         break;
       case SDNA_TYPE_DOUBLE:
-        if (otypenr < 2) {
+        if (old_type < 2) {
           val /= 255;
         }
-        *((double *)curdata) = val;
+        *((double *)new_data) = val;
         break;
       case SDNA_TYPE_INT64:
-        *((int64_t *)curdata) = val;
+        *((int64_t *)new_data) = val;
         break;
       case SDNA_TYPE_UINT64:
-        *((uint64_t *)curdata) = val;
+        *((uint64_t *)new_data) = val;
         break;
     }
 
-    olddata += oldlen;
-    curdata += curlen;
-    name_array_len--;
+    old_data += oldlen;
+    new_data += curlen;
+    array_len--;
   }
 }
 
@@ -898,42 +893,31 @@ static void cast_elem(
  * Converts pointer values between different sizes. These are only used
  * as lookup keys to identify data blocks in the saved .blend file, not
  * as actual in-memory pointers.
- *
- * \param curlen: Pointer length to convert to
- * \param oldlen: Length of pointers in olddata
- * \param name_array_len: Result of #DNA_elem_array_size for this element.
- * \param curdata: Where to put converted data
- * \param olddata: Data to convert
  */
-static void cast_pointer(
-    int curlen, int oldlen, int name_array_len, char *curdata, const char *olddata)
+static void cast_pointer_64_to_32(int array_len, const char *old_data, char *new_data)
 {
-  int64_t lval;
+  while (array_len > 0) {
+    const int64_t lval = *((int64_t *)old_data);
 
-  while (name_array_len > 0) {
+    /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
+     * pointers may lose uniqueness on truncation! (Hopefully this wont
+     * happen unless/until we ever get to multi-gigabyte .blend files...) */
+    *((int *)new_data) = lval >> 3;
 
-    if (curlen == oldlen) {
-      memcpy(curdata, olddata, curlen);
-    }
-    else if (curlen == 4 && oldlen == 8) {
-      lval = *((int64_t *)olddata);
+    old_data += 8;
+    new_data += 4;
+    array_len--;
+  }
+}
 
-      /* WARNING: 32-bit Blender trying to load file saved by 64-bit Blender,
-       * pointers may lose uniqueness on truncation! (Hopefully this wont
-       * happen unless/until we ever get to multi-gigabyte .blend files...) */
-      *((int *)curdata) = lval >> 3;
-    }
-    else if (curlen == 8 && oldlen == 4) {
-      *((int64_t *)curdata) = *((int *)olddata);
-    }
-    else {
-      /* for debug */
-      printf("errpr: illegal pointersize!\n");
-    }
+static void cast_pointer_32_to_64(int array_len, const char *old_data, char *new_data)
+{
+  while (array_len > 0) {
+    *((int64_t *)new_data) = *((int *)old_data);
 
-    olddata += oldlen;
-    curdata += curlen;
-    name_array_len--;
+    old_data += 4;
+    new_data += 8;
+    array_len--;
   }
 }
 
@@ -1079,227 +1063,6 @@ static const char *find_elem(const SDNA *sdna,
   return NULL;
 }
 
-/**
- * Converts the contents of a single field of a struct, of a non-struct type,
- * from \a oldsdna to \a newsdna format.
- *
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param type: current field type name
- * \param new_name_nr: current field name number.
- * \param curdata: put field data converted to newsdna here
- * \param old: pointer to struct info in oldsdna
- * \param olddata: struct contents laid out according to oldsdna
- */
-static void reconstruct_elem(const SDNA *newsdna,
-                             const SDNA *oldsdna,
-                             const char *type,
-                             const int new_name_nr,
-                             char *curdata,
-                             const short *old,
-                             const char *olddata)
-{
-  /* rules: test for NAME:
-   *      - name equal:
-   *          - cast type
-   *      - name partially equal (array differs)
-   *          - type equal: memcpy
-   *          - type cast (per element).
-   * (nzc 2-4-2001 I want the 'unsigned' bit to be parsed as well. Where
-   * can I force this?)
-   */
-  int a, elemcount, len, countpos, mul;
-  const char *otype, *oname, *cp;
-
-  /* is 'name' an array? */
-  const char *name = newsdna->names[new_name_nr];
-  cp = name;
-  countpos = 0;
-  while (*cp && *cp != '[') {
-    cp++;
-    countpos++;
-  }
-  if (*cp != '[') {
-    countpos = 0;
-  }
-
-  /* in old is the old struct */
-  elemcount = old[1];
-  old += 2;
-  for (a = 0; a < elemcount; a++, old += 2) {
-    const int old_name_nr = old[1];
-    otype = oldsdna->types[old[0]];
-    oname = oldsdna->names[old[1]];
-    len = DNA_elem_size_nr(oldsdna, old[0], old[1]);
-
-    if (strcmp(name, oname) == 0) { /* name equal */
-
-      if (ispointer(name)) { /* pointer of functionpointer afhandelen */
-        cast_pointer(newsdna->pointer_size,
-                     oldsdna->pointer_size,
-                     newsdna->names_array_len[new_name_nr],
-                     curdata,
-                     olddata);
-      }
-      else if (strcmp(type, otype) == 0) { /* type equal */
-        memcpy(curdata, olddata, len);
-      }
-      else {
-        cast_elem(type, otype, newsdna->names_array_len[new_name_nr], curdata, olddata);
-      }
-
-      return;
-    }
-    else if (countpos != 0) { /* name is an array */
-
-      if (oname[countpos] == '[' && strncmp(name, oname, countpos) == 0) { /* basis equal */
-        const int new_name_array_len = newsdna->names_array_len[new_name_nr];
-        const int old_name_array_len = oldsdna->names_array_len[old_name_nr];
-        const int min_name_array_len = MIN2(new_name_array_len, old_name_array_len);
-
-        if (ispointer(name)) { /* handle pointer or functionpointer */
-          cast_pointer(
-              newsdna->pointer_size, oldsdna->pointer_size, min_name_array_len, curdata, olddata);
-        }
-        else if (strcmp(type, otype) == 0) { /* type equal */
-          /* size of single old array element */
-          mul = len / old_name_array_len;
-          /* smaller of sizes of old and new arrays */
-          mul *= min_name_array_len;
-
-          memcpy(curdata, olddata, mul);
-
-          if (old_name_array_len > new_name_array_len && strcmp(type, "char") == 0) {
-            /* string had to be truncated, ensure it's still null-terminated */
-            curdata[mul - 1] = '\0';
-          }
-        }
-        else {
-          cast_elem(type, otype, min_name_array_len, curdata, olddata);
-        }
-        return;
-      }
-    }
-    olddata += len;
-  }
-}
-
-/**
- * Converts the contents of an entire struct from oldsdna to newsdna format.
- *
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param compflags:
- *
- * Result from DNA_struct_get_compareflags to avoid needless conversions.
- * \param oldSDNAnr: Index of old struct definition in oldsdna
- * \param data: Struct contents laid out according to oldsdna
- * \param curSDNAnr: Index of current struct definition in newsdna
- * \param cur: Where to put converted struct contents
- */
-static void reconstruct_struct(const SDNA *newsdna,
-                               const SDNA *oldsdna,
-                               const char *compflags,
-
-                               int oldSDNAnr,
-                               const char *data,
-                               int curSDNAnr,
-                               char *cur)
-{
-  /* Recursive!
-   * Per element from cur_struct, read data from old_struct.
-   * If element is a struct, call recursive.
-   */
-  int a, elemcount, elen, eleno, mul, mulo, firststructtypenr;
-  const short *spo, *spc, *sppo;
-  const char *type;
-  const char *cpo;
-  char *cpc;
-  const char *name;
-
-  unsigned int oldsdna_index_last = UINT_MAX;
-  unsigned int cursdna_index_last = UINT_MAX;
-
-  if (oldSDNAnr == -1) {
-    return;
-  }
-  if (curSDNAnr == -1) {
-    return;
-  }
-
-  if (compflags[oldSDNAnr] == SDNA_CMP_EQUAL) {
-    /* if recursive: test for equal */
-    spo = oldsdna->structs[oldSDNAnr];
-    elen = oldsdna->types_size[spo[0]];
-    memcpy(cur, data, elen);
-
-    return;
-  }
-
-  firststructtypenr = *(newsdna->structs[0]);
-
-  spo = oldsdna->structs[oldSDNAnr];
-  spc = newsdna->structs[curSDNAnr];
-
-  elemcount = spc[1];
-
-  spc += 2;
-  cpc = cur;
-  for (a = 0; a < elemcount; a++, spc += 2) { /* convert each field */
-    type = newsdna->types[spc[0]];
-    name = newsdna->names[spc[1]];
-
-    elen = DNA_elem_size_nr(newsdna, spc[0], spc[1]);
-
-    /* Skip pad bytes which must start with '_pad', see makesdna.c 'is_name_legal'.
-     * for exact rules. Note that if we fail to skip a pad byte it's harmless,
-     * this just avoids unnecessary reconstruction. */
-    if (name[0] == '_' || (name[0] == '*' && name[1] == '_')) {
-      cpc += elen;
-    }
-    else if (spc[0] >= firststructtypenr && !ispointer(name)) {
-      /* struct field type */
-
-      /* where does the old struct data start (and is there an old one?) */
-      cpo = (char *)find_elem(oldsdna, type, name, spo, data, &sppo);
-
-      if (cpo) {
-        oldSDNAnr = DNA_struct_find_nr_ex(oldsdna, type, &oldsdna_index_last);
-        curSDNAnr = DNA_struct_find_nr_ex(newsdna, type, &cursdna_index_last);
-
-        /* array! */
-        mul = newsdna->names_array_len[spc[1]];
-        mulo = oldsdna->names_array_len[sppo[1]];
-
-        eleno = DNA_elem_size_nr(oldsdna, sppo[0], sppo[1]);
-
-        elen /= mul;
-        eleno /= mulo;
-
-        while (mul--) {
-          reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-          cpo += eleno;
-          cpc += elen;
-
-          /* new struct array larger than old */
-          mulo--;
-          if (mulo <= 0) {
-            break;
-          }
-        }
-      }
-      else {
-        cpc += elen; /* skip field no longer present */
-      }
-    }
-    else {
-      /* non-struct field type */
-      reconstruct_elem(newsdna, oldsdna, type, spc[1], cpc, spo, data);
-      cpc += elen;
-    }
-  }
-}
-
 /**
  * Does endian swapping on the fields of a struct value.
  *
@@ -1393,57 +1156,509 @@ void DNA_struct_switch_endian(const SDNA *oldsdna, int oldSDNAnr, char *data)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Struct Reconstruction
+ *
+ * Converting structs from the layout of an old SDNA to the current one is done with a list of
+ * steps per struct, computed once per file (see #DNA_reconstruct_info_create).
+ * This way member names are only resolved once, instead of for every struct that is read.
+ * \{ */
+
+typedef enum eReconstructStepType {
+  /** Copy bytes as they are. */
+  RECONSTRUCT_STEP_MEMCPY,
+  /** Convert primitive values, e.g. `short` to `float`. */
+  RECONSTRUCT_STEP_CAST_PRIMITIVE,
+  RECONSTRUCT_STEP_CAST_POINTER_TO_32,
+  RECONSTRUCT_STEP_CAST_POINTER_TO_64,
+  /** Reconstruct (an array of) structs that changed, using their own steps. */
+  RECONSTRUCT_STEP_SUBSTRUCT,
+  /** Null-terminate a `char` array that was truncated. */
+  RECONSTRUCT_STEP_TERMINATE_STRING,
+} eReconstructStepType;
+
+typedef struct ReconstructStep {
+  eReconstructStepType type;
+  int old_offset;
+  int new_offset;
+  /** Number of bytes for #RECONSTRUCT_STEP_MEMCPY, number of array elements otherwise. */
+  int len;
+  union {
+    struct {
+      eSDNA_Type old_type;
+      eSDNA_Type new_type;
+    } cast_primitive;
+    struct {
+      int old_struct_nr;
+      int new_struct_nr;
+    } substruct;
+  } data;
+} ReconstructStep;
+
+typedef struct ReconstructStructInfo {
+  /** Index of the struct in the new SDNA, -1 when it has been removed. */
+  int new_struct_nr;
+  /** Only set for structs which are #SDNA_CMP_NOT_EQUAL. */
+  ReconstructStep *steps;
+  int steps_len;
+} ReconstructStructInfo;
+
+typedef struct DNA_ReconstructInfo {
+  const SDNA *oldsdna;
+  const SDNA *newsdna;
+  const char *compare_flags;
+
+  /** One for every struct in the old SDNA. */
+  ReconstructStructInfo *structs;
+} DNA_ReconstructInfo;
+
 /**
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param compflags:
+ * Find the member with the given type and name (excluding any array-size suffix)
+ * in a struct, returns its index or -1 when it doesn't exist.
  *
- * Result from DNA_struct_get_compareflags to avoid needless conversions
- * \param oldSDNAnr: Index of struct info within oldsdna
- * \param blocks: The number of array elements
- * \param data: Array of struct data
- * \return An allocated reconstructed struct
+ * \param r_offset: The offset of the member in the struct.
  */
-void *DNA_struct_reconstruct(const SDNA *newsdna,
-                             const SDNA *oldsdna,
-                             const char *compflags,
-                             int oldSDNAnr,
-                             int blocks,
-                             const void *data)
+static int elem_find_with_offset(
+    const SDNA *sdna, const char *type, const char *name, const short *old, int *r_offset)
 {
-  int a, curSDNAnr, curlen = 0, oldlen;
-  const short *spo, *spc;
-  char *cur, *cpc;
-  const char *cpo;
-  const char *type;
+  const int elemcount = old[1];
+  int offset = 0;
+
+  old += 2;
+  for (int a = 0; a < elemcount; a++, old += 2) {
+    const char *otype = sdna->types[old[0]];
+    const char *oname = sdna->names[old[1]];
+
+    if (elem_strcmp(name, oname) == 0) { /* name equal */
+      if (strcmp(type, otype) == 0) {    /* type equal */
+        *r_offset = offset;
+        return a;
+      }
+      return -1;
+    }
 
-  /* oldSDNAnr == structnr, we're looking for the corresponding 'cur' number */
-  spo = oldsdna->structs[oldSDNAnr];
-  type = oldsdna->types[spo[0]];
-  oldlen = oldsdna->types_size[spo[0]];
-  curSDNAnr = DNA_struct_find_nr(newsdna, type);
+    offset += DNA_elem_size_nr(sdna, old[0], old[1]);
+  }
+  return -1;
+}
+
+/**
+ * Add a step, merging copies of adjacent memory into one.
+ */
+static void reconstruct_step_add(ReconstructStep *steps,
+                                 int *steps_len,
+                                 const ReconstructStep *step)
+{
+  if (step->type == RECONSTRUCT_STEP_MEMCPY) {
+    if (step->len == 0) {
+      return;
+    }
+    if (*steps_len > 0) {
+      ReconstructStep *step_prev = &steps[*steps_len - 1];
+      if ((step_prev->type == RECONSTRUCT_STEP_MEMCPY) &&
+          (step_prev->old_offset + step_prev->len == step->old_offset) &&
+          (step_prev->new_offset + step_prev->len == step->new_offset)) {
+        step_prev->len += step->len;
+        return;
+      }
+    }
+  }
+  steps[(*steps_len)++] = *step;
+}
+
+static void reconstruct_step_add_pointer(ReconstructStep *steps,
+                                         int *steps_len,
+                                         const SDNA *oldsdna,
+                                         const SDNA *newsdna,
+                                         const int old_offset,
+                                         const int new_offset,
+                                         const int array_len)
+{
+  ReconstructStep step = {.old_offset = old_offset, .new_offset = new_offset, .len = array_len};
+  if (newsdna->pointer_size == oldsdna->pointer_size) {
+    step.type = RECONSTRUCT_STEP_MEMCPY;
+    step.len = newsdna->pointer_size * array_len;
+  }
+  else if (newsdna->pointer_size == 4 && oldsdna->pointer_size == 8) {
+    step.type = RECONSTRUCT_STEP_CAST_POINTER_TO_32;
+  }
+  else if (newsdna->pointer_size == 8 && oldsdna->pointer_size == 4) {
+    step.type = RECONSTRUCT_STEP_CAST_POINTER_TO_64;
+  }
+  else {
+    /* for debug */
+    printf("errpr: illegal pointersize!\n");
+    return;
+  }
+  reconstruct_step_add(steps, steps_len, &step);
+}
+
+static void reconstruct_step_add_cast(ReconstructStep *steps,
+                                      int *steps_len,
+                                      const char *old_type,
+                                      const char *new_type,
+                                      const int old_offset,
+                                      const int new_offset,
+                                      const int array_len)
+{
+  const eSDNA_Type old_type_nr = sdna_type_nr(old_type);
+  const eSDNA_Type new_type_nr = sdna_type_nr(new_type);
+  if (old_type_nr == -1 || new_type_nr == -1) {
+    return;
+  }
+  ReconstructStep step = {
+      .type = RECONSTRUCT_STEP_CAST_PRIMITIVE,
+      .old_offset = old_offset,
+      .new_offset = new_offset,
+      .len = array_len,
+  };
+  step.data.cast_primitive.old_type = old_type_nr;
+  step.data.cast_primitive.new_type = new_type_nr;
+  reconstruct_step_add(steps, steps_len, &step);
+}
+
+/**
+ * Add the step converting a single member of a non-struct type.
+ *
+ * Rules: test for name:
+ * - Name equal: cast type.
+ * - Name partially equal (array differs):
+ *   - Type equal: memcpy.
+ *   - Type cast (per element).
+ */
+static void reconstruct_steps_add_elem(ReconstructStep *steps,
+                                       int *steps_len,
+                                       const SDNA *oldsdna,
+                                       const SDNA *newsdna,
+                                       const short *old_struct,
+                                       const short new_type_nr,
+                                       const short new_name_nr,
+                                       const int new_offset)
+{
+  const char *type = newsdna->types[new_type_nr];
+  const char *name = newsdna->names[new_name_nr];
+
+  /* is 'name' an array? */
+  const char *cp = name;
+  int countpos = 0;
+  while (*cp && *cp != '[') {
+    cp++;
+    countpos++;
+  }
+  if (*cp != '[') {
+    countpos = 0;
+  }
+
+  /* in old is the old struct */
+  const int elemcount = old_struct[1];
+  const short *old = old_struct + 2;
+  int old_offset = 0;
+  for (int a = 0; a < elemcount; a++, old += 2) {
+    const int old_name_nr = old[1];
+    const char *otype = oldsdna->types[old[0]];
+    const char *oname = oldsdna->names[old[1]];
+    const int len = DNA_elem_size_nr(oldsdna, old[0], old[1]);
+
+    if (strcmp(name, oname) == 0) { /* name equal */
+      const int new_name_array_len = newsdna->names_array_len[new_name_nr];
+
+      if (ispointer(name)) { /* pointer of functionpointer afhandelen */
+        reconstruct_step_add_pointer(
+            steps, steps_len, oldsdna, newsdna, old_offset, new_offset, new_name_array_len);
+      }
+      else if (strcmp(type, otype) == 0) { /* type equal */
+        const ReconstructStep step = {
+            .type = RECONSTRUCT_STEP_MEMCPY,
+            .old_offset = old_offset,
+            .new_offset = new_offset,
+            .len = len,
+        };
+        reconstruct_step_add(steps, steps_len, &step);
+      }
+      else {
+        reconstruct_step_add_cast(
+            steps, steps_len, otype, type, old_offset, new_offset, new_name_array_len);
+      }
+      return;
+    }
+    else if (countpos != 0) { /* name is an array */
+
+      if (oname[countpos] == '[' && strncmp(name, oname, countpos) == 0) { /* basis equal */
+        const int new_name_array_len = newsdna->names_array_len[new_name_nr];
+        const int old_name_array_len = oldsdna->names_array_len[old_name_nr];
+        const int min_name_array_len = MIN2(new_name_array_len, old_name_array_len);
+
+        if (ispointer(name)) { /* handle pointer or functionpointer */
+          reconstruct_step_add_pointer(
+              steps, steps_len, oldsdna, newsdna, old_offset, new_offset, min_name_array_len);
+        }
+        else if (strcmp(type, otype) == 0) { /* type equal */
+          /* size of single old array element, times the smaller of sizes of old and new arrays */
+          const int mul = (len / old_name_array_len) * min_name_array_len;
+          const ReconstructStep step = {
+              .type = RECONSTRUCT_STEP_MEMCPY,
+              .old_offset = old_offset,
+              .new_offset = new_offset,
+              .len = mul,
+          };
+          reconstruct_step_add(steps, steps_len, &step);
+
+          if (old_name_array_len > new_name_array_len && strcmp(type, "char") == 0) {
+            /* string had to be truncated, ensure it's still null-terminated */
+            const ReconstructStep step_terminate = {
+                .type = RECONSTRUCT_STEP_TERMINATE_STRING,
+                .new_offset = new_offset + mul - 1,
+            };
+            reconstruct_step_add(steps, steps_len, &step_terminate);
+          }
+        }
+        else {
+          reconstruct_step_add_cast(
+              steps, steps_len, otype, type, old_offset, new_offset, min_name_array_len);
+        }
+        return;
+      }
+    }
+    old_offset += len;
+  }
+}
+
+/**
+ * Compute the steps converting a struct from \a oldsdna to \a newsdna format,
+ * per member of the new struct, reading data from the old struct.
+ */
+static void reconstruct_struct_info_init(const DNA_ReconstructInfo *reconstruct_info,
+                                         const int old_struct_nr,
+                                         ReconstructStructInfo *struct_info)
+{
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  const short *old_struct = oldsdna->structs[old_struct_nr];
+  const short *new_struct = newsdna->structs[struct_info->new_struct_nr];
+  const int first_struct_type_nr = *(newsdna->structs[0]);
+  const int elemcount = new_struct[1];
+
+  /* Every member results in one step at most, besides truncated strings which need two. */
+  ReconstructStep *steps = MEM_mallocN(sizeof(*steps) * (size_t)(elemcount * 2 + 1), __func__);
+  int steps_len = 0;
+
+  const short *spc = new_struct + 2;
+  int new_offset = 0;
+  for (int a = 0; a < elemcount; a++, spc += 2) { /* convert each field */
+    const char *type = newsdna->types[spc[0]];
+    const char *name = newsdna->names[spc[1]];
+    int elen = DNA_elem_size_nr(newsdna, spc[0], spc[1]);
+
+    /* Skip pad bytes which must start with '_pad', see makesdna.c 'is_name_legal'.
+     * for exact rules. Note that if we fail to skip a pad byte it's harmless,
+     * this just avoids unnecessary reconstruction. */
+    if (name[0] == '_' || (name[0] == '*' && name[1] == '_')) {
+      /* pass */
+    }
+    else if (spc[0] >= first_struct_type_nr && !ispointer(name)) {
+      /* struct field type */
+
+      /* where does the old struct data start (and is there an old one?) */
+      int old_offset;
+      const int old_elem_index = elem_find_with_offset(
+          oldsdna, type, name, old_struct, &old_offset);
+
+      if (old_elem_index != -1) {
+        const short *sppo = old_struct + 2 + old_elem_index * 2;
+        const int old_substruct_nr = DNA_struct_find_nr(oldsdna, type);
+        const int new_substruct_nr = DNA_struct_find_nr(newsdna, type);
+
+        if (old_substruct_nr != -1 && new_substruct_nr != -1) {
+          /* array! */
+          const int mul = newsdna->names_array_len[spc[1]];
+          const int mulo = oldsdna->names_array_len[sppo[1]];
+          const int array_len = MIN2(mul, mulo);
+
+          if (reconstruct_info->compare_flags[old_substruct_nr] == SDNA_CMP_EQUAL) {
+            const int eleno = DNA_elem_size_nr(oldsdna, sppo[0], sppo[1]) / mulo;
+            const ReconstructStep step = {
+                .type = RECONSTRUCT_STEP_MEMCPY,
+                .old_offset = old_offset,
+                .new_offset = new_offset,
+                .len = eleno * array_len,
+            };
+            reconstruct_step_add(steps, &steps_len, &step);
+          }
+          else {
+            ReconstructStep step = {
+                .type = RECONSTRUCT_STEP_SUBSTRUCT,
+                .old_offset = old_offset,
+                .new_offset = new_offset,
+                .len = array_len,
+            };
+            step.data.substruct.old_struct_nr = old_substruct_nr;
+            step.data.substruct.new_struct_nr = new_substruct_nr;
+            reconstruct_step_add(steps, &steps_len, &step);
+          }
+        }
+      }
+      /* else skip field no longer present */
+    }
+    else {
+      /* non-struct field type */
+      reconstruct_steps_add_elem(
+          steps, &steps_len, oldsdna, newsdna, old_struct, spc[0], spc[1], new_offset);
+    }
+    new_offset += elen;
+  }
+
+  struct_info->steps = steps;
+  struct_info->steps_len = steps_len;
+}
+
+/**
+ * Pre-compute how structs in a file with \a oldsdna are converted to \a newsdna.
+ *
+ * \param compare_flags: Result from #DNA_struct_get_compareflags,
+ * structs which are equal don't need any conversion.
+ */
+DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
+                                                 const SDNA *newsdna,
+                                                 const char *compare_flags)
+{
+  DNA_ReconstructInfo *reconstruct_info = MEM_callocN(sizeof(*reconstruct_info), __func__);
+  reconstruct_info->oldsdna = oldsdna;
+  reconstruct_info->newsdna = newsdna;
+  reconstruct_info->compare_flags = compare_flags;
+  reconstruct_info->structs = MEM_callocN(
+      sizeof(*reconstruct_info->structs) * (size_t)oldsdna->structs_len, __func__);
+
+  unsigned int newsdna_index_last = 0;
+  for (int old_struct_nr = 0; old_struct_nr < oldsdna->structs_len; old_struct_nr++) {
+    ReconstructStructInfo *struct_info = &reconstruct_info->structs[old_struct_nr];
+    const short *old_struct = oldsdna->structs[old_struct_nr];
+    struct_info->new_struct_nr = DNA_struct_find_nr_ex(
+        newsdna, oldsdna->types[old_struct[0]], &newsdna_index_last);
+    /* The next indices will almost always match */
+    newsdna_index_last++;
+
+    if (struct_info->new_struct_nr != -1 &&
+        compare_flags[old_struct_nr] == SDNA_CMP_NOT_EQUAL) {
+      reconstruct_struct_info_init(reconstruct_info, old_struct_nr, struct_info);
+    }
+  }
+
+  return reconstruct_info;
+}
+
+void DNA_reconstruct_info_free(DNA_ReconstructInfo *reconstruct_info)
+{
+  for (int old_struct_nr = 0; old_struct_nr < reconstruct_info->oldsdna->structs_len;
+       old_struct_nr++) {
+    MEM_SAFE_FREE(reconstruct_info->structs[old_struct_nr].steps);
+  }
+  MEM_freeN(reconstruct_info->structs);
+  MEM_freeN(reconstruct_info);
+}
+
+/**
+ * Converts the contents of an entire struct from oldsdna to newsdna format.
+ *
+ * \param old_struct_nr: Index of old struct definition in oldsdna.
+ * \param old_data: Struct contents laid out according to oldsdna.
+ * \param new_data: Where to put converted struct contents.
+ */
+static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
+                               const int old_struct_nr,
+                               const char *old_data,
+                               char *new_data)
+{
+  const ReconstructStructInfo *struct_info = &reconstruct_info->structs[old_struct_nr];
+
+  if (reconstruct_info->compare_flags[old_struct_nr] == SDNA_CMP_EQUAL) {
+    const SDNA *oldsdna = reconstruct_info->oldsdna;
+    memcpy(new_data, old_data, oldsdna->types_size[oldsdna->structs[old_struct_nr][0]]);
+    return;
+  }
+
+  for (int i = 0; i < struct_info->steps_len; i++) {
+    const ReconstructStep *step = &struct_info->steps[i];
+    const char *old_elem = old_data + step->old_offset;
+    char *new_elem = new_data + step->new_offset;
+
+    switch (step->type) {
+      case RECONSTRUCT_STEP_MEMCPY:
+        memcpy(new_elem, old_elem, (size_t)step->len);
+        break;
+      case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+        cast_primitive_type(step->data.cast_primitive.old_type,
+                            step->data.cast_primitive.new_type,
+                            step->len,
+                            old_elem,
+                            new_elem);
+        break;
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_32:
+        cast_pointer_64_to_32(step->len, old_elem, new_elem);
+        break;
+      case RECONSTRUCT_STEP_CAST_POINTER_TO_64:
+        cast_pointer_32_to_64(step->len, old_elem, new_elem);
+        break;
+      case RECONSTRUCT_STEP_SUBSTRUCT: {
+        const SDNA *oldsdna = reconstruct_info->oldsdna;
+        const SDNA *newsdna = reconstruct_info->newsdna;
+        const int old_substruct_nr = step->data.substruct.old_struct_nr;
+        const int new_substruct_nr = step->data.substruct.new_struct_nr;
+        const int old_size = oldsdna->types_size[oldsdna->structs[old_substruct_nr][0]];
+        const int new_size = newsdna->types_size[newsdna->structs[new_substruct_nr][0]];
+        for (int a = 0; a < step->len; a++) {
+          reconstruct_struct(reconstruct_info, old_substruct_nr, old_elem, new_elem);
+          old_elem += old_size;
+          new_elem += new_size;
+        }
+        break;
+      }
+      case RECONSTRUCT_STEP_TERMINATE_STRING:
+        *new_elem = '\0';
+        break;
+    }
+  }
+}
+
+/**
+ * \param reconstruct_info: Result from #DNA_reconstruct_info_create.
+ * \param old_struct_nr: Index of struct info within oldsdna.
+ * \param blocks: The number of array elements.
+ * \param old_blocks: Array of struct data.
+ * \return An allocated reconstructed struct.
+ */
+void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
+                             int old_struct_nr,
+                             int blocks,
+                             const void *old_blocks)
+{
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+  const ReconstructStructInfo *struct_info = &reconstruct_info->structs[old_struct_nr];
 
   /* init data and alloc */
-  if (curSDNAnr != -1) {
-    spc = newsdna->structs[curSDNAnr];
-    curlen = newsdna->types_size[spc[0]];
+  if (struct_info->new_struct_nr == -1) {
+    return NULL;
   }
-  if (curlen == 0) {
+  const int old_size = oldsdna->types_size[oldsdna->structs[old_struct_nr][0]];
+  const int new_size = newsdna->types_size[newsdna->structs[struct_info->new_struct_nr][0]];
+  if (new_size == 0) {
     return NULL;
   }
 
-  cur = MEM_callocN(blocks * curlen, "reconstruct");
-  cpc = cur;
-  cpo = data;
-  for (a = 0; a < blocks; a++) {
-    reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-    cpc += curlen;
-    cpo += oldlen;
+  char *new_blocks = MEM_callocN((size_t)blocks * (size_t)new_size, "reconstruct");
+  const char *old_block = old_blocks;
+  char *new_block = new_blocks;
+  for (int a = 0; a < blocks; a++) {
+    reconstruct_struct(reconstruct_info, old_struct_nr, old_block, new_block);
+    old_block += old_size;
+    new_block += new_size;
   }
 
-  return cur;
+  return new_blocks;
 }
 
+/** \} */
+
 /**
  * Returns the offset of the field with the specified name and type within the specified
  * struct type in sdna.
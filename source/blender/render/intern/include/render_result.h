@@ -72,6 +72,10 @@ void render_result_clone_passes(struct Render *re, struct RenderResult *rr, cons
 void render_result_free(struct RenderResult *rr);
 void render_result_free_list(struct ListBase *lb, struct RenderResult *rr);
 
+/* Changes */
+
+void render_result_passes_changed(void);
+
 /* Single Layer Render */
 
 void render_result_single_layer_begin(struct Render *re);
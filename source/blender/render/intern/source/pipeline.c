@@ -2778,6 +2778,8 @@ void RE_layer_load_from_file(
   }
 
   if (ibuf && (ibuf->rect || ibuf->rect_float)) {
+    render_result_passes_changed();
+
     if (ibuf->x == layer->rectx && ibuf->y == layer->recty) {
       if (ibuf->rect_float == NULL) {
         IMB_float_from_rect(ibuf);
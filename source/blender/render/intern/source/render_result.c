@@ -28,6 +28,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_ghash.h"
 #include "BLI_hash_md5.h"
 #include "BLI_listbase.h"
@@ -58,6 +60,24 @@
 
 /********************************** Free *************************************/
 
+/* Incremented whenever passes of render results are freed or written to. */
+static uint render_result_generation = 0;
+
+void render_result_passes_changed(void)
+{
+  atomic_add_and_fetch_uint32(&render_result_generation, 1);
+}
+
+/**
+ * Changes whenever the passes of any render result are freed or written to. Passes allocated
+ * afterwards can get the address of a freed one, so data cached for a pass is only valid as long
+ * as the generation stays the same.
+ */
+unsigned int RE_GetResultGeneration(void)
+{
+  return atomic_add_and_fetch_uint32(&render_result_generation, 0);
+}
+
 static void render_result_views_free(RenderResult *res)
 {
   while (res->views.first) {
@@ -88,6 +108,8 @@ void render_result_free(RenderResult *res)
     return;
   }
 
+  render_result_passes_changed();
+
   while (res->layers.first) {
     RenderLayer *rl = res->layers.first;
 
@@ -866,6 +888,8 @@ void render_result_merge(RenderResult *rr, RenderResult *rrpart)
   RenderLayer *rl, *rlp;
   RenderPass *rpass, *rpassp;
 
+  render_result_passes_changed();
+
   for (rl = rr->layers.first; rl; rl = rl->next) {
     rlp = RE_GetRenderLayer(rrpart, rl->name);
     if (rlp) {
@@ -1342,6 +1366,8 @@ int render_result_exr_file_read_path(RenderResult *rr,
   void *exrhandle = IMB_exr_get_handle();
   int rectx, recty;
 
+  render_result_passes_changed();
+
   if (IMB_exr_begin_read(exrhandle, filepath, &rectx, &recty) == 0) {
     printf("failed being read %s\n", filepath);
     IMB_exr_close(exrhandle);
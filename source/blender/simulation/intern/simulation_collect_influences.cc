@@ -449,6 +449,7 @@ void collect_simulation_influences(Simulation &simulation,
   fn::mf_network_optimization::constant_folding(network, resources);
   fn::mf_network_optimization::common_subnetwork_elimination(network);
   fn::mf_network_optimization::dead_node_removal(network);
+  fn::mf_network_optimization::function_chain_fusion(network, resources);
   // WM_clipboard_text_set(network.to_dot().c_str(), false);
 
   collect_forces(network_map, resources, data_sources, r_influences);
@@ -281,20 +281,28 @@ int main(int argc,
 
   /* NOTE: Special exception for guarded allocator type switch:
    *       we need to perform switch from lock-free to fully
-   *       guarded allocator before any allocation happened.
+   *       guarded (or pooled) allocator before any allocation happened.
    */
   {
     int i;
+    bool use_pooled_allocator = false;
     for (i = 0; i < argc; i++) {
       if (STR_ELEM(argv[i], "-d", "--debug", "--debug-memory", "--debug-all")) {
         printf("Switching to fully guarded memory allocator.\n");
         MEM_use_guarded_allocator();
+        use_pooled_allocator = false;
         break;
       }
+      else if (STREQ(argv[i], "--memory-pooled")) {
+        use_pooled_allocator = true;
+      }
       else if (STREQ(argv[i], "--")) {
         break;
       }
     }
+    if (use_pooled_allocator) {
+      MEM_use_pooled_allocator();
+    }
   }
 
 #ifdef BUILD_DATE
@@ -619,6 +619,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--app-template");
   BLI_argsPrintArgDoc(ba, "--factory-startup");
   BLI_argsPrintArgDoc(ba, "--enable-event-simulate");
+  BLI_argsPrintArgDoc(ba, "--memory-pooled");
   printf("\n");
   BLI_argsPrintArgDoc(ba, "--env-system-datafiles");
   BLI_argsPrintArgDoc(ba, "--env-system-scripts");
@@ -968,7 +969,8 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_tag[] =
     "Enable debug messages from dependency graph related on tagging.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_time[] =
     "\n\t"
-    "Enable debug messages from dependency graph related on timing.";
+    "Enable debug messages from dependency graph related on timing,\n"
+    "\tincluding the critical path of every evaluation.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_eval[] =
     "\n\t"
     "Enable debug messages from dependency graph related on evaluation.";
@@ -1130,6 +1132,19 @@ static int arg_handle_enable_event_simulate(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_memory_pooled_set_doc[] =
+    "\n\t"
+    "Use the pooled memory allocator, which keeps small allocations in per-thread caches\n"
+    "\tand uses NUMA node local memory when available.\n"
+    "\tIgnored when memory debugging is enabled.";
+static int arg_handle_memory_pooled_set(int UNUSED(argc),
+                                        const char **UNUSED(argv),
+                                        void *UNUSED(data))
+{
+  /* Nothing to do, the allocator is switched in main() before anything is allocated. */
+  return 0;
+}
+
 static const char arg_handle_env_system_set_doc_datafiles[] =
     "\n\t"
     "Set the " STRINGIFY_ARG(BLENDER_SYSTEM_DATAFILES) " environment variable.";
@@ -2213,6 +2228,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_argsAdd(ba, 1, NULL, "--app-template", CB(arg_handle_app_template), NULL);
   BLI_argsAdd(ba, 1, NULL, "--factory-startup", CB(arg_handle_factory_startup_set), NULL);
   BLI_argsAdd(ba, 1, NULL, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--memory-pooled", CB(arg_handle_memory_pooled_set), NULL);
 
   /* TODO, add user env vars? */
   BLI_argsAdd(
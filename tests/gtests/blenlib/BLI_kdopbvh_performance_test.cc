@@ -0,0 +1,205 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+/* Number of rays per test. */
+#define RAYS_NUM 1000000
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static BVHTree *grid_tree_create(int grid_size)
+{
+  BVHTree *tree = BLI_bvhtree_new(grid_size * grid_size, 0.0f, 4, 6);
+  const float cell_size = 1.0f / (float)grid_size;
+
+  /* A bumpy surface of small boxes, similar to a subdivided mesh. */
+  for (int y = 0; y < grid_size; y++) {
+    for (int x = 0; x < grid_size; x++) {
+      float box[2][3];
+      box[0][0] = (float)x * cell_size;
+      box[0][1] = (float)y * cell_size;
+      box[0][2] = 0.1f * sinf((float)x * 0.1f) * cosf((float)y * 0.1f);
+      box[1][0] = box[0][0] + cell_size;
+      box[1][1] = box[0][1] + cell_size;
+      box[1][2] = box[0][2] + cell_size * 0.5f;
+      BLI_bvhtree_insert(tree, y * grid_size + x, box[0], 2);
+    }
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
+}
+
+/* Coherent rays, like rays cast from the pixels of a camera looking down on the grid. */
+static void camera_rays_create(float (*co)[3], float (*dir)[3], int rays_num)
+{
+  const int res = (int)sqrtf((float)rays_num);
+  const float eye[3] = {0.5f, 0.5f, 2.0f};
+  for (int i = 0; i < rays_num; i++) {
+    const float target[3] = {(float)(i % res) / (float)res, (float)(i / res) / (float)res, 0.0f};
+    copy_v3_v3(co[i], eye);
+    sub_v3_v3v3(dir[i], target, eye);
+    normalize_v3(dir[i]);
+  }
+}
+
+/* Incoherent rays, between random points. */
+static void random_rays_create(float (*co)[3], float (*dir)[3], int rays_num)
+{
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < rays_num; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+    add_v3_fl(co[i], 0.5f);
+    BLI_rng_get_float_unit_v3(rng, dir[i]);
+  }
+  BLI_rng_free(rng);
+}
+
+static void hits_init(BVHTreeRayHit *hits, int rays_num)
+{
+  for (int i = 0; i < rays_num; i++) {
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+}
+
+static void ray_cast_perf_test(const char *id, int grid_size, bool coherent)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BVHTree *tree = grid_tree_create(grid_size);
+
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(*co) * RAYS_NUM, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(*dir) * RAYS_NUM, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * RAYS_NUM, __func__);
+  if (coherent) {
+    camera_rays_create(co, dir, RAYS_NUM);
+  }
+  else {
+    random_rays_create(co, dir, RAYS_NUM);
+  }
+
+  hits_init(hits, RAYS_NUM);
+  TIMEIT_START(ray_cast);
+  for (int i = 0; i < RAYS_NUM; i++) {
+    BLI_bvhtree_ray_cast_ex(tree, co[i], dir[i], 0.0f, &hits[i], NULL, NULL, 0);
+  }
+  TIMEIT_END(ray_cast);
+
+  int hits_num = 0;
+  for (int i = 0; i < RAYS_NUM; i++) {
+    hits_num += (hits[i].index != -1);
+  }
+
+  hits_init(hits, RAYS_NUM);
+  TIMEIT_START(ray_cast_packet);
+  BLI_bvhtree_ray_cast_packet(tree, co, dir, RAYS_NUM, 0.0f, hits, NULL, NULL, 0);
+  TIMEIT_END(ray_cast_packet);
+
+  int hits_packet_num = 0;
+  for (int i = 0; i < RAYS_NUM; i++) {
+    hits_packet_num += (hits[i].index != -1);
+  }
+  EXPECT_EQ(hits_num, hits_packet_num);
+  printf("%d rays hit\n", hits_num);
+
+  BLI_bvhtree_free(tree);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, RayCastCoherent)
+{
+  ray_cast_perf_test(__func__, 1000, true);
+}
+
+TEST(kdopbvh, RayCastIncoherent)
+{
+  ray_cast_perf_test(__func__, 1000, false);
+}
+
+/* Small boxes, most of them packed in a few dense clusters, like a detailed model in a big
+ * scene. Median splits give poor trees for such uneven distributions. */
+static BVHTree *clustered_tree_create(int boxes_num, int balance_flag)
+{
+  RNG *rng = BLI_rng_new(0);
+  BVHTree *tree = BLI_bvhtree_new(boxes_num, 0.0f, 4, 6);
+
+  for (int i = 0; i < boxes_num; i++) {
+    float box[2][3];
+    BLI_rng_get_float_unit_v3(rng, box[0]);
+    if (i % 10 != 0) {
+      /* Cluster around one of the corners of the unit cube. */
+      mul_v3_fl(box[0], 0.02f * BLI_rng_get_float(rng));
+      box[0][0] += (float)(i % 2);
+      box[0][1] += (float)((i / 2) % 2);
+      box[0][2] += (float)((i / 4) % 2);
+    }
+    copy_v3_v3(box[1], box[0]);
+    add_v3_fl(box[1], 0.001f);
+    BLI_bvhtree_insert(tree, i, box[0], 2);
+  }
+
+  TIMEIT_START(balance);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  TIMEIT_END(balance);
+
+  BLI_rng_free(rng);
+  return tree;
+}
+
+static void balance_perf_test(const char *id, int boxes_num, int balance_flag)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BVHTree *tree = clustered_tree_create(boxes_num, balance_flag);
+  printf("SAH cost: %f\n", BLI_bvhtree_get_sah_cost(tree));
+
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(*co) * RAYS_NUM, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(*dir) * RAYS_NUM, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * RAYS_NUM, __func__);
+  random_rays_create(co, dir, RAYS_NUM);
+  hits_init(hits, RAYS_NUM);
+
+  TIMEIT_START(ray_cast);
+  for (int i = 0; i < RAYS_NUM; i++) {
+    BLI_bvhtree_ray_cast_ex(tree, co[i], dir[i], 0.0f, &hits[i], NULL, NULL, 0);
+  }
+  TIMEIT_END(ray_cast);
+
+  TIMEIT_START(rebalance);
+  BLI_bvhtree_rebalance(tree, balance_flag);
+  TIMEIT_END(rebalance);
+
+  BLI_bvhtree_free(tree);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, BalanceMedian)
+{
+  balance_perf_test(__func__, 1000000, 0);
+}
+
+TEST(kdopbvh, BalanceSAH)
+{
+  balance_perf_test(__func__, 1000000, BVH_BALANCE_SAH);
+}
@@ -2,7 +2,7 @@
 
 #include "testing/testing.h"
 
-/* TODO: ray intersection, overlap ... etc.*/
+/* TODO: overlap ... etc.*/
 
 #include "MEM_guardedalloc.h"
 
@@ -70,8 +70,12 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int balance_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
   BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
@@ -83,7 +87,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : NULL;
@@ -136,3 +140,155 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, SahFindNearest_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SahFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SahFindNearest_5000)
+{
+  /* Big enough to build sub-trees in parallel. */
+  find_nearest_points_test(5000, 1.0, 10000, 12, true, BVH_BALANCE_SAH);
+}
+
+/**
+ * Move all points after balancing, the refitted and the rebuilt trees must both find them.
+ */
+static void rebalance_test(int points_len, int random_seed, int balance_flag)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 26);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  const float cost_balanced = BLI_bvhtree_get_sah_cost(tree);
+  EXPECT_GT(cost_balanced, 0.0f);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_update_node(tree, i, points[i], NULL, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  const float cost_refit = BLI_bvhtree_get_sah_cost(tree);
+  EXPECT_GT(cost_refit, cost_balanced);
+
+  for (int i = 0; i < points_len; i++) {
+    EXPECT_EQ(BLI_bvhtree_find_nearest(tree, points[i], NULL, NULL, NULL), i);
+  }
+
+  BLI_bvhtree_rebalance(tree, balance_flag);
+  EXPECT_LT(BLI_bvhtree_get_sah_cost(tree), cost_refit);
+  EXPECT_EQ(BLI_bvhtree_get_len(tree), points_len);
+
+  for (int i = 0; i < points_len; i++) {
+    EXPECT_EQ(BLI_bvhtree_find_nearest(tree, points[i], NULL, NULL, NULL), i);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, Rebalance)
+{
+  rebalance_test(1000, 1234, 0);
+}
+TEST(kdopbvh, SahRebalance)
+{
+  rebalance_test(1000, 1234, BVH_BALANCE_SAH);
+}
+
+/**
+ * Cast rays from random points towards the center of random boxes,
+ * the packet ray-cast must find the same hits as casting the rays one by one.
+ */
+static void ray_cast_packet_test(int boxes_len,
+                                 int rays_len,
+                                 int random_seed,
+                                 int balance_flag = 0)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0, 4, 6);
+
+  float(*centers)[3] = (float(*)[3])MEM_mallocN(sizeof(*centers) * boxes_len, __func__);
+  for (int i = 0; i < boxes_len; i++) {
+    float box[2][3];
+    rng_v3_round(box[0], 3, rng, 1000, 1.0f);
+    for (int j = 0; j < 3; j++) {
+      box[1][j] = box[0][j] + BLI_rng_get_float(rng) * 0.05f;
+    }
+    mid_v3_v3v3(centers[i], box[0], box[1]);
+    BLI_bvhtree_insert(tree, i, box[0], 2);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(*co) * rays_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(*dir) * rays_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    const float *center = centers[BLI_rng_get_uint(rng) % (unsigned int)boxes_len];
+    rng_v3_round(co[i], 3, rng, 1000, 2.0f);
+    /* Some axis aligned rays, to test the zero direction components. */
+    if (i % 7 == 0) {
+      co[i][i % 3] = center[i % 3];
+    }
+    /* Some rays pointing away from the boxes. */
+    if (i % 5 == 0) {
+      sub_v3_v3v3(dir[i], co[i], center);
+    }
+    else {
+      sub_v3_v3v3(dir[i], center, co[i]);
+    }
+    if (normalize_v3(dir[i]) == 0.0f) {
+      dir[i][0] = 1.0f;
+    }
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_packet(tree, co, dir, rays_len, 0.0f, hits, NULL, NULL, 0);
+
+  int hits_num = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast_ex(tree, co[i], dir[i], 0.0f, &hit, NULL, NULL, 0);
+
+    EXPECT_EQ(hit.index == -1, hits[i].index == -1);
+    if (hit.index != -1) {
+      EXPECT_FLOAT_EQ(hit.dist, hits[i].dist);
+      hits_num++;
+    }
+  }
+  /* Make sure the test does not pass only because nothing is hit. */
+  EXPECT_GT(hits_num, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(centers);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+}
+
+TEST(kdopbvh, RayCastPacket_100)
+{
+  ray_cast_packet_test(100, 1001, 1234);
+}
+TEST(kdopbvh, RayCastPacket_500)
+{
+  ray_cast_packet_test(500, 1003, 12);
+}
+TEST(kdopbvh, SahRayCastPacket_500)
+{
+  ray_cast_packet_test(500, 1003, 12, BVH_BALANCE_SAH);
+}
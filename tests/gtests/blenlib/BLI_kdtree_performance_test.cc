@@ -0,0 +1,68 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+/* Number of points in the tree and of queries per test. */
+#define POINTS_NUM 1000000
+#define QUERIES_NUM 200000
+
+static void kdtree_find_nearest_perf_test(const bool use_multi)
+{
+  struct RNG *rng = BLI_rng_new(0);
+  float(*co)[3] = (float(*)[3])MEM_malloc_arrayN(QUERIES_NUM, sizeof(*co), __func__);
+  int *index = (int *)MEM_malloc_arrayN(QUERIES_NUM, sizeof(*index), __func__);
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(POINTS_NUM);
+  for (int i = 0; i < POINTS_NUM; i++) {
+    float point[3];
+    BLI_rng_get_float_unit_v3(rng, point);
+    mul_v3_fl(point, BLI_rng_get_float(rng));
+    BLI_kdtree_3d_insert(tree, i, point);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+    mul_v3_fl(co[i], BLI_rng_get_float(rng));
+  }
+
+  if (use_multi) {
+    TIMEIT_START(kdtree_find_nearest_multi);
+    BLI_kdtree_3d_find_nearest_multi(tree, co, QUERIES_NUM, index, NULL);
+    TIMEIT_END(kdtree_find_nearest_multi);
+  }
+  else {
+    TIMEIT_START(kdtree_find_nearest);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      index[i] = BLI_kdtree_3d_find_nearest(tree, co[i], NULL);
+    }
+    TIMEIT_END(kdtree_find_nearest);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(co);
+  MEM_freeN(index);
+  BLI_rng_free(rng);
+}
+
+TEST(kdtree, FindNearest)
+{
+  kdtree_find_nearest_perf_test(false);
+}
+
+TEST(kdtree, FindNearestMulti)
+{
+  kdtree_find_nearest_perf_test(true);
+}
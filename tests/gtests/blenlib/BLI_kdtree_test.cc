@@ -0,0 +1,114 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static KDTree_3d *random_tree_create(float (*co)[3], int points_num, struct RNG *rng)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new((uint)points_num);
+  for (int i = 0; i < points_num; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+    mul_v3_fl(co[i], BLI_rng_get_float(rng));
+    BLI_kdtree_3d_insert(tree, i, co[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+static void find_nearest_multi_test(int points_num, int queries_num, const uint seed)
+{
+  struct RNG *rng = BLI_rng_new(seed);
+  float(*points)[3] = (float(*)[3])MEM_malloc_arrayN(points_num, sizeof(*points), __func__);
+  float(*co)[3] = (float(*)[3])MEM_malloc_arrayN(queries_num, sizeof(*co), __func__);
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_malloc_arrayN(
+      queries_num, sizeof(*nearest), __func__);
+  int *index = (int *)MEM_malloc_arrayN(queries_num, sizeof(*index), __func__);
+
+  KDTree_3d *tree = random_tree_create(points, points_num, rng);
+  for (int i = 0; i < queries_num; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+    /* Also query points outside of the tree bounds. */
+    mul_v3_fl(co[i], BLI_rng_get_float(rng) * 2.0f);
+  }
+
+  BLI_kdtree_3d_find_nearest_multi(tree, co, (uint)queries_num, index, nearest);
+
+  for (int i = 0; i < queries_num; i++) {
+    KDTreeNearest_3d expect;
+    const int expect_index = BLI_kdtree_3d_find_nearest(tree, co[i], &expect);
+    EXPECT_EQ(expect_index, index[i]);
+    EXPECT_EQ(expect.index, nearest[i].index);
+    EXPECT_FLOAT_EQ(expect.dist, nearest[i].dist);
+    EXPECT_V3_NEAR(expect.co, nearest[i].co, 0.0f);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(points);
+  MEM_freeN(co);
+  MEM_freeN(nearest);
+  MEM_freeN(index);
+  BLI_rng_free(rng);
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(kdtree, FindNearestMultiEmpty)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+
+  const float co[1][3] = {{0.0f, 0.0f, 0.0f}};
+  int index = 0;
+  BLI_kdtree_3d_find_nearest_multi(tree, co, 1, &index, NULL);
+  EXPECT_EQ(-1, index);
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearestMultiDuplicates)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(20);
+  for (int i = 0; i < 20; i++) {
+    const float co[3] = {(float)(i % 4), 0.0f, 0.0f};
+    BLI_kdtree_3d_insert(tree, i, co);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  float co[4][3] = {{0.1f, 0.0f, 0.0f}, {1.2f, 0.0f, 0.0f}, {2.0f, 1.0f, 0.0f}, {9.0f, 0, 0}};
+  KDTreeNearest_3d nearest[4];
+  BLI_kdtree_3d_find_nearest_multi(tree, co, 4, NULL, nearest);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(nearest[i].co[0], (float)(nearest[i].index % 4));
+  }
+  EXPECT_FLOAT_EQ(0.1f, nearest[0].dist);
+  EXPECT_FLOAT_EQ(0.2f, nearest[1].dist);
+  EXPECT_FLOAT_EQ(1.0f, nearest[2].dist);
+  EXPECT_FLOAT_EQ(6.0f, nearest[3].dist);
+
+  BLI_kdtree_3d_free(tree);
+}
+
+#define FIND_NEAREST_MULTI_TEST(points_num) \
+  TEST(kdtree, FindNearestMulti_##points_num) \
+  { \
+    find_nearest_multi_test(points_num, 10000, points_num); \
+  }
+
+FIND_NEAREST_MULTI_TEST(1)
+FIND_NEAREST_MULTI_TEST(5)
+FIND_NEAREST_MULTI_TEST(9)
+FIND_NEAREST_MULTI_TEST(100)
+FIND_NEAREST_MULTI_TEST(10000)
@@ -115,4 +115,26 @@ TEST(linear_allocator, ConstructArrayCopy)
   EXPECT_EQ(span2[2], 3);
 }
 
+TEST(linear_allocator, Reset)
+{
+  LinearAllocator<> allocator;
+
+  void *ptr1 = allocator.allocate(5000, 8);
+  allocator.reset();
+  void *ptr2 = allocator.allocate(5000, 8);
+  EXPECT_EQ(ptr1, ptr2);
+
+  for (int i = 0; i < 100; i++) {
+    memset(allocator.allocate(1000, 8), i, 1000);
+  }
+  allocator.reset();
+
+  /* The largest buffer is reused, it is larger than the first one. */
+  void *ptr3 = allocator.allocate(10000, 8);
+  memset(ptr3, 0, 10000);
+  allocator.reset();
+  void *ptr4 = allocator.allocate(10000, 8);
+  EXPECT_EQ(ptr3, ptr4);
+}
+
 }  // namespace blender
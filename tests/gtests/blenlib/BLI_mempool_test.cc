@@ -0,0 +1,179 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+};
+
+#define ELEMS_NUM 10000
+
+struct Elem {
+  int value;
+  int pad;
+};
+
+static int mempool_count_iter(BLI_mempool *pool)
+{
+  BLI_mempool_iter iter;
+  BLI_mempool_iternew(pool, &iter);
+  int count = 0;
+  while (BLI_mempool_iterstep(&iter)) {
+    count++;
+  }
+  return count;
+}
+
+TEST(mempool, AllocFreeMulti)
+{
+  BLI_mempool *pool = BLI_mempool_create(sizeof(Elem), 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+
+  std::vector<void *> elems(ELEMS_NUM);
+  BLI_mempool_alloc_multi(pool, elems.data(), ELEMS_NUM);
+  for (int i = 0; i < ELEMS_NUM; i++) {
+    ((Elem *)elems[i])->value = i;
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), ELEMS_NUM);
+  EXPECT_EQ(mempool_count_iter(pool), ELEMS_NUM);
+
+  /* Free every second element. */
+  std::vector<void *> elems_free;
+  for (int i = 0; i < ELEMS_NUM; i += 2) {
+    elems_free.push_back(elems[i]);
+  }
+  BLI_mempool_free_multi(pool, elems_free.data(), (uint)elems_free.size());
+  EXPECT_EQ(BLI_mempool_len(pool), ELEMS_NUM / 2);
+
+  BLI_mempool_iter iter;
+  BLI_mempool_iternew(pool, &iter);
+  int count = 0;
+  while (Elem *elem = (Elem *)BLI_mempool_iterstep(&iter)) {
+    EXPECT_EQ(elem->value % 2, 1);
+    count++;
+  }
+  EXPECT_EQ(count, ELEMS_NUM / 2);
+
+  /* Freed elements are used again. */
+  void *elem_new = BLI_mempool_alloc(pool);
+  EXPECT_EQ(elem_new, elems_free.front());
+  BLI_mempool_free(pool, elem_new);
+
+  elems_free.clear();
+  for (int i = 1; i < ELEMS_NUM; i += 2) {
+    elems_free.push_back(elems[i]);
+  }
+  BLI_mempool_free_multi(pool, elems_free.data(), (uint)elems_free.size());
+  EXPECT_EQ(BLI_mempool_len(pool), 0);
+  EXPECT_EQ(mempool_count_iter(pool), 0);
+
+  BLI_mempool_destroy(pool);
+}
+
+static void thread_cache_alloc_func(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  Elem **elems = (Elem **)userdata;
+  BLI_mempool_thread_cache *cache = (BLI_mempool_thread_cache *)tls->userdata_chunk;
+  elems[index] = (Elem *)BLI_mempool_thread_cache_alloc(cache);
+  elems[index]->value = index;
+}
+
+static void thread_cache_flush_func(const void *__restrict UNUSED(userdata),
+                                    void *__restrict userdata_chunk)
+{
+  BLI_mempool_thread_cache_flush((BLI_mempool_thread_cache *)userdata_chunk);
+}
+
+TEST(mempool, ThreadCacheParallelRange)
+{
+  BLI_mempool *pool = BLI_mempool_create(sizeof(Elem), 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+  std::vector<Elem *> elems(ELEMS_NUM);
+
+  BLI_mempool_thread_cache cache;
+  BLI_mempool_thread_cache_init(pool, &cache);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &cache;
+  settings.userdata_chunk_size = sizeof(cache);
+  settings.func_free = thread_cache_flush_func;
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, ELEMS_NUM, elems.data(), thread_cache_alloc_func, &settings);
+
+  EXPECT_EQ(BLI_mempool_len(pool), ELEMS_NUM);
+  EXPECT_EQ(mempool_count_iter(pool), ELEMS_NUM);
+  for (int i = 0; i < ELEMS_NUM; i++) {
+    EXPECT_EQ(elems[i]->value, i);
+  }
+
+  BLI_mempool_destroy(pool);
+}
+
+TEST(mempool, ThreadCacheThreads)
+{
+  const int threads_num = 8;
+  BLI_mempool *pool = BLI_mempool_create(sizeof(Elem), 0, 64, BLI_MEMPOOL_ALLOW_ITER);
+  std::vector<std::vector<Elem *>> elems(threads_num);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_num; i++) {
+    threads.emplace_back([&, i]() {
+      BLI_mempool_thread_cache cache;
+      BLI_mempool_thread_cache_init(pool, &cache);
+      for (int j = 0; j < ELEMS_NUM; j++) {
+        Elem *elem = (Elem *)BLI_mempool_thread_cache_calloc(&cache);
+        EXPECT_EQ(elem->value, 0);
+        elem->value = i;
+        elems[i].push_back(elem);
+        /* Free some elements right away, to mix allocations and frees. */
+        if (j % 3 == 0) {
+          BLI_mempool_thread_cache_free(&cache, elems[i].back());
+          elems[i].pop_back();
+        }
+      }
+      BLI_mempool_thread_cache_flush(&cache);
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  int total = 0;
+  for (int i = 0; i < threads_num; i++) {
+    for (Elem *elem : elems[i]) {
+      EXPECT_EQ(elem->value, i);
+    }
+    total += (int)elems[i].size();
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), total);
+  EXPECT_EQ(mempool_count_iter(pool), total);
+
+  /* Free the elements from other threads than the ones that allocated them. */
+  for (int i = 0; i < threads_num; i++) {
+    threads.emplace_back([&, i]() {
+      BLI_mempool_thread_cache cache;
+      BLI_mempool_thread_cache_init(pool, &cache);
+      for (Elem *elem : elems[(i + 1) % threads_num]) {
+        BLI_mempool_thread_cache_free(&cache, elem);
+      }
+      BLI_mempool_thread_cache_flush(&cache);
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(BLI_mempool_len(pool), 0);
+  EXPECT_EQ(mempool_count_iter(pool), 0);
+
+  BLI_mempool_destroy(pool);
+}
@@ -17,6 +17,8 @@
  */
 #include "blendfile_loading_base_test.h"
 
+#include "BLI_timeit.hh"
+
 class BlendfileLoadingTest : public BlendfileLoadingBaseTest {
 };
 
@@ -29,3 +31,24 @@ TEST_F(BlendfileLoadingTest, CanaryTest)
   depsgraph_create(DAG_EVAL_RENDER);
   EXPECT_NE(nullptr, this->depsgraph);
 }
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it loads the same
+ * file many times. Loading time of files with many data-blocks is dominated by reading the blocks
+ * and remapping the pointers between them (see `OldNewMap` in `readfile.c`).
+ */
+#if 0
+TEST_F(BlendfileLoadingTest, LoadBenchmark)
+{
+  const char *filepath = "modifier_stack/array_test.blend";
+  for (int i = 0; i < 5; i++) {
+    {
+      SCOPED_TIMER(std::string("Load ") + filepath);
+      if (!blendfile_load(filepath)) {
+        return;
+      }
+    }
+    blendfile_free();
+  }
+}
+#endif
@@ -1,5 +1,7 @@
 #include "testing/testing.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "bmesh.h"
@@ -38,3 +40,75 @@ TEST(bmesh_core, BMVertCreate)
   EXPECT_EQ(BM_mesh_elem_count(bm, BM_VERT), 3);
   BM_mesh_free(bm);
 }
+
+TEST(bmesh_core, BMeshCompact)
+{
+  const int size = 40;
+  BMeshCreateParams bm_params;
+  bm_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  BM_mesh_elem_toolflags_ensure(bm);
+
+  BMVert **verts = (BMVert **)MEM_mallocN(sizeof(BMVert *) * (size + 1) * (size + 1), __func__);
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      const float co[3] = {(float)x, (float)y, 0.0f};
+      verts[y * (size + 1) + x] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      BMVert *quad[4] = {verts[y * (size + 1) + x],
+                         verts[y * (size + 1) + x + 1],
+                         verts[(y + 1) * (size + 1) + x + 1],
+                         verts[(y + 1) * (size + 1) + x]};
+      BM_face_create_verts(bm, quad, 4, NULL, BM_CREATE_NOP, true);
+    }
+  }
+  MEM_freeN(verts);
+
+  /* Fragment the memory pools by removing faces and tagging some of the remaining vertices. */
+  BMIter iter;
+  BMFace *f, *f_next;
+  int index = 0;
+  BM_ITER_MESH_MUTABLE (f, f_next, &iter, bm, BM_FACES_OF_MESH) {
+    if (index++ % 3 == 0) {
+      BM_face_kill_loose(bm, f);
+    }
+  }
+  BMVert *v;
+  float co_sum_before = 0.0f;
+  int tagged_num = 0;
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, index) {
+    co_sum_before += v->co[0] + v->co[1];
+    if (index % 5 == 0) {
+      BMO_vert_flag_enable(bm, v, 1);
+      tagged_num++;
+    }
+  }
+
+  const int totvert = bm->totvert, totedge = bm->totedge, totloop = bm->totloop;
+  const int totface = bm->totface;
+
+  BM_mesh_compact(bm);
+
+  EXPECT_EQ(bm->totvert, totvert);
+  EXPECT_EQ(bm->totedge, totedge);
+  EXPECT_EQ(bm->totloop, totloop);
+  EXPECT_EQ(bm->totface, totface);
+  EXPECT_EQ(BM_mesh_elem_count(bm, BM_FACE), totface);
+#ifdef DEBUG
+  EXPECT_TRUE(BM_mesh_validate(bm));
+#endif
+
+  float co_sum_after = 0.0f;
+  int tagged_num_after = 0;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    co_sum_after += v->co[0] + v->co[1];
+    tagged_num_after += BMO_vert_flag_test(bm, v, 1) ? 1 : 0;
+  }
+  EXPECT_EQ(co_sum_after, co_sum_before);
+  EXPECT_EQ(tagged_num_after, tagged_num);
+
+  BM_mesh_free(bm);
+}
@@ -5,6 +5,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_network.hh"
 #include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
 
 namespace blender::fn {
 
@@ -64,6 +65,152 @@ TEST(multi_function_network, Test1)
   }
 }
 
+TEST(multi_function_network, LargeMask)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> add_fn("add", [](int a, int b) { return a + b; });
+  CustomMF_SI_SO<int, std::string> to_string_fn("to string",
+                                                [](int value) { return std::to_string(value); });
+
+  MFNetwork network;
+
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(add_fn);
+  MFNode &node3 = network.add_function(to_string_fn);
+  MFOutputSocket &input_socket1 = network.add_input("Input 1", MFDataType::ForSingle<int>());
+  MFOutputSocket &input_socket2 = network.add_input("Input 2", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket1 = network.add_output("Output 1", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket2 = network.add_output("Output 2",
+                                                     MFDataType::ForSingle<std::string>());
+  network.add_link(input_socket1, node1.input(0));
+  network.add_link(node1.output(0), node2.input(0));
+  network.add_link(input_socket2, node2.input(1));
+  network.add_link(node2.output(0), output_socket1);
+  network.add_link(node2.output(0), node3.input(0));
+  network.add_link(node3.output(0), output_socket2);
+
+  MFNetworkEvaluator network_fn{{&input_socket1, &input_socket2},
+                                {&output_socket1, &output_socket2}};
+
+  const int size = 100000;
+  Array<int> values(size);
+  for (int i = 0; i < size; i++) {
+    values[i] = i;
+  }
+  const int value = 5;
+
+  /* Every third index, so that the chunks are not ranges. */
+  Vector<int64_t> indices;
+  for (int i = 1; i < size; i += 3) {
+    indices.append(i);
+  }
+
+  for (const bool use_range : {true, false}) {
+    Array<int> results1(size, -1);
+    Array<std::string> results2(size);
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_readonly_single_input(&value);
+    params.add_uninitialized_single_output(results1.as_mutable_span());
+    params.add_uninitialized_single_output(results2.as_mutable_span());
+
+    MFContextBuilder context;
+
+    if (use_range) {
+      network_fn.call(IndexRange(10, size - 20), params, context);
+    }
+    else {
+      network_fn.call(indices.as_span(), params, context);
+    }
+
+    for (int i = 0; i < size; i++) {
+      const bool in_mask = use_range ? (i >= 10 && i < size - 10) : (i % 3 == 1);
+      if (in_mask) {
+        EXPECT_EQ(results1[i], i + 15);
+        EXPECT_EQ(results2[i], std::to_string(i + 15));
+      }
+      else {
+        EXPECT_EQ(results1[i], -1);
+        /* The array was default constructed, the output was not initialized. */
+        EXPECT_EQ(results2[i], "");
+      }
+    }
+  }
+}
+
+TEST(multi_function_network, FunctionChainFusion)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+  CustomMF_SI_SO<int, float> to_float_fn("to float", [](int value) { return (float)value; });
+
+  /* (input1 + 10) * input2 + 10, converted to float. The first addition is also used by the
+   * second output, so it cannot be part of the fused chain. */
+  MFNetwork network;
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(multiply_fn);
+  MFNode &node3 = network.add_function(add_10_fn);
+  MFNode &node4 = network.add_function(to_float_fn);
+  MFOutputSocket &input_socket1 = network.add_input("Input 1", MFDataType::ForSingle<int>());
+  MFOutputSocket &input_socket2 = network.add_input("Input 2", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket1 = network.add_output("Output 1", MFDataType::ForSingle<float>());
+  MFInputSocket &output_socket2 = network.add_output("Output 2", MFDataType::ForSingle<int>());
+  network.add_link(input_socket1, node1.input(0));
+  network.add_link(input_socket2, node2.input(0));
+  network.add_link(node1.output(0), node2.input(1));
+  network.add_link(node2.output(0), node3.input(0));
+  network.add_link(node3.output(0), node4.input(0));
+  network.add_link(node4.output(0), output_socket1);
+  network.add_link(node1.output(0), output_socket2);
+
+  ResourceCollector resources;
+  mf_network_optimization::function_chain_fusion(network, resources);
+  EXPECT_EQ(network.function_nodes().size(), 2);
+
+  MFNetworkEvaluator network_fn{{&input_socket1, &input_socket2},
+                                {&output_socket1, &output_socket2}};
+
+  const int size = 10000;
+  Array<int> values(size);
+  for (int i = 0; i < size; i++) {
+    values[i] = i;
+  }
+  const int value = 3;
+
+  /* Indices with gaps larger than the chunk size of the fused function, which is 4096. */
+  Vector<int64_t> indices;
+  for (int i = 0; i < size; i += (i % 7 == 0) ? 5000 : 1) {
+    indices.append(i);
+  }
+
+  for (const bool use_range : {true, false}) {
+    Array<float> results1(size, -1.0f);
+    Array<int> results2(size, -1);
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_readonly_single_input(&value);
+    params.add_uninitialized_single_output(results1.as_mutable_span());
+    params.add_uninitialized_single_output(results2.as_mutable_span());
+
+    MFContextBuilder context;
+
+    if (use_range) {
+      network_fn.call(IndexRange(size), params, context);
+    }
+    else {
+      network_fn.call(indices.as_span(), params, context);
+    }
+
+    for (int i = 0; i < size; i++) {
+      const bool in_mask = use_range || indices.contains(i);
+      EXPECT_EQ(results1[i], in_mask ? (float)((i + 10) * 3 + 10) : -1.0f);
+      EXPECT_EQ(results2[i], in_mask ? i + 10 : -1);
+    }
+  }
+}
+
 class ConcatVectorsFunction : public MultiFunction {
  public:
   ConcatVectorsFunction()
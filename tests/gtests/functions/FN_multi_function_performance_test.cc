@@ -0,0 +1,149 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_float3.hh"
+
+#include "FN_multi_function.hh"
+#include "FN_multi_function_builder.hh"
+#include "FN_multi_function_network.hh"
+#include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
+
+#include "PIL_time.h"
+
+namespace blender::fn {
+
+/* Number of elements per test. */
+#define ELEMENTS_NUM 100000
+#define RUNS_NUM 1000
+
+/**
+ * Reference function that accesses every element through the virtual span, like the builder
+ * functions do for inputs that cannot be devirtualized.
+ */
+template<typename T> class VirtualAddFunction : public MultiFunction {
+ public:
+  VirtualAddFunction()
+  {
+    MFSignatureBuilder builder = this->get_builder("Add");
+    builder.single_input<T>("A");
+    builder.single_input<T>("B");
+    builder.single_output<T>("Result");
+  }
+
+  void call(IndexMask mask, MFParams params, MFContext UNUSED(context)) const override
+  {
+    VSpan<T> a = params.readonly_single_input<T>(0, "A");
+    VSpan<T> b = params.readonly_single_input<T>(1, "B");
+    MutableSpan<T> result = params.uninitialized_single_output<T>(2, "Result");
+
+    mask.foreach_index([&](int64_t i) { new (&result[i]) T(a[i] + b[i]); });
+  }
+};
+
+template<typename T>
+static void add_perf_test(const MultiFunction &fn, const char *name, const bool use_single)
+{
+  Array<T> values_a(ELEMENTS_NUM);
+  Array<T> values_b(ELEMENTS_NUM);
+  Array<T> outputs(ELEMENTS_NUM);
+  for (int i = 0; i < ELEMENTS_NUM; i++) {
+    values_a[i] = T((float)i);
+    values_b[i] = T((float)(i % 100));
+  }
+  const T value_single = T(2.0f);
+
+  MFParamsBuilder params(fn, ELEMENTS_NUM);
+  params.add_readonly_single_input(values_a.as_span());
+  if (use_single) {
+    params.add_readonly_single_input(&value_single);
+  }
+  else {
+    params.add_readonly_single_input(values_b.as_span());
+  }
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+
+  MFContextBuilder context;
+
+  const double start = PIL_check_seconds_timer();
+  for (int run = 0; run < RUNS_NUM; run++) {
+    fn.call(IndexRange(ELEMENTS_NUM), params, context);
+  }
+  printf("%s: %.6f\n", name, PIL_check_seconds_timer() - start);
+
+  const int64_t last = ELEMENTS_NUM - 1;
+  const T expected = values_a[last] + (use_single ? value_single : values_b[last]);
+  EXPECT_EQ(outputs[last], expected);
+}
+
+TEST(multi_function_performance, FloatAdd)
+{
+  VirtualAddFunction<float> virtual_fn;
+  CustomMF_SI_SI_SO<float, float, float> fn{"Add", [](float a, float b) { return a + b; }};
+
+  add_perf_test<float>(virtual_fn, "float_add_virtual", false);
+  add_perf_test<float>(fn, "float_add_builder", false);
+  add_perf_test<float>(virtual_fn, "float_add_single_virtual", true);
+  add_perf_test<float>(fn, "float_add_single_builder", true);
+}
+
+TEST(multi_function_performance, Float3Add)
+{
+  VirtualAddFunction<float3> virtual_fn;
+  CustomMF_SI_SI_SO<float3, float3, float3> fn{"Add",
+                                               [](float3 a, float3 b) { return a + b; }};
+
+  add_perf_test<float3>(virtual_fn, "float3_add_virtual", false);
+  add_perf_test<float3>(fn, "float3_add_builder", false);
+}
+
+TEST(multi_function_performance, NetworkEvaluation)
+{
+  CustomMF_SI_SI_SO<float, float, float> add_fn{"Add", [](float a, float b) { return a + b; }};
+  CustomMF_SI_SI_SO<float, float, float> mul_fn{"Multiply",
+                                                [](float a, float b) { return a * b; }};
+
+  /* A chain of nodes, every node uses the output of the previous one and the input. */
+  MFNetwork network;
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<float>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<float>());
+  MFOutputSocket *previous = &input_socket;
+  for (int i = 0; i < 16; i++) {
+    MFNode &node = network.add_function((i % 2) ? add_fn : mul_fn);
+    network.add_link(*previous, node.input(0));
+    network.add_link(input_socket, node.input(1));
+    previous = &node.output(0);
+  }
+  network.add_link(*previous, output_socket);
+
+  const int size = 1000000;
+  Array<float> values(size, 0.5f);
+  Array<float> results(size);
+
+  auto evaluate = [&](const char *name) {
+    MFNetworkEvaluator network_fn{{&input_socket}, {&output_socket}};
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_uninitialized_single_output(results.as_mutable_span());
+
+    MFContextBuilder context;
+
+    const double start = PIL_check_seconds_timer();
+    for (int run = 0; run < 20; run++) {
+      network_fn.call(IndexRange(size), params, context);
+    }
+    printf("%s: %.6f\n", name, PIL_check_seconds_timer() - start);
+  };
+
+  evaluate("network_evaluation");
+  const float expected = results[0];
+
+  ResourceCollector resources;
+  mf_network_optimization::function_chain_fusion(network, resources);
+  evaluate("network_evaluation_fused");
+  EXPECT_EQ(results[0], expected);
+}
+
+}  // namespace blender::fn
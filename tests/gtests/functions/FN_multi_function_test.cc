@@ -248,6 +248,56 @@ TEST(multi_function, CustomMF_SI_SI_SO)
   EXPECT_EQ(outputs[3], 90);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_Range)
+{
+  CustomMF_SI_SI_SO<float, float, float> fn("add", [](float a, float b) { return a + b; });
+
+  const int size = 100;
+  Array<float> values_a(size);
+  Array<float> values_b(size);
+  Array<const float *> pointers_b(size);
+  for (int i = 0; i < size; i++) {
+    values_a[i] = (float)i;
+    values_b[i] = (float)(i * 10);
+    pointers_b[i] = &values_b[i];
+  }
+  const float value_c = 0.5f;
+  Array<float> outputs1(size, -1.0f);
+  Array<float> outputs2(size, -1.0f);
+  Array<float> outputs3(size, -1.0f);
+
+  MFContextBuilder context;
+
+  /* Full arrays. */
+  MFParamsBuilder params1(fn, size);
+  params1.add_readonly_single_input(values_a.as_span());
+  params1.add_readonly_single_input(values_b.as_span());
+  params1.add_uninitialized_single_output(outputs1.as_mutable_span());
+  fn.call(IndexRange(3, 90), params1, context);
+
+  /* Array and single value. */
+  MFParamsBuilder params2(fn, size);
+  params2.add_readonly_single_input(values_a.as_span());
+  params2.add_readonly_single_input(&value_c);
+  params2.add_uninitialized_single_output(outputs2.as_mutable_span());
+  fn.call(IndexRange(3, 90), params2, context);
+
+  /* Pointer array, which is not devirtualized. */
+  MFParamsBuilder params3(fn, size);
+  params3.add_readonly_single_input(values_a.as_span());
+  params3.add_readonly_single_input(GVSpan::FromFullPointerArray(
+      CPPType::get<float>(), (const void *const *)pointers_b.data(), size));
+  params3.add_uninitialized_single_output(outputs3.as_mutable_span());
+  fn.call(IndexRange(3, 90), params3, context);
+
+  for (int i = 0; i < size; i++) {
+    const bool in_mask = i >= 3 && i < 93;
+    EXPECT_EQ(outputs1[i], in_mask ? (float)(i * 11) : -1.0f);
+    EXPECT_EQ(outputs2[i], in_mask ? (float)i + 0.5f : -1.0f);
+    EXPECT_EQ(outputs3[i], in_mask ? (float)(i * 11) : -1.0f);
+  }
+}
+
 TEST(multi_function, CustomMF_SI_SI_SI_SO)
 {
   CustomMF_SI_SI_SI_SO<int, std::string, bool, uint> fn{
@@ -0,0 +1,122 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+namespace {
+
+/* Switch once, all tests in this file use the pooled allocator. */
+class PooledAllocatorTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    MEM_use_pooled_allocator();
+  }
+};
+
+void alloc_free_many(std::vector<void *> &blocks, const int num, const int seed)
+{
+  for (int i = 0; i < num; i++) {
+    const size_t len = (size_t)((i * 37 + seed) % 2000);
+    char *data = (char *)MEM_mallocN(len, __func__);
+    memset(data, i & 0xff, len);
+    blocks.push_back(data);
+  }
+  for (size_t i = 0; i < blocks.size(); i += 2) {
+    MEM_freeN(blocks[i]);
+    blocks[i] = nullptr;
+  }
+}
+
+}  // namespace
+
+TEST_F(PooledAllocatorTest, AllocN_len)
+{
+  for (size_t len = 0; len < 2048; len++) {
+    void *data = MEM_mallocN(len, __func__);
+    EXPECT_GE(MEM_allocN_len(data), len);
+    EXPECT_LT(MEM_allocN_len(data), len + 4);
+    MEM_freeN(data);
+  }
+}
+
+TEST_F(PooledAllocatorTest, CallocClears)
+{
+  /* Reuse a freed block, which has non-zero contents. */
+  char *data = (char *)MEM_mallocN(100, __func__);
+  memset(data, 0xff, 100);
+  MEM_freeN(data);
+
+  data = (char *)MEM_callocN(100, __func__);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(data[i], 0);
+  }
+
+  data = (char *)MEM_recallocN(data, 500);
+  for (int i = 0; i < 500; i++) {
+    EXPECT_EQ(data[i], 0);
+  }
+  MEM_freeN(data);
+}
+
+TEST_F(PooledAllocatorTest, Aligned)
+{
+  void *data = MEM_mallocN_aligned(100, 64, __func__);
+  EXPECT_EQ((size_t)data % 64, 0);
+  data = MEM_reallocN(data, 20);
+  EXPECT_EQ((size_t)data % 64, 0);
+  MEM_freeN(data);
+}
+
+TEST_F(PooledAllocatorTest, MemoryInUse)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  void *small = MEM_mallocN(64, __func__);
+  void *large = MEM_mallocN(1 << 20, __func__);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use + 64 + (1 << 20));
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use + 2);
+  EXPECT_GE(MEM_get_peak_memory(), mem_in_use + 64 + (1 << 20));
+
+  MEM_freeN(small);
+  MEM_freeN(large);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+}
+
+TEST_F(PooledAllocatorTest, Threads)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const int threads_num = 8;
+
+  std::vector<std::vector<void *>> blocks(threads_num);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_num; i++) {
+    threads.emplace_back(alloc_free_many, std::ref(blocks[i]), 10000, i);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  /* Free the remaining blocks from other threads than the ones that allocated them. */
+  for (int i = 0; i < threads_num; i++) {
+    threads.emplace_back([&blocks, i]() {
+      for (void *data : blocks[(i + 1) % threads_num]) {
+        if (data != nullptr) {
+          MEM_freeN(data);
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+}